@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BUFFERED_FILE_WRITER_H
+#define BUFFERED_FILE_WRITER_H
+
+#include <ostream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class SystemThread;
+class SystemMutex;
+class SystemCondition;
+
+/**
+ * \brief Accumulate trace records in memory and hand them to an output
+ * stream in large blocks.
+ *
+ * Trace file classes such as PcapFile write a handful of bytes per record.
+ * Issuing one stream write per field and per packet makes the simulation
+ * thread spend most of its time in the I/O library when many devices are
+ * traced.  This class lets those classes copy each record into a large
+ * in-memory buffer instead; the buffer is written to the stream with a
+ * single call when it fills up, when Flush () is called and when the
+ * writer is destroyed.
+ *
+ * If asynchronous mode is requested (and the build supports threads), two
+ * buffers are used.  When the active buffer fills up it is handed to a
+ * background SystemThread which performs the stream write while the
+ * simulation keeps filling the other buffer.  The simulation thread only
+ * blocks if it fills the second buffer before the first one has been
+ * written out.
+ *
+ * While a BufferedFileWriter is attached to a stream, the stream must not
+ * be written or repositioned by anyone else, except after a call to Flush ().
+ */
+class BufferedFileWriter
+{
+public:
+  static const uint32_t BUFFER_SIZE_DEFAULT = 1 << 20; /**< Default buffer size, in bytes */
+
+  /**
+   * \brief Create a writer for the given stream.
+   *
+   * \param os The stream that receives the buffered data.  It must outlive
+   * the writer.
+   * \param bufferSize The size of each in-memory buffer, in bytes.
+   * \param async If true, and threads are available, stream writes are
+   * performed by a background thread.
+   */
+  BufferedFileWriter (std::ostream *os, uint32_t bufferSize = BUFFER_SIZE_DEFAULT, bool async = false);
+
+  /**
+   * Flush any pending data and stop the background thread, if any.
+   */
+  ~BufferedFileWriter ();
+
+  /**
+   * \brief Reserve space for a record in the active buffer.
+   *
+   * The caller must fill all the returned bytes before calling any other
+   * method of this object.  If the record does not fit in the remaining
+   * space, the active buffer is handed to the stream first.  Records larger
+   * than the buffer size cause the buffers to grow.
+   *
+   * \param size The number of bytes to reserve.
+   * \returns a pointer to the reserved bytes.
+   */
+  uint8_t * Reserve (uint32_t size);
+
+  /**
+   * \brief Append a block of bytes to the active buffer.
+   *
+   * \param data The bytes to copy.
+   * \param size The number of bytes to copy.
+   */
+  void Write (uint8_t const *data, uint32_t size);
+
+  /**
+   * \brief Hand all buffered data to the stream and wait until it has
+   * been written, then flush the stream itself.
+   */
+  void Flush (void);
+
+  /**
+   * \returns the size of each in-memory buffer, in bytes.
+   */
+  uint32_t GetBufferSize (void) const;
+
+  /**
+   * \returns true if stream writes are performed by a background thread.
+   */
+  bool IsAsync (void) const;
+
+private:
+  /**
+   * \brief Hand the active buffer to the stream (directly or through the
+   * background thread) and make the other buffer active.
+   */
+  void HandOff (void);
+  /**
+   * \brief Block until the background thread has no buffer in progress.
+   */
+  void WaitIdle (void);
+  /**
+   * \brief Entry point of the background thread.
+   */
+  void DoWrite (void);
+
+  std::ostream *m_os;                   //!< destination stream
+  std::vector<uint8_t> m_buffers[2];    //!< double buffer
+  uint32_t m_active;                    //!< index of the buffer being filled
+  uint32_t m_used;                      //!< bytes used in the active buffer
+  bool m_async;                         //!< true if a background thread performs writes
+
+  Ptr<SystemThread> m_thread;           //!< background writer thread
+  SystemMutex *m_mutex;                 //!< protects the fields below
+  SystemCondition *m_work;              //!< signaled when a buffer is handed off
+  SystemCondition *m_idle;              //!< signaled when a buffer has been written
+  uint32_t m_pending;                   //!< index of the buffer being written
+  uint32_t m_pendingSize;               //!< bytes to write from the pending buffer, 0 if none
+  bool m_stop;                          //!< ask the background thread to exit
+};
+
+} // namespace ns3
+
+#endif /* BUFFERED_FILE_WRITER_H */
@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAPTURE_FILTER_H
+#define CAPTURE_FILTER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \brief Decide which packets a trace file records.
+ *
+ * Trace helpers record every packet seen by a traced device, and writing
+ * (pcap) or formatting (ascii) each of them is expensive.  A CaptureFilter
+ * is attached to a trace file and checked before anything is written, so
+ * that packets which are filtered out cost only a few comparisons.
+ *
+ * Three criteria are available, all of which must accept a packet:
+ *
+ * - a time window set with SetTimeWindow ();
+ * - an expression set with SetExpression (), written in a subset of the
+ *   pcap-filter(7) language understood by tcpdump and Wireshark;
+ * - 1-in-N sampling set with SetSampling (), which keeps every N-th packet
+ *   among those accepted by the two previous criteria.
+ *
+ * The expression is compiled once into a postfix program.  Primitives
+ * are combined with "and" (or "&&"), "or" (or "||"), "not" (or "!") and
+ * parentheses, and may be any of:
+ *
+ * - "ip", "ip6", "arp": the network protocol of the packet;
+ * - "tcp", "udp", "icmp", "icmp6": the transport protocol carried by IPv4
+ *   or IPv6 (extension headers are not followed);
+ * - "proto N": the IPv4 protocol or IPv6 next header field is N;
+ * - "[src|dst] host A": the IPv4, IPv6 or ARP source and/or destination
+ *   address is A;
+ * - "[src|dst] net A/L": the source and/or destination address is in the
+ *   prefix A/L;
+ * - "[tcp|udp] [src|dst] port N": the TCP or UDP source and/or
+ *   destination port is N;
+ * - "less N", "greater N": the packet is at most, or at least, N bytes long.
+ *
+ * To find the network header, the filter must know how the traced packet
+ * is framed.  Pcap files pass their data link type to Accept ().  When the
+ * data link type is unknown (as with ascii traces), the network header is
+ * located through the packet metadata, which the ascii trace helpers
+ * enable.
+ *
+ * Filters keep the state of their sampling counter, so a single filter
+ * should not be shared by unrelated trace files; the trace helpers attach
+ * a copy of the filter to each file they create.
+ */
+class CaptureFilter : public SimpleRefCount<CaptureFilter>
+{
+public:
+  static const uint32_t DLT_UNKNOWN = 0xffffffff; /**< Data link type meaning "use packet metadata" */
+
+  /**
+   * Create a filter which accepts every packet.
+   */
+  CaptureFilter ();
+
+  /**
+   * Create a filter from an expression.
+   *
+   * \param expression The filter expression, see SetExpression ().
+   */
+  CaptureFilter (std::string const &expression);
+
+  /**
+   * \brief Compile a filter expression.
+   *
+   * The program aborts if the expression is not valid.  An empty
+   * expression accepts every packet.
+   *
+   * \param expression The filter expression.
+   */
+  void SetExpression (std::string const &expression);
+
+  /**
+   * \returns the filter expression.
+   */
+  std::string GetExpression (void) const;
+
+  /**
+   * \brief Keep only one of every \p n packets that match the other criteria.
+   *
+   * \param n The sampling period; 0 or 1 disable sampling.
+   */
+  void SetSampling (uint32_t n);
+
+  /**
+   * \brief Only accept packets traced during a time window.
+   *
+   * \param start Start of the window.
+   * \param stop End of the window (excluded).  Time::Max () if the window
+   * never ends.
+   */
+  void SetTimeWindow (Time start, Time stop = Time::Max ());
+
+  /**
+   * \brief Check whether a packet should be recorded.
+   *
+   * This updates the sampling counter, so it must be called exactly once
+   * per traced packet.
+   *
+   * \param p The traced packet.
+   * \param dataLinkType The pcap data link type of the packet, or
+   * DLT_UNKNOWN to locate the network header with packet metadata.
+   * \param header An optional header which precedes the packet in the trace.
+   * \returns true if the packet should be recorded.
+   */
+  bool Accept (Ptr<const Packet> p, uint32_t dataLinkType = DLT_UNKNOWN, const Header *header = 0);
+
+  /**
+   * \brief Check whether a raw frame should be recorded.
+   *
+   * As Accept (Ptr<const Packet>, uint32_t, const Header *), for frames
+   * which are already serialized.  There is no packet metadata, so the
+   * expression can only match if \p dataLinkType is known.
+   *
+   * \param buffer The frame.
+   * \param length The length of the frame.
+   * \param dataLinkType The pcap data link type of the frame.
+   * \returns true if the frame should be recorded.
+   */
+  bool Accept (uint8_t const *buffer, uint32_t length, uint32_t dataLinkType);
+
+  /**
+   * \returns a new filter with the same criteria and a fresh sampling counter.
+   */
+  Ptr<CaptureFilter> Copy (void) const;
+
+private:
+  /**
+   * The fields of a packet which primitives test, extracted once per packet.
+   */
+  struct Fields
+  {
+    uint16_t l3;            //!< network protocol, as an ethertype, or 0 if unknown
+    uint8_t proto;          //!< IPv4 protocol or IPv6 next header
+    uint8_t addrLen;        //!< length of the addresses, 0 if none
+    uint8_t src[16];        //!< source address
+    uint8_t dst[16];        //!< destination address
+    bool hasPorts;          //!< true if the ports are known
+    uint16_t srcPort;       //!< source port
+    uint16_t dstPort;       //!< destination port
+    uint32_t length;        //!< total length of the traced packet
+  };
+
+  /// Kind of a program instruction
+  enum Opcode
+  {
+    OP_AND,       //!< pop two values, push their conjunction
+    OP_OR,        //!< pop two values, push their disjunction
+    OP_NOT,       //!< negate the top value
+    OP_L3,        //!< network protocol is \c value
+    OP_PROTO,     //!< transport protocol is \c value
+    OP_HOST,      //!< address matches \c addr
+    OP_NET,       //!< address matches \c addr / \c value
+    OP_PORT,      //!< port is \c value, optionally for protocol \c proto
+    OP_LESS,      //!< length at most \c value
+    OP_GREATER    //!< length at least \c value
+  };
+
+  /// Which addresses or ports a primitive tests
+  enum Direction
+  {
+    SRC_OR_DST,   //!< either the source or the destination
+    SRC,          //!< the source only
+    DST           //!< the destination only
+  };
+
+  /// One instruction of a compiled expression
+  struct Instruction
+  {
+    Opcode op;              //!< instruction kind
+    Direction dir;          //!< direction qualifier
+    uint32_t value;         //!< numeric operand
+    uint8_t proto;          //!< protocol qualifier of a port, 0 if none
+    uint8_t addrLen;        //!< length of \c addr: 4 or 16
+    uint8_t addr[16];       //!< address operand
+  };
+
+  /**
+   * \brief Recursive-descent compiler for filter expressions.
+   */
+  class Parser;
+
+  /**
+   * \brief Extract the fields tested by primitives.
+   * \param p the packet
+   * \param dataLinkType the pcap data link type, or DLT_UNKNOWN
+   * \param header optional header preceding the packet
+   * \param fields [out] the extracted fields
+   */
+  static void Extract (Ptr<const Packet> p, uint32_t dataLinkType, const Header *header, Fields &fields);
+
+  /**
+   * \brief Extract the fields tested by primitives from serialized bytes.
+   * \param buf the start of the traced data
+   * \param want the number of bytes available in \p buf
+   * \param dataLinkType the pcap data link type, or DLT_UNKNOWN if
+   * \p l3Offset and \c fields.l3 are already known
+   * \param l3Offset the offset of the network header, if already known
+   * \param fields [in,out] the extracted fields
+   */
+  static void Parse (uint8_t const *buf, uint32_t want, uint32_t dataLinkType, uint32_t l3Offset, Fields &fields);
+
+  /**
+   * \brief Evaluate one primitive.
+   * \param insn the primitive
+   * \param fields the packet fields
+   * \returns the value of the primitive
+   */
+  static bool Test (Instruction const &insn, Fields const &fields);
+
+  /**
+   * \returns true if the current time is within the time window
+   */
+  bool InTimeWindow (void) const;
+
+  /**
+   * \brief Run the compiled expression.
+   * \param fields the packet fields
+   * \returns the value of the expression
+   */
+  bool Evaluate (Fields const &fields) const;
+
+  /**
+   * \brief Apply sampling to a packet which matched the other criteria.
+   * \returns true if the packet is kept
+   */
+  bool Sample (void);
+
+  std::string m_expression;                 //!< source of the expression
+  std::vector<Instruction> m_program;       //!< compiled expression, in postfix order
+  uint32_t m_sampling;                      //!< sampling period
+  uint32_t m_sampleCount;                   //!< matching packets seen since the last sample
+  Time m_start;                             //!< start of the time window
+  Time m_stop;                              //!< end of the time window
+};
+
+} // namespace ns3
+
+#endif /* CAPTURE_FILTER_H */
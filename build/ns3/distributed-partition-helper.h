@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DISTRIBUTED_PARTITION_HELPER_H
+#define DISTRIBUTED_PARTITION_HELPER_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Assign the system ids of the nodes of a distributed simulation.
+ *
+ * The topology is described to the helper before any device is installed:
+ * the nodes, with an optional estimate of the load they generate, the
+ * point to point links with their delay, and the shared channels (csma,
+ * wifi, ...) whose nodes cannot be split across systems.  Partition ()
+ * then computes a balanced partition of the nodes and sets the SystemId
+ * attribute of each node, so that the point to point helper creates remote
+ * channels for the links which are cut.
+ *
+ * The partition first maximizes the lookahead, i.e., the smallest delay
+ * of the cut links: the links shorter than the largest delay which still
+ * allows a balanced partition are never cut.  The remaining graph is then
+ * partitioned by a multilevel algorithm (heavy edge matching, greedy graph
+ * growing and greedy k-way refinement) which minimizes the sum of the
+ * inverse of the delays of the cut links, while keeping the load of every
+ * system within the allowed imbalance.
+ *
+ * The algorithm is deterministic, so that all the systems compute the
+ * same partition from the same description of the topology.
+ */
+class DistributedPartitionHelper
+{
+public:
+  DistributedPartitionHelper ();
+
+  /**
+   * \param imbalance the allowed imbalance, as a fraction of the average
+   *        load of the systems (0.05 by default)
+   */
+  void SetImbalance (double imbalance);
+
+  /**
+   * Add a node, or update its load if it was already added.
+   *
+   * \param node the node
+   * \param load an estimate of the load of the node, in any unit
+   */
+  void AddNode (Ptr<Node> node, double load = 1.0);
+  /**
+   * Add a set of nodes, or update their load.
+   *
+   * \param nodes the nodes
+   * \param load an estimate of the load of each node
+   */
+  void AddNodes (NodeContainer nodes, double load = 1.0);
+  /**
+   * Add a point to point link.  The nodes are added with a load of 1
+   * if they were not added yet.  A link with a zero delay is never cut.
+   *
+   * \param a the first node
+   * \param b the second node
+   * \param delay the propagation delay of the link
+   */
+  void AddLink (Ptr<Node> a, Ptr<Node> b, Time delay);
+  /**
+   * Add a channel which cannot span several systems: all the nodes
+   * attached to it are assigned to the same system.
+   *
+   * \param nodes the nodes attached to the channel
+   */
+  void AddChannel (NodeContainer nodes);
+
+  /**
+   * Partition the nodes and set their SystemId attribute.  This must be
+   * done before the devices are installed on the nodes.
+   *
+   * \param systemCount the number of systems
+   */
+  void Partition (uint32_t systemCount);
+
+  /**
+   * \param node a node added to the helper
+   * \returns the system id assigned to the node by Partition ()
+   */
+  uint32_t GetSystemId (Ptr<Node> node) const;
+  /**
+   * \returns the smallest delay of the links cut by Partition (),
+   *          or Time::Max () if no link is cut
+   */
+  Time GetLookahead (void) const;
+  /**
+   * \param systemId the system id
+   * \returns the sum of the loads of the nodes assigned to the system
+   */
+  double GetLoad (uint32_t systemId) const;
+
+private:
+  /// A link between two nodes, identified by their index
+  struct Link
+  {
+    uint32_t a;  //!< The first node
+    uint32_t b;  //!< The second node
+    Time delay;  //!< The delay of the link
+  };
+
+  /**
+   * \param node a node
+   * \returns the index of the node, after adding it with a load of 1
+   *          if needed
+   */
+  uint32_t GetIndex (Ptr<Node> node);
+
+  double m_imbalance;                       //!< The allowed imbalance
+  std::vector<Ptr<Node> > m_nodes;          //!< The nodes
+  std::vector<double> m_loads;              //!< The load of each node
+  std::map<uint32_t, uint32_t> m_indices;   //!< The index of each node, by node id
+  std::vector<Link> m_links;                //!< The point to point links
+  std::vector<std::vector<uint32_t> > m_channels; //!< The nodes of each shared channel
+  std::vector<uint32_t> m_systemIds;        //!< The system id of each node
+  std::vector<double> m_systemLoads;        //!< The load of each system
+  Time m_lookahead;                         //!< The smallest delay of the cut links
+};
+
+} // namespace ns3
+
+#endif /* DISTRIBUTED_PARTITION_HELPER_H */
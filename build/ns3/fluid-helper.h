@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLUID_HELPER_H
+#define FLUID_HELPER_H
+
+#include <string>
+#include "ns3/object-factory.h"
+#include "ns3/node-container.h"
+#include "ns3/fluid-traffic-matrix.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup fluid
+ *
+ * \brief Build the fluid model of the background traffic of point-to-point links
+ */
+class FluidHelper
+{
+public:
+  /**
+   * Create a FluidHelper to carry background traffic as fluid over the
+   * point-to-point links of a set of nodes.
+   */
+  FluidHelper ();
+
+  /**
+   * Set an attribute of the FluidLink objects created by the helper.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetLinkAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Attach a FluidLink to each PointToPointNetDevice of the nodes, with the
+   * data rate of the device, and add them to a new traffic matrix.
+   *
+   * \param c the nodes
+   * \return the traffic matrix, to which the background demands are added
+   */
+  Ptr<FluidTrafficMatrix> Install (NodeContainer c) const;
+
+private:
+  ObjectFactory m_linkFactory; //!< The factory of the FluidLink objects
+};
+
+} // namespace ns3
+
+#endif /* FLUID_HELPER_H */
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLUID_LINK_H
+#define FLUID_LINK_H
+
+#include "ns3/point-to-point-load-model.h"
+#include "ns3/data-rate.h"
+#include "ns3/random-variable-stream.h"
+#include <deque>
+
+namespace ns3 {
+
+/**
+ * \ingroup fluid
+ *
+ * \brief The fluid queue of the transmitter of a point-to-point link
+ *
+ * The background traffic sent on the link is modeled as a fluid which
+ * arrives at a given rate (set by the FluidTrafficMatrix when the rates of
+ * the background demands change) in a FIFO queue of BufferSize bytes, and
+ * leaves it at the data rate of the link.  Between rate changes, the backlog
+ * of the queue evolves linearly, and it is only computed when the link is
+ * queried.  The fluid which arrives when the queue is full is lost.
+ *
+ * The foreground packets sent to the device share the FIFO with the fluid:
+ * a packet is lost with the ratio of the fluid which is lost when it is
+ * sent to the device, it waits for the fluid which arrived before it to
+ * be transmitted, and the fluid does not leave the queue while a packet is
+ * being transmitted.  The buffer of the device queue is not shared with the
+ * fluid.
+ */
+class FluidLink : public PointToPointLoadModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FluidLink ();
+  virtual ~FluidLink ();
+
+  /**
+   * \brief Set the data rate at which the fluid leaves the queue
+   * \param rate the data rate of the link
+   */
+  void SetDataRate (DataRate rate);
+
+  /**
+   * \brief Get the data rate at which the fluid leaves the queue
+   * \return the data rate of the link
+   */
+  DataRate GetDataRate (void) const;
+
+  /**
+   * \brief Set the rate at which the fluid arrives, from now on
+   * \param rate the arrival rate, in bits per second
+   */
+  void SetArrivalRate (double rate);
+
+  /**
+   * \brief Get the rate at which the fluid arrives
+   * \return the arrival rate, in bits per second
+   */
+  double GetArrivalRate (void) const;
+
+  /**
+   * \brief Get the current backlog of the fluid queue
+   * \return the backlog, in bytes
+   */
+  double GetBacklog (void);
+
+  /**
+   * \brief Get the current queueing delay of the fluid queue
+   * \return the time to transmit the backlog
+   */
+  Time GetQueueingDelay (void);
+
+  /**
+   * \brief Get the ratio of the fluid currently lost
+   * \return the loss ratio, which is positive if the queue is full and the
+   *         arrival rate exceeds the data rate
+   */
+  double GetLossRatio (void);
+
+  /**
+   * \brief Get the amount of fluid lost so far
+   * \return the lost bytes
+   */
+  double GetLostBytes (void);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  // Inherited from PointToPointLoadModel
+  virtual bool IsLost (Ptr<const Packet> p);
+  virtual Time StartTransmission (Ptr<const Packet> p, Time txTime);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Bring the state of the fluid queue to the current time
+   */
+  void Update (void);
+
+  /**
+   * \brief Compute the time to transmit some fluid at the data rate of the link
+   * \param bytes the amount of fluid, in bytes
+   * \return the transmission time
+   */
+  Time TransmissionTime (double bytes) const;
+
+  uint32_t m_bufferSize;    //!< The size of the buffer of the fluid queue, in bytes
+  DataRate m_rate;          //!< The data rate of the link
+  double m_arrivalRate;     //!< The arrival rate of the fluid, in bits per second
+  double m_backlog;         //!< The backlog, in bytes
+  double m_arrived;         //!< The fluid which entered the queue so far, in bytes
+  double m_lost;            //!< The fluid lost so far, in bytes
+  Time m_lastUpdate;        //!< The time of the state of the fluid queue
+  Time m_busyStart;         //!< The start of the transmission of the last packet
+  Time m_busyEnd;           //!< The end of the transmission of the last packet
+  /// The uid of the packets sent to the device, with the fluid arrived before them
+  std::deque<std::pair<uint64_t, double> > m_packets;
+  Ptr<UniformRandomVariable> m_uv;  //!< Random variable for the packet losses
+};
+
+} // namespace ns3
+
+#endif /* FLUID_LINK_H */
@@ -0,0 +1,526 @@
+// -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*-
+//
+// Copyright (c) 2008 University of Washington
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//
+
+#ifndef IPV4_GLOBAL_ROUTING_H
+#define IPV4_GLOBAL_ROUTING_H
+
+#include <list>
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
+
+namespace ns3 {
+
+class Packet;
+class NetDevice;
+class Ipv4Interface;
+class Ipv4Address;
+class Ipv4Header;
+class Ipv4RoutingTableEntry;
+class Ipv4MulticastRoutingTableEntry;
+class Node;
+
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Global routing protocol for IPv4 stacks.
+ *
+ * In ns-3 we have the concept of a pluggable routing protocol.  Routing
+ * protocols are added to a list maintained by the Ipv4L3Protocol.  Every 
+ * stack gets one routing protocol for free -- the Ipv4StaticRouting routing
+ * protocol is added in the constructor of the Ipv4L3Protocol (this is the 
+ * piece of code that implements the functionality of the IP layer).
+ *
+ * As an option to running a dynamic routing protocol, a GlobalRouteManager
+ * object has been created to allow users to build routes for all participating
+ * nodes.  One can think of this object as a "routing oracle"; it has
+ * an omniscient view of the topology, and can construct shortest path
+ * routes between all pairs of nodes.  These routes must be stored 
+ * somewhere in the node, so therefore this class Ipv4GlobalRouting
+ * is used as one of the pluggable routing protocols.  It is kept distinct
+ * from Ipv4StaticRouting because these routes may be dynamically cleared
+ * and rebuilt in the middle of the simulation, while manually entered
+ * routes into the Ipv4StaticRouting may need to be kept distinct.
+ *
+ * This class deals with Ipv4 unicast routes only.
+ *
+ * With the CompactRoutes attribute, the routes are not stored as
+ * Ipv4RoutingTableEntry objects but in sorted arrays of destination prefixes,
+ * each with the index of its next hop (gateway and interface) in a table
+ * shared by all the nodes.  Host routes with the same next hops to all the
+ * addresses of a prefix are stored once, as a route to that prefix.  The
+ * lookups give the same routes, except that the network and external routes
+ * which match a destination are considered from the longest prefix to the
+ * shortest one rather than in the order in which they were added.
+ *
+ * \see Ipv4RoutingProtocol
+ * \see GlobalRouteManager
+ */
+class Ipv4GlobalRouting : public Ipv4RoutingProtocol
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief Construct an empty Ipv4GlobalRouting routing protocol,
+   *
+   * The Ipv4GlobalRouting class supports host and network unicast routes.
+   * This method initializes the lists containing these routes to empty.
+   *
+   * \see Ipv4GlobalRouting
+   */
+  Ipv4GlobalRouting ();
+  virtual ~Ipv4GlobalRouting ();
+
+  // These methods inherited from base class
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+
+  virtual bool RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                            UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                            LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+
+  /**
+   * \brief Add a host route to the global routing table.
+   *
+   * \param dest The Ipv4Address destination for this route.
+   * \param nextHop The Ipv4Address of the next hop in the route.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddHostRouteTo (Ipv4Address dest, 
+                       Ipv4Address nextHop, 
+                       uint32_t interface);
+  /**
+   * \brief Add a host route to the global routing table.
+   *
+   * \param dest The Ipv4Address destination for this route.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddHostRouteTo (Ipv4Address dest, 
+                       uint32_t interface);
+
+  /**
+   * \brief Add a network route to the global routing table.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param nextHop The next hop in the route to the destination network.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddNetworkRouteTo (Ipv4Address network, 
+                          Ipv4Mask networkMask, 
+                          Ipv4Address nextHop, 
+                          uint32_t interface);
+
+  /**
+   * \brief Add a network route to the global routing table.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddNetworkRouteTo (Ipv4Address network, 
+                          Ipv4Mask networkMask, 
+                          uint32_t interface);
+
+  /**
+   * \brief Add an external route to the global routing table.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param nextHop The next hop Ipv4Address
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   */
+  void AddASExternalRouteTo (Ipv4Address network,
+                             Ipv4Mask networkMask,
+                             Ipv4Address nextHop,
+                             uint32_t interface);
+
+  /**
+   * \brief Get the number of individual unicast routes that have been added
+   * to the routing table.
+   *
+   * \warning The default route counts as one of the routes.
+   * \returns the number of routes
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \brief Get a route from the global unicast routing table.
+   *
+   * Externally, the unicast global routing table appears simply as a table with
+   * n entries.  The one subtlety of note is that if a default route has been set
+   * it will appear as the zeroth entry in the table.  This means that if you
+   * add only a default route, the table will have one entry that can be accessed
+   * either by explicitly calling GetDefaultRoute () or by calling GetRoute (0).
+   *
+   * Similarly, if the default route has been set, calling RemoveRoute (0) will
+   * remove the default route.
+   *
+   * \param i The index (into the routing table) of the route to retrieve.  If
+   * the default route has been set, it will occupy index zero.
+   * \return If route is set, a pointer to that Ipv4RoutingTableEntry is returned, otherwise
+   * a zero pointer is returned.  With the CompactRoutes attribute, the entry
+   * is only valid until the next call.
+   *
+   * \see Ipv4RoutingTableEntry
+   * \see Ipv4GlobalRouting::RemoveRoute
+   */
+  Ipv4RoutingTableEntry *GetRoute (uint32_t i) const;
+
+  /**
+   * \brief Remove a route from the global unicast routing table.
+   *
+   * Externally, the unicast global routing table appears simply as a table with
+   * n entries.  The one subtlety of note is that if a default route has been set
+   * it will appear as the zeroth entry in the table.  This means that if the
+   * default route has been set, calling RemoveRoute (0) will remove the
+   * default route.
+   *
+   * \param i The index (into the routing table) of the route to remove.  If
+   * the default route has been set, it will occupy index zero.
+   *
+   * \see Ipv4RoutingTableEntry
+   * \see Ipv4GlobalRouting::GetRoute
+   * \see Ipv4GlobalRouting::AddRoute
+   */
+  void RemoveRoute (uint32_t i);
+
+  /**
+   * \brief Remove a host route from the global routing table.
+   *
+   * The first host route with the given destination, next hop and interface
+   * is removed.
+   *
+   * \param dest The Ipv4Address destination of the route.
+   * \param nextHop The Ipv4Address of the next hop in the route.
+   * \param interface The network interface index of the route.
+   * \returns true if a route was removed
+   */
+  bool RemoveHostRouteTo (Ipv4Address dest,
+                          Ipv4Address nextHop,
+                          uint32_t interface);
+
+  /**
+   * \brief Remove a network route from the global routing table.
+   *
+   * The first network route with the given destination, next hop and
+   * interface is removed.
+   *
+   * \param network The Ipv4Address network of the route.
+   * \param networkMask The Ipv4Mask of the network.
+   * \param nextHop The next hop in the route.
+   * \param interface The network interface index of the route.
+   * \returns true if a route was removed
+   */
+  bool RemoveNetworkRouteTo (Ipv4Address network,
+                             Ipv4Mask networkMask,
+                             Ipv4Address nextHop,
+                             uint32_t interface);
+
+  /**
+   * \brief Remove all the routes from the global routing table.
+   */
+  void RemoveAllRoutes (void);
+
+  /**
+   * \brief Get the memory used by the routes of this routing table.
+   *
+   * This counts the routes, the lists and the indices which hold them, but
+   * not the next hop table shared by the compact storage of all the nodes.
+   *
+   * \returns the approximate number of bytes used by the routes
+   */
+  uint64_t GetMemoryUsage (void) const;
+
+  /**
+   * \brief Get the memory used by the next hop table shared by the compact
+   * storage of all the nodes.
+   *
+   * \returns the approximate number of bytes used by the table
+   */
+  static uint64_t GetSharedMemoryUsage (void);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  void DoDispose (void);
+
+private:
+  /// Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently
+  bool m_randomEcmpRouting;
+  /// Set to true if this interface should respond to interface events by globallly recomputing routes 
+  bool m_respondToInterfaceEvents;
+  /// A uniform random number generator for randomly routing packets among ECMP 
+  Ptr<UniformRandomVariable> m_rand;
+
+  /// container of Ipv4RoutingTableEntry (routes to hosts)
+  typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
+  /// const iterator of container of Ipv4RoutingTableEntry (routes to hosts)
+  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator HostRoutesCI;
+  /// iterator of container of Ipv4RoutingTableEntry (routes to hosts)
+  typedef std::list<Ipv4RoutingTableEntry *>::iterator HostRoutesI;
+
+  /// container of Ipv4RoutingTableEntry (routes to networks)
+  typedef std::list<Ipv4RoutingTableEntry *> NetworkRoutes;
+  /// const iterator of container of Ipv4RoutingTableEntry (routes to networks)
+  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator NetworkRoutesCI;
+  /// iterator of container of Ipv4RoutingTableEntry (routes to networks)
+  typedef std::list<Ipv4RoutingTableEntry *>::iterator NetworkRoutesI;
+
+  /// container of Ipv4RoutingTableEntry (routes to external AS)
+  typedef std::list<Ipv4RoutingTableEntry *> ASExternalRoutes;
+  /// const iterator of container of Ipv4RoutingTableEntry (routes to external AS)
+  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator ASExternalRoutesCI;
+  /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
+  typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
+
+  /**
+   * \brief Lookup in the forwarding table for destination.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return Ipv4Route to route the packet to reach dest address
+   */
+  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+
+  /// Routes of a list, indexed by their destination prefix
+  struct RouteIndex
+  {
+    std::vector<Ipv4RoutingTableEntry *> routes; //!< the routes, in list order
+    PrefixTrie<uint32_t> trie;                   //!< positions in routes, by prefix
+    std::vector<uint32_t> others;                //!< positions of the routes with a non-contiguous mask, not in trie
+  };
+
+  /**
+   * \brief Index a list of routes.
+   * \param routes the routes
+   * \param index [out] the index
+   */
+  static void BuildIndex (std::list<Ipv4RoutingTableEntry *> const &routes, RouteIndex &index);
+
+  /**
+   * \brief Find the routes of an index which match a destination.
+   * \param index the index
+   * \param dest the destination
+   * \param found [out] the positions of the routes found, in list order
+   */
+  static void FindRoutes (RouteIndex const &index, Ipv4Address dest, std::vector<uint32_t> &found);
+
+  /**
+   * \brief Rebuild the route indices if the route lists changed.
+   */
+  void UpdateIndices (void);
+
+  HostRoutes m_hostRoutes;             //!< Routes to hosts
+  NetworkRoutes m_networkRoutes;       //!< Routes to networks
+  ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+
+  bool m_indicesValid;                 //!< True if the indices match the route lists
+  RouteIndex m_hostIndex;              //!< Index of m_hostRoutes
+  RouteIndex m_networkIndex;           //!< Index of m_networkRoutes
+  RouteIndex m_ASexternalIndex;        //!< Index of m_ASexternalRoutes
+
+  /// A next hop of the compact route storage
+  struct CompactNextHop
+  {
+    Ipv4Address gateway;  //!< the gateway
+    uint32_t interface;   //!< the outgoing interface
+  };
+
+  /// The next hops of the compact route storage of all the nodes
+  struct CompactNextHopTable
+  {
+    std::vector<CompactNextHop> nextHops;  //!< the next hops, by index
+    /// the indices of the next hops, by gateway and interface
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> indices;
+  };
+
+  /// A route of the compact route storage
+  struct CompactRoute
+  {
+    uint32_t dest;          //!< the destination prefix
+    uint32_t nextHop : 24;  //!< the index of the next hop
+    uint32_t length : 8;    //!< the length of the destination prefix
+  };
+
+  /// The routes of a list, in compact storage
+  struct CompactRoutes
+  {
+    /// the routes: host routes are sorted by prefix, network and external
+    /// routes by decreasing prefix length then by prefix
+    std::vector<CompactRoute> routes;
+    /// the first network or external route with each prefix length
+    std::vector<std::pair<uint8_t, uint32_t> > lengths;
+  };
+
+  /**
+   * \returns the next hop table shared by all the nodes
+   */
+  static CompactNextHopTable &GetNextHopTable (void);
+
+  /**
+   * \brief Get the index of a next hop, adding it to the shared table if needed.
+   * \param gateway the gateway
+   * \param interface the outgoing interface
+   * \returns the index of the next hop
+   */
+  static uint32_t GetNextHopIndex (Ipv4Address gateway, uint32_t interface);
+
+  /**
+   * \brief Look up the index of a next hop in the shared table.
+   * \param gateway the gateway
+   * \param interface the outgoing interface
+   * \param index [out] the index of the next hop
+   * \returns true if the next hop is in the table
+   */
+  static bool FindNextHopIndex (Ipv4Address gateway, uint32_t interface, uint32_t &index);
+
+  /**
+   * \brief Add a route to the compact storage.
+   * \param routes the routes
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param gateway the gateway
+   * \param interface the outgoing interface
+   */
+  void AddCompactRoute (CompactRoutes &routes, Ipv4Address dest, Ipv4Mask mask,
+                        Ipv4Address gateway, uint32_t interface);
+
+  /**
+   * \brief Sort the compact routes and aggregate the host routes, if routes
+   * were added since the last time.
+   */
+  void SortCompactRoutes (void) const;
+
+  /**
+   * \brief Aggregate sorted host routes: the routes to two halves of a
+   * prefix with the same next hops become routes to the prefix.
+   * \param routes the host routes, sorted by prefix
+   */
+  static void AggregateHostRoutes (std::vector<CompactRoute> &routes);
+
+  /**
+   * \brief Replace the host routes to a prefix by the routes to each of its
+   * addresses.
+   * \param routes the host routes, sorted by prefix
+   * \param first the first route to the prefix
+   * \returns the number of routes which replace the routes to the prefix
+   */
+  static uint32_t ExpandHostRoutes (std::vector<CompactRoute> &routes, uint32_t first);
+
+  /**
+   * \brief Find the host routes which match a destination.
+   * \param dest the destination
+   * \param first [out] the first matching route
+   * \param last [out] past the last matching route
+   * \returns true if there are matching routes
+   */
+  bool FindCompactHostRoutes (Ipv4Address dest, uint32_t &first, uint32_t &last) const;
+
+  /**
+   * \brief Find the network or external routes which match a destination.
+   * \param routes the routes
+   * \param dest the destination
+   * \param found [out] the positions of the matching routes, longest prefix first
+   */
+  static void FindCompactRoutes (CompactRoutes const &routes, Ipv4Address dest, std::vector<uint32_t> &found);
+
+  /**
+   * \brief Index the network or external routes by prefix length.
+   * \param routes the routes, sorted by decreasing prefix length
+   */
+  static void UpdateLengths (CompactRoutes &routes);
+
+  /**
+   * \brief Remove a network or external route.
+   * \param routes the routes
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param gateway the gateway
+   * \param interface the outgoing interface
+   * \returns true if a route was removed
+   */
+  bool RemoveCompactRoute (CompactRoutes &routes, Ipv4Address dest, Ipv4Mask mask,
+                           Ipv4Address gateway, uint32_t interface);
+
+  /**
+   * \brief Look up the compact routes.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return Ipv4Route to route the packet to reach dest address
+   */
+  Ptr<Ipv4Route> LookupCompact (Ipv4Address dest, Ptr<NetDevice> oif);
+
+  /**
+   * \param route a compact route
+   * \param host whether it is a host route
+   * \returns the route as a routing table entry
+   */
+  static Ipv4RoutingTableEntry MakeEntry (CompactRoute const &route, bool host);
+
+  bool m_compact;                        //!< True if the routes are in compact storage
+  mutable bool m_compactSorted;          //!< True if the compact routes are sorted
+  mutable CompactRoutes m_compactHost;   //!< Routes to hosts, in compact storage
+  mutable CompactRoutes m_compactNetwork; //!< Routes to networks, in compact storage
+  mutable CompactRoutes m_compactExternal; //!< External routes, in compact storage
+  mutable Ipv4RoutingTableEntry *m_compactEntry; //!< The entry returned by GetRoute in compact storage
+
+  Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
+};
+
+} // Namespace ns3
+
+#endif /* IPV4_GLOBAL_ROUTING_H */
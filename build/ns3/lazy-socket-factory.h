@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef LAZY_SOCKET_FACTORY_H
+#define LAZY_SOCKET_FACTORY_H
+
+#include "ns3/udp-socket-factory.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class UdpL4Protocol;
+class TcpL4Protocol;
+
+/**
+ * \ingroup udp
+ *
+ * \brief UDP socket factory creating the UDP protocol on first use.
+ *
+ * This factory is aggregated to a node in place of ns3::UdpL4Protocol.
+ * The first time a socket is requested, it creates an
+ * ns3::UdpL4Protocol, aggregates it to the node, and forwards this and
+ * all the next socket requests to it.  Until then, the node has no UDP
+ * layer: datagrams received by the node are discarded silently.
+ */
+class LazyUdpSocketFactory : public UdpSocketFactory
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  LazyUdpSocketFactory ();
+  virtual ~LazyUdpSocketFactory ();
+
+  /**
+   * \brief Create a socket, and the UDP protocol if needed.
+   * \return smart pointer to Socket
+   */
+  virtual Ptr<Socket> CreateSocket (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  Ptr<UdpL4Protocol> m_udp; //!< the UDP L4 protocol, once created
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief TCP socket factory creating the TCP protocol on first use.
+ *
+ * This factory is aggregated to a node in place of ns3::TcpL4Protocol.
+ * The first time a socket is requested, it creates the TCP protocol with
+ * the configured object factory, aggregates it to the node, and forwards
+ * this and all the next socket requests to it.  Until then, the node has
+ * no TCP layer: segments received by the node are discarded silently,
+ * without any reset being sent back.
+ */
+class LazyTcpSocketFactory : public TcpSocketFactory
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  LazyTcpSocketFactory ();
+  virtual ~LazyTcpSocketFactory ();
+
+  /**
+   * \brief Set the factory of the TCP protocol.
+   *
+   * The TypeId of the factory must be ns3::TcpL4Protocol or one of its
+   * subclasses.
+   *
+   * \param factory the TCP protocol factory
+   */
+  void SetTcpFactory (ObjectFactory factory);
+
+  /**
+   * \brief Create a socket, and the TCP protocol if needed.
+   * \return smart pointer to Socket
+   */
+  virtual Ptr<Socket> CreateSocket (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  ObjectFactory m_tcpFactory; //!< the TCP protocol factory
+  Ptr<TcpL4Protocol> m_tcp;   //!< the TCP L4 protocol, once created
+};
+
+} // namespace ns3
+
+#endif /* LAZY_SOCKET_FACTORY_H */
@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_LOAD_MODEL_H
+#define POINT_TO_POINT_LOAD_MODEL_H
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ *
+ * \brief The load of the transmitter of a PointToPointNetDevice by traffic
+ * which is not simulated as packets
+ *
+ * A load model attached to a PointToPointNetDevice (see the LoadModel
+ * attribute) is asked whether each packet sent to the device is lost
+ * because the transmitter is overloaded, and how long each packet waits
+ * for the traffic ahead of it before being transmitted.
+ */
+class PointToPointLoadModel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PointToPointLoadModel ();
+  virtual ~PointToPointLoadModel ();
+
+  /**
+   * \brief Check whether a packet sent to the device is lost
+   *
+   * \param p the packet, with its PPP header
+   * \return true if the packet must be dropped
+   */
+  virtual bool IsLost (Ptr<const Packet> p) = 0;
+
+  /**
+   * \brief Notify the start of the transmission of a packet
+   *
+   * The transmitter is busy with the packet from the end of the returned
+   * time for the transmission time of the packet.
+   *
+   * \param p the packet, with its PPP header
+   * \param txTime the time to transmit the packet at the data rate of the device
+   * \return the time the packet waits before its transmission
+   */
+  virtual Time StartTransmission (Ptr<const Packet> p, Time txTime) = 0;
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_LOAD_MODEL_H */
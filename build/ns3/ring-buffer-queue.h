@@ -0,0 +1,334 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_QUEUE_H
+#define RING_BUFFER_QUEUE_H
+
+#include "ns3/queue.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue that drops tail-end packets on overflow,
+ * storing the packets in a preallocated ring buffer
+ *
+ * This queue behaves exactly as DropTailQueue: it provides the same
+ * statistics and trace sources.  However, DropTailQueue keeps its items
+ * in a list, which allocates a node for each enqueued item.  This queue
+ * keeps them in a circular array allocated once, which makes Enqueue and
+ * Dequeue cheap on the per-packet path of net devices.
+ *
+ * The array is allocated on the first enqueue and never grows.  It holds
+ * the number of items given by the Capacity attribute or, if that is 0,
+ * the maximum number of packets of the queue in packet mode, and the
+ * maximum number of bytes of the queue (at most MAX_DEFAULT_CAPACITY) in
+ * byte mode.  Items which do not fit in the array are dropped as if the
+ * queue were full, so in byte mode with many small packets the Capacity
+ * should be set to the largest number of packets expected in the queue.
+ *
+ * EnqueueBulk and DequeueBulk process a batch of items without a virtual
+ * call per item.
+ */
+template <typename Item>
+class RingBufferQueue : public Queue<Item>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief RingBufferQueue Constructor
+   */
+  RingBufferQueue ();
+
+  virtual ~RingBufferQueue ();
+
+  virtual bool Enqueue (Ptr<Item> item);
+  virtual Ptr<Item> Dequeue (void);
+  virtual Ptr<Item> Remove (void);
+  virtual Ptr<const Item> Peek (void) const;
+  virtual uint32_t EnqueueBulk (std::vector<Ptr<Item> > const &items);
+  virtual uint32_t DequeueBulk (std::vector<Ptr<Item> > &items, uint32_t n);
+
+  /**
+   * \return the number of items the ring buffer can hold, 0 if it has not
+   * been allocated yet.
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  using Queue<Item>::CheckEnqueue;
+  using Queue<Item>::NotifyEnqueue;
+  using Queue<Item>::NotifyDequeue;
+  using Queue<Item>::NotifyRemove;
+
+  /**
+   * \brief Insert an item at the tail of the ring.
+   * \param item the item
+   * \return true if the item has been enqueued
+   */
+  bool DoEnqueueItem (Ptr<Item> item);
+
+  /**
+   * \brief Extract the item at the head of the ring.
+   * \return the item, or 0 if the queue is empty
+   */
+  Ptr<Item> PopHead (void);
+
+  /**
+   * \brief Allocate the ring.
+   */
+  void Allocate (void);
+
+  /// The largest capacity derived from the maximum number of bytes
+  static const uint32_t MAX_DEFAULT_CAPACITY = 1 << 16;
+
+  std::vector<Ptr<Item> > m_ring;   //!< the ring buffer, whose size is a power of 2
+  uint32_t m_mask;                  //!< size of the ring minus 1
+  uint32_t m_head;                  //!< index of the first item
+  uint32_t m_count;                 //!< number of items in the ring
+  uint32_t m_capacity;              //!< requested capacity
+  uint32_t m_limit;                 //!< number of items the ring can hold, once allocated
+
+  NS_LOG_TEMPLATE_DECLARE;     //!< redefinition of the log component
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename Item>
+const uint32_t RingBufferQueue<Item>::MAX_DEFAULT_CAPACITY;
+
+template <typename Item>
+TypeId
+RingBufferQueue<Item>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (("ns3::RingBufferQueue<" + GetTypeParamName<RingBufferQueue<Item> > () + ">").c_str ())
+    .SetParent<Queue<Item> > ()
+    .SetGroupName ("Network")
+    .template AddConstructor<RingBufferQueue<Item> > ()
+    .AddAttribute ("Capacity",
+                   "The number of items the ring buffer can hold; the items "
+                   "beyond are dropped. If 0, the maximum number of packets "
+                   "(or bytes, up to 65536) of the queue is used.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RingBufferQueue<Item>::m_capacity),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+template <typename Item>
+RingBufferQueue<Item>::RingBufferQueue () :
+  Queue<Item> (),
+  m_mask (0),
+  m_head (0),
+  m_count (0),
+  m_capacity (0),
+  m_limit (0),
+  NS_LOG_TEMPLATE_DEFINE ("RingBufferQueue")
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+RingBufferQueue<Item>::~RingBufferQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+uint32_t
+RingBufferQueue<Item>::GetCapacity (void) const
+{
+  return m_limit;
+}
+
+template <typename Item>
+void
+RingBufferQueue<Item>::Allocate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_limit = m_capacity;
+  if (m_limit == 0)
+    {
+      if (this->GetMode () == QueueBase::QUEUE_MODE_PACKETS)
+        {
+          m_limit = this->GetMaxPackets ();
+        }
+      else
+        {
+          m_limit = std::min (this->GetMaxBytes (), MAX_DEFAULT_CAPACITY);
+        }
+    }
+  NS_ABORT_MSG_IF (m_limit == 0 || m_limit > 0x80000000U, "RingBufferQueue: invalid capacity " << m_limit);
+
+  uint32_t size = 1;
+  while (size < m_limit)
+    {
+      size <<= 1;
+    }
+  m_ring.resize (size);
+  m_mask = size - 1;
+}
+
+template <typename Item>
+bool
+RingBufferQueue<Item>::DoEnqueueItem (Ptr<Item> item)
+{
+  if (!CheckEnqueue (item))
+    {
+      return false;
+    }
+
+  if (m_limit == 0)
+    {
+      Allocate ();
+    }
+  if (m_count == m_limit)
+    {
+      NS_LOG_LOGIC ("Ring full -- dropping pkt");
+      this->DropBeforeEnqueue (item);
+      return false;
+    }
+  m_ring[(m_head + m_count) & m_mask] = item;
+  m_count++;
+
+  NotifyEnqueue (item);
+  return true;
+}
+
+template <typename Item>
+Ptr<Item>
+RingBufferQueue<Item>::PopHead (void)
+{
+  if (m_count == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_ring[m_head];
+  m_ring[m_head] = 0;
+  m_head = (m_head + 1) & m_mask;
+  m_count--;
+  return item;
+}
+
+template <typename Item>
+bool
+RingBufferQueue<Item>::Enqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  return DoEnqueueItem (item);
+}
+
+template <typename Item>
+Ptr<Item>
+RingBufferQueue<Item>::Dequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = PopHead ();
+  if (item != 0)
+    {
+      NotifyDequeue (item);
+    }
+
+  NS_LOG_LOGIC ("Popped " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+RingBufferQueue<Item>::Remove (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = PopHead ();
+  if (item != 0)
+    {
+      NotifyRemove (item);
+    }
+
+  NS_LOG_LOGIC ("Removed " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<const Item>
+RingBufferQueue<Item>::Peek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_count == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return m_ring[m_head];
+}
+
+template <typename Item>
+uint32_t
+RingBufferQueue<Item>::EnqueueBulk (std::vector<Ptr<Item> > const &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  uint32_t n = 0;
+  for (typename std::vector<Ptr<Item> >::const_iterator i = items.begin (); i != items.end (); ++i)
+    {
+      if (DoEnqueueItem (*i))
+        {
+          n++;
+        }
+    }
+  return n;
+}
+
+template <typename Item>
+uint32_t
+RingBufferQueue<Item>::DequeueBulk (std::vector<Ptr<Item> > &items, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+
+  n = std::min (n, m_count);
+  items.reserve (items.size () + n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Item> item = PopHead ();
+      NotifyDequeue (item);
+      items.push_back (item);
+    }
+  return n;
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_QUEUE_H */
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENT_OFFLOAD_TAG_H
+#define SEGMENT_OFFLOAD_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class NetDevice;
+
+/**
+ * \ingroup network
+ *
+ * \brief Mark a packet as a super-segment, i.e., a burst of segments of the
+ * same flow carried as a single packet (segmentation offload).
+ *
+ * The packet holds the headers of one segment followed by the payload of
+ * all of them.  The tag records the payload size and the segment size, so
+ * that the number of segments and the number of bytes they would take on
+ * the wire can be computed.  A NetDevice that is able to carry
+ * super-segments exposes a boolean "SegmentOffload" attribute set to true,
+ * and computes its transmission time from GetWireSize(); the packet is
+ * split in its segments before any other device.
+ */
+class SegmentOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentOffloadTag ();
+
+  /**
+   * \brief Constructs a SegmentOffloadTag
+   * \param segmentSize the payload size of each segment but the last one
+   * \param payloadSize the payload size of the super-segment
+   */
+  SegmentOffloadTag (uint16_t segmentSize, uint32_t payloadSize);
+
+  /**
+   * \brief Set the payload size of each segment but the last one
+   * \param segmentSize the segment size
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+  /**
+   * \brief Get the payload size of each segment but the last one
+   * \returns the segment size
+   */
+  uint16_t GetSegmentSize (void) const;
+  /**
+   * \brief Set the payload size of the super-segment
+   * \param payloadSize the payload size
+   */
+  void SetPayloadSize (uint32_t payloadSize);
+  /**
+   * \brief Get the payload size of the super-segment
+   * \returns the payload size
+   */
+  uint32_t GetPayloadSize (void) const;
+  /**
+   * \brief Get the number of segments carried by the super-segment
+   * \returns the number of segments
+   */
+  uint32_t GetSegments (void) const;
+  /**
+   * \brief Get the number of bytes the segments take once split
+   *
+   * Every segment carries its own copy of the headers found in front of
+   * the payload.
+   *
+   * \param packetSize the size of the packet carrying the tag
+   * \returns the total size of the segments
+   */
+  uint32_t GetWireSize (uint32_t packetSize) const;
+
+  /**
+   * \brief Check whether a device carries super-segments
+   * \param device the device
+   * \returns true if the "SegmentOffload" attribute of the device exists and is set
+   */
+  static bool IsSupportedBy (Ptr<const NetDevice> device);
+
+private:
+  uint16_t m_segmentSize; //!< Payload size of each segment but the last one
+  uint32_t m_payloadSize; //!< Payload size of the super-segment
+};
+
+} // namespace ns3
+
+#endif /* SEGMENT_OFFLOAD_TAG_H */
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2006,2007 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
+ */
+
+#ifndef YANS_WIFI_CHANNEL_H
+#define YANS_WIFI_CHANNEL_H
+
+#include <map>
+#include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include "yans-wifi-phy.h"
+
+namespace ns3 {
+
+class NetDevice;
+class PropagationLossModel;
+class PropagationDelayModel;
+
+/**
+ * \brief a channel to interconnect ns3::YansWifiPhy objects.
+ * \ingroup wifi
+ *
+ * This class is expected to be used in tandem with the ns3::YansWifiPhy
+ * class and supports an ns3::PropagationLossModel and an 
+ * ns3::PropagationDelayModel.  By default, no propagation models are set; 
+ * it is the caller's responsibility to set them before using the channel.
+ *
+ * By default, every transmission is delivered to all the other
+ * YansWifiPhy objects on the channel.  The MaxRange and MaxLossDb
+ * attributes cut off the receivers which are too far or too attenuated
+ * to matter.  With MaxRange, the candidate receivers of each sender are
+ * cached, so that the receivers out of range cost nothing.  The set of a
+ * sender is refreshed as the nodes move, when the sender fires its
+ * CourseChange trace, and when another node fires it while it may now
+ * enter the range of the sender before the set expires.  This requires
+ * the mobility models to fire CourseChange as soon as their velocity
+ * changes, which WaypointMobilityModel does not do with LazyNotify.
+ */
+class YansWifiChannel : public Channel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  YansWifiChannel ();
+  virtual ~YansWifiChannel ();
+
+  //inherited from Channel.
+  virtual uint32_t GetNDevices (void) const;
+  virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
+
+  /**
+   * Adds the given YansWifiPhy to the PHY list
+   *
+   * \param phy the YansWifiPhy to be added to the PHY list
+   */
+  void Add (Ptr<YansWifiPhy> phy);
+
+  /**
+   * \param loss the new propagation loss model.
+   */
+  void SetPropagationLossModel (const Ptr<PropagationLossModel> loss);
+  /**
+   * \param delay the new propagation delay model.
+   */
+  void SetPropagationDelayModel (const Ptr<PropagationDelayModel> delay);
+
+  /**
+   * \param sender the phy object from which the packet is originating.
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param duration the transmission duration associated with the packet
+   *
+   * This method should not be invoked by normal users. It is
+   * currently invoked only from YansWifiPhy::StartTx.  The channel
+   * attempts to deliver the packet to all other YansWifiPhy objects
+   * on the channel (except for the sender).
+   */
+  void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   *
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \param maxRange the distance beyond which transmissions are not
+   * delivered, in meters, or 0 to deliver them at any distance
+   */
+  void SetMaxRange (double maxRange);
+  /**
+   * \return the distance beyond which transmissions are not delivered,
+   * in meters, or 0 if they are delivered at any distance
+   */
+  double GetMaxRange (void) const;
+
+
+protected:
+  // Inherited
+  virtual void DoDispose (void);
+
+
+private:
+  /**
+   * A vector of pointers to YansWifiPhy.
+   */
+  typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+
+  /**
+   * The candidate receivers of a sender, within MaxRange plus a margin
+   */
+  struct NeighborSet
+  {
+    NeighborSet ();
+
+    PhyList phys;        //!< The candidate receivers
+    std::vector<Ptr<const MobilityModel> > mobilities; //!< The mobility models of the candidate receivers
+    uint32_t generation; //!< The generation of the channel the set was computed in, or 0 if invalidated
+    Time expiry;         //!< The time the nodes may have moved beyond the margin
+    Ptr<const MobilityModel> mobility; //!< The mobility model of the sender
+    Vector position;     //!< The position of the sender when the set was computed
+    double drift;        //!< The distance the sender may cover before the set expires
+  };
+
+  /**
+   * \param sender the phy object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \return the YansWifiPhy objects which may be within MaxRange of the sender
+   *
+   * Recompute the set of the sender if the nodes moved since it was cached.
+   */
+  const PhyList & GetNeighbors (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility) const;
+
+  /**
+   * Invalidate the neighbor set of a node which changes course, and the
+   * sets of the senders whose range it may now enter before they expire
+   *
+   * \param mobility the mobility model which changed course
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility) const;
+
+  /**
+   * This method is scheduled by Send for each associated YansWifiPhy.
+   * The method then calls the corresponding YansWifiPhy that the first
+   * bit of the packet has arrived.
+   *
+   * \param receiver the device to which the packet is destined
+   * \param packet the packet being sent
+   * \param txPowerDbm the tx power associated to the packet being sent (dBm)
+   * \param duration the transmission duration associated with the packet being sent
+   */
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
+
+  PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
+  Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
+  Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxRange;                   //!< Distance beyond which receivers are cut off, or 0
+  double m_maxLossDb;                  //!< Loss beyond which receivers are cut off
+
+  typedef std::map<Ptr<YansWifiPhy>, NeighborSet> NeighborMap; //!< Neighbor sets, by sender
+  mutable NeighborMap m_neighbors;     //!< The cached neighbor sets
+  mutable uint32_t m_generation;       //!< Incremented to invalidate the neighbor sets
+  mutable std::vector<Ptr<MobilityModel> > m_watched; //!< Mobility models whose CourseChange trace is connected
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_CHANNEL_H */
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the time taken by global routing to populate the
+// routing tables of a k-ary fat tree of routers, and to recompute them after
+// a link failure, with the SPF calculations run in one or several threads,
+// and recomputed from scratch or incrementally.  It also reports the memory
+// used by the routes, stored as routing table entries or in compact form.
+//
+// The fat tree has k pods of k/2 edge and k/2 aggregation routers, and
+// (k/2)^2 core routers, all linked by point-to-point links.
+//
+//   ./waf --run "global-routing-spf-benchmark --k=12 --threads=4 --incremental=1 --compact=1"
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("GlobalRoutingSpfBenchmark");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t k = 8;
+  uint32_t threads = 1;
+  bool incremental = false;
+  bool compact = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("k", "Number of pods of the fat tree (even)", k);
+  cmd.AddValue ("threads", "Number of threads of the SPF calculations", threads);
+  cmd.AddValue ("incremental", "Recompute only the SPF trees affected by the link failure", incremental);
+  cmd.AddValue ("compact", "Store the routes in compact form", compact);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (k < 2 || k % 2, "k must be even");
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (threads));
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (incremental));
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::CompactRoutes", BooleanValue (compact));
+
+  uint32_t half = k / 2;
+  NodeContainer core;
+  core.Create (half * half);
+  std::vector<NodeContainer> aggregation (k);
+  std::vector<NodeContainer> edge (k);
+  for (uint32_t pod = 0; pod < k; pod++)
+    {
+      aggregation[pod].Create (half);
+      edge[pod].Create (half);
+    }
+  InternetStackHelper stack;
+  stack.InstallAll ();
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  NetDeviceContainer failed;
+  for (uint32_t pod = 0; pod < k; pod++)
+    {
+      for (uint32_t a = 0; a < half; a++)
+        {
+          for (uint32_t e = 0; e < half; e++)
+            {
+              ipv4.Assign (p2p.Install (aggregation[pod].Get (a), edge[pod].Get (e)));
+              ipv4.NewNetwork ();
+            }
+          for (uint32_t c = 0; c < half; c++)
+            {
+              NetDeviceContainer devices = p2p.Install (aggregation[pod].Get (a), core.Get (a * half + c));
+              ipv4.Assign (devices);
+              ipv4.NewNetwork ();
+              if (pod == 0 && a == 0 && c == 0)
+                {
+                  failed = devices;
+                }
+            }
+        }
+    }
+  std::cout << "Fat tree with " << NodeList::GetNNodes () << " routers" << std::endl;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::cout << "PopulateRoutingTables: " << clock.End () << " ms" << std::endl;
+
+  uint32_t routes = 0;
+  uint64_t bytes = Ipv4GlobalRouting::GetSharedMemoryUsage ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = (*i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      routes += gr->GetNRoutes ();
+      bytes += gr->GetMemoryUsage ();
+    }
+  std::cout << "Routes: " << routes << ", memory: " << bytes << " bytes" << std::endl;
+
+  // Fail the link between the first aggregation router and the first core router
+  Ptr<Ipv4> ip = failed.Get (0)->GetNode ()->GetObject<Ipv4> ();
+  ip->SetDown (ip->GetInterfaceForDevice (failed.Get (0)));
+  clock.Start ();
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::cout << "RecomputeRoutingTables after a link failure: " << clock.End () << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the cost of a unicast route lookup in the
+// Ipv4GlobalRouting, Ipv4StaticRouting and Ipv6StaticRouting tables of a
+// node, as a function of the number of routes in the tables.
+//
+// Each table is filled with the given number of host routes, as global
+// routing installs on every node of a large topology, plus one network
+// route for every 16 host routes.  The lookups are made through
+// RouteOutput towards random destinations of the table.
+//
+//   ./waf --run "route-lookup-benchmark --routes=10000 --lookups=1000000"
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RouteLookupBenchmark");
+
+/**
+ * Time RouteOutput lookups.
+ * \param name the name of the routing protocol
+ * \param routing the routing protocol
+ * \param destinations the destinations to look up, in turn
+ * \param lookups the number of lookups
+ */
+template <typename Protocol, typename Header, typename Address>
+static void
+Bench (std::string name, Ptr<Protocol> routing, std::vector<Address> const &destinations, uint32_t lookups)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  Socket::SocketErrno err;
+  uint32_t found = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      Header header;
+      header.SetDestination (destinations[i % destinations.size ()]);
+      if (routing->RouteOutput (p, header, 0, err))
+        {
+          found++;
+        }
+    }
+  int64_t elapsed = clock.End ();
+
+  std::cout << name << ": " << lookups << " lookups in " << elapsed << " ms ("
+            << 1e6 * elapsed / lookups << " ns per lookup), " << found << " found" << std::endl;
+}
+
+/// IPv6 header with the destination setter of Ipv4Header
+class Ipv6BenchHeader : public Ipv6Header
+{
+public:
+  /**
+   * \param dst the destination address
+   */
+  void SetDestination (Ipv6Address dst)
+  {
+    SetDestinationAddress (dst);
+  }
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t routes = 10000;
+  uint32_t lookups = 1000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("routes", "Number of host routes in each table", routes);
+  cmd.AddValue ("lookups", "Number of lookups", lookups);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  Ipv4StaticRoutingHelper staticRouting;
+  Ipv4GlobalRoutingHelper globalRouting;
+  Ipv4ListRoutingHelper list;
+  list.Add (staticRouting, 0);
+  list.Add (globalRouting, -10);
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (list);
+  stack.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.252");
+  ipv4.Assign (devices);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+  ipv6.Assign (devices);
+
+  Ptr<Ipv4> ip = nodes.Get (0)->GetObject<Ipv4> ();
+  Ptr<Ipv4GlobalRouting> global = Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting> (ip->GetRoutingProtocol ());
+  Ptr<Ipv4StaticRouting> static4 = staticRouting.GetStaticRouting (ip);
+  Ptr<Ipv6StaticRouting> static6 = Ipv6StaticRoutingHelper ().GetStaticRouting (nodes.Get (0)->GetObject<Ipv6> ());
+
+  Ipv4Address gateway ("192.168.0.2");
+  Ipv6Address gateway6 ("2001:db8::200:ff:fe00:2");
+  std::vector<Ipv4Address> destinations;
+  std::vector<Ipv6Address> destinations6;
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      Ipv4Address dest (0x0a000000 + 4 * i + 1);
+      destinations.push_back (dest);
+      global->AddHostRouteTo (dest, gateway, 1);
+      static4->AddHostRouteTo (dest, gateway, 1);
+
+      uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb9 };
+      bytes[12] = (i >> 24) & 0xff;
+      bytes[13] = (i >> 16) & 0xff;
+      bytes[14] = (i >> 8) & 0xff;
+      bytes[15] = i & 0xff;
+      Ipv6Address dest6 (bytes);
+      destinations6.push_back (dest6);
+      static6->AddHostRouteTo (dest6, gateway6, 1);
+
+      if (i % 16 == 0)
+        {
+          Ipv4Address network (0x0b000000 + 256 * i);
+          global->AddNetworkRouteTo (network, Ipv4Mask ("255.255.255.0"), gateway, 1);
+          static4->AddNetworkRouteTo (network, Ipv4Mask ("255.255.255.0"), gateway, 1);
+          bytes[1] = 0x02;
+          static6->AddNetworkRouteTo (Ipv6Address (bytes), Ipv6Prefix (112), gateway6, 1);
+        }
+    }
+
+  Bench<Ipv4GlobalRouting, Ipv4Header> ("Ipv4GlobalRouting", global, destinations, lookups);
+  Bench<Ipv4StaticRouting, Ipv4Header> ("Ipv4StaticRouting", static4, destinations, lookups);
+  Bench<Ipv6StaticRouting, Ipv6BenchHeader> ("Ipv6StaticRouting", static6, destinations6, lookups);
+
+  Simulator::Destroy ();
+  return 0;
+}
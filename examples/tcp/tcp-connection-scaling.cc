@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures how the cost of a simulation grows with the number
+// of TCP connections open on a node.  A client node opens the given number
+// of connections to one port of a server node, over IPv4 or IPv6, and each
+// connection transfers a few segments.  Every segment received by either
+// node is demultiplexed among all the connections of the node.
+//
+//   ./waf --run "tcp-connection-scaling --connections=10000 --ipv6=0"
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpConnectionScaling");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t connections = 1000;
+  uint32_t bytes = 5000;
+  bool ipv6 = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("connections", "Number of TCP connections (at most 16383)", connections);
+  cmd.AddValue ("bytes", "Number of bytes sent on each connection", bytes);
+  cmd.AddValue ("ipv6", "Use IPv6 instead of IPv4", ipv6);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (100000));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  Address server;
+  Address any;
+  uint16_t port = 80;
+  if (ipv6)
+    {
+      Ipv6AddressHelper address;
+      address.SetBase (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (devices);
+      server = Inet6SocketAddress (interfaces.GetAddress (1, 1), port);
+      any = Inet6SocketAddress (Ipv6Address::GetAny (), port);
+    }
+  else
+    {
+      Ipv4AddressHelper address;
+      address.SetBase ("10.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      server = InetSocketAddress (interfaces.GetAddress (1), port);
+      any = InetSocketAddress (Ipv4Address::GetAny (), port);
+    }
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", any);
+  ApplicationContainer sinkApp = sink.Install (nodes.Get (1));
+  sinkApp.Start (Seconds (0));
+
+  BulkSendHelper source ("ns3::TcpSocketFactory", server);
+  source.SetAttribute ("MaxBytes", UintegerValue (bytes));
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < connections; i++)
+    {
+      sources.Add (source.Install (nodes.Get (0)));
+    }
+  // the connections open over the first second, then transfer concurrently
+  Ptr<UniformRandomVariable> start = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < sources.GetN (); i++)
+    {
+      sources.Get (i)->SetStartTime (Seconds (start->GetValue (0, 1)));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  std::cout << connections << " connections, " << DynamicCast<PacketSink> (sinkApp.Get (0))->GetTotalRx ()
+            << " bytes received in " << elapsed << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -348,6 +348,16 @@ Ipv4L3ProtocolDropSinkWithoutContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', p, interface);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -376,6 +386,16 @@ Ipv4L3ProtocolDropSinkWithContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', context, p, interface);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") "
                         << *p << std::endl;
@@ -820,6 +820,12 @@ RealtimeSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+void
+RealtimeSimulatorImpl::SetContext (uint32_t context)
+{
+  m_currentContext = context;
+}
+
 void 
 RealtimeSimulatorImpl::SetSynchronizationMode (enum SynchronizationMode mode)
 {
@@ -99,6 +99,8 @@ public:
   virtual uint32_t GetSystemId () const = 0; 
   /** \copydoc Simulator::GetContext */
   virtual uint32_t GetContext (void) const = 0;
+  /** \copydoc Simulator::SetContext */
+  virtual void SetContext (uint32_t context) = 0;
 };
 
 } // namespace ns3
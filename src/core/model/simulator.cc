@@ -380,6 +380,12 @@ Simulator::GetContext (void)
   return GetImpl ()->GetContext ();
 }
 
+void
+Simulator::SetContext (uint32_t context)
+{
+  GetImpl ()->SetContext (context);
+}
+
 uint32_t
 Simulator::GetSystemId (void)
 {
@@ -184,6 +184,21 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * Set the current simulation context.
+   *
+   * This is intended for models which deliver the same event to
+   * objects of several contexts, such as a shared channel delivering
+   * a frame to all the devices attached to it, to run the code of each
+   * receiver in its own context without scheduling one event per
+   * receiver.  The caller must restore the context of the event before
+   * returning.  Events scheduled with Schedule() while the context is
+   * changed inherit the new context.
+   *
+   * @param [in] context The new simulation context
+   */
+  static void SetContext (uint32_t context);
+
   /** Context enum values. */
   enum {
     /**
@@ -219,30 +219,48 @@ CsmaChannel::TransmitEnd ()
 
   NS_LOG_LOGIC ("Schedule event in " << m_delay.GetSeconds () << " sec");
 
-
-  NS_LOG_LOGIC ("Receive");
-
+  //
+  // The receivers are the devices active at the end of the transmission,
+  // as if a reception event had been scheduled for each of them.
+  //
+  m_receivers.clear ();
   std::vector<CsmaDeviceRec>::iterator it;
-  uint32_t devId = 0;
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
     {
       if (it->IsActive ())
         {
-          // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          m_receivers.push_back (it->devicePtr);
         }
-      devId++;
     }
 
-  // also schedule for the tx side to go back to IDLE
-  Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
-                       this);
+  // a single event delivers the packet and sends the tx side back to IDLE
+  Simulator::Schedule (m_delay, &CsmaChannel::Deliver, this);
   return retVal;
 }
 
+void
+CsmaChannel::Deliver (void)
+{
+  NS_LOG_FUNCTION (this << m_currentPkt);
+  NS_LOG_LOGIC ("Receive");
+
+  Ptr<CsmaNetDevice> sender = m_deviceList[m_currentSrc].devicePtr;
+  uint32_t context = Simulator::GetContext ();
+  std::vector<Ptr<CsmaNetDevice> >::const_iterator it;
+  for (it = m_receivers.begin (); it != m_receivers.end (); it++)
+    {
+      //
+      // The packet is shared by all the receivers, which copy it only if
+      // they need to modify it.
+      //
+      Simulator::SetContext ((*it)->GetNode ()->GetId ());
+      (*it)->Receive (m_currentPkt, sender);
+    }
+  Simulator::SetContext (context);
+
+  PropagationCompleteEvent ();
+}
+
 void
 CsmaChannel::PropagationCompleteEvent ()
 {
@@ -192,10 +192,10 @@ public:
    *
    * The channel will stay busy until the packet has completely
    * propagated to all net devices attached to the channel. The
-   * TransmitEnd function schedules the PropagationCompleteEvent which
-   * will free the channel for further transmissions. Stores the
-   * packet p as the m_currentPkt, the packet being currently
-   * transmitting.
+   * TransmitEnd function schedules a single event which delivers the
+   * packet to the active net devices, and then calls the
+   * PropagationCompleteEvent which will free the channel for further
+   * transmissions.
    *
    * \return Returns true unless the source was detached before it
    * completed its transmission.
@@ -205,9 +205,6 @@ public:
   /**
    * \brief Indicates that the channel has finished propagating the
    * current packet. The channel is released and becomes free.
-   *
-   * Calls the receive function of every active net device that is
-   * attached to the channel.
    */
   void PropagationCompleteEvent ();
 
@@ -308,6 +305,14 @@ private:
    */
   CsmaChannel &operator = (CsmaChannel const &o);
 
+  /**
+   * \brief Deliver the current packet to the receivers
+   *
+   * The same packet is passed to the Receive method of every receiver,
+   * in the context of its node, and the channel is released.
+   */
+  void Deliver (void);
+
   /**
    * The assigned data rate of the channel
    */
@@ -336,7 +341,13 @@ private:
    * packet to have been transmitted on the channel if the channel is
    * free.)
    */
-  Ptr<Packet> m_currentPkt;
+  Ptr<const Packet> m_currentPkt;
+
+  /**
+   * The net devices which were active at the end of the transmission
+   * of the current packet, and receive it at the end of the propagation.
+   */
+  std::vector<Ptr<CsmaNetDevice> > m_receivers;
 
   /**
    * Device Id of the source that is currently transmitting on the
@@ -720,7 +720,7 @@ CsmaNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
 }
 
 void
-CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
+CsmaNetDevice::Receive (Ptr<const Packet> packet, Ptr<CsmaNetDevice> senderDevice)
 {
   NS_LOG_FUNCTION (packet << senderDevice);
   NS_LOG_LOGIC ("UID is " << packet->GetUid ());
@@ -749,36 +749,63 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
       return;
     }
 
-  if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
+  if (m_receiveErrorModel)
     {
-      NS_LOG_LOGIC ("Dropping pkt due to error model ");
-      m_phyRxDropTrace (packet);
-      return;
+      //
+      // The error model may corrupt the packet, which is shared with the
+      // other devices on the channel.
+      //
+      Ptr<Packet> copy = packet->Copy ();
+      if (m_receiveErrorModel->IsCorrupt (copy))
+        {
+          NS_LOG_LOGIC ("Dropping pkt due to error model ");
+          m_phyRxDropTrace (copy);
+          return;
+        }
+      packet = copy;
+    }
+
+  //
+  // A frame addressed to another host only hits the promiscuous sniffer
+  // hook, unless a promiscuous callback is set or the FCS has to be
+  // checked.  Since the sniffer does not modify the packet, we can avoid
+  // copying the frame to remove its headers.
+  //
+  if (m_promiscRxCallback.IsNull () && !Node::ChecksumEnabled ())
+    {
+      EthernetHeader header (false);
+      packet->PeekHeader (header);
+      if (!header.GetDestination ().IsGroup () && header.GetDestination () != m_address)
+        {
+          m_promiscSnifferTrace (packet);
+          return;
+        }
     }
 
   //
   // Trace sinks will expect complete packets, not packets without some of the
-  // headers.
+  // headers, so the headers are removed from a copy of the packet.
   //
-  Ptr<Packet> originalPacket = packet->Copy ();
+  Ptr<const Packet> originalPacket = packet;
+  Ptr<Packet> frame = packet->Copy ();
 
   EthernetTrailer trailer;
-  packet->RemoveTrailer (trailer);
+  frame->RemoveTrailer (trailer);
   if (Node::ChecksumEnabled ())
     {
       trailer.EnableFcs (true);
     }
 
-  bool crcGood = trailer.CheckFcs (packet);
+  bool crcGood = trailer.CheckFcs (frame);
   if (!crcGood)
     {
-      NS_LOG_INFO ("CRC error on Packet " << packet);
-      m_phyRxDropTrace (packet);
+      NS_LOG_INFO ("CRC error on Packet " << frame);
+      m_phyRxDropTrace (frame);
       return;
     }
 
   EthernetHeader header (false);
-  packet->RemoveHeader (header);
+  frame->RemoveHeader (header);
 
   NS_LOG_LOGIC ("Pkt source is " << header.GetSource ());
   NS_LOG_LOGIC ("Pkt destination is " << header.GetDestination ());
@@ -792,16 +819,16 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   //
   if (header.GetLengthType () <= 1500)
     {
-      NS_ASSERT (packet->GetSize () >= header.GetLengthType ());
-      uint32_t padlen = packet->GetSize () - header.GetLengthType ();
+      NS_ASSERT (frame->GetSize () >= header.GetLengthType ());
+      uint32_t padlen = frame->GetSize () - header.GetLengthType ();
       NS_ASSERT (padlen <= 46);
       if (padlen > 0)
         {
-          packet->RemoveAtEnd (padlen);
+          frame->RemoveAtEnd (padlen);
         }
 
       LlcSnapHeader llc;
-      packet->RemoveHeader (llc);
+      frame->RemoveHeader (llc);
       protocol = llc.GetType ();
     }
   else
@@ -840,7 +867,7 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   if (!m_promiscRxCallback.IsNull ())
     {
       m_macPromiscRxTrace (originalPacket);
-      m_promiscRxCallback (this, packet, protocol, header.GetSource (), header.GetDestination (), packetType);
+      m_promiscRxCallback (this, frame, protocol, header.GetSource (), header.GetDestination (), packetType);
     }
 
   //
@@ -852,7 +879,7 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
     {
       m_snifferTrace (originalPacket);
       m_macRxTrace (originalPacket);
-      m_rxCallback (this, packet, protocol, header.GetSource ());
+      m_rxCallback (this, frame, protocol, header.GetSource ());
     }
 }
 
@@ -1033,6 +1060,62 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   return true;
 }
 
+uint32_t
+CsmaNetDevice::SendBulk (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  NS_ASSERT (IsLinkUp ());
+
+  //
+  // Same as SendFrom for each packet, with our own address as the source,
+  // but the send side and the transmission queue are checked once for the
+  // whole burst.
+  //
+  if (IsSendEnabled () == false)
+    {
+      for (uint32_t i = 0; i < items.size (); i++)
+        {
+          m_macTxDropTrace (items[i]->GetPacket ());
+        }
+      return items.size ();
+    }
+
+  Ptr<NetDeviceQueue> txq;
+  if (m_queueInterface)
+    {
+      txq = m_queueInterface->GetTxQueue (0);
+    }
+
+  uint32_t sent = 0;
+  for (; sent < items.size (); sent++)
+    {
+      if (txq && txq->IsStopped ())
+        {
+          break;
+        }
+
+      Ptr<Packet> packet = items[sent]->GetPacket ();
+      AddHeader (packet, m_address, Mac48Address::ConvertFrom (items[sent]->GetAddress ()), items[sent]->GetProtocol ());
+      m_macTxTrace (packet);
+
+      if (m_queue->Enqueue (packet) == false)
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+
+      if (m_txMachineState == READY && m_queue->IsEmpty () == false)
+        {
+          m_currentPkt = m_queue->Dequeue ();
+          m_promiscSnifferTrace (m_currentPkt);
+          m_snifferTrace (m_currentPkt);
+          TransmitStart ();
+        }
+    }
+  return sent;
+}
+
 Ptr<Node>
 CsmaNetDevice::GetNode (void) const
 {
@@ -163,11 +163,15 @@ public:
    * used by the channel to indicate that the last bit of a packet has 
    * arrived at the device.
    *
+   * The packet is shared by all the devices attached to the channel, so
+   * it is copied before its headers are removed, and only if the frame
+   * is passed up the stack.
+   *
    * \see CsmaChannel
    * \param p a reference to the received packet
    * \param sender the CsmaNetDevice that transmitted the packet in the first place
    */
-  void Receive (Ptr<Packet> p, Ptr<CsmaNetDevice> sender);
+  void Receive (Ptr<const Packet> p, Ptr<CsmaNetDevice> sender);
 
   /**
    * Is the send side of the network device enabled?
@@ -285,6 +289,13 @@ public:
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, 
                          uint16_t protocolNumber);
 
+  /**
+   * Start sending a burst of packets down the channel.
+   * \param items the packets to send, with their destination and protocol number
+   * \return the number of packets sent
+   */
+  virtual uint32_t SendBulk (const std::vector<Ptr<QueueDiscItem> > &items);
+
   /**
    * Get the node to which this device is attached.
    *
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/csma-helper.h"
+#include "ns3/csma-channel.h"
+#include "ns3/csma-net-device.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup csma
+ * \defgroup csma-test csma module tests
+ */
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief Test the delivery of the frames to all the devices of a CSMA segment
+ *
+ * Node 0 sends unicast frames to node 1 and node 2 sends broadcast frames,
+ * on a segment of six nodes.  The channel passes each frame to all the
+ * other devices by a single event; each device must still see it in the
+ * context of its own node and unmodified.  Only the destinations trace
+ * the frames as received, while the other devices only sniff the unicast
+ * frames, unless a promiscuous callback is set.
+ */
+class CsmaSharedDeliveryTestCase : public TestCase
+{
+public:
+  CsmaSharedDeliveryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Send a frame
+   * \param device the sending device
+   * \param dest the destination address
+   */
+  void SendFrame (Ptr<NetDevice> device, Address dest);
+  /**
+   * \brief Record a frame passed up by a device
+   * \param context the index of the node
+   * \param p the frame
+   */
+  void MacRx (std::string context, Ptr<const Packet> p);
+  /**
+   * \brief Record a frame sniffed by a device
+   * \param context the index of the node
+   * \param p the frame
+   */
+  void PromiscSniffer (std::string context, Ptr<const Packet> p);
+  /**
+   * \brief Promiscuous receive callback
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the source address
+   * \param to the destination address
+   * \param packetType the type of the packet
+   * \return true
+   */
+  bool PromiscRx (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                  const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  std::vector<uint32_t> m_macRx;   //!< Frames passed up by each node
+  std::vector<uint32_t> m_sniffed; //!< Frames sniffed by each node
+  uint32_t m_otherHost;            //!< Frames to other hosts passed to the promiscuous callback
+  uint32_t m_wrongContext;         //!< Frames seen out of the context of their node
+  uint32_t m_frameSize;            //!< Size of the first frame sniffed
+  uint32_t m_wrongSize;            //!< Frames sniffed with another size
+};
+
+CsmaSharedDeliveryTestCase::CsmaSharedDeliveryTestCase ()
+  : TestCase ("Delivery of the frames to all the devices of a CSMA segment"),
+    m_macRx (6, 0),
+    m_sniffed (6, 0),
+    m_otherHost (0),
+    m_wrongContext (0),
+    m_frameSize (0),
+    m_wrongSize (0)
+{
+}
+
+void
+CsmaSharedDeliveryTestCase::SendFrame (Ptr<NetDevice> device, Address dest)
+{
+  device->Send (Create<Packet> (100), dest, 0x800);
+}
+
+void
+CsmaSharedDeliveryTestCase::MacRx (std::string context, Ptr<const Packet> p)
+{
+  uint32_t node = std::atoi (context.c_str ());
+  if (Simulator::GetContext () != node)
+    {
+      m_wrongContext++;
+    }
+  m_macRx[node]++;
+}
+
+void
+CsmaSharedDeliveryTestCase::PromiscSniffer (std::string context, Ptr<const Packet> p)
+{
+  uint32_t node = std::atoi (context.c_str ());
+  if (Simulator::GetContext () != node)
+    {
+      m_wrongContext++;
+    }
+  // All the frames have the same size, whichever device received them first
+  if (m_frameSize == 0)
+    {
+      m_frameSize = p->GetSize ();
+    }
+  else if (p->GetSize () != m_frameSize)
+    {
+      m_wrongSize++;
+    }
+  m_sniffed[node]++;
+}
+
+bool
+CsmaSharedDeliveryTestCase::PromiscRx (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                       const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  if (packetType == NetDevice::PACKET_OTHERHOST)
+    {
+      m_otherHost++;
+    }
+  return true;
+}
+
+//
+// Network topology
+//
+//       n0    n1   n2   n3   n4   n5
+//       |     |    |    |    |    |
+//     ================================
+//
+// - 10 unicast frames from n0 to n1, and 10 broadcast frames from n2
+// - n5 has a promiscuous callback
+//
+void
+CsmaSharedDeliveryTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (6);
+
+  Ptr<CsmaChannel> channel = CreateObjectWithAttributes<CsmaChannel> (
+      "DataRate", DataRateValue (DataRate (5000000)),
+      "Delay", TimeValue (MilliSeconds (2)));
+
+  CsmaHelper csma;
+  NetDeviceContainer devs = csma.Install (nodes, channel);
+
+  for (uint32_t i = 0; i < devs.GetN (); i++)
+    {
+      std::ostringstream oss;
+      oss << i;
+      devs.Get (i)->TraceConnect ("MacRx", oss.str (),
+                                  MakeCallback (&CsmaSharedDeliveryTestCase::MacRx, this));
+      devs.Get (i)->TraceConnect ("PromiscSniffer", oss.str (),
+                                  MakeCallback (&CsmaSharedDeliveryTestCase::PromiscSniffer, this));
+    }
+  devs.Get (5)->SetPromiscReceiveCallback (MakeCallback (&CsmaSharedDeliveryTestCase::PromiscRx, this));
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::ScheduleWithContext (0, MilliSeconds (10 * i), &CsmaSharedDeliveryTestCase::SendFrame,
+                                      this, devs.Get (0), devs.Get (1)->GetAddress ());
+      Simulator::ScheduleWithContext (2, MilliSeconds (10 * i + 5), &CsmaSharedDeliveryTestCase::SendFrame,
+                                      this, devs.Get (2), devs.Get (2)->GetBroadcast ());
+    }
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_wrongContext, 0, "Frames were received out of the context of their node");
+  NS_TEST_ASSERT_MSG_EQ (m_wrongSize, 0, "A frame was modified by a receiver");
+  // The senders sniff their own frames when they transmit them
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_sniffed[i], 20, "Node " << i << " should have sniffed all the frames");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_macRx[0], 10, "Node 0 should have received the broadcast frames");
+  NS_TEST_ASSERT_MSG_EQ (m_macRx[1], 20, "Node 1 should have received all the frames");
+  NS_TEST_ASSERT_MSG_EQ (m_macRx[2], 0, "Node 2 should not have received any frame");
+  for (uint32_t i = 3; i < 6; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_macRx[i], 10, "Node " << i << " should have received the broadcast frames");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_otherHost, 10, "Node 5 should have passed the unicast frames to its promiscuous callback");
+}
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief CSMA TestSuite
+ */
+class CsmaTestSuite : public TestSuite
+{
+public:
+  CsmaTestSuite ();
+};
+
+CsmaTestSuite::CsmaTestSuite ()
+  : TestSuite ("devices-csma", UNIT)
+{
+  AddTestCase (new CsmaSharedDeliveryTestCase, TestCase::QUICK);
+}
+
+static CsmaTestSuite g_csmaTestSuite; //!< The testsuite
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// A foreground UDP flow crosses a line of four nodes, whose links also carry
+// background traffic modeled as fluid:
+//
+//   n0 -------- n1 -------- n2 -------- n3
+//      10 Mbps     10 Mbps     10 Mbps
+//
+// - a background demand of 6 Mbps from n0 to n3, from 1 s to 4 s
+// - a background demand of 6 Mbps from n1 to n2, from 2 s to 3 s, which
+//   overloads the link from n1 to n2
+//
+// Every 500 ms, the state of the fluid queue of the link from n1 to n2 and
+// the one-way delay of the foreground packets are printed.
+
+#include <iostream>
+#include <map>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/fluid-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("FluidBackground");
+
+std::map<uint64_t, Time> g_txTimes;   //!< The transmission time of the foreground packets
+Time g_delay;                         //!< The sum of the delays of the received packets
+uint32_t g_received = 0;              //!< The number of received packets
+uint32_t g_lost = 0;                  //!< The number of packets lost by the fluid links
+
+void
+Tx (Ptr<const Packet> p)
+{
+  g_txTimes[p->GetUid ()] = Simulator::Now ();
+}
+
+void
+Rx (Ptr<const Packet> p)
+{
+  std::map<uint64_t, Time>::iterator it = g_txTimes.find (p->GetUid ());
+  if (it != g_txTimes.end ())
+    {
+      g_delay += Simulator::Now () - it->second;
+      g_received++;
+      g_txTimes.erase (it);
+    }
+}
+
+void
+Drop (Ptr<const Packet> p)
+{
+  g_lost++;
+}
+
+void
+Report (Ptr<FluidLink> link)
+{
+  std::cout << Simulator::Now ().GetSeconds () << "s: fluid arrival "
+            << link->GetArrivalRate () / 1e6 << " Mbps, backlog "
+            << link->GetBacklog () << " bytes, queueing delay "
+            << link->GetQueueingDelay ().GetMilliSeconds () << " ms, loss ratio "
+            << link->GetLossRatio () << "; foreground received " << g_received
+            << ", lost " << g_lost;
+  if (g_received > 0)
+    {
+      std::cout << ", mean delay " << g_delay.GetMilliSeconds () / g_received << " ms";
+    }
+  std::cout << std::endl;
+  g_delay = Seconds (0);
+  g_received = 0;
+  g_lost = 0;
+  Simulator::Schedule (MilliSeconds (500), &Report, link);
+}
+
+int
+main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer d01 = p2p.Install (nodes.Get (0), nodes.Get (1));
+  NetDeviceContainer d12 = p2p.Install (nodes.Get (1), nodes.Get (2));
+  NetDeviceContainer d23 = p2p.Install (nodes.Get (2), nodes.Get (3));
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (d01);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  address.Assign (d12);
+  address.SetBase ("10.1.3.0", "255.255.255.0");
+  Ipv4InterfaceContainer i23 = address.Assign (d23);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // The background traffic
+  FluidHelper fluid;
+  Ptr<FluidTrafficMatrix> matrix = fluid.Install (nodes);
+  matrix->AddDemand (nodes.Get (0), nodes.Get (3), DataRate ("6Mbps"), Seconds (1), Seconds (4));
+  matrix->AddDemand (nodes.Get (1), nodes.Get (2), DataRate ("6Mbps"), Seconds (2), Seconds (3));
+
+  // The foreground traffic
+  UdpServerHelper server (9);
+  ApplicationContainer apps = server.Install (nodes.Get (3));
+  UdpClientHelper client (i23.GetAddress (1), 9);
+  client.SetAttribute ("MaxPackets", UintegerValue (1000000));
+  client.SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+  client.SetAttribute ("PacketSize", UintegerValue (1000));
+  apps.Add (client.Install (nodes.Get (0)));
+  apps.Start (Seconds (0.5));
+  apps.Stop (Seconds (5));
+
+  d01.Get (0)->TraceConnectWithoutContext ("MacTx", MakeCallback (&Tx));
+  d23.Get (1)->TraceConnectWithoutContext ("MacRx", MakeCallback (&Rx));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacTxDrop",
+                                 MakeCallback (&Drop));
+
+  Simulator::Schedule (MilliSeconds (500), &Report, matrix->GetLink (d12.Get (0)));
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fluid-helper.h"
+#include "ns3/log.h"
+#include "ns3/point-to-point-net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidHelper");
+
+FluidHelper::FluidHelper ()
+{
+  m_linkFactory.SetTypeId ("ns3::FluidLink");
+}
+
+void
+FluidHelper::SetLinkAttribute (std::string name, const AttributeValue &value)
+{
+  m_linkFactory.Set (name, value);
+}
+
+Ptr<FluidTrafficMatrix>
+FluidHelper::Install (NodeContainer c) const
+{
+  Ptr<FluidTrafficMatrix> matrix = CreateObject<FluidTrafficMatrix> ();
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); i++)
+    {
+      for (uint32_t j = 0; j < (*i)->GetNDevices (); j++)
+        {
+          Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> ((*i)->GetDevice (j));
+          if (device == 0)
+            {
+              continue;
+            }
+          DataRateValue rate;
+          device->GetAttribute ("DataRate", rate);
+          Ptr<FluidLink> link = m_linkFactory.Create<FluidLink> ();
+          link->SetDataRate (rate.Get ());
+          device->SetLoadModel (link);
+          matrix->AddLink (device, link);
+        }
+    }
+  return matrix;
+}
+
+} // namespace ns3
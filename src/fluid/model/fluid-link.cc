@@ -0,0 +1,234 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fluid-link.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidLink");
+
+NS_OBJECT_ENSURE_REGISTERED (FluidLink);
+
+TypeId
+FluidLink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FluidLink")
+    .SetParent<PointToPointLoadModel> ()
+    .SetGroupName ("Fluid")
+    .AddConstructor<FluidLink> ()
+    .AddAttribute ("BufferSize",
+                   "The size of the buffer of the fluid queue, in bytes",
+                   UintegerValue (100000),
+                   MakeUintegerAccessor (&FluidLink::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+FluidLink::FluidLink ()
+  : m_arrivalRate (0),
+    m_backlog (0),
+    m_arrived (0),
+    m_lost (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+FluidLink::~FluidLink ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FluidLink::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_packets.clear ();
+  m_uv = 0;
+  PointToPointLoadModel::DoDispose ();
+}
+
+void
+FluidLink::SetDataRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  Update ();
+  m_rate = rate;
+}
+
+DataRate
+FluidLink::GetDataRate (void) const
+{
+  return m_rate;
+}
+
+void
+FluidLink::SetArrivalRate (double rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  Update ();
+  m_arrivalRate = rate;
+}
+
+double
+FluidLink::GetArrivalRate (void) const
+{
+  return m_arrivalRate;
+}
+
+double
+FluidLink::GetBacklog (void)
+{
+  Update ();
+  return m_backlog;
+}
+
+Time
+FluidLink::GetQueueingDelay (void)
+{
+  Update ();
+  return TransmissionTime (m_backlog);
+}
+
+double
+FluidLink::GetLossRatio (void)
+{
+  Update ();
+  double capacity = m_rate.GetBitRate ();
+  if (m_backlog < m_bufferSize || m_arrivalRate <= capacity)
+    {
+      return 0;
+    }
+  return (m_arrivalRate - capacity) / m_arrivalRate;
+}
+
+double
+FluidLink::GetLostBytes (void)
+{
+  Update ();
+  return m_lost;
+}
+
+int64_t
+FluidLink::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
+
+Time
+FluidLink::TransmissionTime (double bytes) const
+{
+  // rounded to the nanosecond, so that the fluid transmitted in that time
+  // is as close as possible to the given bytes
+  return NanoSeconds (std::floor (bytes * 8e9 / m_rate.GetBitRate () + 0.5));
+}
+
+void
+FluidLink::Update (void)
+{
+  Time now = Simulator::Now ();
+  double arrival = m_arrivalRate / 8;
+  double capacity = m_rate.GetBitRate () / 8.0;
+
+  // The fluid leaves the queue at the data rate of the link, except while a
+  // packet is being transmitted
+  while (m_lastUpdate < now)
+    {
+      Time end = now;
+      double departure = capacity;
+      if (m_lastUpdate < m_busyStart)
+        {
+          end = std::min (now, m_busyStart);
+        }
+      else if (m_lastUpdate < m_busyEnd)
+        {
+          end = std::min (now, m_busyEnd);
+          departure = 0;
+        }
+
+      double dt = (end - m_lastUpdate).GetSeconds ();
+      double in = arrival * dt;
+      double backlog = m_backlog + (arrival - departure) * dt;
+      if (backlog < 0)
+        {
+          backlog = 0;
+        }
+      else if (backlog > m_bufferSize)
+        {
+          m_lost += backlog - m_bufferSize;
+          in -= backlog - m_bufferSize;
+          backlog = m_bufferSize;
+        }
+      m_arrived += in;
+      m_backlog = backlog;
+      m_lastUpdate = end;
+    }
+}
+
+bool
+FluidLink::IsLost (Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  double ratio = GetLossRatio ();
+  if (ratio > 0 && m_uv->GetValue () < ratio)
+    {
+      NS_LOG_LOGIC ("Packet lost with the fluid, loss ratio " << ratio);
+      return true;
+    }
+  m_packets.push_back (std::make_pair (p->GetUid (), m_arrived));
+  return false;
+}
+
+Time
+FluidLink::StartTransmission (Ptr<const Packet> p, Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << txTime);
+  Update ();
+
+  // The packets which were dropped by the device queue are skipped. If the
+  // packet was not seen by IsLost, all the backlog is ahead of it
+  double arrived = m_arrived;
+  while (!m_packets.empty ())
+    {
+      std::pair<uint64_t, double> packet = m_packets.front ();
+      m_packets.pop_front ();
+      if (packet.first == p->GetUid ())
+        {
+          arrived = packet.second;
+          break;
+        }
+    }
+
+  // The fluid which has not left the queue yet, out of the fluid which
+  // arrived before the packet
+  double ahead = std::max (0.0, arrived - (m_arrived - m_backlog));
+  Time wait = TransmissionTime (ahead);
+  NS_LOG_LOGIC ("Packet waits " << wait << " for " << ahead << " bytes of fluid");
+
+  m_busyStart = Simulator::Now () + wait;
+  m_busyEnd = m_busyStart + txTime;
+  return wait;
+}
+
+} // namespace ns3
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fluid-traffic-matrix.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/channel.h"
+#include "ns3/node-list.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidTrafficMatrix");
+
+NS_OBJECT_ENSURE_REGISTERED (FluidTrafficMatrix);
+
+TypeId
+FluidTrafficMatrix::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FluidTrafficMatrix")
+    .SetParent<Object> ()
+    .SetGroupName ("Fluid")
+    .AddConstructor<FluidTrafficMatrix> ()
+  ;
+  return tid;
+}
+
+FluidTrafficMatrix::FluidTrafficMatrix ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FluidTrafficMatrix::~FluidTrafficMatrix ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FluidTrafficMatrix::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_links.clear ();
+  m_linkIndices.clear ();
+  m_demands.clear ();
+  Object::DoDispose ();
+}
+
+void
+FluidTrafficMatrix::AddLink (Ptr<NetDevice> device, Ptr<FluidLink> link)
+{
+  NS_LOG_FUNCTION (this << device << link);
+  NS_ABORT_MSG_IF (m_linkIndices.find (device) != m_linkIndices.end (),
+                   "FluidTrafficMatrix::AddLink(): device already added");
+  m_linkIndices[device] = m_links.size ();
+  m_links.push_back (link);
+  m_factors.push_back (1.0);
+}
+
+Ptr<FluidLink>
+FluidTrafficMatrix::GetLink (Ptr<NetDevice> device) const
+{
+  std::map<Ptr<NetDevice>, uint32_t>::const_iterator it = m_linkIndices.find (device);
+  if (it == m_linkIndices.end ())
+    {
+      return 0;
+    }
+  return m_links[it->second];
+}
+
+uint32_t
+FluidTrafficMatrix::AddDemand (Ptr<Node> src, Ptr<Node> dst)
+{
+  NS_LOG_FUNCTION (this << src << dst);
+  Demand demand;
+  demand.path = FindPath (src, dst);
+  m_demands.push_back (demand);
+  return m_demands.size () - 1;
+}
+
+uint32_t
+FluidTrafficMatrix::AddDemand (Ptr<Node> src, Ptr<Node> dst, DataRate rate, Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this << src << dst << rate << start << stop);
+  uint32_t demand = AddDemand (src, dst);
+  Simulator::Schedule (start, &FluidTrafficMatrix::SetDemandRate, this, demand, rate);
+  Simulator::Schedule (stop, &FluidTrafficMatrix::SetDemandRate, this, demand, DataRate (0));
+  return demand;
+}
+
+uint32_t
+FluidTrafficMatrix::GetNDemands (void) const
+{
+  return m_demands.size ();
+}
+
+void
+FluidTrafficMatrix::SetDemandRate (uint32_t demand, DataRate rate)
+{
+  NS_LOG_FUNCTION (this << demand << rate);
+  NS_ASSERT (demand < m_demands.size ());
+  m_demands[demand].rate = rate;
+  UpdateRates ();
+}
+
+DataRate
+FluidTrafficMatrix::GetDemandRate (uint32_t demand) const
+{
+  NS_ASSERT (demand < m_demands.size ());
+  return m_demands[demand].rate;
+}
+
+double
+FluidTrafficMatrix::GetDemandThroughput (uint32_t demand) const
+{
+  NS_ASSERT (demand < m_demands.size ());
+  const Demand &d = m_demands[demand];
+  double rate = d.rate.GetBitRate ();
+  for (std::vector<uint32_t>::const_iterator it = d.path.begin (); it != d.path.end (); it++)
+    {
+      rate *= m_factors[*it];
+    }
+  return rate;
+}
+
+int64_t
+FluidTrafficMatrix::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  int64_t currentStream = stream;
+  for (uint32_t i = 0; i < m_links.size (); i++)
+    {
+      currentStream += m_links[i]->AssignStreams (currentStream);
+    }
+  return (currentStream - stream);
+}
+
+std::vector<uint32_t>
+FluidTrafficMatrix::FindPath (Ptr<Node> src, Ptr<Node> dst) const
+{
+  NS_LOG_FUNCTION (this << src << dst);
+
+  // Breadth-first search from the source over the links of the matrix. The
+  // link used to reach each node is stored to build the path backwards
+  uint32_t nNodes = NodeList::GetNNodes ();
+  std::vector<int64_t> parentLink (nNodes, -1);
+  std::vector<uint32_t> parentNode (nNodes);
+  std::vector<bool> visited (nNodes, false);
+  std::queue<Ptr<Node> > greyNodes;
+  visited[src->GetId ()] = true;
+  greyNodes.push (src);
+
+  while (!greyNodes.empty () && !visited[dst->GetId ()])
+    {
+      Ptr<Node> node = greyNodes.front ();
+      greyNodes.pop ();
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (i);
+          std::map<Ptr<NetDevice>, uint32_t>::const_iterator it = m_linkIndices.find (device);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (it == m_linkIndices.end () || channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+            {
+              Ptr<Node> peer = channel->GetDevice (j)->GetNode ();
+              if (peer != node && !visited[peer->GetId ()])
+                {
+                  visited[peer->GetId ()] = true;
+                  parentLink[peer->GetId ()] = it->second;
+                  parentNode[peer->GetId ()] = node->GetId ();
+                  greyNodes.push (peer);
+                }
+            }
+        }
+    }
+
+  NS_ABORT_MSG_UNLESS (visited[dst->GetId ()], "FluidTrafficMatrix::FindPath(): no path from node "
+                       << src->GetId () << " to node " << dst->GetId ());
+
+  std::vector<uint32_t> path;
+  for (uint32_t id = dst->GetId (); id != src->GetId (); id = parentNode[id])
+    {
+      path.push_back (parentLink[id]);
+    }
+  std::reverse (path.begin (), path.end ());
+  return path;
+}
+
+void
+FluidTrafficMatrix::UpdateRates (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // The arrival rate of a link depends on the fluid leaving the links before
+  // it, hence the rates are computed again until the ratios of the fluid
+  // leaving the links do not change, which takes as many rounds as the
+  // longest chain of overloaded links
+  std::vector<double> arrival (m_links.size ());
+  std::fill (m_factors.begin (), m_factors.end (), 1.0);
+  for (uint32_t round = 0; round <= m_links.size (); round++)
+    {
+      std::fill (arrival.begin (), arrival.end (), 0.0);
+      for (std::vector<Demand>::const_iterator d = m_demands.begin (); d != m_demands.end (); d++)
+        {
+          double rate = d->rate.GetBitRate ();
+          for (std::vector<uint32_t>::const_iterator it = d->path.begin (); it != d->path.end () && rate > 0; it++)
+            {
+              arrival[*it] += rate;
+              rate *= m_factors[*it];
+            }
+        }
+
+      bool changed = false;
+      for (uint32_t i = 0; i < m_links.size (); i++)
+        {
+          double capacity = m_links[i]->GetDataRate ().GetBitRate ();
+          double factor = arrival[i] > capacity ? capacity / arrival[i] : 1.0;
+          if (std::fabs (factor - m_factors[i]) > 1e-9)
+            {
+              changed = true;
+            }
+          m_factors[i] = factor;
+        }
+      if (!changed)
+        {
+          break;
+        }
+    }
+
+  for (uint32_t i = 0; i < m_links.size (); i++)
+    {
+      m_links[i]->SetArrivalRate (arrival[i]);
+    }
+}
+
+} // namespace ns3
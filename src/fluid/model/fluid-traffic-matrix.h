@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLUID_TRAFFIC_MATRIX_H
+#define FLUID_TRAFFIC_MATRIX_H
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "fluid-link.h"
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \ingroup fluid
+ *
+ * \brief A matrix of background demands carried as fluid over point-to-point links
+ *
+ * Each demand sends fluid from a source node to a destination node, along
+ * the shortest path over the links added to the matrix.  Whenever the rate
+ * of a demand changes, the arrival rate of each link is computed again: the
+ * fluid of a demand which leaves an overloaded link is reduced in proportion
+ * of the data rate of the link over its arrival rate, and the arrival rates
+ * of the links are iterated until they are consistent.  Between rate changes,
+ * the links evolve on their own, with no event scheduled.
+ */
+class FluidTrafficMatrix : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FluidTrafficMatrix ();
+  virtual ~FluidTrafficMatrix ();
+
+  /**
+   * \brief Add a link to carry the fluid of the demands
+   * \param device the transmitting device of the link
+   * \param link the fluid queue of the device
+   */
+  void AddLink (Ptr<NetDevice> device, Ptr<FluidLink> link);
+
+  /**
+   * \brief Get the fluid queue of a device
+   * \param device the transmitting device of the link
+   * \return the fluid queue of the device, or 0 if the link was not added
+   */
+  Ptr<FluidLink> GetLink (Ptr<NetDevice> device) const;
+
+  /**
+   * \brief Add a demand, with a null rate
+   *
+   * \param src the source node
+   * \param dst the destination node
+   * \return the index of the demand
+   */
+  uint32_t AddDemand (Ptr<Node> src, Ptr<Node> dst);
+
+  /**
+   * \brief Add a demand which is active for some time
+   *
+   * \param src the source node
+   * \param dst the destination node
+   * \param rate the rate of the demand
+   * \param start the time the demand starts, relative to now
+   * \param stop the time the demand stops, relative to now
+   * \return the index of the demand
+   */
+  uint32_t AddDemand (Ptr<Node> src, Ptr<Node> dst, DataRate rate, Time start, Time stop);
+
+  /**
+   * \brief Get the number of demands
+   * \return the number of demands
+   */
+  uint32_t GetNDemands (void) const;
+
+  /**
+   * \brief Change the rate of a demand, from now on
+   * \param demand the index of the demand
+   * \param rate the new rate
+   */
+  void SetDemandRate (uint32_t demand, DataRate rate);
+
+  /**
+   * \brief Get the rate of a demand
+   * \param demand the index of the demand
+   * \return the rate of the demand
+   */
+  DataRate GetDemandRate (uint32_t demand) const;
+
+  /**
+   * \brief Get the rate of a demand which reaches its destination
+   * \param demand the index of the demand
+   * \return the rate of the demand, reduced by the overloaded links of its path, in bits per second
+   */
+  double GetDemandThroughput (uint32_t demand) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the links.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Compute the path of a demand
+   * \param src the source node
+   * \param dst the destination node
+   * \return the indices of the links of the path
+   */
+  std::vector<uint32_t> FindPath (Ptr<Node> src, Ptr<Node> dst) const;
+
+  /**
+   * \brief Compute the arrival rate of each link and set it
+   */
+  void UpdateRates (void);
+
+  /**
+   * \brief A background demand
+   */
+  struct Demand
+  {
+    DataRate rate;               //!< the rate of the demand
+    std::vector<uint32_t> path;  //!< the links of the path
+  };
+
+  std::vector<Ptr<FluidLink> > m_links;                 //!< The links
+  std::map<Ptr<NetDevice>, uint32_t> m_linkIndices;     //!< The index of the link of each device
+  std::vector<double> m_factors;                        //!< The ratio of the fluid leaving each link
+  std::vector<Demand> m_demands;                        //!< The demands
+};
+
+} // namespace ns3
+
+#endif /* FLUID_TRAFFIC_MATRIX_H */
@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/fluid-link.h"
+#include "ns3/fluid-traffic-matrix.h"
+#include "ns3/fluid-helper.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup fluid
+ * \defgroup fluid-test fluid module tests
+ */
+
+/**
+ * \ingroup fluid-test
+ * \ingroup tests
+ *
+ * \brief Test the evolution of the fluid queue of a link
+ */
+class FluidLinkTestCase : public TestCase
+{
+public:
+  FluidLinkTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the state of the fluid queue
+   * \param link the link
+   * \param backlog the expected backlog, in bytes
+   * \param lost the expected lost bytes
+   * \param lossRatio the expected loss ratio
+   */
+  void Check (Ptr<FluidLink> link, double backlog, double lost, double lossRatio);
+  /**
+   * Start the transmission of a packet and check its wait
+   * \param link the link
+   * \param wait the expected wait
+   */
+  void Transmit (Ptr<FluidLink> link, Time wait);
+};
+
+FluidLinkTestCase::FluidLinkTestCase ()
+  : TestCase ("Check the evolution of the fluid queue")
+{
+}
+
+void
+FluidLinkTestCase::Check (Ptr<FluidLink> link, double backlog, double lost, double lossRatio)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (link->GetBacklog (), backlog, 1e-6, "Wrong backlog at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (link->GetLostBytes (), lost, 1e-6, "Wrong lost bytes at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (link->GetLossRatio (), lossRatio, 1e-9, "Wrong loss ratio at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+FluidLinkTestCase::Transmit (Ptr<FluidLink> link, Time wait)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  NS_TEST_EXPECT_MSG_EQ (link->IsLost (p), false, "Unexpected loss");
+  NS_TEST_EXPECT_MSG_EQ (link->StartTransmission (p, MilliSeconds (10)), wait, "Wrong wait");
+}
+
+void
+FluidLinkTestCase::DoRun (void)
+{
+  // At 8 Mbps, one byte leaves the queue every microsecond
+  Ptr<FluidLink> link = CreateObject<FluidLink> ();
+  link->SetDataRate (DataRate ("8Mbps"));
+  link->SetAttribute ("BufferSize", UintegerValue (100000));
+
+  // The backlog grows by 1e6 bytes per second and the queue is full after 100 ms
+  link->SetArrivalRate (16e6);
+  Simulator::Schedule (MilliSeconds (50), &FluidLinkTestCase::Check, this, link, 50000, 0, 0);
+  Simulator::Schedule (MilliSeconds (150), &FluidLinkTestCase::Check, this, link, 100000, 50000, 0.5);
+
+  // The backlog decreases by 0.5e6 bytes per second, except while the
+  // packet is transmitted after the 50000 bytes ahead of it
+  Simulator::Schedule (MilliSeconds (150), &FluidLink::SetArrivalRate, link, 4e6);
+  Simulator::Schedule (MilliSeconds (200), &FluidLinkTestCase::Check, this, link, 75000, 50000, 0);
+  Simulator::Schedule (MilliSeconds (200), &FluidLinkTestCase::Transmit, this, link, MilliSeconds (75));
+  Simulator::Schedule (MilliSeconds (275), &FluidLinkTestCase::Check, this, link, 37500, 50000, 0);
+  Simulator::Schedule (MilliSeconds (285), &FluidLinkTestCase::Check, this, link, 42500, 50000, 0);
+  Simulator::Schedule (MilliSeconds (295), &FluidLinkTestCase::Check, this, link, 37500, 50000, 0);
+  Simulator::Schedule (MilliSeconds (500), &FluidLinkTestCase::Check, this, link, 0, 50000, 0);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup fluid-test
+ * \ingroup tests
+ *
+ * \brief Test the arrival rates of the links of a traffic matrix
+ */
+class FluidTrafficMatrixTestCase : public TestCase
+{
+public:
+  FluidTrafficMatrixTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FluidTrafficMatrixTestCase::FluidTrafficMatrixTestCase ()
+  : TestCase ("Check the arrival rates of the links of a traffic matrix")
+{
+}
+
+void
+FluidTrafficMatrixTestCase::DoRun (void)
+{
+  // A line of three nodes, with a bottleneck between the second and the third
+  NodeContainer nodes;
+  nodes.Create (3);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  NetDeviceContainer ab = p2p.Install (nodes.Get (0), nodes.Get (1));
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  NetDeviceContainer bc = p2p.Install (nodes.Get (1), nodes.Get (2));
+
+  FluidHelper fluid;
+  Ptr<FluidTrafficMatrix> matrix = fluid.Install (nodes);
+  Ptr<FluidLink> abLink = matrix->GetLink (ab.Get (0));
+  Ptr<FluidLink> bcLink = matrix->GetLink (bc.Get (0));
+  Ptr<FluidLink> cbLink = matrix->GetLink (bc.Get (1));
+  NS_TEST_ASSERT_MSG_NE (abLink, 0, "No fluid link on the first link");
+  NS_TEST_ASSERT_MSG_EQ (bcLink->GetDataRate (), DataRate ("5Mbps"), "Wrong data rate");
+
+  uint32_t ac = matrix->AddDemand (nodes.Get (0), nodes.Get (2));
+  uint32_t bc1 = matrix->AddDemand (nodes.Get (1), nodes.Get (2));
+  uint32_t ca = matrix->AddDemand (nodes.Get (2), nodes.Get (0));
+  matrix->SetDemandRate (ac, DataRate ("8Mbps"));
+  matrix->SetDemandRate (bc1, DataRate ("2Mbps"));
+  matrix->SetDemandRate (ca, DataRate ("1Mbps"));
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (abLink->GetArrivalRate (), 8e6, 1e-3, "Wrong arrival rate of the first link");
+  NS_TEST_EXPECT_MSG_EQ_TOL (bcLink->GetArrivalRate (), 10e6, 1e-3, "Wrong arrival rate of the second link");
+  NS_TEST_EXPECT_MSG_EQ_TOL (cbLink->GetArrivalRate (), 1e6, 1e-3, "Wrong arrival rate of the reverse link");
+  NS_TEST_EXPECT_MSG_EQ_TOL (matrix->GetDemandThroughput (ac), 4e6, 1e-3, "Wrong throughput");
+  NS_TEST_EXPECT_MSG_EQ_TOL (matrix->GetDemandThroughput (bc1), 1e6, 1e-3, "Wrong throughput");
+
+  // The first link is overloaded and only passes 10 Mbps to the second one
+  matrix->SetDemandRate (ac, DataRate ("20Mbps"));
+  NS_TEST_EXPECT_MSG_EQ_TOL (abLink->GetArrivalRate (), 20e6, 1e-3, "Wrong arrival rate of the first link");
+  NS_TEST_EXPECT_MSG_EQ_TOL (bcLink->GetArrivalRate (), 12e6, 1e-3, "Wrong arrival rate of the second link");
+  NS_TEST_EXPECT_MSG_EQ_TOL (matrix->GetDemandThroughput (ac), 10e6 * 5 / 12, 1e-3, "Wrong throughput");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup fluid-test
+ * \ingroup tests
+ *
+ * \brief Test the delay and the loss of foreground packets
+ */
+class FluidForegroundTestCase : public TestCase
+{
+public:
+  FluidForegroundTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Send packets
+   * \param device the sending device
+   * \param n the number of packets
+   */
+  static void Send (Ptr<NetDevice> device, uint32_t n);
+  /**
+   * Record the reception of a packet
+   * \param p the packet
+   */
+  void Rx (Ptr<const Packet> p);
+  /**
+   * Record the drop of a packet
+   * \param p the packet
+   */
+  void Drop (Ptr<const Packet> p);
+
+  std::vector<Time> m_rxTimes;  //!< The reception times
+  uint32_t m_drops;             //!< The number of dropped packets
+};
+
+FluidForegroundTestCase::FluidForegroundTestCase ()
+  : TestCase ("Check the delay and the loss of foreground packets"),
+    m_drops (0)
+{
+}
+
+void
+FluidForegroundTestCase::Send (Ptr<NetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (998), device->GetBroadcast (), 0x800);
+    }
+}
+
+void
+FluidForegroundTestCase::Rx (Ptr<const Packet> p)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+}
+
+void
+FluidForegroundTestCase::Drop (Ptr<const Packet> p)
+{
+  m_drops++;
+}
+
+void
+FluidForegroundTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("0ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  devices.Get (0)->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&FluidForegroundTestCase::Drop, this));
+  devices.Get (1)->TraceConnectWithoutContext ("MacRx", MakeCallback (&FluidForegroundTestCase::Rx, this));
+
+  FluidHelper fluid;
+  fluid.SetLinkAttribute ("BufferSize", UintegerValue (100000));
+  Ptr<FluidTrafficMatrix> matrix = fluid.Install (nodes);
+  matrix->AssignStreams (1);
+  matrix->AddDemand (nodes.Get (0), nodes.Get (1), DataRate ("16Mbps"), Seconds (0), Seconds (10));
+
+  // The first packet waits for the 50000 bytes of fluid ahead of it, which
+  // leave in 50 ms. The second packet waits for the first one, then for the
+  // 20000 bytes of fluid which arrived before it and are still queued
+  Simulator::Schedule (MilliSeconds (50), &FluidForegroundTestCase::Send, devices.Get (0), 1);
+  Simulator::Schedule (MilliSeconds (60), &FluidForegroundTestCase::Send, devices.Get (0), 1);
+  // When the fluid queue is full, half of the fluid is lost, and so are the packets
+  Simulator::Schedule (MilliSeconds (500), &FluidForegroundTestCase::Send, devices.Get (0), 50);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_GT (m_rxTimes.size (), 2, "The packets were not received");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[0], MilliSeconds (101), "Wrong reception time of the first packet");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[1], MilliSeconds (122), "Wrong reception time of the second packet");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes.size () + m_drops, 52, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_GT (m_drops, 10, "Too few packets lost");
+  NS_TEST_EXPECT_MSG_LT (m_drops, 40, "Too many packets lost");
+}
+
+/**
+ * \ingroup fluid-test
+ * \ingroup tests
+ *
+ * \brief Fluid Test Suite
+ */
+static class FluidTestSuite : public TestSuite
+{
+public:
+  FluidTestSuite ()
+    : TestSuite ("fluid", UNIT)
+  {
+    AddTestCase (new FluidLinkTestCase (), TestCase::QUICK);
+    AddTestCase (new FluidTrafficMatrixTestCase (), TestCase::QUICK);
+    AddTestCase (new FluidForegroundTestCase (), TestCase::QUICK);
+  }
+} g_fluidTestSuite; ///< the test suite
@@ -47,8 +47,12 @@
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/global-router-interface.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/lazy-socket-factory.h"
+#include "ns3/pointer.h"
+#include "ns3/object-ptr-container.h"
 #include <limits>
 #include <map>
+#include <set>
 
 namespace ns3 {
 
@@ -107,8 +111,8 @@ InternetStackHelper::InternetStackHelper ()
     m_ipv4Enabled (true),
     m_ipv6Enabled (true),
     m_ipv4ArpJitterEnabled (true),
-    m_ipv6NsRsJitterEnabled (true)
-
+    m_ipv6NsRsJitterEnabled (true),
+    m_lazyTransportEnabled (false)
 {
   Initialize ();
 }
@@ -143,6 +147,7 @@ InternetStackHelper::InternetStackHelper (const InternetStackHelper &o)
   m_tcpFactory = o.m_tcpFactory;
   m_ipv4ArpJitterEnabled = o.m_ipv4ArpJitterEnabled;
   m_ipv6NsRsJitterEnabled = o.m_ipv6NsRsJitterEnabled;
+  m_lazyTransportEnabled = o.m_lazyTransportEnabled;
 }
 
 InternetStackHelper &
@@ -168,6 +173,7 @@ InternetStackHelper::Reset (void)
   m_ipv6Enabled = true;
   m_ipv4ArpJitterEnabled = true;
   m_ipv6NsRsJitterEnabled = true;
+  m_lazyTransportEnabled = false;
   Initialize ();
 }
 
@@ -206,6 +212,102 @@ void InternetStackHelper::SetIpv6NsRsJitter (bool enable)
   m_ipv6NsRsJitterEnabled = enable;
 }
 
+void InternetStackHelper::SetLazyTransportInstall (bool enable)
+{
+  m_lazyTransportEnabled = enable;
+}
+
+/**
+ * \brief Add the size of an object and of the objects reachable from it.
+ *
+ * The objects are followed through their pointer and object container
+ * attributes.  Nodes are not followed.
+ *
+ * \param object the object
+ * \param visited the objects already counted
+ * \returns the size of the objects which were not counted yet
+ */
+static uint32_t
+GetObjectFootprint (Ptr<Object> object, std::set<Ptr<Object> > &visited)
+{
+  if (object == 0 || DynamicCast<Node> (object) != 0 || !visited.insert (object).second)
+    {
+      return 0;
+    }
+  TypeId tid = object->GetInstanceTypeId ();
+  uint32_t size = tid.GetSize ();
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ())
+            {
+              continue;
+            }
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              PointerValue pointer;
+              object->GetAttribute (info.name, pointer);
+              size += GetObjectFootprint (pointer.Get<Object> (), visited);
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              ObjectPtrContainerValue container;
+              object->GetAttribute (info.name, container);
+              for (ObjectPtrContainerValue::Iterator it = container.Begin (); it != container.End (); it++)
+                {
+                  size += GetObjectFootprint (it->second, visited);
+                }
+            }
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return size;
+}
+
+std::map<std::string, uint32_t>
+InternetStackHelper::GetMemoryFootprint (Ptr<Node> node)
+{
+  std::map<std::string, uint32_t> footprint;
+  std::set<Ptr<Object> > visited;
+  // the components are counted on their own, not as reachable objects
+  Object::AggregateIterator it = node->GetAggregateIterator ();
+  while (it.HasNext ())
+    {
+      visited.insert (ConstCast<Object> (it.Next ()));
+    }
+  it = node->GetAggregateIterator ();
+  while (it.HasNext ())
+    {
+      Ptr<Object> component = ConstCast<Object> (it.Next ());
+      if (component == node)
+        {
+          continue;
+        }
+      visited.erase (component);
+      footprint[component->GetInstanceTypeId ().GetName ()] += GetObjectFootprint (component, visited);
+    }
+  return footprint;
+}
+
+void
+InternetStackHelper::PrintMemoryFootprint (Ptr<Node> node, std::ostream &os)
+{
+  std::map<std::string, uint32_t> footprint = GetMemoryFootprint (node);
+  uint32_t total = 0;
+  os << "Node " << node->GetId () << " memory footprint (bytes):" << std::endl;
+  for (std::map<std::string, uint32_t>::const_iterator it = footprint.begin (); it != footprint.end (); it++)
+    {
+      os << "  " << it->first << " " << it->second << std::endl;
+      total += it->second;
+    }
+  os << "  Total " << total << std::endl;
+}
+
 int64_t
 InternetStackHelper::AssignStreams (NodeContainer c, int64_t stream)
 {
@@ -346,8 +448,18 @@ InternetStackHelper::Install (Ptr<Node> node) const
   if (m_ipv4Enabled || m_ipv6Enabled)
     {
       CreateAndAggregateObjectFromTypeId (node, "ns3::TrafficControlLayer");
-      CreateAndAggregateObjectFromTypeId (node, "ns3::UdpL4Protocol");
-      node->AggregateObject (m_tcpFactory.Create<Object> ());
+      if (m_lazyTransportEnabled)
+        {
+          node->AggregateObject (CreateObject<LazyUdpSocketFactory> ());
+          Ptr<LazyTcpSocketFactory> tcpFactory = CreateObject<LazyTcpSocketFactory> ();
+          tcpFactory->SetTcpFactory (m_tcpFactory);
+          node->AggregateObject (tcpFactory);
+        }
+      else
+        {
+          CreateAndAggregateObjectFromTypeId (node, "ns3::UdpL4Protocol");
+          node->AggregateObject (m_tcpFactory.Create<Object> ());
+        }
       Ptr<PacketSocketFactory> factory = CreateObject<PacketSocketFactory> ();
       node->AggregateObject (factory);
     }
@@ -589,6 +701,16 @@ Ipv4L3ProtocolDropSinkWithoutContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', p, interface);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -613,6 +735,16 @@ Ipv4L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', packet, interface);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -637,6 +769,16 @@ Ipv4L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', packet, interface);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -675,6 +817,16 @@ Ipv4L3ProtocolDropSinkWithContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', context, p, interface);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *p << std::endl;
@@ -706,6 +858,16 @@ Ipv4L3ProtocolTxSinkWithContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', context, packet, interface);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -737,6 +899,16 @@ Ipv4L3ProtocolRxSinkWithContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', context, packet, interface);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -927,6 +1099,16 @@ Ipv6L3ProtocolDropSinkWithoutContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', p, interface);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -951,6 +1133,16 @@ Ipv6L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', packet, interface);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -975,6 +1167,16 @@ Ipv6L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', packet, interface);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -1013,6 +1215,16 @@ Ipv6L3ProtocolDropSinkWithContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', context, p, interface);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *p << std::endl;
@@ -1044,6 +1256,16 @@ Ipv6L3ProtocolTxSinkWithContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', context, packet, interface);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -1075,6 +1297,16 @@ Ipv6L3ProtocolRxSinkWithContext (
       return;
     }
 
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', context, packet, interface);
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
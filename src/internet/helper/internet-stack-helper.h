@@ -29,6 +29,9 @@
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "internet-trace-helper.h"
+#include <map>
+#include <string>
+#include <ostream>
 
 namespace ns3 {
 
@@ -82,6 +85,9 @@ class Ipv6RoutingHelper;
  *  - a PacketSocketFactory
  *  - Ipv4 routing (a list routing object, a global routing object, and a static routing object)
  *  - Ipv6 routing (a static routing object)
+ *
+ * With SetLazyTransportInstall, the UDP and TCP protocols are replaced by
+ * socket factories that create them on first use.
  */
 class InternetStackHelper : public PcapHelperForIpv4, public PcapHelperForIpv6, 
                             public AsciiTraceHelperForIpv4, public AsciiTraceHelperForIpv6
@@ -223,6 +229,50 @@ public:
    */
   void SetIpv6NsRsJitter (bool enable);
 
+  /**
+   * \brief Enable/disable the lazy install of the transport protocols.
+   *
+   * When enabled, ns3::UdpL4Protocol and the TCP protocol are not created
+   * by Install.  A ns3::LazyUdpSocketFactory and a ns3::LazyTcpSocketFactory
+   * are aggregated in their place, which create the protocols the first
+   * time a socket of the matching type is created on the node.  This saves
+   * time and memory on nodes that use only one of the protocols, or none.
+   *
+   * Until its protocol is created, a node discards the UDP datagrams and
+   * TCP segments it receives without any ICMP error or TCP reset.  The
+   * TCP protocol set with SetTcp must be a ns3::TcpL4Protocol subclass.
+   *
+   * \param enable enable state
+   */
+  void SetLazyTransportInstall (bool enable);
+
+  /**
+   * \brief Get the memory footprint of a node, by component.
+   *
+   * The components are the objects aggregated to the node.  The footprint
+   * of a component is the sum of the sizes of the component and of the
+   * objects reachable from it through pointer and object container
+   * attributes, e.g., the interfaces and the ARP caches of
+   * ns3::Ipv4L3Protocol.  Each object is counted once, and other nodes are
+   * not followed.  Only the size of the object classes is counted, not
+   * the memory the objects allocate for their members: the result is a
+   * lower bound, meant to compare stack configurations.
+   *
+   * \param node the node
+   * \returns the footprint in bytes, indexed by component TypeId name
+   */
+  static std::map<std::string, uint32_t> GetMemoryFootprint (Ptr<Node> node);
+
+  /**
+   * \brief Print the memory footprint of a node, by component.
+   *
+   * \see GetMemoryFootprint
+   *
+   * \param node the node
+   * \param os the output stream
+   */
+  static void PrintMemoryFootprint (Ptr<Node> node, std::ostream &os);
+
   /**
   * Assign a fixed random variable stream number to the random variables
   * used by this model.  Return the number of streams (possibly zero) that
@@ -369,6 +419,11 @@ private:
    * \brief IPv6 IPv6 NS and RS Jitter state (enabled/disabled) ?
    */
   bool m_ipv6NsRsJitterEnabled;
+
+  /**
+   * \brief Lazy install of the transport protocols (enabled/disabled) ?
+   */
+  bool m_lazyTransportEnabled;
 };
 
 } // namespace ns3
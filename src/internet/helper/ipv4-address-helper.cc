@@ -135,6 +135,17 @@ Ipv4AddressHelper::Assign (const NetDeviceContainer &c)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Ipv4InterfaceContainer retval;
+//
+// Allocate the addresses of all the devices at once: the generator checks
+// the whole range for duplicates in a single step.
+//
+  if (c.GetN () > 0)
+    {
+      NS_ASSERT_MSG (m_address + c.GetN () - 1 <= m_max,
+                     "Ipv4AddressHelper::Assign(): Address overflow");
+      Ipv4AddressGenerator::AddAllocated (Ipv4Address ((m_network << m_shift) | m_address),
+                                          Ipv4Address ((m_network << m_shift) | (m_address + c.GetN () - 1)));
+    }
   for (uint32_t i = 0; i < c.GetN (); ++i) {
       Ptr<NetDevice> device = c.Get (i);
 
@@ -155,7 +166,7 @@ Ipv4AddressHelper::Assign (const NetDeviceContainer &c)
       NS_ASSERT_MSG (interface >= 0, "Ipv4AddressHelper::Assign(): "
                      "Interface index not found");
 
-      Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (NewAddress (), m_mask);
+      Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (Ipv4Address ((m_network << m_shift) | m_address++), m_mask);
       ipv4->AddAddress (interface, ipv4Addr);
       ipv4->SetMetric (interface, 1);
       ipv4->SetUp (interface);
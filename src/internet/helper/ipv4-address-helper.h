@@ -171,6 +171,10 @@ public:
  * the addresses overflow the number of bits allocated for them by the network 
  * mask in the SetBase method, the system will NS_ASSERT and halt.
  *
+ * The addresses of all the net devices are allocated as one range in the
+ * Ipv4AddressGenerator, so the cost of the duplicate detection does not
+ * depend on the number of net devices in the container.
+ *
  * @param c The NetDeviceContainer holding the collection of net devices we
  * are asked to assign Ipv4 addresses to.
  *
@@ -21,6 +21,7 @@
 #include "ns3/global-router-interface.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/node-list.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -66,9 +67,30 @@ Ipv4GlobalRoutingHelper::PopulateRoutingTables (void)
 void 
 Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
 {
-  GlobalRouteManager::DeleteGlobalRoutes ();
-  GlobalRouteManager::BuildGlobalRoutingDatabase ();
-  GlobalRouteManager::InitializeRoutes ();
+  GlobalRouteManager::RecomputeRoutingTables ();
+}
+
+void
+Ipv4GlobalRoutingHelper::PrintMemoryUsage (Ptr<OutputStreamWrapper> stream)
+{
+  std::ostream* os = stream->GetStream ();
+  uint64_t total = 0;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      uint64_t bytes = gr->GetMemoryUsage ();
+      *os << "Node: " << (*i)->GetId () << ", global routes: " << gr->GetNRoutes ()
+          << ", bytes: " << bytes << std::endl;
+      total += bytes;
+    }
+  uint64_t shared = Ipv4GlobalRouting::GetSharedMemoryUsage ();
+  *os << "Shared next hop table bytes: " << shared << std::endl;
+  *os << "Total bytes: " << total + shared << std::endl;
 }
 
 
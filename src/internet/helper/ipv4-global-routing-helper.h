@@ -84,6 +84,17 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+
+  /**
+   * \brief Print the number of global routes and the memory they use on
+   * each node, and the memory used by the next hop table shared by the
+   * nodes which store their routes in compact form.
+   *
+   * \param stream The output stream object to use
+   *
+   * \see Ipv4GlobalRouting::GetMemoryUsage
+   */
+  static void PrintMemoryUsage (Ptr<OutputStreamWrapper> stream);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+#include "neighbor-cache-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeighborCacheHelper");
+
+NeighborCacheHelper::NeighborCacheHelper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      PopulateNeighborCache (*i);
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      PopulateIpv4Entries (channel->GetDevice (i));
+      PopulateIpv6Entries (channel->GetDevice (i));
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const NetDeviceContainer &devices) const
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      PopulateIpv4Entries (*i);
+      PopulateIpv6Entries (*i);
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const Ipv4InterfaceContainer &interfaces) const
+{
+  NS_LOG_FUNCTION (this);
+  for (Ipv4InterfaceContainer::Iterator i = interfaces.Begin (); i != interfaces.End (); ++i)
+    {
+      PopulateIpv4Entries (i->first->GetNetDevice (i->second));
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const Ipv6InterfaceContainer &interfaces) const
+{
+  NS_LOG_FUNCTION (this);
+  for (Ipv6InterfaceContainer::Iterator i = interfaces.Begin (); i != interfaces.End (); ++i)
+    {
+      PopulateIpv6Entries (i->first->GetNetDevice (i->second));
+    }
+}
+
+void
+NeighborCacheHelper::PopulateIpv4Entries (Ptr<NetDevice> device) const
+{
+  NS_LOG_FUNCTION (this << device);
+  Ptr<Channel> channel = device->GetChannel ();
+  Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+  if (channel == 0 || ipv4 == 0 || ipv4->GetInterfaceForDevice (device) < 0)
+    {
+      return;
+    }
+  Ptr<ArpCache> cache = ipv4->GetInterface (ipv4->GetInterfaceForDevice (device))->GetArpCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> neighbor = channel->GetDevice (i);
+      Ptr<Ipv4L3Protocol> neighborIpv4 = neighbor->GetNode ()->GetObject<Ipv4L3Protocol> ();
+      if (neighbor == device || neighborIpv4 == 0 || neighborIpv4->GetInterfaceForDevice (neighbor) < 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4Interface> interface = neighborIpv4->GetInterface (neighborIpv4->GetInterfaceForDevice (neighbor));
+      for (uint32_t j = 0; j < interface->GetNAddresses (); j++)
+        {
+          Ipv4Address address = interface->GetAddress (j).GetLocal ();
+          ArpCache::Entry *entry = cache->Lookup (address);
+          if (entry == 0)
+            {
+              entry = cache->Add (address);
+            }
+          entry->SetMacAddress (neighbor->GetAddress ());
+          entry->MarkPermanent ();
+          NS_LOG_LOGIC ("Node " << device->GetNode ()->GetId () << ": " << address << " is at " << neighbor->GetAddress ());
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateIpv6Entries (Ptr<NetDevice> device) const
+{
+  NS_LOG_FUNCTION (this << device);
+  Ptr<Channel> channel = device->GetChannel ();
+  Ptr<Ipv6L3Protocol> ipv6 = device->GetNode ()->GetObject<Ipv6L3Protocol> ();
+  if (channel == 0 || ipv6 == 0 || ipv6->GetInterfaceForDevice (device) < 0)
+    {
+      return;
+    }
+  Ptr<NdiscCache> cache = ipv6->GetInterface (ipv6->GetInterfaceForDevice (device))->GetNdiscCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> neighbor = channel->GetDevice (i);
+      Ptr<Ipv6L3Protocol> neighborIpv6 = neighbor->GetNode ()->GetObject<Ipv6L3Protocol> ();
+      if (neighbor == device || neighborIpv6 == 0 || neighborIpv6->GetInterfaceForDevice (neighbor) < 0)
+        {
+          continue;
+        }
+      uint32_t index = neighborIpv6->GetInterfaceForDevice (neighbor);
+      Ptr<Ipv6Interface> interface = neighborIpv6->GetInterface (index);
+      for (uint32_t j = 0; j < interface->GetNAddresses (); j++)
+        {
+          Ipv6Address address = interface->GetAddress (j).GetAddress ();
+          NdiscCache::Entry *entry = cache->Lookup (address);
+          if (entry == 0)
+            {
+              entry = cache->Add (address);
+            }
+          entry->SetMacAddress (neighbor->GetAddress ());
+          entry->SetRouter (neighborIpv6->IsForwarding (index));
+          entry->MarkPermanent ();
+          NS_LOG_LOGIC ("Node " << device->GetNode ()->GetId () << ": " << address << " is at " << neighbor->GetAddress ());
+        }
+    }
+}
+
+} // namespace ns3
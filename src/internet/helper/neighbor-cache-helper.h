@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef NEIGHBOR_CACHE_HELPER_H
+#define NEIGHBOR_CACHE_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv6-interface-container.h"
+
+namespace ns3 {
+
+class Channel;
+class NetDevice;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Helper class that fills the ARP and NDISC caches with permanent
+ * entries.
+ *
+ * Each IPv4 (resp. IPv6) interface gets, in its ArpCache (resp.
+ * NdiscCache), a permanent entry for every address of the IP interfaces of
+ * the other devices attached to the same channel.  Packets to these
+ * neighbors are then sent right away: no ARP request, Neighbor
+ * Solicitation, pending packet queue or entry expiry is involved.
+ *
+ * The caches must be populated once the addresses have been assigned, and
+ * again if addresses are added later.  Neighbors that are only reachable
+ * through a bridge are not on the same channel, and are still resolved
+ * dynamically.  Devices that do not use address resolution (e.g.,
+ * point-to-point devices) have no cache and are left alone.
+ */
+class NeighborCacheHelper
+{
+public:
+  NeighborCacheHelper ();
+
+  /**
+   * \brief Populate the caches of all the interfaces attached to a channel
+   * of the simulation.
+   */
+  void PopulateNeighborCache (void) const;
+
+  /**
+   * \brief Populate the caches of the interfaces attached to a channel
+   * \param channel the channel
+   */
+  void PopulateNeighborCache (Ptr<Channel> channel) const;
+
+  /**
+   * \brief Populate the caches of the interfaces of some devices, with
+   * the neighbors on their channels
+   * \param devices the devices
+   */
+  void PopulateNeighborCache (const NetDeviceContainer &devices) const;
+
+  /**
+   * \brief Populate the caches of some IPv4 interfaces, with the neighbors
+   * on their channels
+   * \param interfaces the interfaces
+   */
+  void PopulateNeighborCache (const Ipv4InterfaceContainer &interfaces) const;
+
+  /**
+   * \brief Populate the caches of some IPv6 interfaces, with the neighbors
+   * on their channels
+   * \param interfaces the interfaces
+   */
+  void PopulateNeighborCache (const Ipv6InterfaceContainer &interfaces) const;
+
+private:
+  /**
+   * \brief Populate the ArpCache of the IPv4 interface of a device
+   * \param device the device
+   */
+  void PopulateIpv4Entries (Ptr<NetDevice> device) const;
+
+  /**
+   * \brief Populate the NdiscCache of the IPv6 interface of a device
+   * \param device the device
+   */
+  void PopulateIpv6Entries (Ptr<NetDevice> device) const;
+};
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_CACHE_HELPER_H */
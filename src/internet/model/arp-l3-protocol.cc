@@ -274,6 +274,14 @@ ArpL3Protocol::Lookup (Ptr<Packet> packet, const Ipv4Header & ipHeader, Ipv4Addr
 {
   NS_LOG_FUNCTION (this << packet << destination << device << cache << hardwareDestination);
   ArpCache::Entry *entry = cache->Lookup (destination);
+  if (entry != 0 && entry->IsPermanent ())
+    {
+      // Permanent entries never expire: skip the resolution state machine
+      NS_LOG_LOGIC ("node="<<m_node->GetId ()<<
+                    ", permanent for " << destination << " valid -- send");
+      *hardwareDestination = entry->GetMacAddress ();
+      return true;
+    }
   if (entry != 0)
     {
       if (entry->IsExpired ()) 
@@ -325,13 +333,6 @@ ArpL3Protocol::Lookup (Ptr<Packet> packet, const Ipv4Header & ipHeader, Ipv4Addr
                   m_dropTrace (packet);
                 }
             }
-          else if (entry-> IsPermanent ())
-            {
-              NS_LOG_LOGIC ("node="<<m_node->GetId ()<<
-                            ", permanent for " << destination << "valid -- send");
-              *hardwareDestination = entry->GetMacAddress ();
-              return true;
-            }
           else
             {
               NS_LOG_LOGIC ("Test for possibly unreachable code-- please file a bug report, with a test case, if this is ever hit");
@@ -26,6 +26,7 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <iterator>
 #include <iostream>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
@@ -35,15 +36,41 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/core-config.h"
+#include "ns3/unused.h"
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
 #include "ipv4-global-routing.h"
 
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \brief The number of threads which run the SPF calculations.
+ */
+static GlobalValue g_spfThreads = GlobalValue ("GlobalRoutingSpfThreads",
+                                               "The number of threads which run the SPF calculations of global routing",
+                                               UintegerValue (1),
+                                               MakeUintegerChecker<uint32_t> (1));
+
+/**
+ * \brief Whether global routing keeps the SPF trees for incremental updates.
+ */
+static GlobalValue g_incrementalSpf = GlobalValue ("GlobalRoutingIncrementalSpf",
+                                                   "Keep the SPF trees of global routing, so that recomputing "
+                                                   "the routes only runs the SPF calculations which may have changed",
+                                                   BooleanValue (false),
+                                                   MakeBooleanChecker ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -495,13 +522,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -531,6 +555,93 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
   return 0;
 }
 
+/**
+ * \brief Compare two Link State Advertisements, regardless of their SPF status.
+ * \param a an LSA
+ * \param b another LSA
+ * \returns true if the LSAs are equal
+ */
+static bool
+IsSameLSA (GlobalRoutingLSA* a, GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask ().Get () != b->GetNetworkLSANetworkMask ().Get ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+GlobalRouteManagerLSDB::GetChanges (const GlobalRouteManagerLSDB* old,
+                                    std::vector<LSAChange_t>& changes) const
+{
+  NS_LOG_FUNCTION (this << old);
+//
+// Both maps are ordered by link state ID, walk them together.
+//
+  LSDBMap_t::const_iterator i = old->m_database.begin ();
+  LSDBMap_t::const_iterator j = m_database.begin ();
+  while (i != old->m_database.end () || j != m_database.end ())
+    {
+      if (j == m_database.end () || (i != old->m_database.end () && i->first < j->first))
+        {
+          changes.push_back (LSAChange_t (i->second, 0));
+          i++;
+        }
+      else if (i == old->m_database.end () || j->first < i->first)
+        {
+          changes.push_back (LSAChange_t (0, j->second));
+          j++;
+        }
+      else
+        {
+          if (!IsSameLSA (i->second, j->second))
+            {
+              changes.push_back (LSAChange_t (i->second, j->second));
+            }
+          i++;
+          j++;
+        }
+    }
+
+  if (old->m_extdatabase.size () != m_extdatabase.size ())
+    {
+      return true;
+    }
+  for (uint32_t k = 0; k < m_extdatabase.size (); k++)
+    {
+      if (!IsSameLSA (old->m_extdatabase[k], m_extdatabase[k]))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,12 +650,32 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_job (0),
+    m_checkStubs (false),
+    m_keepTrees (false),
+    m_jobs (0),
+    m_firstJob (0),
+    m_jobStride (1)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (GlobalRouteManagerImpl const *manager)
+  :
+    m_spfroot (0),
+    m_lsdb (manager->m_lsdb),
+    m_job (0),
+    m_checkStubs (manager->m_checkStubs),
+    m_keepTrees (manager->m_keepTrees),
+    m_jobs (0),
+    m_firstJob (0),
+    m_jobStride (1)
+{
+  NS_LOG_FUNCTION (this << manager);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -579,19 +710,10 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
           continue;
         }
       Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
       NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      gr->RemoveAllRoutes ();
     }
+  m_trees.clear ();
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -693,41 +815,661 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
 // list becomes empty. 
 //
 void
-GlobalRouteManagerImpl::InitializeRoutes ()
+GlobalRouteManagerImpl::InitializeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_incrementalSpf.GetValue (incremental);
+  m_keepTrees = incremental.Get ();
+  m_trees.clear ();
+  m_checkStubs = NodeList::GetNNodes () > 0;
+//
+// Walk the list of nodes in the system.
+//
+  NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFJob> jobs;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+//
+// Look for the GlobalRouter interface that indicates that the node is
+// participating in routing.
+//
+      Ptr<GlobalRouter> rtr = 
+        node->GetObject<GlobalRouter> ();
+
+      uint32_t systemId = MpiInterface::GetSystemId ();
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      if (node->GetSystemId () != systemId) 
+        {
+          continue;
+        }
+
+//
+// if the node has a global router interface, then run the global routing
+// algorithms.
+//
+      if (rtr && rtr->GetNumLSAs () )
+        {
+          jobs.push_back (SPFJob ());
+          PrepareJob (jobs.back (), node, rtr->GetRouterId ());
+        }
+    }
+  RunJobs (jobs);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_incrementalSpf.GetValue (incremental);
+  if (!incremental.Get () || !m_keepTrees || m_trees.empty ())
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+//
+// Keep the previous LSDB to find out what changed.
+//
+  GlobalRouteManagerLSDB *old = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::vector<GlobalRouteManagerLSDB::LSAChange_t> changes;
+  bool externals = m_lsdb->GetChanges (old, changes);
+  NS_LOG_INFO (changes.size () << " LSAs changed" << (externals ? ", and external LSAs changed" : ""));
+  m_checkStubs = NodeList::GetNNodes () > 0;
+
+  std::vector<SPFJob> jobs;
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (!rtr || node->GetSystemId () != systemId)
+        {
+          continue;
+        }
+      Ipv4Address routerId = rtr->GetRouterId ();
+      std::map<Ipv4Address, SPFTree>::iterator tree = m_trees.find (routerId);
+      if (!rtr->GetNumLSAs ())
+        {
+          if (tree != m_trees.end ())
+            {
+              rtr->GetRoutingProtocol ()->RemoveAllRoutes ();
+              m_trees.erase (tree);
+            }
+          continue;
+        }
+      if (externals || tree == m_trees.end ()
+          || IsTreeAffected (routerId, tree->second, changes, old))
+        {
+          NS_LOG_LOGIC ("SPF tree of router " << routerId << " may have changed");
+          jobs.push_back (SPFJob ());
+          PrepareJob (jobs.back (), node, routerId);
+          jobs.back ().replace = true;
+        }
+      else if (!changes.empty ())
+        {
+          NS_LOG_LOGIC ("SPF tree of router " << routerId << " did not change");
+          PatchRoutes (node, tree->second, changes);
+        }
+    }
+  NS_LOG_INFO ("Recomputing " << jobs.size () << " SPF trees");
+  RunJobs (jobs);
+  delete old;
+}
+
+void
+GlobalRouteManagerImpl::PrepareJob (SPFJob& job, Ptr<Node> node, Ipv4Address routerId) const
+{
+  NS_LOG_FUNCTION (this << &job << node << routerId);
+  job.node = node;
+  job.routerId = routerId;
+  job.replace = false;
+  if (node == 0)
+    {
+      return;
+    }
+//
+// Record the addresses of the root node, in the order in which
+// Ipv4::GetInterfaceForPrefix () looks at them, so that the SPF calculation
+// does not access the node.
+//
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::PrepareJob (): "
+                 "GetObject for <Ipv4> interface failed");
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          job.addresses.push_back (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), i));
+        }
+    }
+}
+
+uint32_t
+GlobalRouteManagerImpl::GetNThreads (uint32_t nJobs) const
+{
+  NS_LOG_FUNCTION (this << nJobs);
+  UintegerValue threads;
+  g_spfThreads.GetValue (threads);
+  uint32_t n = std::min (threads.Get (), static_cast<uint64_t> (nJobs));
+#ifndef HAVE_PTHREAD_H
+  n = 1;
+#endif /* HAVE_PTHREAD_H */
+  if (n > 1)
+    {
+//
+// The logging of the SPF calculation is not thread-safe.
+//
+      LogComponent::ComponentList *components = LogComponent::GetComponentList ();
+      for (LogComponent::ComponentList::const_iterator i = components->begin ();
+           i != components->end (); i++)
+        {
+          if (!i->second->IsNoneEnabled ())
+            {
+              NS_LOG_INFO ("Logging is enabled, running the SPF calculations in a single thread");
+              return 1;
+            }
+        }
+    }
+  return n;
+}
+
+void
+GlobalRouteManagerImpl::RunJobs (std::vector<SPFJob>& jobs)
+{
+  NS_LOG_FUNCTION (this << jobs.size ());
+  uint32_t nThreads = GetNThreads (jobs.size ());
+  if (nThreads <= 1)
+    {
+      for (uint32_t i = 0; i < jobs.size (); i++)
+        {
+          m_job = &jobs[i];
+          SPFCalculate (jobs[i].routerId);
+          m_job = 0;
+          InstallRoutes (jobs[i]);
+        }
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+//
+// Run the calculations by batches, so that the routes of only a few routers
+// wait to be installed at any time.
+//
+  NS_LOG_INFO ("Running " << jobs.size () << " SPF calculations in " << nThreads << " threads");
+  uint32_t batchSize = 64 * nThreads;
+  for (uint32_t first = 0; first < jobs.size (); first += batchSize)
+    {
+      std::vector<SPFJob> batch;
+      uint32_t last = std::min<uint32_t> (first + batchSize, jobs.size ());
+      batch.reserve (last - first);
+      for (uint32_t i = first; i < last; i++)
+        {
+          batch.push_back (SPFJob ());
+          std::swap (batch.back (), jobs[i]);
+        }
+
+      std::vector<GlobalRouteManagerImpl *> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl (this);
+          worker->m_jobs = &batch;
+          worker->m_firstJob = t;
+          worker->m_jobStride = nThreads;
+          workers.push_back (worker);
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::RunWorkerJobs, worker)));
+          threads.back ()->Start ();
+        }
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads[t]->Join ();
+          // The LSDB belongs to this manager
+          workers[t]->m_lsdb = 0;
+          delete workers[t];
+        }
+
+      for (uint32_t i = 0; i < batch.size (); i++)
+        {
+          InstallRoutes (batch[i]);
+        }
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+GlobalRouteManagerImpl::RunWorkerJobs (void)
+{
+  for (uint32_t i = m_firstJob; i < m_jobs->size (); i += m_jobStride)
+    {
+      m_job = &(*m_jobs)[i];
+      SPFCalculate (m_job->routerId);
+      m_job = 0;
+    }
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (SPFJob& job)
+{
+  NS_LOG_FUNCTION (this << &job);
+  if (job.node != 0)
+    {
+      Ptr<GlobalRouter> router = job.node->GetObject<GlobalRouter> ();
+      NS_ASSERT (router);
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      if (job.replace)
+        {
+          gr->RemoveAllRoutes ();
+        }
+      NS_LOG_LOGIC ("Installing " << job.routes.size () << " routes on node " << job.node->GetId ());
+      for (std::vector<SPFRoute>::const_iterator i = job.routes.begin (); i != job.routes.end (); i++)
+        {
+          switch (i->type)
+            {
+            case SPFRoute::HOST:
+              gr->AddHostRouteTo (i->dest, i->nextHop, i->outIf);
+              break;
+            case SPFRoute::NETWORK:
+              gr->AddNetworkRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+              break;
+            case SPFRoute::EXTERNAL:
+              gr->AddASExternalRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+              break;
+            }
+        }
+    }
+  if (m_keepTrees)
+    {
+      std::swap (m_trees[job.routerId], job.tree);
+    }
+  std::vector<SPFRoute> ().swap (job.routes);
+  job.tree = SPFTree ();
+}
+
+bool
+GlobalRouteManagerImpl::SPFRoute::operator< (SPFRoute const &other) const
+{
+  if (type != other.type)
+    {
+      return type < other.type;
+    }
+  if (dest != other.dest)
+    {
+      return dest < other.dest;
+    }
+  if (mask.Get () != other.mask.Get ())
+    {
+      return mask.Get () < other.mask.Get ();
+    }
+  if (nextHop != other.nextHop)
+    {
+      return nextHop < other.nextHop;
+    }
+  return outIf < other.outIf;
+}
+
+/**
+ * \brief An edge of the SPF graph, as followed by SPFNext ()
+ */
+struct SPFEdge
+{
+  Ipv4Address from;   //!< the vertex ID of the origin
+  Ipv4Address to;     //!< the vertex ID of the destination
+  uint32_t cost;      //!< the cost of the edge
+  Ipv4Address data;   //!< the link data of the edge
+
+  /**
+   * \param other another edge
+   * \returns true if this edge is ordered before the other one
+   */
+  bool operator< (SPFEdge const &other) const
+  {
+    if (from != other.from)
+      {
+        return from < other.from;
+      }
+    if (to != other.to)
+      {
+        return to < other.to;
+      }
+    if (cost != other.cost)
+      {
+        return cost < other.cost;
+      }
+    return data < other.data;
+  }
+};
+
+/**
+ * \brief Get the edges of the SPF graph which depend on an LSA.
+ *
+ * These are the edges out of the vertex of the LSA and, for a router LSA,
+ * the edges into the router from the transit networks it is attached to.
+ *
+ * \param lsa the LSA, or 0
+ * \param lsdb the database of the LSA
+ * \param edges [out] the edges, sorted
+ */
+static void
+GetSPFEdges (GlobalRoutingLSA* lsa, GlobalRouteManagerLSDB const* lsdb, std::vector<SPFEdge>& edges)
+{
+  if (lsa == 0)
+    {
+      return;
+    }
+  SPFEdge edge;
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          edge.from = lsa->GetLinkStateId ();
+          edge.to = l->GetLinkId ();
+          edge.cost = l->GetMetric ();
+          edge.data = l->GetLinkData ();
+          edges.push_back (edge);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              edge.from = l->GetLinkId ();
+              edge.to = lsa->GetLinkStateId ();
+              edge.cost = 0;
+              edges.push_back (edge);
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+        {
+          GlobalRoutingLSA *w = lsdb->GetLSAByLinkData (lsa->GetAttachedRouter (i));
+          if (w == 0)
+            {
+              continue;
+            }
+          edge.from = lsa->GetLinkStateId ();
+          edge.to = w->GetLinkStateId ();
+          edge.cost = 0;
+          edge.data = lsa->GetAttachedRouter (i);
+          edges.push_back (edge);
+        }
+    }
+  std::sort (edges.begin (), edges.end ());
+}
+
+/**
+ * \param lsa an LSA, or 0
+ * \param type the type of link records
+ * \param id a link ID
+ * \returns true if the LSA has a link record of the given type to the given ID
+ */
+static bool
+HasLinkTo (GlobalRoutingLSA* lsa, GlobalRoutingLinkRecord::LinkType type, Ipv4Address id)
+{
+  if (lsa == 0 || lsa->GetLSType () != GlobalRoutingLSA::RouterLSA)
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+      if (l->GetLinkType () == type && l->GetLinkId () == id)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+//
+// The SPF tree of a router depends on its own LSA, on the LSAs of its
+// neighbors (which give the next hops towards them) and on the edges of
+// the SPF graph which are on a shortest path.  Any change which cannot be
+// ruled out by these rules triggers a new SPF calculation.
+//
+bool
+GlobalRouteManagerImpl::IsTreeAffected (Ipv4Address root, SPFTree const& tree,
+                                        std::vector<GlobalRouteManagerLSDB::LSAChange_t> const& changes,
+                                        GlobalRouteManagerLSDB const* old) const
+{
+  NS_LOG_FUNCTION (this << root << changes.size () << old);
+  const uint64_t infinity = SPF_INFINITY;
+  GlobalRoutingLSA *rootLsa = m_lsdb->GetLSA (root);
+
+  for (std::vector<GlobalRouteManagerLSDB::LSAChange_t>::const_iterator i = changes.begin ();
+       i != changes.end (); i++)
+    {
+      GlobalRoutingLSA *o = i->first;
+      GlobalRoutingLSA *n = i->second;
+      Ipv4Address id = o ? o->GetLinkStateId () : n->GetLinkStateId ();
+//
+// The router itself, and its neighbors.
+//
+      if (id == root)
+        {
+          return true;
+        }
+      if (HasLinkTo (o, GlobalRoutingLinkRecord::PointToPoint, root)
+          || HasLinkTo (n, GlobalRoutingLinkRecord::PointToPoint, root)
+          || HasLinkTo (rootLsa, GlobalRoutingLinkRecord::TransitNetwork, id))
+        {
+          return true;
+        }
+      for (uint32_t j = 0; j < rootLsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = rootLsa->GetLinkRecord (j);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork
+              && (HasLinkTo (o, GlobalRoutingLinkRecord::TransitNetwork, l->GetLinkId ())
+                  || HasLinkTo (n, GlobalRoutingLinkRecord::TransitNetwork, l->GetLinkId ())))
+            {
+              return true;
+            }
+        }
+//
+// A stub router only has a default route towards its neighbor.
+//
+      if (tree.stub)
+        {
+          continue;
+        }
+//
+// Vertices of the tree which disappear or change type.
+//
+      std::map<Ipv4Address, SPFTreeVertex>::const_iterator v = tree.vertices.find (id);
+      if (v != tree.vertices.end ()
+          && (o == 0 || n == 0 || o->GetLSType () != n->GetLSType ()))
+        {
+          return true;
+        }
+//
+// Edges which are removed from a shortest path, or added to a path at least
+// as short as the current ones.
+//
+      std::vector<SPFEdge> oldEdges, newEdges, removed, added;
+      GetSPFEdges (o, old, oldEdges);
+      GetSPFEdges (n, m_lsdb, newEdges);
+      std::set_difference (oldEdges.begin (), oldEdges.end (), newEdges.begin (), newEdges.end (),
+                           std::back_inserter (removed));
+      std::set_difference (newEdges.begin (), newEdges.end (), oldEdges.begin (), oldEdges.end (),
+                           std::back_inserter (added));
+      for (uint32_t pass = 0; pass < 2; pass++)
+        {
+          std::vector<SPFEdge> const& edges = pass ? added : removed;
+          for (std::vector<SPFEdge>::const_iterator e = edges.begin (); e != edges.end (); e++)
+            {
+              std::map<Ipv4Address, SPFTreeVertex>::const_iterator from = tree.vertices.find (e->from);
+              if (from == tree.vertices.end ())
+                {
+                  continue;
+                }
+              std::map<Ipv4Address, SPFTreeVertex>::const_iterator to = tree.vertices.find (e->to);
+              uint64_t distance = uint64_t (from->second.distance) + e->cost;
+              uint64_t current = to == tree.vertices.end () ? infinity : to->second.distance;
+              if (pass ? distance <= current : distance == current)
+                {
+                  NS_LOG_LOGIC ("Edge from " << e->from << " to " << e->to << " changes the tree of " << root);
+                  return true;
+                }
+            }
+        }
+    }
+  return false;
+}
+
+/**
+ * \brief A destination of the intra-area routes towards a vertex
+ */
+struct SPFDestination
+{
+  Ipv4Address dest;   //!< the destination host or network
+  Ipv4Mask mask;      //!< the destination network mask
+  bool host;          //!< true for a host route
+};
+
+/**
+ * \brief Get the destinations of the intra-area routes towards the vertex of
+ * an LSA, as added by SPFIntraAddRouter (), SPFIntraAddTransit () and
+ * SPFIntraAddStub ().
+ * \param lsa the LSA, or 0
+ * \param dests [out] the destinations
+ */
+static void
+GetSPFDestinations (GlobalRoutingLSA* lsa, std::vector<SPFDestination>& dests)
+{
+  if (lsa == 0)
+    {
+      return;
+    }
+  SPFDestination d;
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              d.dest = l->GetLinkData ();
+              d.mask = Ipv4Mask::GetOnes ();
+              d.host = true;
+              dests.push_back (d);
+            }
+          else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              d.mask = Ipv4Mask (l->GetLinkData ().Get ());
+              d.dest = l->GetLinkId ().CombineMask (d.mask);
+              d.host = false;
+              dests.push_back (d);
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      d.mask = lsa->GetNetworkLSANetworkMask ();
+      d.dest = lsa->GetLinkStateId ().CombineMask (d.mask);
+      d.host = false;
+      dests.push_back (d);
+    }
+}
+
+void
+GlobalRouteManagerImpl::PatchRoutes (Ptr<Node> node, SPFTree const& tree,
+                                     std::vector<GlobalRouteManagerLSDB::LSAChange_t> const& changes)
 {
-  NS_LOG_FUNCTION (this);
-//
-// Walk the list of nodes in the system.
-//
-  NS_LOG_INFO ("About to start SPF calculation");
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+  NS_LOG_FUNCTION (this << node << changes.size ());
+  if (tree.stub)
     {
-      Ptr<Node> node = *i;
-//
-// Look for the GlobalRouter interface that indicates that the node is
-// participating in routing.
-//
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      uint32_t systemId = MpiInterface::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+      return;
+    }
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  for (std::vector<GlobalRouteManagerLSDB::LSAChange_t>::const_iterator i = changes.begin ();
+       i != changes.end (); i++)
+    {
+      if (i->first == 0 || i->second == 0)
+        {
+          continue;
+        }
+      std::map<Ipv4Address, SPFTreeVertex>::const_iterator v = tree.vertices.find (i->first->GetLinkStateId ());
+      if (v == tree.vertices.end () || v->second.distance == 0)
         {
           continue;
         }
-
 //
-// if the node has a global router interface, then run the global routing
-// algorithms.
+// The vertex is still reached through the same exits, only its destinations
+// changed.
 //
-      if (rtr && rtr->GetNumLSAs () )
+      std::vector<SPFRoute> routes[2];
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          std::vector<SPFDestination> dests;
+          GetSPFDestinations (k ? i->second : i->first, dests);
+          for (std::vector<SPFDestination>::const_iterator d = dests.begin (); d != dests.end (); d++)
+            {
+              for (std::vector<SPFVertex::NodeExit_t>::const_iterator e = v->second.exits.begin ();
+                   e != v->second.exits.end (); e++)
+                {
+                  if (e->second < 0)
+                    {
+                      continue;
+                    }
+                  SPFRoute route;
+                  route.type = d->host ? SPFRoute::HOST : SPFRoute::NETWORK;
+                  route.dest = d->dest;
+                  route.mask = d->mask;
+                  route.nextHop = e->first;
+                  route.outIf = e->second;
+                  routes[k].push_back (route);
+                }
+            }
+          std::sort (routes[k].begin (), routes[k].end ());
+        }
+      std::vector<SPFRoute> removed, added;
+      std::set_difference (routes[0].begin (), routes[0].end (), routes[1].begin (), routes[1].end (),
+                           std::back_inserter (removed));
+      std::set_difference (routes[1].begin (), routes[1].end (), routes[0].begin (), routes[0].end (),
+                           std::back_inserter (added));
+      for (std::vector<SPFRoute>::const_iterator r = removed.begin (); r != removed.end (); r++)
+        {
+          NS_LOG_LOGIC ("Node " << node->GetId () << " removes route to " << r->dest << "/" << r->mask);
+          bool found;
+          if (r->type == SPFRoute::HOST)
+            {
+              found = gr->RemoveHostRouteTo (r->dest, r->nextHop, r->outIf);
+            }
+          else
+            {
+              found = gr->RemoveNetworkRouteTo (r->dest, r->mask, r->nextHop, r->outIf);
+            }
+          NS_ASSERT_MSG (found, "Route to " << r->dest << " not found on node " << node->GetId ());
+          NS_UNUSED (found);
+        }
+      for (std::vector<SPFRoute>::const_iterator r = added.begin (); r != added.end (); r++)
         {
-          SPFCalculate (rtr->GetRouterId ());
+          NS_LOG_LOGIC ("Node " << node->GetId () << " adds route to " << r->dest << "/" << r->mask);
+          if (r->type == SPFRoute::HOST)
+            {
+              gr->AddHostRouteTo (r->dest, r->nextHop, r->outIf);
+            }
+          else
+            {
+              gr->AddNetworkRouteTo (r->dest, r->mask, r->nextHop, r->outIf);
+            }
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
 }
 
 //
@@ -836,7 +1578,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE)
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1603,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -873,7 +1615,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
           w = new SPFVertex (w_lsa);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              SetLSAStatus (w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1630,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -1247,7 +1989,27 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+//
+// The LSDB may have been built by hand, without any node behind the root.
+//
+  Ptr<Node> node;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          node = *i;
+          break;
+        }
+    }
+  m_checkStubs = NodeList::GetNNodes () > 0;
+  SPFJob job;
+  PrepareJob (job, node, root);
+  m_job = &job;
   SPFCalculate (root);
+  m_job = 0;
+  InstallRoutes (job);
 }
 
 //
@@ -1320,12 +2082,13 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  SPFRoute route;
+                  route.type = SPFRoute::NETWORK;
+                  route.dest = Ipv4Address ("0.0.0.0");
+                  route.mask = Ipv4Mask ("0.0.0.0");
+                  route.nextHop = lr->GetLinkData ();
+                  route.outIf = FindOutgoingInterfaceId (transitLink->GetLinkData ());
+                  m_job->routes.push_back (route);
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
                                 FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1345,9 +2108,11 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the status of the LSAs.  The status is kept by the calculation
+// rather than in the Link State Database, which may be shared by several
+// calculations running at the same time.
 //
-  m_lsdb->Initialize ();
+  m_lsaStatus.clear ();
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1367,7 +2132,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  KeepTreeVertex (v);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +2143,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_checkStubs && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      m_job->tree.stub = true;
       delete m_spfroot;
+      m_spfroot = 0;
+      m_lsaStatus.clear ();
       return;
     }
 
@@ -1428,7 +2197,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      KeepTreeVertex (v);
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1502,6 +2272,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_lsaStatus.clear ();
 }
 
 void
@@ -1555,110 +2326,17 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
     }
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
-
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 //
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
+// The root node reaches the external network through the same next hops and
+// outgoing interfaces as the advertising router <v>.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  AddRoutes (SPFRoute::EXTERNAL, tempip, tempmask, v);
 }
 
 
@@ -1718,118 +2396,17 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
       return;
     }
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+// The stub network is reached through the same next hops and outgoing
+// interfaces as the vertex <v> it hangs off.
 //
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  AddRoutes (SPFRoute::NETWORK, tempip, tempmask, v);
 }
 
 //
@@ -1844,69 +2421,24 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// We have an IP address <a> and the addresses of the root of the SPF tree,
+// recorded in the order of its interfaces when the calculation was prepared.
+// The first address in the same prefix gives the interface index, as
+// Ipv4::GetInterfaceForPrefix () would.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_ASSERT_MSG (m_job, "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): No SPF calculation in progress");
+  for (std::vector<std::pair<Ipv4Address, int32_t> >::const_iterator i = m_job->addresses.begin ();
+       i != m_job->addresses.end (); i++)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
+      if (i->first.CombineMask (amask) == a.CombineMask (amask))
         {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+          return i->second;
         }
     }
 //
 // Couldn't find it.
 //
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find an interface for " << a << " on root node " << m_job->routerId);
   return -1;
 }
 
@@ -1934,70 +2466,17 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
   NS_ASSERT_MSG (m_spfroot, 
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
-//
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,69 +2485,26 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Root " << m_spfroot->GetVertexId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
-            }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
-// Done adding the routes for the selected node.
+// We're going to add a host route to the host address found in the
+// m_linkData field of the point-to-point link record.  In the case of a
+// point-to-point link, this is the local IP address of the node connected to
+// the link.  The vertex <v> has the next hops and outgoing interfaces of the
+// root node towards it, possibly several of them due to ECMP.
 //
-          return;
-        }
+      AddRoutes (SPFRoute::HOST, lr->GetLinkData (), Ipv4Mask::GetOnes (), v);
     }
 }
 void
@@ -2079,105 +2515,91 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
   NS_ASSERT_MSG (m_spfroot, 
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
-// The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to.  This is the network LSA of the transit network,
+// which carries the network mask.
+//
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  AddRoutes (SPFRoute::NETWORK, tempip, tempmask, v);
+}
 
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// Record the routes of the root node to <dest>, one per exit direction of
+// the root towards the vertex <v>.  The routes are installed once the SPF
+// calculation is over.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+void
+GlobalRouteManagerImpl::AddRoutes (SPFRoute::Type type, Ipv4Address dest, Ipv4Mask mask, SPFVertex* v)
+{
+  NS_LOG_FUNCTION (this << type << dest << mask << v);
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      if (exit.second >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          SPFRoute route;
+          route.type = type;
+          route.dest = dest;
+          route.mask = mask;
+          route.nextHop = exit.first;
+          route.outIf = exit.second;
+          m_job->routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " add route to " << dest << "/" << mask <<
+                        " using next hop " << exit.first <<
+                        " via interface " << exit.second);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+          NS_LOG_LOGIC ("(Route " << i << ") Root " << m_spfroot->GetVertexId () <<
+                        " NOT able to add route to " << dest << "/" << mask <<
+                        " using next hop " << exit.first <<
+                        " since outgoing interface id is negative " << exit.second);
         }
-    } 
+    }
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetLSAStatus (GlobalRoutingLSA* lsa) const
+{
+  std::map<GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus>::const_iterator i = m_lsaStatus.find (lsa);
+  if (i == m_lsaStatus.end ())
+    {
+      return GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED;
+    }
+  return i->second;
+}
+
+void
+GlobalRouteManagerImpl::SetLSAStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+  m_lsaStatus[lsa] = status;
+}
+
+void
+GlobalRouteManagerImpl::KeepTreeVertex (SPFVertex* v)
+{
+  if (!m_keepTrees)
+    {
+      return;
+    }
+  SPFTreeVertex& vertex = m_job->tree.vertices[v->GetVertexId ()];
+  vertex.distance = v->GetDistanceFromRoot ();
+  vertex.exits.clear ();
+  if (v->GetDistanceFromRoot () == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      vertex.exits.push_back (v->GetRootExitDirection (i));
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
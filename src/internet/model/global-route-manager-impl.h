@@ -38,6 +38,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -674,6 +675,22 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /// A Link State Advertisement which differs between two databases: the
+  /// old LSA and the new one, either of which is 0 if it does not exist
+  typedef std::pair<GlobalRoutingLSA*, GlobalRoutingLSA*> LSAChange_t;
+
+/**
+ * @brief Compare this database with an older one.
+ *
+ * The router and network Link State Advertisements are matched by link
+ * state ID, and compared field by field, regardless of their SPF status.
+ *
+ * @param old the older database
+ * @param changes [out] the LSAs which were added, removed or modified,
+ * ordered by link state ID
+ * @returns true if the External Link State Advertisements differ
+ */
+  bool GetChanges (const GlobalRouteManagerLSDB* old, std::vector<LSAChange_t>& changes) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -708,6 +725,16 @@ private:
  * and finally configure each of the node's forwarding tables.
  *
  * The design is guided by OSPFv2 \RFC{2328} section 16.1.1 and quagga ospfd.
+ *
+ * The SPF calculation of each router only reads the LSDB, and returns the
+ * routes of the router, which are then installed in its forwarding table.
+ * The "GlobalRoutingSpfThreads" global value sets the number of threads
+ * which run these calculations; the routes are always installed in node
+ * order, so that the forwarding tables do not depend on the number of
+ * threads.  When the "GlobalRoutingIncrementalSpf" global value is true,
+ * a summary of the SPF tree of each router is kept, and RecomputeRoutes ()
+ * only runs the SPF calculation of the routers whose tree may have been
+ * changed by the new LSAs.
  */
 class GlobalRouteManagerImpl
 {
@@ -735,6 +762,21 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after a change of the topology
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes (), unless the "GlobalRoutingIncrementalSpf" global
+ * value is true and the routes were computed with it.  Then the new LSDB is
+ * compared with the previous one, the SPF calculation is run again only for
+ * the routers whose SPF tree may have changed, that is when a changed link
+ * was on a shortest path or gives a path as short as the current ones; the
+ * routes towards the changed LSAs are updated in place for the other
+ * routers.  The forwarding tables then hold the same routes as after a full
+ * recomputation, although not necessarily in the same order.
+ */
+  virtual void RecomputeRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +808,161 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+/**
+ * @brief Create a worker, which runs SPF calculations in a thread.
+ *
+ * The worker shares the LSDB of the manager, and only reads it; the
+ * manager detaches the LSDB from the worker before deleting it.
+ *
+ * @param manager the manager which owns the LSDB
+ */
+  GlobalRouteManagerImpl (GlobalRouteManagerImpl const *manager);
+
+  /// A route computed by the SPF calculation of a router
+  struct SPFRoute
+  {
+    /// The route types, one for each Ipv4GlobalRouting::Add*RouteTo method
+    enum Type
+    {
+      HOST,
+      NETWORK,
+      EXTERNAL
+    };
+    Type type;            //!< the route type
+    Ipv4Address dest;     //!< the destination host or network
+    Ipv4Mask mask;        //!< the destination network mask
+    Ipv4Address nextHop;  //!< the next hop
+    uint32_t outIf;       //!< the outgoing interface
+
+    /**
+     * \param other another route
+     * \returns true if this route is ordered before the other one
+     */
+    bool operator< (SPFRoute const &other) const;
+  };
+
+  /// A vertex of the SPF tree of a router, as kept for incremental updates
+  struct SPFTreeVertex
+  {
+    uint32_t distance;                          //!< the distance from the root
+    std::vector<SPFVertex::NodeExit_t> exits;   //!< the root exit directions
+  };
+
+  /// The SPF tree of a router, as kept for incremental updates
+  struct SPFTree
+  {
+    SPFTree () : stub (false) {}
+    bool stub;   //!< the tree was not computed, see CheckForStubNode ()
+    std::map<Ipv4Address, SPFTreeVertex> vertices; //!< the vertices, by vertex ID
+  };
+
+  /// The SPF calculation of a router
+  struct SPFJob
+  {
+    SPFJob () : replace (false) {}
+    Ptr<Node> node;          //!< the router node, only used by the main thread
+    Ipv4Address routerId;    //!< the router ID
+    /// the local addresses of the router, with their interfaces
+    std::vector<std::pair<Ipv4Address, int32_t> > addresses;
+    bool replace;            //!< remove the routes of the router before installing the new ones
+    std::vector<SPFRoute> routes;  //!< the routes computed
+    SPFTree tree;            //!< the SPF tree, if it is kept
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  /// the SPF status of the LSAs during the current SPF calculation
+  std::map<GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_lsaStatus;
+  SPFJob* m_job; //!< the current SPF calculation
+  bool m_checkStubs; //!< whether CheckForStubNode () may be used
+  bool m_keepTrees; //!< whether the SPF trees are kept for incremental updates
+  std::map<Ipv4Address, SPFTree> m_trees; //!< the SPF trees, by router ID
+  std::vector<SPFJob>* m_jobs; //!< the SPF calculations of a worker thread
+  uint32_t m_firstJob; //!< the first job of a worker thread
+  uint32_t m_jobStride; //!< the distance between the jobs of a worker thread
+
+  /**
+   * \brief Set up the SPF calculation of a router.
+   * \param job the job to set up
+   * \param node the router node
+   * \param routerId the router ID
+   */
+  void PrepareJob (SPFJob& job, Ptr<Node> node, Ipv4Address routerId) const;
+
+  /**
+   * \brief Run SPF calculations, possibly in several threads, and install the
+   * routes in the forwarding tables, in the order of the jobs.
+   * \param jobs the SPF calculations
+   */
+  void RunJobs (std::vector<SPFJob>& jobs);
+
+  /**
+   * \brief Run the SPF calculations of a worker thread.
+   */
+  void RunWorkerJobs (void);
+
+  /**
+   * \brief Install the routes computed by an SPF calculation, and keep its tree.
+   * \param job the SPF calculation
+   */
+  void InstallRoutes (SPFJob& job);
+
+  /**
+   * \returns the number of threads to use for a number of SPF calculations
+   * \param nJobs the number of SPF calculations
+   */
+  uint32_t GetNThreads (uint32_t nJobs) const;
+
+  /**
+   * \brief Test if changes of the LSDB may change the SPF tree of a router.
+   * \param root the router ID
+   * \param tree the SPF tree of the router
+   * \param changes the changed LSAs
+   * \param old the previous LSDB
+   * \returns true if the tree may have changed
+   */
+  bool IsTreeAffected (Ipv4Address root, SPFTree const& tree,
+                       std::vector<GlobalRouteManagerLSDB::LSAChange_t> const& changes,
+                       GlobalRouteManagerLSDB const* old) const;
+
+  /**
+   * \brief Update the routes of a router towards changed LSAs, when its SPF
+   * tree did not change.
+   * \param node the router node
+   * \param tree the SPF tree of the router
+   * \param changes the changed LSAs
+   */
+  void PatchRoutes (Ptr<Node> node, SPFTree const& tree,
+                    std::vector<GlobalRouteManagerLSDB::LSAChange_t> const& changes);
+
+  /**
+   * \brief Add the routes towards a vertex, one for each of its root exits,
+   * to the current SPF calculation.
+   * \param type the route type
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param v the vertex
+   */
+  void AddRoutes (SPFRoute::Type type, Ipv4Address dest, Ipv4Mask mask, SPFVertex* v);
+
+  /**
+   * \param lsa an LSA
+   * \returns the SPF status of the LSA in the current SPF calculation
+   */
+  GlobalRoutingLSA::SPFStatus GetLSAStatus (GlobalRoutingLSA* lsa) const;
+
+  /**
+   * \brief Set the SPF status of an LSA in the current SPF calculation
+   * \param lsa the LSA
+   * \param status the status
+   */
+  void SetLSAStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
+
+  /**
+   * \brief Keep a vertex which was added to the SPF tree, if the tree is kept.
+   * \param v the vertex
+   */
+  void KeepTreeVertex (SPFVertex* v);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -935,8 +1130,9 @@ private:
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
+   * This is equivalent to Ipv4::GetInterfaceForPrefix() on the root node,
+   * using the addresses of the root node recorded in the current SPF
+   * calculation, so that it does not access the node.
    * If no such interface is found, return -1 (note:  unit test framework
    * for routing assumes -1 to be a legal return value)
    *
@@ -65,6 +65,16 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes of all nodes after a topology change.
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes ().  If the global value
+ * GlobalRoutingIncrementalSpf is set, only the nodes whose shortest path
+ * tree may have changed run a new SPF calculation.
+ */
+  static void RecomputeRoutingTables ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -16,7 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <list>
+#include <map>
 #include "ns3/abort.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
@@ -126,6 +126,15 @@ public:
    */
   bool AddAllocated (const Ipv4Address addr);
 
+  /**
+   * \brief Add a range of Ipv4Address to the list of IPv4 entries
+   *
+   * \param low The lowest Ipv4Address of the range
+   * \param high The highest Ipv4Address of the range
+   * \returns true on success
+   */
+  bool AddAllocated (const Ipv4Address low, const Ipv4Address high);
+
   /**
    * \brief Used to turn off fatal errors and assertions, for testing
    */
@@ -157,16 +166,14 @@ public:
   NetworkState m_netTable[N_BITS]; //!< the available networks
 
   /**
-   * \brief This class holds the allocated addresses
+   * \brief Container of the allocated addresses
+   *
+   * Each entry is a block of consecutive addresses, indexed by its lowest
+   * address and holding its highest address.  Adjacent blocks are merged.
    */
-  class Entry
-  {
-public:
-    uint32_t addrLow;  //!< the lowest allocated address
-    uint32_t addrHigh; //!< the highest allocated address
-  };
+  typedef std::map<uint32_t, uint32_t> Entries;
 
-  std::list<Entry> m_entries; //!< contained of allocated addresses
+  Entries m_entries; //!< the allocated address blocks
   bool m_test; //!< test mode (if true)
 };
 
@@ -345,87 +352,74 @@ bool
 Ipv4AddressGeneratorImpl::AddAllocated (const Ipv4Address address)
 {
   NS_LOG_FUNCTION (this << address);
+  return AddAllocated (address, address);
+}
 
-  uint32_t addr = address.Get ();
+bool
+Ipv4AddressGeneratorImpl::AddAllocated (const Ipv4Address low, const Ipv4Address high)
+{
+  NS_LOG_FUNCTION (this << low << high);
 
-  NS_ABORT_MSG_UNLESS (addr, "Ipv4AddressGeneratorImpl::Add(): Allocating the broadcast address is not a good idea"); 
- 
-  std::list<Entry>::iterator i;
+  uint32_t addrLow = low.Get ();
+  uint32_t addrHigh = high.Get ();
 
-  for (i = m_entries.begin (); i != m_entries.end (); ++i)
-    {
-      NS_LOG_LOGIC ("examine entry: " << Ipv4Address ((*i).addrLow) << 
-                    " to " << Ipv4Address ((*i).addrHigh));
-//
-// First things first.  Is there an address collision -- that is, does the
-// new address fall in a previously allocated block of addresses.
-//
-      if (addr >= (*i).addrLow && addr <= (*i).addrHigh)
-        {
-          NS_LOG_LOGIC ("Ipv4AddressGeneratorImpl::Add(): Address Collision: " << Ipv4Address (addr)); 
-          if (!m_test) 
-            {
-              NS_FATAL_ERROR ("Ipv4AddressGeneratorImpl::Add(): Address Collision: " << Ipv4Address (addr));
-            }
-          return false;
-        }
+  NS_ABORT_MSG_UNLESS (addrLow, "Ipv4AddressGeneratorImpl::Add(): Allocating the broadcast address is not a good idea"); 
+  NS_ABORT_MSG_UNLESS (addrLow <= addrHigh, "Ipv4AddressGeneratorImpl::Add(): Inverted address range");
 //
-// If the new address is less than the lowest address in the current block,
-// and can't be merged into to the current block, then insert it as a new
-// block before the current block.
+// The blocks are sorted and never overlap, so the new addresses can only
+// collide with the last block starting at or before addrLow, or with the
+// blocks starting after it, of which the first one is enough to check.
 //
-      if (addr < (*i).addrLow - 1)
-        {
-          break;
-        }
-//
-// If the new address fits at the end of the block, look ahead to the next 
-// block and make sure it's not a collision there.  If we won't overlap, then
-// just extend the current block by one address.  We expect that completely
-// filled network ranges will be a fairly rare occurrence, so we don't worry
-// about collapsing address range blocks.
-// 
-      if (addr == (*i).addrHigh + 1)
+  Entries::iterator next = m_entries.upper_bound (addrLow);
+  Entries::iterator prev = m_entries.end ();
+  if (next != m_entries.begin ())
+    {
+      prev = next;
+      --prev;
+      NS_LOG_LOGIC ("examine entry: " << Ipv4Address (prev->first) <<
+                    " to " << Ipv4Address (prev->second));
+    }
+
+  uint32_t collision = 0;
+  if (prev != m_entries.end () && addrLow <= prev->second)
+    {
+      collision = addrLow;
+    }
+  else if (next != m_entries.end () && next->first <= addrHigh)
+    {
+      collision = next->first;
+    }
+  if (collision)
+    {
+      NS_LOG_LOGIC ("Ipv4AddressGeneratorImpl::Add(): Address Collision: " << Ipv4Address (collision));
+      if (!m_test)
         {
-          std::list<Entry>::iterator j = i;
-          ++j;
-
-          if (j != m_entries.end ())
-            {
-              if (addr == (*j).addrLow)
-                {
-                  NS_LOG_LOGIC ("Ipv4AddressGeneratorImpl::Add(): "
-                                "Address Collision: " << Ipv4Address (addr));
-                  if (!m_test)
-                    {
-                      NS_FATAL_ERROR ("Ipv4AddressGeneratorImpl::Add(): Address Collision: " << Ipv4Address (addr));
-                    }
-                  return false;
-                }
-            }
-
-          NS_LOG_LOGIC ("New addrHigh = " << Ipv4Address (addr));
-          (*i).addrHigh = addr;
-          return true;
+          NS_FATAL_ERROR ("Ipv4AddressGeneratorImpl::Add(): Address Collision: " << Ipv4Address (collision));
         }
+      return false;
+    }
 //
-// If we get here, we know that the next lower block of addresses couldn't 
-// have been extended to include this new address since the code immediately 
-// above would have been executed and that next lower block extended upward.
-// So we know it's safe to extend the current block down to includ the new
-// address.
+// Extend the previous block up to the new addresses if they follow it, or
+// insert a new block, and then merge the next block if the new addresses
+// precede it.
 //
-      if (addr == (*i).addrLow - 1)
-        {
-          NS_LOG_LOGIC ("New addrLow = " << Ipv4Address (addr));
-          (*i).addrLow = addr;
-          return true;
-        }
+  Entries::iterator block;
+  if (prev != m_entries.end () && prev->second + 1 == addrLow)
+    {
+      NS_LOG_LOGIC ("New addrHigh = " << Ipv4Address (addrHigh));
+      block = prev;
+      block->second = addrHigh;
+    }
+  else
+    {
+      block = m_entries.insert (next, std::make_pair (addrLow, addrHigh));
+    }
+  if (next != m_entries.end () && next->first - 1 == addrHigh)
+    {
+      NS_LOG_LOGIC ("Merge with the block starting at " << Ipv4Address (next->first));
+      block->second = next->second;
+      m_entries.erase (next);
     }
-
-  Entry entry;
-  entry.addrLow = entry.addrHigh = addr;
-  m_entries.insert (i, entry);
   return true;
 }
 
@@ -546,6 +540,15 @@ Ipv4AddressGenerator::AddAllocated (const Ipv4Address addr)
          ->AddAllocated (addr);
 }
 
+bool
+Ipv4AddressGenerator::AddAllocated (const Ipv4Address low, const Ipv4Address high)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  return SimulationSingleton<Ipv4AddressGeneratorImpl>::Get ()
+         ->AddAllocated (low, high);
+}
+
 void
 Ipv4AddressGenerator::TestMode (void)
 {
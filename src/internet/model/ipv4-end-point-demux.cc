@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
@@ -29,7 +30,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152),
+    m_nextOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -40,38 +42,136 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_index.clear ();
+  m_locals.clear ();
+  m_ports.clear ();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::Key::operator== (Key const &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return localAddress == other.localAddress && peerAddress == other.peerAddress
+         && localPort == other.localPort && peerPort == other.peerPort;
+}
+
+size_t
+Ipv4EndPointDemux::KeyHash::operator() (Key const &key) const
+{
+  size_t hash = key.localAddress.Get ();
+  hash = hash * 1000003 ^ key.peerAddress.Get ();
+  hash = hash * 1000003 ^ ((uint32_t (key.localPort) << 16) | key.peerPort);
+  return hash;
+}
+
+Ipv4EndPointDemux::Key
+Ipv4EndPointDemux::MakeKey (Ipv4Address localAddress, uint16_t localPort,
+                            Ipv4Address peerAddress, uint16_t peerPort)
+{
+  Key key;
+  key.localAddress = localAddress;
+  key.peerAddress = peerAddress;
+  key.localPort = localPort;
+  key.peerPort = peerPort;
+  return key;
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Entry entry;
+  entry.order = m_nextOrder++;
+  entry.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  AddEntry (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                     endPoint->GetPeerAddress (), endPoint->GetPeerPort ()), entry);
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+/**
+ * \param a an entry
+ * \param b another entry
+ * \returns true if a was added before b
+ */
+template <typename T>
+static bool
+CompareOrder (T const &a, T const &b)
+{
+  return a.order < b.order;
+}
+
+void
+Ipv4EndPointDemux::AddEntry (Key const &key, Entry const &entry)
+{
+  Bucket &bucket = m_index[key];
+  bucket.insert (std::upper_bound (bucket.begin (), bucket.end (), entry, CompareOrder<Entry>), entry);
+  m_locals[MakeKey (key.localAddress, key.localPort, Ipv4Address::GetAny (), 0)]++;
+  m_ports[key.localPort]++;
+}
+
+bool
+Ipv4EndPointDemux::RemoveEntry (Key const &key, Ipv4EndPoint *endPoint, Entry &entry)
+{
+  std::unordered_map<Key, Bucket, KeyHash>::iterator i = m_index.find (key);
+  if (i == m_index.end ())
     {
-      if ((*i)->GetLocalPort  () == port) 
+      return false;
+    }
+  for (Bucket::iterator j = i->second.begin (); j != i->second.end (); j++)
+    {
+      if (*j->position == endPoint)
         {
+          entry = *j;
+          i->second.erase (j);
+          if (i->second.empty ())
+            {
+              m_index.erase (i);
+            }
+          Key local = MakeKey (key.localAddress, key.localPort, Ipv4Address::GetAny (), 0);
+          if (--m_locals[local] == 0)
+            {
+              m_locals.erase (local);
+            }
+          if (--m_ports[key.localPort] == 0)
+            {
+              m_ports.erase (key.localPort);
+            }
           return true;
         }
     }
   return false;
 }
 
+void
+Ipv4EndPointDemux::Reindex (Ipv4EndPoint *endPoint, Ipv4Address localAddress,
+                            Ipv4Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << endPoint << localAddress << peerAddress << peerPort);
+  Entry entry;
+  bool found = RemoveEntry (MakeKey (localAddress, endPoint->GetLocalPort (), peerAddress, peerPort),
+                            endPoint, entry);
+  NS_ASSERT (found);
+  AddEntry (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                     endPoint->GetPeerAddress (), endPoint->GetPeerPort ()), entry);
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
+}
+
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_locals.find (MakeKey (addr, port, Ipv4Address::GetAny (), 0)) != m_locals.end ();
 }
 
 Ipv4EndPoint *
@@ -84,10 +184,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -100,10 +197,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -123,10 +217,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -134,39 +225,30 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (m_index.find (MakeKey (localAddress, localPort, peerAddress, peerPort)) != m_index.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Entry entry;
+  if (endPoint->m_demux == this
+      && RemoveEntry (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                               endPoint->GetPeerAddress (), endPoint->GetPeerPort ()),
+                      endPoint, entry))
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      m_endPoints.erase (entry.position);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -206,9 +288,52 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+
+  //
+  // Only the endpoints indexed under the four-tuples which may match are
+  // visited, in the order in which they were added: the local address is
+  // the destination, any, or the network part of one of the addresses of the
+  // incoming interface, and the peer is the source or any.
+  //
+  std::vector<Ipv4Address> localAddresses;
+  localAddresses.push_back (daddr);
+  localAddresses.push_back (Ipv4Address::GetAny ());
+  if (incomingInterface)
     {
-      Ipv4EndPoint* endP = *i;
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (addrNetpart == daddr.CombineMask (addr.GetMask ()))
+            {
+              localAddresses.push_back (addrNetpart);
+            }
+        }
+    }
+  std::vector<Key> keys;
+  for (std::vector<Ipv4Address>::const_iterator i = localAddresses.begin (); i != localAddresses.end (); i++)
+    {
+      keys.push_back (MakeKey (*i, dport, saddr, sport));
+      keys.push_back (MakeKey (*i, dport, Ipv4Address::GetAny (), 0));
+    }
+  Bucket candidates;
+  for (uint32_t i = 0; i < keys.size (); i++)
+    {
+      if (std::find (keys.begin (), keys.begin () + i, keys[i]) != keys.begin () + i)
+        {
+          continue;
+        }
+      std::unordered_map<Key, Bucket, KeyHash>::const_iterator bucket = m_index.find (keys[i]);
+      if (bucket != m_index.end ())
+        {
+          candidates.insert (candidates.end (), bucket->second.begin (), bucket->second.end ());
+        }
+    }
+  std::sort (candidates.begin (), candidates.end (), CompareOrder<Entry>);
+
+  for (Bucket::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      Ipv4EndPoint* endP = *i->position;
 
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
@@ -339,6 +464,16 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
+  std::unordered_map<Key, Bucket, KeyHash>::const_iterator exact = m_index.find (MakeKey (daddr, dport, saddr, sport));
+  if (exact != m_index.end ())
+    {
+      /* this is an exact match. */
+      return *exact->second.front ().position;
+    }
+  if (!LookupPortLocal (dport))
+    {
+      return 0;
+    }
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
@@ -17,6 +17,7 @@
 //
 
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -27,6 +28,7 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/abort.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
@@ -53,13 +55,22 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("CompactRoutes",
+                   "Set to true to store the routes in sorted arrays which share their next hops with the other nodes, and aggregate the host routes; must be set before the routes are added",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_compact),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_indicesValid (false),
+    m_compact (false),
+    m_compactSorted (true),
+    m_compactEntry (new Ipv4RoutingTableEntry ())
 {
   NS_LOG_FUNCTION (this);
 
@@ -69,6 +80,7 @@ Ipv4GlobalRouting::Ipv4GlobalRouting ()
 Ipv4GlobalRouting::~Ipv4GlobalRouting ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_compactEntry;
 }
 
 void 
@@ -77,9 +89,15 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
                                    uint32_t interface)
 {
   NS_LOG_FUNCTION (this << dest << nextHop << interface);
+  if (m_compact)
+    {
+      AddCompactRoute (m_compactHost, dest, Ipv4Mask::GetOnes (), nextHop, interface);
+      return;
+    }
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_indicesValid = false;
 }
 
 void 
@@ -87,9 +105,15 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
                                    uint32_t interface)
 {
   NS_LOG_FUNCTION (this << dest << interface);
+  if (m_compact)
+    {
+      AddCompactRoute (m_compactHost, dest, Ipv4Mask::GetOnes (), Ipv4Address::GetZero (), interface);
+      return;
+    }
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_indicesValid = false;
 }
 
 void 
@@ -99,12 +123,18 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
+  if (m_compact)
+    {
+      AddCompactRoute (m_compactNetwork, network, networkMask, nextHop, interface);
+      return;
+    }
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_indicesValid = false;
 }
 
 void 
@@ -113,11 +143,17 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                       uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << interface);
+  if (m_compact)
+    {
+      AddCompactRoute (m_compactNetwork, network, networkMask, Ipv4Address::GetZero (), interface);
+      return;
+    }
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_indicesValid = false;
 }
 
 void 
@@ -127,91 +163,172 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                          uint32_t interface)
 {
   NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
+  if (m_compact)
+    {
+      AddCompactRoute (m_compactExternal, network, networkMask, nextHop, interface);
+      return;
+    }
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_indicesValid = false;
+}
+
+
+/**
+ * \param mask a network mask
+ * \returns true if the bits of the mask are all leading ones
+ */
+static bool
+IsContiguous (Ipv4Mask mask)
+{
+  uint16_t length = mask.GetPrefixLength ();
+  return mask.Get () == (length == 0 ? 0 : 0xffffffff << (32 - length));
+}
+
+void
+Ipv4GlobalRouting::BuildIndex (std::list<Ipv4RoutingTableEntry *> const &routes, RouteIndex &index)
+{
+  index.routes.assign (routes.begin (), routes.end ());
+  index.trie.Clear ();
+  index.others.clear ();
+  for (uint32_t i = 0; i < index.routes.size (); i++)
+    {
+      Ipv4Mask mask = index.routes[i]->GetDestNetworkMask ();
+      if (!IsContiguous (mask))
+        {
+          index.others.push_back (i);
+          continue;
+        }
+      uint8_t prefix[4];
+      index.routes[i]->GetDestNetwork ().Serialize (prefix);
+      index.trie.Insert (prefix, mask.GetPrefixLength (), i);
+    }
+}
+
+void
+Ipv4GlobalRouting::FindRoutes (RouteIndex const &index, Ipv4Address dest, std::vector<uint32_t> &found)
+{
+  uint8_t address[4];
+  dest.Serialize (address);
+  PrefixTrie<uint32_t>::Match matches[33];
+  uint32_t n = index.trie.Lookup (address, 32, matches);
+  found.clear ();
+  for (uint32_t k = 0; k < n; k++)
+    {
+      found.insert (found.end (), matches[k].values->begin (), matches[k].values->end ());
+    }
+  for (std::vector<uint32_t>::const_iterator i = index.others.begin (); i != index.others.end (); i++)
+    {
+      Ipv4RoutingTableEntry *route = index.routes[*i];
+      if (route->GetDestNetworkMask ().IsMatch (dest, route->GetDestNetwork ()))
+        {
+          found.push_back (*i);
+        }
+    }
+  std::sort (found.begin (), found.end ());
 }
 
+void
+Ipv4GlobalRouting::UpdateIndices (void)
+{
+  if (m_indicesValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  BuildIndex (m_hostRoutes, m_hostIndex);
+  BuildIndex (m_networkRoutes, m_networkIndex);
+  BuildIndex (m_ASexternalRoutes, m_ASexternalIndex);
+  m_indicesValid = true;
+}
 
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
+  if (m_compact)
+    {
+      return LookupCompact (dest, oif);
+    }
   Ptr<Ipv4Route> rtentry = 0;
   // store all available routes that bring packets to their destination
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  //
+  // The route lists are indexed by prefix, so that only the routes which
+  // match the destination are visited.  The routes are considered in the
+  // order of the lists, as if the lists were scanned.  Host routes always
+  // have a contiguous mask.
+  //
+  UpdateIndices ();
+  uint8_t address[4];
+  dest.Serialize (address);
+  PrefixTrie<uint32_t>::Match matches[33];
+  std::vector<uint32_t> found;
+
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  uint32_t n = m_hostIndex.trie.Lookup (address, 32, matches);
+  if (n > 0 && matches[n - 1].length == 32)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      std::vector<uint32_t> const &hosts = *matches[n - 1].values;
+      for (std::vector<uint32_t>::const_iterator i = hosts.begin (); i != hosts.end (); i++)
         {
+          Ipv4RoutingTableEntry *route = m_hostIndex.routes[*i];
+          NS_ASSERT (route->IsHost ());
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << route);
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      FindRoutes (m_networkIndex, dest, found);
+      for (std::vector<uint32_t>::const_iterator j = found.begin (); j != found.end (); j++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          Ipv4RoutingTableEntry *route = m_networkIndex.routes[*j];
+          if (oif != 0)
             {
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
+          allRoutes.push_back (route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << route);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      FindRoutes (m_ASexternalIndex, dest, found);
+      for (std::vector<uint32_t>::const_iterator l = found.begin (); l != found.end (); l++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          Ipv4RoutingTableEntry *route = m_ASexternalIndex.routes[*l];
+          NS_LOG_LOGIC ("Found external route" << route);
+          if (oif != 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice (route->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
+          allRoutes.push_back (route);
+          break;
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
@@ -250,6 +367,14 @@ Ipv4GlobalRouting::GetNRoutes (void) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t n = 0;
+  if (m_compact)
+    {
+      SortCompactRoutes ();
+      n += m_compactHost.routes.size ();
+      n += m_compactNetwork.routes.size ();
+      n += m_compactExternal.routes.size ();
+      return n;
+    }
   n += m_hostRoutes.size ();
   n += m_networkRoutes.size ();
   n += m_ASexternalRoutes.size ();
@@ -260,6 +385,25 @@ Ipv4RoutingTableEntry *
 Ipv4GlobalRouting::GetRoute (uint32_t index) const
 {
   NS_LOG_FUNCTION (this << index);
+  if (m_compact)
+    {
+      SortCompactRoutes ();
+      if (index < m_compactHost.routes.size ())
+        {
+          *m_compactEntry = MakeEntry (m_compactHost.routes[index], true);
+          return m_compactEntry;
+        }
+      index -= m_compactHost.routes.size ();
+      if (index < m_compactNetwork.routes.size ())
+        {
+          *m_compactEntry = MakeEntry (m_compactNetwork.routes[index], false);
+          return m_compactEntry;
+        }
+      index -= m_compactNetwork.routes.size ();
+      NS_ASSERT (index < m_compactExternal.routes.size ());
+      *m_compactEntry = MakeEntry (m_compactExternal.routes[index], false);
+      return m_compactEntry;
+    }
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -309,6 +453,27 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  if (m_compact)
+    {
+      SortCompactRoutes ();
+      if (index < m_compactHost.routes.size ())
+        {
+          m_compactHost.routes.erase (m_compactHost.routes.begin () + index);
+          return;
+        }
+      index -= m_compactHost.routes.size ();
+      if (index < m_compactNetwork.routes.size ())
+        {
+          m_compactNetwork.routes.erase (m_compactNetwork.routes.begin () + index);
+          UpdateLengths (m_compactNetwork);
+          return;
+        }
+      index -= m_compactNetwork.routes.size ();
+      NS_ASSERT (index < m_compactExternal.routes.size ());
+      m_compactExternal.routes.erase (m_compactExternal.routes.begin () + index);
+      UpdateLengths (m_compactExternal);
+      return;
+    }
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -321,6 +486,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
               delete *i;
               m_hostRoutes.erase (i);
+              m_indicesValid = false;
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
               return;
             }
@@ -338,6 +504,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
           delete *j;
           m_networkRoutes.erase (j);
+          m_indicesValid = false;
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -354,6 +521,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
           delete *k;
           m_ASexternalRoutes.erase (k);
+          m_indicesValid = false;
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -362,16 +530,93 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
-int64_t
-Ipv4GlobalRouting::AssignStreams (int64_t stream)
+bool
+Ipv4GlobalRouting::RemoveHostRouteTo (Ipv4Address dest,
+                                      Ipv4Address nextHop,
+                                      uint32_t interface)
 {
-  NS_LOG_FUNCTION (this << stream);
-  m_rand->SetStream (stream);
-  return 1;
+  NS_LOG_FUNCTION (this << dest << nextHop << interface);
+  if (m_compact)
+    {
+      uint32_t index;
+      uint32_t first;
+      uint32_t last;
+      if (!FindNextHopIndex (nextHop, interface, index)
+          || !FindCompactHostRoutes (dest, first, last))
+        {
+          return false;
+        }
+      std::vector<CompactRoute> &routes = m_compactHost.routes;
+      bool found = false;
+      for (uint32_t k = first; k < last; k++)
+        {
+          found = found || routes[k].nextHop == index;
+        }
+      if (!found)
+        {
+          return false;
+        }
+      if (routes[first].length < 32)
+        {
+          // split the aggregated routes, they are aggregated again when next used
+          ExpandHostRoutes (routes, first);
+          FindCompactHostRoutes (dest, first, last);
+          m_compactSorted = false;
+        }
+      for (uint32_t k = first; k < last; k++)
+        {
+          if (routes[k].nextHop == index)
+            {
+              routes.erase (routes.begin () + k);
+              return true;
+            }
+        }
+      NS_ASSERT (false);
+      return false;
+    }
+  for (HostRoutesI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      if ((*i)->GetDest () == dest && (*i)->GetGateway () == nextHop
+          && (*i)->GetInterface () == interface)
+        {
+          delete *i;
+          m_hostRoutes.erase (i);
+          m_indicesValid = false;
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+Ipv4GlobalRouting::RemoveNetworkRouteTo (Ipv4Address network,
+                                         Ipv4Mask networkMask,
+                                         Ipv4Address nextHop,
+                                         uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
+  if (m_compact)
+    {
+      return RemoveCompactRoute (m_compactNetwork, network, networkMask, nextHop, interface);
+    }
+  for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      if ((*j)->GetDestNetwork () == network
+          && (*j)->GetDestNetworkMask ().IsEqual (networkMask)
+          && (*j)->GetGateway () == nextHop
+          && (*j)->GetInterface () == interface)
+        {
+          delete *j;
+          m_networkRoutes.erase (j);
+          m_indicesValid = false;
+          return true;
+        }
+    }
+  return false;
 }
 
 void
-Ipv4GlobalRouting::DoDispose (void)
+Ipv4GlobalRouting::RemoveAllRoutes (void)
 {
   NS_LOG_FUNCTION (this);
   for (HostRoutesI i = m_hostRoutes.begin (); 
@@ -392,6 +637,433 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_indicesValid = false;
+  m_compactHost.routes.clear ();
+  m_compactHost.lengths.clear ();
+  m_compactNetwork.routes.clear ();
+  m_compactNetwork.lengths.clear ();
+  m_compactExternal.routes.clear ();
+  m_compactExternal.lengths.clear ();
+  m_compactSorted = true;
+}
+
+uint64_t
+Ipv4GlobalRouting::GetMemoryUsage (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // each entry of a list is a node with two links and a pointer to the route
+  uint64_t n = m_hostRoutes.size () + m_networkRoutes.size () + m_ASexternalRoutes.size ();
+  uint64_t bytes = n * (sizeof (Ipv4RoutingTableEntry) + 3 * sizeof (void *));
+  if (m_indicesValid)
+    {
+      RouteIndex const *indices[] = { &m_hostIndex, &m_networkIndex, &m_ASexternalIndex };
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          bytes += indices[i]->routes.capacity () * sizeof (Ipv4RoutingTableEntry *);
+          bytes += indices[i]->trie.GetMemoryUsage ();
+        }
+    }
+  CompactRoutes const *compact[] = { &m_compactHost, &m_compactNetwork, &m_compactExternal };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      bytes += compact[i]->routes.capacity () * sizeof (CompactRoute);
+      bytes += compact[i]->lengths.capacity () * sizeof (std::pair<uint8_t, uint32_t>);
+    }
+  return bytes;
+}
+
+uint64_t
+Ipv4GlobalRouting::GetSharedMemoryUsage (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CompactNextHopTable const &table = GetNextHopTable ();
+  // each entry of the map is a tree node with three links and a color
+  return table.nextHops.capacity () * sizeof (CompactNextHop)
+         + table.indices.size () * (sizeof (std::pair<std::pair<uint32_t, uint32_t>, uint32_t>) + 4 * sizeof (void *));
+}
+
+Ipv4GlobalRouting::CompactNextHopTable &
+Ipv4GlobalRouting::GetNextHopTable (void)
+{
+  static CompactNextHopTable table;
+  return table;
+}
+
+uint32_t
+Ipv4GlobalRouting::GetNextHopIndex (Ipv4Address gateway, uint32_t interface)
+{
+  CompactNextHopTable &table = GetNextHopTable ();
+  std::pair<uint32_t, uint32_t> key (gateway.Get (), interface);
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator i = table.indices.find (key);
+  if (i != table.indices.end ())
+    {
+      return i->second;
+    }
+  uint32_t index = table.nextHops.size ();
+  NS_ABORT_MSG_IF (index >= (1 << 24), "Too many next hops for the compact route storage");
+  CompactNextHop nextHop;
+  nextHop.gateway = gateway;
+  nextHop.interface = interface;
+  table.nextHops.push_back (nextHop);
+  table.indices[key] = index;
+  return index;
+}
+
+bool
+Ipv4GlobalRouting::FindNextHopIndex (Ipv4Address gateway, uint32_t interface, uint32_t &index)
+{
+  CompactNextHopTable &table = GetNextHopTable ();
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator i =
+    table.indices.find (std::make_pair (gateway.Get (), interface));
+  if (i == table.indices.end ())
+    {
+      return false;
+    }
+  index = i->second;
+  return true;
+}
+
+/**
+ * \param length a prefix length
+ * \returns the mask of the prefix
+ */
+static uint32_t
+GetMaskBits (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+void
+Ipv4GlobalRouting::AddCompactRoute (CompactRoutes &routes, Ipv4Address dest, Ipv4Mask mask,
+                                    Ipv4Address gateway, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << dest << mask << gateway << interface);
+  CompactRoute route;
+  route.dest = dest.CombineMask (mask).Get ();
+  route.nextHop = GetNextHopIndex (gateway, interface);
+  route.length = mask.GetPrefixLength ();
+  routes.routes.push_back (route);
+  m_compactSorted = false;
+}
+
+/**
+ * \param a a route
+ * \param b another route
+ * \returns true if a has a lower prefix than b
+ */
+template <typename T>
+static bool
+CompareDest (T const &a, T const &b)
+{
+  return a.dest < b.dest;
+}
+
+/**
+ * \param a a route
+ * \param b another route
+ * \returns true if a has a longer prefix than b, or the same length and a
+ * lower prefix
+ */
+template <typename T>
+static bool
+CompareLengthDest (T const &a, T const &b)
+{
+  return a.length > b.length || (a.length == b.length && a.dest < b.dest);
+}
+
+void
+Ipv4GlobalRouting::SortCompactRoutes (void) const
+{
+  if (m_compactSorted)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  std::vector<CompactRoute> &hosts = m_compactHost.routes;
+  for (uint32_t i = 0; i < hosts.size (); )
+    {
+      i += hosts[i].length < 32 ? ExpandHostRoutes (hosts, i) : 1;
+    }
+  std::stable_sort (hosts.begin (), hosts.end (), CompareDest<CompactRoute>);
+  AggregateHostRoutes (hosts);
+  std::stable_sort (m_compactNetwork.routes.begin (), m_compactNetwork.routes.end (), CompareLengthDest<CompactRoute>);
+  UpdateLengths (m_compactNetwork);
+  std::stable_sort (m_compactExternal.routes.begin (), m_compactExternal.routes.end (), CompareLengthDest<CompactRoute>);
+  UpdateLengths (m_compactExternal);
+  m_compactSorted = true;
+}
+
+void
+Ipv4GlobalRouting::AggregateHostRoutes (std::vector<CompactRoute> &routes)
+{
+  //
+  // The routes to each host form a group.  The groups are pushed on a stack
+  // and, as long as the two groups on top of the stack are the two halves of
+  // a prefix with the same next hops in the same order, they are merged into
+  // a group for the prefix.
+  //
+  struct Group
+  {
+    uint32_t prefix;
+    uint32_t length;
+    uint32_t first;
+    uint32_t last;
+  };
+  std::vector<Group> stack;
+  uint32_t i = 0;
+  while (i < routes.size ())
+    {
+      Group group;
+      group.prefix = routes[i].dest;
+      group.length = 32;
+      group.first = i;
+      while (i < routes.size () && routes[i].dest == group.prefix)
+        {
+          i++;
+        }
+      group.last = i;
+      while (!stack.empty () && group.length > 1)
+        {
+          Group const &lower = stack.back ();
+          uint32_t size = 1u << (32 - group.length);
+          if (lower.length != group.length || (lower.prefix & size) != 0
+              || group.prefix != lower.prefix + size
+              || lower.last - lower.first != group.last - group.first)
+            {
+              break;
+            }
+          bool same = true;
+          for (uint32_t k = 0; k < group.last - group.first && same; k++)
+            {
+              same = routes[lower.first + k].nextHop == routes[group.first + k].nextHop;
+            }
+          if (!same)
+            {
+              break;
+            }
+          group.prefix = lower.prefix;
+          group.length--;
+          group.first = lower.first;
+          group.last = lower.last;
+          stack.pop_back ();
+        }
+      stack.push_back (group);
+    }
+  if (stack.size () == routes.size ())
+    {
+      return;
+    }
+  std::vector<CompactRoute> aggregated;
+  aggregated.reserve (stack.size ());
+  for (std::vector<Group>::const_iterator j = stack.begin (); j != stack.end (); j++)
+    {
+      for (uint32_t k = j->first; k < j->last; k++)
+        {
+          CompactRoute route;
+          route.dest = j->prefix;
+          route.nextHop = routes[k].nextHop;
+          route.length = j->length;
+          aggregated.push_back (route);
+        }
+    }
+  routes.swap (aggregated);
+}
+
+uint32_t
+Ipv4GlobalRouting::ExpandHostRoutes (std::vector<CompactRoute> &routes, uint32_t first)
+{
+  uint32_t last = first;
+  while (last < routes.size () && routes[last].dest == routes[first].dest
+         && routes[last].length == routes[first].length)
+    {
+      last++;
+    }
+  uint32_t count = 1u << (32 - routes[first].length);
+  std::vector<CompactRoute> expanded;
+  expanded.reserve (count * (last - first));
+  for (uint32_t a = 0; a < count; a++)
+    {
+      for (uint32_t k = first; k < last; k++)
+        {
+          CompactRoute route;
+          route.dest = routes[first].dest + a;
+          route.nextHop = routes[k].nextHop;
+          route.length = 32;
+          expanded.push_back (route);
+        }
+    }
+  routes.erase (routes.begin () + first, routes.begin () + last);
+  routes.insert (routes.begin () + first, expanded.begin (), expanded.end ());
+  return expanded.size ();
+}
+
+bool
+Ipv4GlobalRouting::FindCompactHostRoutes (Ipv4Address dest, uint32_t &first, uint32_t &last) const
+{
+  SortCompactRoutes ();
+  std::vector<CompactRoute> const &routes = m_compactHost.routes;
+  CompactRoute key;
+  key.dest = dest.Get ();
+  std::vector<CompactRoute>::const_iterator i =
+    std::upper_bound (routes.begin (), routes.end (), key, CompareDest<CompactRoute>);
+  if (i == routes.begin ())
+    {
+      return false;
+    }
+  last = i - routes.begin ();
+  first = last - 1;
+  if ((key.dest & GetMaskBits (routes[first].length)) != routes[first].dest)
+    {
+      return false;
+    }
+  while (first > 0 && routes[first - 1].dest == routes[last - 1].dest)
+    {
+      first--;
+    }
+  return true;
+}
+
+void
+Ipv4GlobalRouting::FindCompactRoutes (CompactRoutes const &routes, Ipv4Address dest, std::vector<uint32_t> &found)
+{
+  for (uint32_t l = 0; l < routes.lengths.size (); l++)
+    {
+      std::vector<CompactRoute>::const_iterator begin = routes.routes.begin () + routes.lengths[l].second;
+      std::vector<CompactRoute>::const_iterator end = l + 1 < routes.lengths.size () ?
+        routes.routes.begin () + routes.lengths[l + 1].second : routes.routes.end ();
+      CompactRoute key;
+      key.dest = dest.Get () & GetMaskBits (routes.lengths[l].first);
+      for (std::vector<CompactRoute>::const_iterator i = std::lower_bound (begin, end, key, CompareDest<CompactRoute>);
+           i != end && i->dest == key.dest; i++)
+        {
+          found.push_back (i - routes.routes.begin ());
+        }
+    }
+}
+
+void
+Ipv4GlobalRouting::UpdateLengths (CompactRoutes &routes)
+{
+  routes.lengths.clear ();
+  for (uint32_t i = 0; i < routes.routes.size (); i++)
+    {
+      if (i == 0 || routes.routes[i].length != routes.routes[i - 1].length)
+        {
+          routes.lengths.push_back (std::make_pair (uint8_t (routes.routes[i].length), i));
+        }
+    }
+}
+
+bool
+Ipv4GlobalRouting::RemoveCompactRoute (CompactRoutes &routes, Ipv4Address dest, Ipv4Mask mask,
+                                       Ipv4Address gateway, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << dest << mask << gateway << interface);
+  uint32_t index;
+  if (!FindNextHopIndex (gateway, interface, index))
+    {
+      return false;
+    }
+  SortCompactRoutes ();
+  uint32_t key = dest.CombineMask (mask).Get ();
+  uint32_t length = mask.GetPrefixLength ();
+  for (std::vector<CompactRoute>::iterator i = routes.routes.begin (); i != routes.routes.end (); i++)
+    {
+      if (i->dest == key && i->length == length && i->nextHop == index)
+        {
+          routes.routes.erase (i);
+          UpdateLengths (routes);
+          return true;
+        }
+    }
+  return false;
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupCompact (Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  std::vector<CompactNextHop> const &nextHops = GetNextHopTable ().nextHops;
+  // the next hops of the routes found, with the destinations of the routes
+  std::vector<std::pair<uint32_t, Ipv4Address> > allRoutes;
+
+  uint32_t first;
+  uint32_t last;
+  if (FindCompactHostRoutes (dest, first, last))
+    {
+      for (uint32_t k = first; k < last; k++)
+        {
+          uint32_t nextHop = m_compactHost.routes[k].nextHop;
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (nextHops[nextHop].interface))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          allRoutes.push_back (std::make_pair (nextHop, dest));
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route");
+        }
+    }
+  CompactRoutes const *lists[] = { &m_compactNetwork, &m_compactExternal };
+  for (uint32_t l = 0; l < 2 && allRoutes.size () == 0; l++)
+    {
+      std::vector<uint32_t> found;
+      FindCompactRoutes (*lists[l], dest, found);
+      for (std::vector<uint32_t>::const_iterator j = found.begin (); j != found.end (); j++)
+        {
+          CompactRoute const &route = lists[l]->routes[*j];
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (nextHops[route.nextHop].interface))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          allRoutes.push_back (std::make_pair (uint32_t (route.nextHop), Ipv4Address (route.dest)));
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network or external route");
+          if (lists[l] == &m_compactExternal)
+            {
+              // only the first external route is considered
+              break;
+            }
+        }
+    }
+  if (allRoutes.size () == 0)
+    {
+      return 0;
+    }
+  uint32_t selectIndex = m_randomEcmpRouting ? m_rand->GetInteger (0, allRoutes.size () - 1) : 0;
+  CompactNextHop const &nextHop = nextHops[allRoutes[selectIndex].first];
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (allRoutes[selectIndex].second);
+  rtentry->SetSource (m_ipv4->GetAddress (nextHop.interface, 0).GetLocal ());
+  rtentry->SetGateway (nextHop.gateway);
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (nextHop.interface));
+  return rtentry;
+}
+
+Ipv4RoutingTableEntry
+Ipv4GlobalRouting::MakeEntry (CompactRoute const &route, bool host)
+{
+  CompactNextHop const &nextHop = GetNextHopTable ().nextHops[route.nextHop];
+  if (host && route.length == 32)
+    {
+      return Ipv4RoutingTableEntry::CreateHostRouteTo (Ipv4Address (route.dest), nextHop.gateway, nextHop.interface);
+    }
+  return Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address (route.dest), Ipv4Mask (GetMaskBits (route.length)),
+                                                      nextHop.gateway, nextHop.interface);
+}
+
+int64_t
+Ipv4GlobalRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
+void
+Ipv4GlobalRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  RemoveAllRoutes ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -537,9 +1209,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -549,9 +1219,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -561,9 +1229,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
@@ -573,9 +1239,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutingTables ();
     }
 }
 
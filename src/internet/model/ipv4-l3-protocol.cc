@@ -33,6 +33,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -41,6 +42,7 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-l4-protocol.h"
 
 namespace ns3 {
 
@@ -925,12 +927,31 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // A super-segment is carried as is by the devices supporting segmentation
+  // offload, and split in its segments before the other ones
+  SegmentOffloadTag offloadTag;
+  bool superSegment = packet->PeekPacketTag (offloadTag)
+    && ipHeader.GetProtocol () == TcpL4Protocol::PROT_NUMBER;
+  if (superSegment && !SegmentOffloadTag::IsSupportedBy (outDev))
+    {
+      NS_LOG_LOGIC ("Splitting a super-segment of " << offloadTag.GetSegments () << " segments");
+      std::list<Ptr<Packet> > segments;
+      TcpL4Protocol::SplitSuperSegment (packet, ipHeader.GetSource (), ipHeader.GetDestination (), segments);
+      for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+        {
+          Ipv4Header segmentHeader = ipHeader;
+          segmentHeader.SetPayloadSize ((*it)->GetSize ());
+          SendRealOut (route, *it, segmentHeader);
+        }
+      return;
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!superSegment && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -957,7 +978,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!superSegment && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -23,6 +23,7 @@
       std::clog << Simulator::Now ().GetSeconds () \
                 << " [node " << m_ipv4->GetObject<Node> ()->GetId () << "] "; }
 
+#include <algorithm>
 #include <iomanip>
 #include "ns3/log.h"
 #include "ns3/names.h"
@@ -54,7 +55,8 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_networkRouteIndexValid (false),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +75,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteIndexValid = false;
 }
 
 void 
@@ -87,6 +90,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkRouteIndexValid = false;
 }
 
 void 
@@ -144,6 +148,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_networkRouteIndexValid = false;
 }
 
 uint32_t 
@@ -219,12 +224,22 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+/**
+ * \param mask a network mask
+ * \returns true if the bits of the mask are all leading ones
+ */
+static bool
+IsContiguous (Ipv4Mask mask)
+{
+  uint16_t length = mask.GetPrefixLength ();
+  return mask.Get () == (length == 0 ? 0 : 0xffffffff << (32 - length));
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
   uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
@@ -240,18 +255,70 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  //
+  // Visit the prefixes which match the destination from the longest one.
+  // Among the routes of the longest prefix which have a route on the
+  // requested interface, pick the one with the lowest metric; on a tie the
+  // last one in the table wins, except for host routes where the first one
+  // wins.
+  //
+  // The routes with a non-contiguous mask are not in the trie.  Those which
+  // match compete with the routes of the trie whose prefix is as long as
+  // their mask, up to its last bit.
+  //
+  UpdateNetworkRouteIndex ();
+  uint8_t address[4];
+  dest.Serialize (address);
+  PrefixTrie<uint32_t>::Match matches[33];
+  uint32_t n = m_networkRouteTrie.Lookup (address, 32, matches);
+  std::vector<uint32_t> others;
+  for (std::vector<uint32_t>::const_iterator i = m_networkRouteOthers.begin (); i != m_networkRouteOthers.end (); i++)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      Ipv4RoutingTableEntry *j = m_networkRouteVector[*i].first;
+      if (j->GetDestNetworkMask ().IsMatch (dest, j->GetDestNetwork ()))
+        {
+          others.push_back (*i);
+        }
+    }
+  std::vector<uint32_t> merged;
+  for (uint32_t k = n; (k > 0 || !others.empty ()) && rtentry == 0; )
+    {
+      uint16_t masklen = k > 0 ? matches[k - 1].length : 0;
+      for (std::vector<uint32_t>::const_iterator i = others.begin (); i != others.end (); i++)
+        {
+          masklen = std::max (masklen, m_networkRouteVector[*i].first->GetDestNetworkMask ().GetPrefixLength ());
+        }
+      std::vector<uint32_t> const *level = &merged;
+      merged.clear ();
+      if (k > 0 && matches[k - 1].length == masklen)
         {
+          level = matches[k - 1].values;
+          k--;
+        }
+      for (std::vector<uint32_t>::iterator i = others.begin (); i != others.end (); )
+        {
+          if (m_networkRouteVector[*i].first->GetDestNetworkMask ().GetPrefixLength () == masklen)
+            {
+              merged.push_back (*i);
+              i = others.erase (i);
+            }
+          else
+            {
+              i++;
+            }
+        }
+      if (!merged.empty () && level != &merged)
+        {
+          merged.insert (merged.end (), level->begin (), level->end ());
+          std::sort (merged.begin (), merged.end ());
+          level = &merged;
+        }
+      std::vector<uint32_t> const &indices = *level;
+      Ipv4RoutingTableEntry *route = 0;
+      for (std::vector<uint32_t>::const_iterator i = indices.begin (); i != indices.end (); i++)
+        {
+          Ipv4RoutingTableEntry *j = m_networkRouteVector[*i].first;
+          uint32_t metric = m_networkRouteVector[*i].second;
           NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
           if (oif != 0)
             {
@@ -261,33 +328,26 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
           if (metric > shortest_metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
               continue;
             }
           shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
+          route = j;
+          if (masklen == 32)
+            {
+              break;
+            }
+        }
+      if (route != 0)
+        {
           uint32_t interfaceIdx = route->GetInterface ();
           rtentry = Create<Ipv4Route> ();
           rtentry->SetDestination (route->GetDest ());
           rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
           rtentry->SetGateway (route->GetGateway ());
           rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
-            }
         }
     }
   if (rtentry != 0)
@@ -301,6 +361,33 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
   return rtentry;
 }
 
+void
+Ipv4StaticRouting::UpdateNetworkRouteIndex (void)
+{
+  if (m_networkRouteIndexValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_networkRouteVector.assign (m_networkRoutes.begin (), m_networkRoutes.end ());
+  m_networkRouteTrie.Clear ();
+  m_networkRouteOthers.clear ();
+  for (uint32_t i = 0; i < m_networkRouteVector.size (); i++)
+    {
+      Ipv4RoutingTableEntry *route = m_networkRouteVector[i].first;
+      Ipv4Mask mask = route->GetDestNetworkMask ();
+      if (!IsContiguous (mask))
+        {
+          m_networkRouteOthers.push_back (i);
+          continue;
+        }
+      uint8_t prefix[4];
+      route->GetDestNetwork ().Serialize (prefix);
+      m_networkRouteTrie.Insert (prefix, mask.GetPrefixLength (), i);
+    }
+  m_networkRouteIndexValid = true;
+}
+
 Ptr<Ipv4MulticastRoute>
 Ipv4StaticRouting::LookupStatic (
   Ipv4Address origin, 
@@ -449,6 +536,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_networkRouteIndexValid = false;
           return;
         }
       tmp++;
@@ -575,6 +663,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteIndexValid = false;
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -615,6 +704,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_networkRouteIndexValid = false;
         }
       else
         {
@@ -662,6 +752,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_networkRouteIndexValid = false;
         }
       else
         {
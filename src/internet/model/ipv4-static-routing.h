@@ -24,6 +24,7 @@
 
 #include <list>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -31,6 +32,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -413,11 +415,38 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Rebuild m_networkRouteVector, m_networkRouteTrie and
+   * m_networkRouteOthers if the network routes changed.
+   */
+  void UpdateNetworkRouteIndex (void);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, in the order of m_networkRoutes.
+   */
+  std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > m_networkRouteVector;
+
+  /**
+   * \brief the positions in m_networkRouteVector, by destination prefix.
+   */
+  PrefixTrie<uint32_t> m_networkRouteTrie;
+
+  /**
+   * \brief the positions in m_networkRouteVector of the routes with a
+   * non-contiguous mask, which are not in m_networkRouteTrie.
+   */
+  std::vector<uint32_t> m_networkRouteOthers;
+
+  /**
+   * \brief true if the index of the network routes is up to date.
+   */
+  bool m_networkRouteIndexValid;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -17,7 +17,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <list>
+#include <map>
 #include "ns3/abort.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
@@ -128,6 +128,15 @@ public:
    */
   bool AddAllocated (const Ipv6Address addr);
 
+  /**
+   * \brief Add a range of Ipv6Address to the list of IPv6 entries
+   *
+   * \param low The lowest Ipv6Address of the range
+   * \param high The highest Ipv6Address of the range
+   * \returns true on success
+   */
+  bool AddAllocated (const Ipv6Address low, const Ipv6Address high);
+
   /**
    * \brief Used to turn off fatal errors and assertions, for testing
    */
@@ -160,16 +169,21 @@ public:
   NetworkState m_netTable[N_BITS]; //!< the available networks
 
   /**
-   * \brief This class holds the allocated addresses
+   * \brief Get the address following an address
+   * \param addr the address
+   * \returns the next address, wrapping around to ::
    */
-  class Entry
-  {
-public:
-    uint8_t addrLow[16];  //!< the lowest allocated address
-    uint8_t addrHigh[16]; //!< the highest allocated address
-  };
+  static Ipv6Address Increment (const Ipv6Address addr);
+
+  /**
+   * \brief Container of the allocated addresses
+   *
+   * Each entry is a block of consecutive addresses, indexed by its lowest
+   * address and holding its highest address.  Adjacent blocks are merged.
+   */
+  typedef std::map<Ipv6Address, Ipv6Address> Entries;
 
-  std::list<Entry> m_entries; //!< contained of allocated addresses
+  Entries m_entries; //!< the allocated address blocks
   Ipv6Address m_base; //!< base address
   bool m_test; //!< test mode (if true)
 };
@@ -448,116 +462,90 @@ bool
 Ipv6AddressGeneratorImpl::AddAllocated (const Ipv6Address address)
 {
   NS_LOG_FUNCTION (this << address);
+  return AddAllocated (address, address);
+}
 
-  uint8_t addr[16];
-  address.GetBytes (addr);
-
-  std::list<Entry>::iterator i;
+bool
+Ipv6AddressGeneratorImpl::AddAllocated (const Ipv6Address low, const Ipv6Address high)
+{
+  NS_LOG_FUNCTION (this << low << high);
 
-  for (i = m_entries.begin (); i != m_entries.end (); ++i)
+  NS_ABORT_MSG_IF (high < low, "Ipv6AddressGeneratorImpl::Add(): Inverted address range");
+  //
+  // The blocks are sorted and never overlap, so the new addresses can only
+  // collide with the last block starting at or before low, or with the
+  // blocks starting after it, of which the first one is enough to check.
+  //
+  Entries::iterator next = m_entries.upper_bound (low);
+  Entries::iterator prev = m_entries.end ();
+  if (next != m_entries.begin ())
     {
-      NS_LOG_LOGIC ("examine entry: " << Ipv6Address ((*i).addrLow) <<
-                    " to " << Ipv6Address ((*i).addrHigh));
-      //
-      // First things first.  Is there an address collision -- that is, does the
-      // new address fall in a previously allocated block of addresses.
-      //
-      if (!(Ipv6Address (addr) < Ipv6Address ((*i).addrLow))
-          && ((Ipv6Address (addr) < Ipv6Address ((*i).addrHigh))
-              || (Ipv6Address (addr) == Ipv6Address ((*i).addrHigh))))
-        {
-          NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << Ipv6Address (addr));
-          if (!m_test)
-            {
-              NS_FATAL_ERROR ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << Ipv6Address (addr));
-            }
-          return false;
-        }
-      //
-      // If the new address is less than the lowest address in the current
-      // block and can't be merged into to the current block, then insert it
-      // as a new block before the current block.
-      //
-      uint8_t taddr[16];
-      for (uint32_t j = 0; j < 16; j++)
-        {
-          taddr[j] = (*i).addrLow[j];
-        }
-      taddr[15] -= 1;
-      if (Ipv6Address (addr) < Ipv6Address (taddr))
-        {
-          break;
-        }
-      //
-      // If the new address fits at the end of the block, look ahead to the next
-      // block and make sure it's not a collision there.  If we won't overlap,
-      // then just extend the current block by one address.  We expect that
-      // completely filled network ranges will be a fairly rare occurrence,
-      // so we don't worry about collapsing address range blocks.
-      //
-      for (uint32_t j = 0; j < 16; j++)
-        {
-          taddr[j] = (*i).addrLow[j];
-        }
-      taddr[15] += 1;
-      if (Ipv6Address (addr) == Ipv6Address (taddr))
-        {
-          std::list<Entry>::iterator j = i;
-          ++j;
-
-          if (j != m_entries.end ())
-            {
-              if (Ipv6Address (addr) == Ipv6Address ((*j).addrLow))
-                {
-                  NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::Add(): "
-                                "Address Collision: " << Ipv6Address (addr));
-                  if (!m_test)
-                    {
-                      NS_FATAL_ERROR ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << Ipv6Address (addr));
-                    }
-                  return false;
-                }
-            }
+      prev = next;
+      --prev;
+      NS_LOG_LOGIC ("examine entry: " << prev->first << " to " << prev->second);
+    }
 
-          NS_LOG_LOGIC ("New addrHigh = " << Ipv6Address (addr));
-          for (uint32_t j = 0; j < 16; j++)
-            {
-              (*i).addrHigh[j] = addr[j];
-            }
-          return true;
-        }
-      //
-      // If we get here, we know that the next lower block of addresses
-      // couldn't have been extended to include this new address since the
-      // code immediately above would have been executed and that next lower
-      // block extended upward.  So we know it's safe to extend the current
-      // block down to includ the new address.
-      //
-      for (uint32_t j = 0; j < 16; j++)
-        {
-          taddr[j] = (*i).addrLow[j];
-        }
-      taddr[15] -= 1;
-      if ((Ipv6Address (addr) == Ipv6Address (taddr)))
+  bool collision = false;
+  Ipv6Address addr;
+  if (prev != m_entries.end () && !(prev->second < low))
+    {
+      collision = true;
+      addr = low;
+    }
+  else if (next != m_entries.end () && !(high < next->first))
+    {
+      collision = true;
+      addr = next->first;
+    }
+  if (collision)
+    {
+      NS_LOG_LOGIC ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << addr);
+      if (!m_test)
         {
-          NS_LOG_LOGIC ("New addrLow = " << Ipv6Address (addr));
-          for (uint32_t j = 0; j < 16; j++)
-            {
-              (*i).addrLow[j] = addr[j];
-            }
-          return true;
+          NS_FATAL_ERROR ("Ipv6AddressGeneratorImpl::Add(): Address Collision: " << addr);
         }
+      return false;
     }
-
-  Entry entry;
-  for (uint32_t j = 0; j < 16; j++)
+  //
+  // Extend the previous block up to the new addresses if they follow it, or
+  // insert a new block, and then merge the next block if the new addresses
+  // precede it.
+  //
+  Entries::iterator block;
+  if (prev != m_entries.end () && Increment (prev->second) == low)
+    {
+      NS_LOG_LOGIC ("New addrHigh = " << high);
+      block = prev;
+      block->second = high;
+    }
+  else
+    {
+      block = m_entries.insert (next, std::make_pair (low, high));
+    }
+  if (next != m_entries.end () && Increment (high) == next->first)
     {
-      entry.addrLow[j] = entry.addrHigh[j] = addr[j];
+      NS_LOG_LOGIC ("Merge with the block starting at " << next->first);
+      block->second = next->second;
+      m_entries.erase (next);
     }
-  m_entries.insert (i, entry);
   return true;
 }
 
+Ipv6Address
+Ipv6AddressGeneratorImpl::Increment (const Ipv6Address addr)
+{
+  uint8_t bytes[16];
+  addr.GetBytes (bytes);
+  for (int32_t i = 15; i >= 0; --i)
+    {
+      if (++bytes[i] != 0)
+        {
+          break;
+        }
+    }
+  return Ipv6Address (bytes);
+}
+
 void
 Ipv6AddressGeneratorImpl::TestMode (void)
 {
@@ -676,6 +664,15 @@ Ipv6AddressGenerator::AddAllocated (const Ipv6Address addr)
          ->AddAllocated (addr);
 }
 
+bool
+Ipv6AddressGenerator::AddAllocated (const Ipv6Address low, const Ipv6Address high)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  return SimulationSingleton<Ipv6AddressGeneratorImpl>::Get ()
+         ->AddAllocated (low, high);
+}
+
 void
 Ipv6AddressGenerator::TestMode (void)
 {
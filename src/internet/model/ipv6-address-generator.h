@@ -146,6 +146,20 @@ public:
    */
   static bool AddAllocated (const Ipv6Address addr);
 
+  /**
+   * \brief Add a range of Ipv6Address to the list of IPv6 entries
+   *
+   * This is equivalent to adding each address of the range, but takes the
+   * same time as adding a single address: the allocated addresses are kept
+   * as blocks of consecutive addresses.
+   *
+   * \param low The lowest Ipv6Address of the range
+   * \param high The highest Ipv6Address of the range
+   * \returns true on success, false if any address of the range was
+   *          already allocated
+   */
+  static bool AddAllocated (const Ipv6Address low, const Ipv6Address high);
+
   /**
    * \brief Used to turn off fatal errors and assertions, for testing
    */
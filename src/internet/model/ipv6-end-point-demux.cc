@@ -18,6 +18,7 @@
  * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
  */
 
+#include <algorithm>
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
@@ -29,7 +30,8 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_nextOrder (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -40,36 +42,128 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_index.clear ();
+  m_locals.clear ();
+  m_ports.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+bool Ipv6EndPointDemux::Key::operator== (Key const &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return localAddress == other.localAddress && peerAddress == other.peerAddress
+         && localPort == other.localPort && peerPort == other.peerPort;
+}
+
+size_t Ipv6EndPointDemux::KeyHash::operator() (Key const &key) const
+{
+  Ipv6AddressHash addressHash;
+  size_t hash = addressHash (key.localAddress);
+  hash = hash * 1000003 ^ addressHash (key.peerAddress);
+  hash = hash * 1000003 ^ ((uint32_t (key.localPort) << 16) | key.peerPort);
+  return hash;
+}
+
+Ipv6EndPointDemux::Key Ipv6EndPointDemux::MakeKey (Ipv6Address localAddress, uint16_t localPort,
+                                                   Ipv6Address peerAddress, uint16_t peerPort)
+{
+  Key key;
+  key.localAddress = localAddress;
+  key.peerAddress = peerAddress;
+  key.localPort = localPort;
+  key.peerPort = peerPort;
+  return key;
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Entry entry;
+  entry.order = m_nextOrder++;
+  entry.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  AddEntry (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                     endPoint->GetPeerAddress (), endPoint->GetPeerPort ()), entry);
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+/**
+ * \param a an entry
+ * \param b another entry
+ * \returns true if a was added before b
+ */
+template <typename T>
+static bool
+CompareOrder (T const &a, T const &b)
+{
+  return a.order < b.order;
+}
+
+void Ipv6EndPointDemux::AddEntry (Key const &key, Entry const &entry)
+{
+  Bucket &bucket = m_index[key];
+  bucket.insert (std::upper_bound (bucket.begin (), bucket.end (), entry, CompareOrder<Entry>), entry);
+  m_locals[MakeKey (key.localAddress, key.localPort, Ipv6Address::GetAny (), 0)]++;
+  m_ports[key.localPort]++;
+}
+
+bool Ipv6EndPointDemux::RemoveEntry (Key const &key, Ipv6EndPoint *endPoint, Entry &entry)
+{
+  std::unordered_map<Key, Bucket, KeyHash>::iterator i = m_index.find (key);
+  if (i == m_index.end ())
+    {
+      return false;
+    }
+  for (Bucket::iterator j = i->second.begin (); j != i->second.end (); j++)
     {
-      if ((*i)->GetLocalPort  () == port)
+      if (*j->position == endPoint)
         {
+          entry = *j;
+          i->second.erase (j);
+          if (i->second.empty ())
+            {
+              m_index.erase (i);
+            }
+          Key local = MakeKey (key.localAddress, key.localPort, Ipv6Address::GetAny (), 0);
+          if (--m_locals[local] == 0)
+            {
+              m_locals.erase (local);
+            }
+          if (--m_ports[key.localPort] == 0)
+            {
+              m_ports.erase (key.localPort);
+            }
           return true;
         }
     }
   return false;
 }
 
+void Ipv6EndPointDemux::Reindex (Ipv6EndPoint *endPoint, Ipv6Address localAddress,
+                                 Ipv6Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << endPoint << localAddress << peerAddress << peerPort);
+  Entry entry;
+  bool found = RemoveEntry (MakeKey (localAddress, endPoint->GetLocalPort (), peerAddress, peerPort),
+                            endPoint, entry);
+  NS_ASSERT (found);
+  AddEntry (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                     endPoint->GetPeerAddress (), endPoint->GetPeerPort ()), entry);
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
+}
+
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_locals.find (MakeKey (addr, port, Ipv6Address::GetAny (), 0)) != m_locals.end ();
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
@@ -81,10 +175,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -96,10 +187,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (uint16_t port)
@@ -117,48 +205,36 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t localPort,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (m_index.find (MakeKey (localAddress, localPort, peerAddress, peerPort)) != m_index.end ())
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Entry entry;
+  if (endPoint->m_demux == this
+      && RemoveEntry (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                               endPoint->GetPeerAddress (), endPoint->GetPeerPort ()),
+                      endPoint, entry))
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      m_endPoints.erase (entry.position);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -179,9 +255,34 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  /* Only the endpoints indexed under the four-tuples which may match are
+     visited, in the order in which they were added: the local address is
+     the destination or any, and the peer is the source or any. */
+  Key keys[4] = {
+    MakeKey (daddr, dport, saddr, sport),
+    MakeKey (daddr, dport, Ipv6Address::GetAny (), 0),
+    MakeKey (Ipv6Address::GetAny (), dport, saddr, sport),
+    MakeKey (Ipv6Address::GetAny (), dport, Ipv6Address::GetAny (), 0)
+  };
+  Bucket candidates;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      if (std::find (keys, keys + i, keys[i]) != keys + i)
+        {
+          continue;
+        }
+      std::unordered_map<Key, Bucket, KeyHash>::const_iterator bucket = m_index.find (keys[i]);
+      if (bucket != m_index.end ())
+        {
+          candidates.insert (candidates.end (), bucket->second.begin (), bucket->second.end ());
+        }
+    }
+  std::sort (candidates.begin (), candidates.end (), CompareOrder<Entry>);
+
+  for (Bucket::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
-      Ipv6EndPoint* endP = *i;
+      Ipv6EndPoint* endP = *i->position;
 
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
@@ -293,6 +394,16 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  std::unordered_map<Key, Bucket, KeyHash>::const_iterator exact = m_index.find (MakeKey (dst, dport, src, sport));
+  if (exact != m_index.end ())
+    {
+      /* this is an exact match. */
+      return *exact->second.front ().position;
+    }
+  if (!LookupPortLocal (dport))
+    {
+      return 0;
+    }
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
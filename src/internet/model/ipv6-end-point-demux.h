@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed by their four-tuple in a hash table, which the
+ * endpoints keep up to date when their addresses change, so that a lookup
+ * only visits the endpoints which may match.  The local ports in use are
+ * counted, so that allocating an ephemeral port does not scan the endpoints.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +160,103 @@ private:
    */
   uint16_t AllocateEphemeralPort ();
 
+  /**
+   * \brief The four-tuple by which the endpoints are indexed.
+   */
+  struct Key
+  {
+    Ipv6Address localAddress; //!< the local address
+    Ipv6Address peerAddress;  //!< the peer address
+    uint16_t localPort;       //!< the local port
+    uint16_t peerPort;        //!< the peer port
+
+    /**
+     * \param other another key
+     * \returns true if both keys are equal
+     */
+    bool operator== (Key const &other) const;
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct KeyHash
+  {
+    /**
+     * \param key a four-tuple
+     * \returns the hash of the four-tuple
+     */
+    size_t operator() (Key const &key) const;
+  };
+
+  /**
+   * \brief An endpoint in the index: its position in m_endPoints and the
+   * order in which it was added.
+   */
+  struct Entry
+  {
+    uint64_t order;       //!< the order in which the endpoint was added
+    EndPointsI position;  //!< the position of the endpoint in m_endPoints
+  };
+
+  /**
+   * \brief The endpoints with the same four-tuple, in the order in which
+   * they were added.
+   */
+  typedef std::vector<Entry> Bucket;
+
+  /**
+   * \brief Build a four-tuple.
+   * \param localAddress the local address
+   * \param localPort the local port
+   * \param peerAddress the peer address
+   * \param peerPort the peer port
+   * \returns the four-tuple
+   */
+  static Key MakeKey (Ipv6Address localAddress, uint16_t localPort,
+                      Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add an endpoint to the list and to the index.
+   * \param endPoint the endpoint
+   * \returns the endpoint
+   */
+  Ipv6EndPoint *Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an entry to the index of four-tuples and to the counts of
+   * local addresses and ports.
+   * \param key the four-tuple of the endpoint
+   * \param entry the entry of the endpoint
+   */
+  void AddEntry (Key const &key, Entry const &entry);
+
+  /**
+   * \brief Remove an endpoint from the index of four-tuples and from the
+   * counts of local addresses and ports.
+   * \param key the four-tuple under which the endpoint is indexed
+   * \param endPoint the endpoint
+   * \param entry [out] the entry of the endpoint
+   * \returns true if the endpoint was found
+   */
+  bool RemoveEntry (Key const &key, Ipv6EndPoint *endPoint, Entry &entry);
+
+  /**
+   * \brief Move an endpoint whose four-tuple changed in the index.
+   *
+   * This is called by the endpoint after its local address or its peer
+   * changed.
+   *
+   * \param endPoint the endpoint
+   * \param localAddress the previous local address
+   * \param peerAddress the previous peer address
+   * \param peerPort the previous peer port
+   */
+  void Reindex (Ipv6EndPoint *endPoint, Ipv6Address localAddress,
+                Ipv6Address peerAddress, uint16_t peerPort);
+
+  friend class Ipv6EndPoint;
+
   /**
    * \brief The ephemeral port.
    */
@@ -172,6 +276,27 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  std::unordered_map<Key, Bucket, KeyHash> m_index;
+
+  /**
+   * \brief The number of end points with each local address and port (with
+   * a wildcard peer in the key).
+   */
+  std::unordered_map<Key, uint32_t, KeyHash> m_locals;
+
+  /**
+   * \brief The number of end points with each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
+
+  /**
+   * \brief The order of the next end point added.
+   */
+  uint64_t m_nextOrder;
 };
 
 } /* namespace ns3 */
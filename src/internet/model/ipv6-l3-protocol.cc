@@ -31,6 +31,7 @@
 #include "ns3/mac16-address.h"
 #include "ns3/mac64-address.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "loopback-net-device.h"
 #include "ipv6-l3-protocol.h"
@@ -44,6 +45,7 @@
 #include "ipv6-option.h"
 #include "icmpv6-l4-protocol.h"
 #include "ndisc-cache.h"
+#include "tcp-l4-protocol.h"
 
 /// Minimum IPv6 MTU, as defined by \RFC{2460}
 #define IPV6_MIN_MTU 1280
@@ -1116,6 +1118,25 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
   Ptr<Ipv6Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << dev->GetIfIndex () << " Ipv6InterfaceIndex " << interface);
 
+  // A super-segment is carried as is by the devices supporting segmentation
+  // offload, and split in its segments before the other ones
+  SegmentOffloadTag offloadTag;
+  bool superSegment = packet->PeekPacketTag (offloadTag)
+    && ipHeader.GetNextHeader () == TcpL4Protocol::PROT_NUMBER;
+  if (superSegment && !SegmentOffloadTag::IsSupportedBy (dev))
+    {
+      NS_LOG_LOGIC ("Splitting a super-segment of " << offloadTag.GetSegments () << " segments");
+      std::list<Ptr<Packet> > segments;
+      TcpL4Protocol::SplitSuperSegment (packet, ipHeader.GetSourceAddress (), ipHeader.GetDestinationAddress (), segments);
+      for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); it++)
+        {
+          Ipv6Header segmentHeader = ipHeader;
+          segmentHeader.SetPayloadLength ((*it)->GetSize ());
+          SendRealOut (route, *it, segmentHeader);
+        }
+      return;
+    }
+
   // Check packet size
   std::list<Ipv6ExtensionFragment::Ipv6PayloadHeaderPair> fragments;
 
@@ -1126,7 +1147,7 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  if (!superSegment && packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
     {
       // Router => drop
 
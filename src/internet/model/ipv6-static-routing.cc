@@ -18,6 +18,7 @@
  * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
  */
 
+#include <algorithm>
 #include <iomanip>
 #include "ns3/log.h"
 #include "ns3/node.h"
@@ -47,7 +48,8 @@ TypeId Ipv6StaticRouting::GetTypeId ()
 }
 
 Ipv6StaticRouting::Ipv6StaticRouting ()
-  : m_ipv6 (0)
+  : m_networkRouteIndexValid (false),
+    m_ipv6 (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -152,6 +154,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkRouteIndexValid = false;
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -165,6 +168,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkRouteIndexValid = false;
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
@@ -173,6 +177,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkRouteIndexValid = false;
 }
 
 void Ipv6StaticRouting::SetDefaultRoute (Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -197,6 +202,7 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
   m_networkRoutes.push_back (std::make_pair (route, 0));
+  m_networkRouteIndexValid = false;
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -281,11 +287,56 @@ bool Ipv6StaticRouting::HasNetworkDest (Ipv6Address network, uint32_t interfaceI
   return false;
 }
 
+/**
+ * \param prefix a network prefix
+ * \returns true if the bits of the prefix are all leading ones
+ */
+static bool
+IsContiguous (Ipv6Prefix prefix)
+{
+  uint8_t bytes[16];
+  prefix.GetBytes (bytes);
+  int length = prefix.GetPrefixLength ();
+  for (int i = 0; i < 16; i++)
+    {
+      int bits = std::max (0, std::min (length - 8 * i, 8));
+      if (bytes[i] != static_cast<uint8_t> (0xff00 >> bits))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void Ipv6StaticRouting::UpdateNetworkRouteIndex ()
+{
+  if (m_networkRouteIndexValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_networkRouteVector.assign (m_networkRoutes.begin (), m_networkRoutes.end ());
+  m_networkRouteTrie.Clear ();
+  m_networkRouteOthers.clear ();
+  for (uint32_t i = 0; i < m_networkRouteVector.size (); i++)
+    {
+      Ipv6RoutingTableEntry* route = m_networkRouteVector[i].first;
+      if (!IsContiguous (route->GetDestNetworkPrefix ()))
+        {
+          m_networkRouteOthers.push_back (i);
+          continue;
+        }
+      uint8_t prefix[16];
+      route->GetDestNetwork ().GetBytes (prefix);
+      m_networkRouteTrie.Insert (prefix, route->GetDestNetworkPrefix ().GetPrefixLength (), i);
+    }
+  m_networkRouteIndexValid = true;
+}
+
 Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice> interface)
 {
   NS_LOG_FUNCTION (this << dst << interface);
   Ptr<Ipv6Route> rtentry = 0;
-  uint16_t longestMask = 0;
   uint32_t shortestMetric = 0xffffffff;
 
   /* when sending on link-local multicast, there have to be interface specified */
@@ -300,35 +351,68 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  /* visit the prefixes which match the destination from the longest one,
+   * along with the routes with a non-contiguous prefix, see
+   * Ipv4StaticRouting::LookupStatic */
+  UpdateNetworkRouteIndex ();
+  uint8_t address[16];
+  dst.GetBytes (address);
+  PrefixTrie<uint32_t>::Match matches[PrefixTrie<uint32_t>::MAX_MATCHES];
+  uint32_t n = m_networkRouteTrie.Lookup (address, 128, matches);
+  std::vector<uint32_t> others;
+  for (std::vector<uint32_t>::const_iterator it = m_networkRouteOthers.begin (); it != m_networkRouteOthers.end (); it++)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
-
-      NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
-
-      if (mask.IsMatch (dst, entry))
+      Ipv6RoutingTableEntry* j = m_networkRouteVector[*it].first;
+      if (j->GetDestNetworkPrefix ().IsMatch (dst, j->GetDestNetwork ()))
+        {
+          others.push_back (*it);
+        }
+    }
+  std::vector<uint32_t> merged;
+  for (uint32_t k = n; (k > 0 || !others.empty ()) && !rtentry; )
+    {
+      uint16_t maskLen = k > 0 ? matches[k - 1].length : 0;
+      for (std::vector<uint32_t>::const_iterator it = others.begin (); it != others.end (); it++)
+        {
+          maskLen = std::max<uint16_t> (maskLen, m_networkRouteVector[*it].first->GetDestNetworkPrefix ().GetPrefixLength ());
+        }
+      std::vector<uint32_t> const *level = &merged;
+      merged.clear ();
+      if (k > 0 && matches[k - 1].length == maskLen)
+        {
+          level = matches[k - 1].values;
+          k--;
+        }
+      for (std::vector<uint32_t>::iterator it = others.begin (); it != others.end (); )
+        {
+          if (m_networkRouteVector[*it].first->GetDestNetworkPrefix ().GetPrefixLength () == maskLen)
+            {
+              merged.push_back (*it);
+              it = others.erase (it);
+            }
+          else
+            {
+              it++;
+            }
+        }
+      if (!merged.empty () && level != &merged)
+        {
+          merged.insert (merged.end (), level->begin (), level->end ());
+          std::sort (merged.begin (), merged.end ());
+          level = &merged;
+        }
+      std::vector<uint32_t> const &indices = *level;
+      Ipv6RoutingTableEntry* route = 0;
+      for (std::vector<uint32_t>::const_iterator it = indices.begin (); it != indices.end (); it++)
         {
+          Ipv6RoutingTableEntry* j = m_networkRouteVector[*it].first;
+          uint32_t metric = m_networkRouteVector[*it].second;
+
           NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << maskLen << ", metric " << metric);
 
           /* if interface is given, check the route will output on this interface */
           if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
             {
-              if (maskLen < longestMask)
-                {
-                  NS_LOG_LOGIC ("Previous match longer, skipping");
-                  continue;
-                }
-
-              if (maskLen > longestMask)
-                {
-                  shortestMetric = 0xffffffff;
-                }
-
-              longestMask = maskLen;
               if (metric > shortestMetric)
                 {
                   NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
@@ -336,32 +420,36 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
                 }
 
               shortestMetric = metric;
-              Ipv6RoutingTableEntry* route = j;
-              uint32_t interfaceIdx = route->GetInterface ();
-              rtentry = Create<Ipv6Route> ();
-
-              if (route->GetGateway ().IsAny ())
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                }
-              else if (route->GetDest ().IsAny ()) /* default route */
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
-                }
-              else
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
-                }
-
-              rtentry->SetDestination (route->GetDest ());
-              rtentry->SetGateway (route->GetGateway ());
-              rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+              route = j;
               if (maskLen == 128)
                 {
                   break;
                 }
             }
         }
+
+      if (route)
+        {
+          uint32_t interfaceIdx = route->GetInterface ();
+          rtentry = Create<Ipv6Route> ();
+
+          if (route->GetGateway ().IsAny ())
+            {
+              rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+            }
+          else if (route->GetDest ().IsAny ()) /* default route */
+            {
+              rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
+            }
+          else
+            {
+              rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+            }
+
+          rtentry->SetDestination (route->GetDest ());
+          rtentry->SetGateway (route->GetGateway ());
+          rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+        }
     }
 
   if (rtentry)
@@ -380,6 +468,7 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_networkRouteIndexValid = false;
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -530,6 +619,7 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          m_networkRouteIndexValid = false;
           return;
         }
       tmp++;
@@ -549,6 +639,7 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          m_networkRouteIndexValid = false;
           return;
         }
     }
@@ -674,6 +765,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_networkRouteIndexValid = false;
         }
       else
         {
@@ -719,6 +811,7 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_networkRouteIndexValid = false;
         }
       else
         {
@@ -763,6 +856,7 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
             {
               delete j->first;
               j = m_networkRoutes.erase (j);
+              m_networkRouteIndexValid = false;
             }
           else
             {
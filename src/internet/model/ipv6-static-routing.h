@@ -24,12 +24,15 @@
 #include <stdint.h>
 
 #include <list>
+#include <utility>
+#include <vector>
 
 #include "ns3/ptr.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -281,11 +284,38 @@ private:
    */
   Ptr<Ipv6MulticastRoute> LookupStatic (Ipv6Address origin, Ipv6Address group, uint32_t ifIndex);
 
+  /**
+   * \brief Rebuild m_networkRouteVector, m_networkRouteTrie and
+   * m_networkRouteOthers if the network routes changed.
+   */
+  void UpdateNetworkRouteIndex ();
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, in the order of m_networkRoutes.
+   */
+  std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> > m_networkRouteVector;
+
+  /**
+   * \brief the positions in m_networkRouteVector, by destination prefix.
+   */
+  PrefixTrie<uint32_t> m_networkRouteTrie;
+
+  /**
+   * \brief the positions in m_networkRouteVector of the routes with a
+   * non-contiguous prefix, which are not in m_networkRouteTrie.
+   */
+  std::vector<uint32_t> m_networkRouteOthers;
+
+  /**
+   * \brief true if the index of the network routes is up to date.
+   */
+  bool m_networkRouteIndexValid;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "lazy-socket-factory.h"
+#include "udp-l4-protocol.h"
+#include "tcp-l4-protocol.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LazySocketFactory");
+
+NS_OBJECT_ENSURE_REGISTERED (LazyUdpSocketFactory);
+
+TypeId
+LazyUdpSocketFactory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LazyUdpSocketFactory")
+    .SetParent<UdpSocketFactory> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<LazyUdpSocketFactory> ()
+  ;
+  return tid;
+}
+
+LazyUdpSocketFactory::LazyUdpSocketFactory ()
+  : m_udp (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LazyUdpSocketFactory::~LazyUdpSocketFactory ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_udp == 0);
+}
+
+Ptr<Socket>
+LazyUdpSocketFactory::CreateSocket (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_udp == 0)
+    {
+      Ptr<Node> node = GetObject<Node> ();
+      NS_ASSERT_MSG (node != 0, "LazyUdpSocketFactory is not aggregated to a node");
+      m_udp = node->GetObject<UdpL4Protocol> ();
+      if (m_udp == 0)
+        {
+          NS_LOG_LOGIC ("Create the UDP protocol of node " << node->GetId ());
+          m_udp = CreateObject<UdpL4Protocol> ();
+          node->AggregateObject (m_udp);
+        }
+    }
+  return m_udp->CreateSocket ();
+}
+
+void
+LazyUdpSocketFactory::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_udp = 0;
+  UdpSocketFactory::DoDispose ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (LazyTcpSocketFactory);
+
+TypeId
+LazyTcpSocketFactory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LazyTcpSocketFactory")
+    .SetParent<TcpSocketFactory> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<LazyTcpSocketFactory> ()
+  ;
+  return tid;
+}
+
+LazyTcpSocketFactory::LazyTcpSocketFactory ()
+  : m_tcp (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_tcpFactory.SetTypeId (TcpL4Protocol::GetTypeId ());
+}
+
+LazyTcpSocketFactory::~LazyTcpSocketFactory ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_tcp == 0);
+}
+
+void
+LazyTcpSocketFactory::SetTcpFactory (ObjectFactory factory)
+{
+  NS_LOG_FUNCTION (this);
+  m_tcpFactory = factory;
+}
+
+Ptr<Socket>
+LazyTcpSocketFactory::CreateSocket (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_tcp == 0)
+    {
+      Ptr<Node> node = GetObject<Node> ();
+      NS_ASSERT_MSG (node != 0, "LazyTcpSocketFactory is not aggregated to a node");
+      m_tcp = node->GetObject<TcpL4Protocol> ();
+      if (m_tcp == 0)
+        {
+          NS_LOG_LOGIC ("Create the TCP protocol of node " << node->GetId ());
+          m_tcp = m_tcpFactory.Create<TcpL4Protocol> ();
+          NS_ASSERT_MSG (m_tcp != 0, "The TCP protocol must be a TcpL4Protocol");
+          node->AggregateObject (m_tcp);
+        }
+    }
+  return m_tcp->CreateSocket ();
+}
+
+void
+LazyTcpSocketFactory::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tcp = 0;
+  TcpSocketFactory::DoDispose ();
+}
+
+} // namespace ns3
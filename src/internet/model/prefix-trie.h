@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A path-compressed binary trie of address prefixes, for
+ * longest-prefix-match lookups in forwarding tables.
+ *
+ * Prefixes and addresses are given as byte arrays in network order (see
+ * Ipv4Address::Serialize and Ipv6Address::GetBytes) together with their
+ * length in bits, so that the same trie serves IPv4 and IPv6.  Each prefix
+ * holds the list of values inserted with it, in insertion order.  Nodes
+ * only exist where prefixes are stored or where paths fork, so that a
+ * lookup visits at most one node per stored prefix length which matches
+ * the address, instead of scanning a whole routing table.
+ *
+ * The trie does not support removal: the routing protocols which use it
+ * keep their route lists as the reference, and rebuild the trie from them
+ * when they change.  The values are typically indices in those lists.
+ */
+template <typename T>
+class PrefixTrie
+{
+public:
+  /// A prefix which matches an address
+  struct Match
+  {
+    uint8_t length;                 //!< length of the prefix, in bits
+    std::vector<T> const *values;   //!< values of the prefix, in insertion order
+  };
+
+  /// Largest number of matches of a lookup, for 128-bit addresses
+  static const uint32_t MAX_MATCHES = 129;
+
+  PrefixTrie ();
+
+  /**
+   * \brief Remove all prefixes.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Add a value to a prefix.
+   * \param prefix the prefix bytes, in network order; the bits beyond
+   * \p length are ignored
+   * \param length the length of the prefix, in bits
+   * \param value the value
+   */
+  void Insert (uint8_t const *prefix, uint8_t length, T const &value);
+
+  /**
+   * \brief Find the prefixes which match an address.
+   * \param address the address bytes, in network order
+   * \param length the length of the address, in bits
+   * \param matches [out] an array of at least MAX_MATCHES elements (or
+   * \p length + 1), filled with the matching prefixes which hold values,
+   * from the shortest to the longest
+   * \return the number of matching prefixes
+   */
+  uint32_t Lookup (uint8_t const *address, uint8_t length, Match matches[]) const;
+
+  /**
+   * \return the number of nodes of the trie
+   */
+  uint32_t GetNNodes (void) const;
+
+  /**
+   * \return the number of bytes allocated by the trie, besides the trie
+   * object itself
+   */
+  uint64_t GetMemoryUsage (void) const;
+
+private:
+  /// Index of a missing child
+  static const uint32_t NONE = 0xffffffff;
+
+  /// A node of the trie
+  struct Node
+  {
+    uint8_t key[16];        //!< prefix bytes, zero beyond length
+    uint8_t length;         //!< prefix length, in bits
+    uint32_t child[2];      //!< children indices, by the bit after the prefix
+    std::vector<T> values;  //!< values stored at this prefix
+  };
+
+  /**
+   * \param key a byte array
+   * \param i a bit index
+   * \return the bit \p i of \p key, starting from the most significant bit
+   */
+  static uint32_t GetBit (uint8_t const *key, uint32_t i);
+
+  /**
+   * \param a a byte array
+   * \param b another byte array
+   * \param max the number of bits to compare
+   * \return the number of leading bits which are equal, at most \p max
+   */
+  static uint32_t CommonLength (uint8_t const *a, uint8_t const *b, uint32_t max);
+
+  /**
+   * \brief Create a node.
+   * \param key the prefix bytes
+   * \param length the prefix length
+   * \return the index of the node
+   */
+  uint32_t NewNode (uint8_t const *key, uint8_t length);
+
+  std::vector<Node> m_nodes;  //!< the nodes; the root, of length 0, is the first one
+};
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T>
+const uint32_t PrefixTrie<T>::MAX_MATCHES;
+
+template <typename T>
+const uint32_t PrefixTrie<T>::NONE;
+
+template <typename T>
+PrefixTrie<T>::PrefixTrie ()
+{
+  Clear ();
+}
+
+template <typename T>
+void
+PrefixTrie<T>::Clear (void)
+{
+  uint8_t zero[16] = { 0 };
+  m_nodes.clear ();
+  NewNode (zero, 0);
+}
+
+template <typename T>
+uint32_t
+PrefixTrie<T>::GetNNodes (void) const
+{
+  return m_nodes.size ();
+}
+
+template <typename T>
+uint64_t
+PrefixTrie<T>::GetMemoryUsage (void) const
+{
+  uint64_t bytes = m_nodes.capacity () * sizeof (Node);
+  for (typename std::vector<Node>::const_iterator i = m_nodes.begin (); i != m_nodes.end (); i++)
+    {
+      bytes += i->values.capacity () * sizeof (T);
+    }
+  return bytes;
+}
+
+template <typename T>
+uint32_t
+PrefixTrie<T>::GetBit (uint8_t const *key, uint32_t i)
+{
+  return (key[i >> 3] >> (7 - (i & 7))) & 1;
+}
+
+template <typename T>
+uint32_t
+PrefixTrie<T>::CommonLength (uint8_t const *a, uint8_t const *b, uint32_t max)
+{
+  uint32_t i = 0;
+  while (i < max)
+    {
+      uint8_t diff = a[i >> 3] ^ b[i >> 3];
+      if (diff == 0)
+        {
+          i += 8;
+          continue;
+        }
+      while (!(diff & 0x80))
+        {
+          diff <<= 1;
+          i++;
+        }
+      break;
+    }
+  return i < max ? i : max;
+}
+
+template <typename T>
+uint32_t
+PrefixTrie<T>::NewNode (uint8_t const *key, uint8_t length)
+{
+  Node node;
+  std::memset (node.key, 0, sizeof (node.key));
+  std::memcpy (node.key, key, (length + 7) / 8);
+  if (length % 8)
+    {
+      node.key[length / 8] &= 0xff << (8 - length % 8);
+    }
+  node.length = length;
+  node.child[0] = NONE;
+  node.child[1] = NONE;
+  m_nodes.push_back (node);
+  return m_nodes.size () - 1;
+}
+
+template <typename T>
+void
+PrefixTrie<T>::Insert (uint8_t const *prefix, uint8_t length, T const &value)
+{
+  NS_ASSERT (length <= 128);
+  uint32_t index = 0;
+  while (true)
+    {
+      // The prefix of the node is a prefix of the inserted one
+      if (m_nodes[index].length == length)
+        {
+          m_nodes[index].values.push_back (value);
+          return;
+        }
+      uint32_t bit = GetBit (prefix, m_nodes[index].length);
+      uint32_t child = m_nodes[index].child[bit];
+      if (child == NONE)
+        {
+          uint32_t leaf = NewNode (prefix, length);
+          m_nodes[leaf].values.push_back (value);
+          m_nodes[index].child[bit] = leaf;
+          return;
+        }
+      uint8_t childLength = m_nodes[child].length;
+      uint32_t common = CommonLength (prefix, m_nodes[child].key,
+                                      length < childLength ? length : childLength);
+      if (common == childLength)
+        {
+          index = child;
+          continue;
+        }
+
+      // Split the path to the child at the first differing bit
+      uint32_t fork = NewNode (prefix, common);
+      m_nodes[fork].child[GetBit (m_nodes[child].key, common)] = child;
+      m_nodes[index].child[bit] = fork;
+      if (common == length)
+        {
+          m_nodes[fork].values.push_back (value);
+        }
+      else
+        {
+          uint32_t leaf = NewNode (prefix, length);
+          m_nodes[leaf].values.push_back (value);
+          m_nodes[fork].child[GetBit (prefix, common)] = leaf;
+        }
+      return;
+    }
+}
+
+template <typename T>
+uint32_t
+PrefixTrie<T>::Lookup (uint8_t const *address, uint8_t length, Match matches[]) const
+{
+  uint32_t n = 0;
+  uint32_t index = 0;
+  while (index != NONE)
+    {
+      Node const &node = m_nodes[index];
+      if (node.length > length
+          || CommonLength (address, node.key, node.length) < node.length)
+        {
+          break;
+        }
+      if (!node.values.empty ())
+        {
+          matches[n].length = node.length;
+          matches[n].values = &node.values;
+          n++;
+        }
+      if (node.length == length)
+        {
+          break;
+        }
+      index = node.child[GetBit (address, node.length)];
+    }
+  return n;
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -29,6 +29,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
+#include "ns3/segment-offload-tag.h"
 
 #include "tcp-l4-protocol.h"
 #include "tcp-header.h"
@@ -44,6 +45,7 @@
 #include "tcp-congestion-ops.h"
 #include "rtt-estimator.h"
 
+#include <algorithm>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -120,9 +122,13 @@ TcpL4Protocol::NotifyNewAggregate ()
       if ((node != 0) && (ipv4 != 0 || ipv6 != 0))
         {
           this->SetNode (node);
-          Ptr<TcpSocketFactoryImpl> tcpFactory = CreateObject<TcpSocketFactoryImpl> ();
-          tcpFactory->SetTcp (this);
-          node->AggregateObject (tcpFactory);
+          // A lazy socket factory may already be there, creating this protocol
+          if (node->GetObject<TcpSocketFactory> () == 0)
+            {
+              Ptr<TcpSocketFactoryImpl> tcpFactory = CreateObject<TcpSocketFactoryImpl> ();
+              tcpFactory->SetTcp (this);
+              node->AggregateObject (tcpFactory);
+            }
         }
     }
 
@@ -682,6 +688,39 @@ TcpL4Protocol::SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
   NS_FATAL_ERROR ("Trying to send a packet without IP addresses");
 }
 
+void
+TcpL4Protocol::SplitSuperSegment (Ptr<const Packet> packet,
+                                  const Address &saddr, const Address &daddr,
+                                  std::list<Ptr<Packet> > &segments)
+{
+  Ptr<Packet> payload = packet->Copy ();
+  SegmentOffloadTag offloadTag;
+  bool found = payload->RemovePacketTag (offloadTag);
+  NS_ASSERT_MSG (found, "The packet is not a super-segment");
+  TcpHeader header;
+  payload->RemoveHeader (header);
+
+  uint32_t segmentSize = offloadTag.GetSegmentSize ();
+  uint32_t size = payload->GetSize ();
+  uint8_t lastFlags = header.GetFlags ();
+  uint8_t flags = lastFlags & ~(TcpHeader::FIN | TcpHeader::PSH);
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = payload->CreateFragment (offset, length);
+      TcpHeader segmentHeader = header;
+      segmentHeader.SetSequenceNumber (header.GetSequenceNumber () + SequenceNumber32 (offset));
+      segmentHeader.SetFlags (offset + length < size ? flags : lastFlags);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentHeader.EnableChecksums ();
+        }
+      segmentHeader.InitializeChecksum (saddr, daddr, PROT_NUMBER);
+      segment->AddHeader (segmentHeader);
+      segments.push_back (segment);
+    }
+}
+
 void
 TcpL4Protocol::AddSocket (Ptr<TcpSocketBase> socket)
 {
@@ -22,6 +22,7 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <list>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -197,6 +198,23 @@ public:
                    const Address &saddr, const Address &daddr,
                    Ptr<NetDevice> oif = 0) const;
 
+  /**
+   * \brief Split a TCP super-segment in its segments
+   *
+   * The packet starts with the TCP header and carries a SegmentOffloadTag.
+   * Each segment gets a copy of the header with its own sequence number;
+   * FIN and PSH are kept on the last segment only.  The segments do not
+   * carry the SegmentOffloadTag.
+   *
+   * \param packet The super-segment
+   * \param saddr The source address, used for the checksum
+   * \param daddr The destination address, used for the checksum
+   * \param segments The list the segments are appended to
+   */
+  static void SplitSuperSegment (Ptr<const Packet> packet,
+                                 const Address &saddr, const Address &daddr,
+                                 std::list<Ptr<Packet> > &segments);
+
   /**
    * \brief Make a socket fully operational
    *
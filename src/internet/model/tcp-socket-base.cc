@@ -41,6 +41,7 @@
 #include "ns3/double.h"
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/segment-offload-tag.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -104,6 +105,12 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_timestampEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("SegmentOffload",
+                   "Maximum number of segments of new data sent as a single "
+                   "super-segment packet (segmentation offload); 1 disables it",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_segmentOffload),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("MinRto",
                    "Minimum retransmit timeout value",
                    TimeValue (Seconds (1.0)), // RFC 6298 says min RTO=1 sec, but Linux uses 200ms.
@@ -326,6 +333,7 @@ TcpSocketBase::TcpSocketBase (void)
     m_sndWindShift (0),
     m_timestampEnabled (true),
     m_timestampToEcho (0),
+    m_segmentOffload (1),
     m_sendPendingDataEvent (),
     // Set m_recover to the initial sequence number
     m_recover (0),
@@ -404,6 +412,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_sndWindShift (sock.m_sndWindShift),
     m_timestampEnabled (sock.m_timestampEnabled),
     m_timestampToEcho (sock.m_timestampToEcho),
+    m_segmentOffload (sock.m_segmentOffload),
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
@@ -2677,6 +2686,12 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       p->AddPacketTag (ipHopLimitTag);
     }
 
+  if (sz > m_tcb->m_segmentSize)
+    {
+      SegmentOffloadTag offloadTag (m_tcb->m_segmentSize, sz);
+      p->AddPacketTag (offloadTag);
+    }
+
   uint8_t priority = GetPriority ();
   if (priority)
     {
@@ -2849,6 +2864,18 @@ TcpSocketBase::SendPendingData (bool withAck)
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
 
+          // With segmentation offload, new data is sent as a super-segment
+          // of whole segments while there is no loss to recover from.  The
+          // super-segment must fit in the 64 KB length of an IP packet.
+          if (m_segmentOffload > 1 && next == m_tcb->m_highTxMark
+              && m_tcb->m_congState == TcpSocketState::CA_OPEN
+              && availableWindow >= 2 * m_tcb->m_segmentSize)
+            {
+              uint32_t segments = std::min (m_segmentOffload, 65000 / m_tcb->m_segmentSize);
+              s = std::min (availableWindow, segments * m_tcb->m_segmentSize);
+              s -= s % m_tcb->m_segmentSize;
+            }
+
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
           //       retransmitted segment unless NextSeg () rule (4) was
@@ -3027,8 +3054,11 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
       SendEmptyPacket (TcpHeader::ACK);
     }
   else
-    { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+    { // In-sequence packet: ACK if delayed ack count allows. A super-segment
+      // counts as all the segments it carries, as done by receive offload.
+      SegmentOffloadTag offloadTag;
+      m_delAckCount += p->PeekPacketTag (offloadTag) ? offloadTag.GetSegments () : 1;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -112,7 +112,9 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_sentIndexValid (true), m_pipeValid (false), m_pipe (0), m_pipeDupThresh (0),
+    m_pipeSegmentSize (0), m_retransHint (n), m_lostMarkEnd (n)
 {
 }
 
@@ -180,6 +182,11 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_sentIndex.clear ();
+  m_sentIndexValid = true;
+  m_pipeValid = false;
+  m_retransHint = seq;
+  m_lostMarkEnd = seq;
 }
 
 bool
@@ -250,6 +257,7 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       outItem = GetTransmittedSegment (s, seq);
       NS_ASSERT (outItem != 0);
       outItem->m_retrans = true;
+      m_pipeValid = false;
 
       NS_LOG_DEBUG ("Retransmitting [" << seq << ";" << seq + s << "|" << s <<
                     "] from " << *this);
@@ -264,6 +272,10 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       NS_ASSERT (outItem != 0);
       NS_ASSERT (outItem->m_retrans == false);
 
+      // New data begins above any SACKed byte: it is never lost, and it is
+      // in flight from now on
+      m_pipe += s;
+
       NS_LOG_DEBUG ("New segment [" << seq << ";" << seq + s << "|" << s <<
                     "] from " << *this);
     }
@@ -311,7 +323,11 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  it = m_sentList.insert (m_sentList.end (), item);
+  if (m_sentIndexValid)
+    {
+      m_sentIndex.insert (m_sentIndex.end (), std::make_pair (startOfAppList, it));
+    }
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -326,7 +342,20 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
 
   bool listEdited = false;
 
-  TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, numBytes, seq, &listEdited);
+  // Start from the item which contains seq
+  IndexSentList ();
+  SentIndex::iterator start = m_sentIndex.upper_bound (seq);
+  NS_ASSERT (start != m_sentIndex.begin ());
+  --start;
+
+  TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, start->second,
+                                       start->first, numBytes, seq, &listEdited);
+
+  if (listEdited)
+    {
+      m_sentIndexValid = false;
+      m_retransHint = m_firstByteSeq;
+    }
 
   if (listEdited && m_highestSack.second >= m_firstByteSeq)
     {
@@ -360,6 +389,26 @@ TcpTxBuffer::GetHighestSacked () const
   return ret;
 }
 
+void
+TcpTxBuffer::IndexSentList ()
+{
+  if (m_sentIndexValid)
+    {
+      return;
+    }
+
+  NS_LOG_FUNCTION (this);
+  PacketList::iterator it;
+  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+
+  m_sentIndex.clear ();
+  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      m_sentIndex.insert (m_sentIndex.end (), std::make_pair (beginOfCurrentPacket, it));
+      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+    }
+  m_sentIndexValid = true;
+}
 
 void
 TcpTxBuffer::SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const
@@ -379,6 +428,16 @@ TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
                                 bool *listEdited) const
+{
+  return GetPacketFromList (list, listStartFrom, list.begin (), listStartFrom,
+                            numBytes, seq, listEdited);
+}
+
+TcpTxItem*
+TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
+                                PacketList::iterator start, const SequenceNumber32 &startSeq,
+                                uint32_t numBytes, const SequenceNumber32 &seq,
+                                bool *listEdited) const
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -412,8 +471,8 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   Ptr<Packet> currentPacket = 0;
   TcpTxItem *currentItem = 0;
   TcpTxItem *outItem = 0;
-  PacketList::iterator it = list.begin ();
-  SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  PacketList::iterator it = start;
+  SequenceNumber32 beginOfCurrentPacket = startSeq;
 
   while (it != list.end ())
     {
@@ -603,6 +662,18 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
       Ptr<Packet> p = item->m_packet;
       pktSize = p->GetSize ();
 
+      // The segments above this one decide if it is lost, so the pipe is
+      // updated without walking the list again
+      if (m_pipeValid && IsInPipe (item, m_firstByteSeq))
+        {
+          m_pipe -= std::min (offset, pktSize);
+        }
+      if (m_sentIndexValid)
+        {
+          NS_ASSERT (m_sentIndex.begin ()->second == i);
+          m_sentIndex.erase (m_sentIndex.begin ());
+        }
+
       if (offset >= pktSize)
         { // This packet is behind the seqnum. Remove this packet from the buffer
           m_size -= pktSize;
@@ -624,6 +695,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
+          if (m_sentIndexValid)
+            {
+              m_sentIndex.insert (m_sentIndex.begin (), std::make_pair (m_firstByteSeq.Get (), i));
+            }
           NS_LOG_INFO ("Fragmented one packet by size " << offset <<
                        ", new size=" << pktSize);
           break;
@@ -644,6 +719,8 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // have been ACKed. This is, most likely, our wrong guessing
           // when crafting the SACK option for a non-SACK receiver.
           head->m_sacked = false;
+          m_pipeValid = false;
+          m_retransHint = m_firstByteSeq;
         }
     }
 
@@ -665,17 +742,20 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
   bool modified = false;
   TcpOptionSack::SackList::const_iterator option_it;
   NS_LOG_INFO ("Updating scoreboard, got " << list.size () << " blocks to analyze");
+  IndexSentList ();
   for (option_it = list.begin (); option_it != list.end (); ++option_it)
     {
       Ptr<Packet> current;
       TcpTxItem *item;
       const TcpOptionSack::SackBlock b = (*option_it);
 
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+      // The packets which begin before the block can not be mapped over it
+      SentIndex::iterator index_it = m_sentIndex.lower_bound (b.first);
 
-      while (item_it != m_sentList.end ())
+      while (index_it != m_sentIndex.end ())
         {
+          PacketList::iterator item_it = index_it->second;
+          SequenceNumber32 beginOfCurrentPacket = index_it->first;
           item = *item_it;
           current = item->m_packet;
 
@@ -694,6 +774,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
               else
                 {
                   item->m_sacked = true;
+                  m_pipeValid = false;
                   NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
                                ", checking sentList for block " << beginOfCurrentPacket <<
                                ";" << beginOfCurrentPacket + current->GetSize () <<
@@ -717,8 +798,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
               break;
             }
 
-          beginOfCurrentPacket += current->GetSize ();
-          ++item_it;
+          ++index_it;
         }
     }
 
@@ -732,12 +812,6 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq, const PacketList::const_iterat
                      uint32_t dupThresh, uint32_t segmentSize) const
 {
   NS_LOG_FUNCTION (this << seq << dupThresh << segmentSize);
-  uint32_t count = 0;
-  uint32_t bytes = 0;
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  Ptr<const Packet> current;
-  SequenceNumber32 beginOfCurrentPacket = seq;
 
   NS_LOG_INFO ("Checking if seq=" << seq << " is lost from the buffer ");
 
@@ -758,34 +832,14 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq, const PacketList::const_iterat
   // > sequences have arrived above 'seq' or more than (dupThresh - 1) * SMSS bytes
   // > with sequence numbers greater than 'SeqNum' have been SACKed.  Otherwise, the
   // > routine returns false.
-  for (it = segment; it != m_highestSack.first; ++it)
+  UpdatePipe (dupThresh, segmentSize);
+  if (seq < m_lostBoundary)
     {
-      if (beginOfCurrentPacket >= m_highestSack.second)
-        {
-          NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead");
-          return false;
-        }
-
-      item = *it;
-      current = item->m_packet;
-
-      if (item->m_sacked)
-        {
-          NS_LOG_INFO ("Segment [" << beginOfCurrentPacket << ", " <<
-                       beginOfCurrentPacket+item->m_packet->GetSize () <<
-                       "] found to be SACKed");
-          ++count;
-          bytes += current->GetSize ();
-          if ((count >= dupThresh) || (bytes > (dupThresh-1) * segmentSize))
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of 3 sacked blocks ahead");
-              return true;
-            }
-        }
-
-      beginOfCurrentPacket += current->GetSize ();
+      NS_LOG_INFO ("seq=" << seq << " is lost because of " << dupThresh << " sacked blocks ahead");
+      return true;
     }
 
+  NS_LOG_INFO ("seq=" << seq << " is not lost because there are not enough sacked segments ahead");
   return false;
 }
 
@@ -803,8 +857,18 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq, uint32_t dupThresh,
       return false;
     }
 
-  // This O(n) method is called only once, and outside this class.
-  // It should not harm the performance
+  if (m_sentIndexValid)
+    {
+      SentIndex::const_iterator index_it = m_sentIndex.lower_bound (seq);
+      if (index_it == m_sentIndex.end ())
+        {
+          return false;
+        }
+      return IsLost (index_it->first, index_it->second, dupThresh, segmentSize);
+    }
+
+  // The index is rebuilt only by non-const methods; this O(n) walk is done
+  // only after the sent list has been fragmented or merged
   for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
       // Search for the right iterator before calling IsLost()
@@ -839,19 +903,49 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
+  PacketList::const_iterator it = m_sentList.begin ();
   TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
+  bool isHintValid = false;
   SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Skip the segments already retransmitted or SACKed
+  if (m_sentIndexValid && m_retransHint > m_firstByteSeq)
+    {
+      SentIndex::const_iterator index_it = m_sentIndex.lower_bound (m_retransHint);
+      if (index_it != m_sentIndex.end ())
+        {
+          it = index_it->second;
+          beginOfCurrentPkt = index_it->first;
+        }
+      else
+        {
+          it = m_sentList.end ();
+        }
+    }
+
+  UpdatePipe (dupThresh, segmentSize);
+  for (; it != m_sentList.end (); ++it)
     {
       item = *it;
 
+      // Above the lost boundary, only the segments marked as lost by an RTO
+      // can be lost; there are none above m_lostMarkEnd
+      if (beginOfCurrentPkt >= m_lostBoundary && beginOfCurrentPkt >= m_lostMarkEnd
+          && (isSeqPerRule3Valid || !isRecovery))
+        {
+          break;
+        }
+
       // Condition 1.a , 1.b , and 1.c
       if (item->m_retrans == false && item->m_sacked == false)
         {
+          if (!isHintValid)
+            {
+              m_retransHint = beginOfCurrentPkt;
+              isHintValid = true;
+            }
           if (IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
             {
               *seq = beginOfCurrentPkt;
@@ -868,6 +962,11 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
       beginOfCurrentPkt += item->m_packet->GetSize ();
     }
 
+  if (!isHintValid)
+    {
+      m_retransHint = beginOfCurrentPkt;
+    }
+
   /* (2) If no sequence number 'S2' per rule (1) exists but there
    *     exists available unsent data and the receiver's advertised
    *     window allows, the sequence range of one segment of up to SMSS
@@ -910,36 +1009,87 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
 uint32_t
 TcpTxBuffer::BytesInFlight (uint32_t dupThresh, uint32_t segmentSize) const
 {
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  uint32_t size = 0; // "pipe" in RFC
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  UpdatePipe (dupThresh, segmentSize);
+  return m_pipe;
+}
 
-  // After initializing pipe to zero, the following steps are taken for each
-  // octet 'S1' in the sequence space between HighACK and HighData that has not
-  // been SACKed:
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+bool
+TcpTxBuffer::IsInPipe (const TcpTxItem *item, const SequenceNumber32 &seq) const
+{
+  if (item->m_sacked)
     {
-      item = *it;
-      if (!item->m_sacked)
+      return false;
+    }
+  // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
+  // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
+  // (NOTE: we use the m_retrans flag instead of keeping and updating
+  // another variable). Only if the item is not marked as lost
+  return !item->m_lost && (seq >= m_lostBoundary || item->m_retrans);
+}
+
+void
+TcpTxBuffer::UpdatePipe (uint32_t dupThresh, uint32_t segmentSize) const
+{
+  if (m_pipeValid && m_pipeDupThresh == dupThresh && m_pipeSegmentSize == segmentSize)
+    {
+      return;
+    }
+
+  NS_LOG_FUNCTION (this << dupThresh << segmentSize);
+
+  // IsLost (S1) counts the segments SACKed between S1 and the highest SACKed
+  // byte. Walking the sent list backwards, the count only grows: once a
+  // segment is lost, all the segments below it are lost too.
+  PacketList::const_reverse_iterator it;
+  uint32_t count = 0;
+  uint32_t bytes = 0;
+  bool lost = false;
+  SequenceNumber32 endOfCurrentPkt = m_firstByteSeq + m_sentSize;
+
+  m_lostBoundary = endOfCurrentPkt;
+  for (it = m_sentList.rbegin (); it != m_sentList.rend () && !lost; ++it)
+    {
+      const TcpTxItem *item = *it;
+      SequenceNumber32 beginOfCurrentPkt = endOfCurrentPkt - item->m_packet->GetSize ();
+
+      if (beginOfCurrentPkt >= m_highestSack.second)
         {
-          // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
-          if (!IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
+          // No sacked segment ahead
+          m_lostBoundary = beginOfCurrentPkt;
+        }
+      else
+        {
+          if (item->m_sacked)
             {
-              size += item->m_packet->GetSize ();
+              ++count;
+              bytes += item->m_packet->GetSize ();
             }
-          // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
-          // (NOTE: we use the m_retrans flag instead of keeping and updating
-          // another variable). Only if the item is not marked as lost
-          else if (item->m_retrans && !item->m_lost)
+          lost = count > 0 && ((count >= dupThresh) || (bytes > (dupThresh - 1) * segmentSize));
+          if (!lost)
             {
-              size += item->m_packet->GetSize ();
+              m_lostBoundary = beginOfCurrentPkt;
             }
         }
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      endOfCurrentPkt = beginOfCurrentPkt;
     }
 
-  return size;
+  // After initializing pipe to zero, the following steps are taken for each
+  // octet 'S1' in the sequence space between HighACK and HighData that has not
+  // been SACKed
+  m_pipe = 0;
+  m_pipeDupThresh = dupThresh;
+  m_pipeSegmentSize = segmentSize;
+  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  PacketList::const_iterator item_it;
+  for (item_it = m_sentList.begin (); item_it != m_sentList.end (); ++item_it)
+    {
+      if (IsInPipe (*item_it, beginOfCurrentPkt))
+        {
+          m_pipe += (*item_it)->m_packet->GetSize ();
+        }
+      beginOfCurrentPkt += (*item_it)->m_packet->GetSize ();
+    }
+  m_pipeValid = true;
 }
 
 void
@@ -957,6 +1107,8 @@ TcpTxBuffer::ResetScoreboard ()
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_pipeValid = false;
+  m_retransHint = m_firstByteSeq;
 }
 
 void
@@ -988,6 +1140,10 @@ TcpTxBuffer::ResetSentList ()
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_sentIndexValid = false;
+  m_pipeValid = false;
+  m_retransHint = m_firstByteSeq;
+  m_lostMarkEnd = m_firstByteSeq + m_sentSize;
 }
 
 void
@@ -1001,6 +1157,8 @@ TcpTxBuffer::ResetLastSegmentSent ()
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       m_appList.insert (m_appList.begin (), item);
+      m_sentIndexValid = false;
+      m_pipeValid = false;
     }
 }
 
@@ -1015,6 +1173,8 @@ TcpTxBuffer::SetSentListLost ()
     {
       (*it)->m_lost = true;
     }
+  m_pipeValid = false;
+  m_lostMarkEnd = m_firstByteSeq + m_sentSize;
 }
 
 bool
@@ -22,6 +22,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -113,11 +114,20 @@ public:
  * particular, traveling all the sent list each time it is needed to compute
  * the bytes in flight is expensive. We try to overcome the issue by
  * maintaining a pointer to the highest sequence SACKed; in this way, we can
- * avoid traveling all the list in some cases. Another option could be keeping
- * a count of each critical value (e.g., the number of packets sacked).
- * However, this would be different from the algorithms in RFC. There are some
- * other possible improvements; if you wish, take a look and try  to add some
- * earlier exit conditions in the loops.
+ * avoid traveling all the list in some cases.
+ *
+ * With a large window the sent list holds many thousands of segments, so the
+ * items of the sent list are also indexed by their first sequence number. A
+ * SACK block is then mapped on the scoreboard in logarithmic time, and the
+ * same index locates the segments to retransmit. Since IsLost (S) only
+ * depends on the segments SACKed above S, the segments deemed lost by the
+ * SACK information are exactly the ones below a boundary sequence. The
+ * boundary and the "pipe" of RFC 6675 are computed with one walk of the sent
+ * list after the scoreboard changes, and they are kept up to date without
+ * walking the list when new data is sent or cumulatively acknowledged. In this
+ * way BytesInFlight is constant time in the common case, and IsLost is
+ * constant time for each segment, while returning the same values as the
+ * algorithms in the RFC.
  *
  * \see Size
  * \see SizeFromSequence
@@ -438,6 +448,26 @@ private:
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
                                 bool *listEdited) const;
 
+  /**
+   * \brief Get a block (which is returned as Packet) from a list, starting
+   * the search from an item of the list
+   *
+   * \see GetPacketFromList
+   *
+   * \param list List to extract block from
+   * \param startingSeq Starting sequence of the list
+   * \param start First item to look at; it must not begin after requestedSeq
+   * \param startSeq Starting sequence of the item start
+   * \param numBytes Bytes to extract, starting from requestedSeq
+   * \param requestedSeq Requested sequence
+   * \param listEdited output parameter which indicates if the list has been edited
+   * \return the item that contains the right packet
+   */
+  TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
+                                PacketList::iterator start, const SequenceNumber32 &startSeq,
+                                uint32_t numBytes, const SequenceNumber32 &requestedSeq,
+                                bool *listEdited) const;
+
   /**
    * \brief Merge two TcpTxItem
    *
@@ -468,6 +498,30 @@ private:
   std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
   GetHighestSacked () const;
 
+  /**
+   * \brief Rebuild the index of the sent list, if it is not up to date
+   */
+  void IndexSentList ();
+
+  /**
+   * \brief Compute the lost boundary and the pipe, if they are not up to date
+   *
+   * The segments that are not SACKed and begin before m_lostBoundary are lost
+   * per RFC 6675 IsLost ().
+   *
+   * \param dupThresh dupAck threshold
+   * \param segmentSize segment size
+   */
+  void UpdatePipe (uint32_t dupThresh, uint32_t segmentSize) const;
+
+  /**
+   * \brief Check if an item counts in the pipe, given an up to date lost boundary
+   * \param item item of the sent list
+   * \param seq first sequence number of the item
+   * \return true if the bytes of the item are in flight
+   */
+  bool IsInPipe (const TcpTxItem *item, const SequenceNumber32 &seq) const;
+
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
@@ -478,6 +532,19 @@ private:
 
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< Items of the sent list by first sequence
+
+  SentIndex m_sentIndex;   //!< Index of the sent list
+  bool m_sentIndexValid;   //!< True if m_sentIndex matches the sent list
+
+  mutable bool m_pipeValid;                  //!< True if m_pipe and m_lostBoundary are up to date
+  mutable uint32_t m_pipe;                   //!< Bytes in flight ("pipe" in RFC 6675)
+  mutable SequenceNumber32 m_lostBoundary;   //!< Unsacked segments below are lost
+  mutable uint32_t m_pipeDupThresh;          //!< dupAck threshold used for m_pipe
+  mutable uint32_t m_pipeSegmentSize;        //!< Segment size used for m_pipe
+  mutable SequenceNumber32 m_retransHint;    //!< Segments below are retransmitted or SACKed
+  SequenceNumber32 m_lostMarkEnd;            //!< No segment above is marked as lost
+
 };
 
 /**
@@ -99,9 +99,13 @@ UdpL4Protocol::NotifyNewAggregate ()
       if ((node != 0) && (ipv4 != 0 || ipv6 != 0))
         {
           this->SetNode (node);
-          Ptr<UdpSocketFactoryImpl> udpFactory = CreateObject<UdpSocketFactoryImpl> ();
-          udpFactory->SetUdp (this);
-          node->AggregateObject (udpFactory);
+          // A lazy socket factory may already be there, creating this protocol
+          if (node->GetObject<UdpSocketFactory> () == 0)
+            {
+              Ptr<UdpSocketFactoryImpl> udpFactory = CreateObject<UdpSocketFactoryImpl> ();
+              udpFactory->SetUdp (this);
+              node->AggregateObject (udpFactory);
+            }
         }
     }
   
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups and the allocations of Ipv4EndPointDemux.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check Ipv4EndPointDemux lookups and allocations")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("/24")));
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4EndPointDemux::EndPoints found;
+
+  Ipv4EndPoint *listener = demux.Allocate (80);
+  Ipv4EndPoint *bound = demux.Allocate (local, 80);
+  Ipv4EndPoint *connection = demux.Allocate (local, 80, peer, 1000);
+  NS_TEST_EXPECT_MSG_EQ ((demux.Allocate (local, 80) == 0), true, "The local address and port are in use");
+  NS_TEST_EXPECT_MSG_EQ ((demux.Allocate (local, 80, peer, 1000) == 0), true, "The four-tuple is in use");
+
+  // The most exact match is returned
+  found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match the connection");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connection, "The connection should match exactly");
+  found = demux.Lookup (local, 80, Ipv4Address ("10.0.0.3"), 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match another peer");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), bound, "The endpoint bound to the address should match");
+  found = demux.Lookup (Ipv4Address ("10.0.0.9"), 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match another address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "The endpoint bound to any address should match");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1000), connection, "SimpleLookup should find the connection");
+
+  // Wildcard matches are returned in the order in which they were added
+  Ipv4EndPoint *subnet = demux.Allocate (Ipv4Address ("10.0.0.0"), 5000);
+  Ipv4EndPoint *any = demux.Allocate (5000);
+  found = demux.Lookup (Ipv4Address ("10.0.0.255"), 5000, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 2, "Two endpoints should match the subnet broadcast");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), subnet, "The subnet endpoint was added first");
+  NS_TEST_EXPECT_MSG_EQ (found.back (), any, "The any endpoint was added last");
+
+  // The endpoints stay indexed when their four-tuple changes
+  Ipv4EndPoint *client = demux.Allocate ();
+  NS_TEST_EXPECT_MSG_EQ (client->GetLocalPort (), 49153, "The first ephemeral port is 49153");
+  client->SetLocalAddress (local);
+  client->SetPeer (peer, 22);
+  found = demux.Lookup (local, 49153, peer, 22, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match the client");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), client, "The client should match after its peer is set");
+  found = demux.Lookup (local, 49153, peer, 23, interface);
+  NS_TEST_EXPECT_MSG_EQ (found.size (), 0, "The client should not match another peer port");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (local, 49153), true, "The client address and port are in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (Ipv4Address::GetAny (), 49153), false, "The client is no longer bound to any address");
+
+  // Ports in use are skipped by the ephemeral port allocation
+  demux.Allocate (49154);
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate ()->GetLocalPort (), 49155, "The ephemeral port in use should be skipped");
+
+  demux.DeAllocate (connection);
+  found = demux.Lookup (local, 80, peer, 1000, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match after the connection is removed");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), bound, "The bound endpoint should match after the connection is removed");
+  demux.DeAllocate (bound);
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 is no longer in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 5, "Five endpoints should remain");
+
+  // Many connections to the same port
+  std::vector<Ipv4EndPoint *> connections;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      connections.push_back (demux.Allocate (local, 80, Ipv4Address (0x0b000000 + i / 10), 1024 + i));
+    }
+  bool exact = true;
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      found = demux.Lookup (local, 80, Ipv4Address (0x0b000000 + i / 10), 1024 + i, interface);
+      exact = exact && found.size () == 1 && found.front () == connections[i];
+    }
+  NS_TEST_EXPECT_MSG_EQ (exact, true, "Each connection should match exactly");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lookups and the allocations of Ipv6EndPointDemux.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check Ipv6EndPointDemux lookups and allocations")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ipv6Address local ("2001:db8::1");
+  Ipv6Address peer ("2001:db8::2");
+  Ipv6EndPointDemux::EndPoints found;
+
+  Ipv6EndPoint *listener = demux.Allocate (80);
+  Ipv6EndPoint *bound = demux.Allocate (local, 80);
+  Ipv6EndPoint *connection = demux.Allocate (local, 80, peer, 1000);
+  NS_TEST_EXPECT_MSG_EQ ((demux.Allocate (local, 80) == 0), true, "The local address and port are in use");
+  NS_TEST_EXPECT_MSG_EQ ((demux.Allocate (local, 80, peer, 1000) == 0), true, "The four-tuple is in use");
+
+  found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match the connection");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connection, "The connection should match exactly");
+  found = demux.Lookup (local, 80, Ipv6Address ("2001:db8::3"), 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match another peer");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), bound, "The endpoint bound to the address should match");
+  found = demux.Lookup (Ipv6Address ("2001:db8::9"), 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match another address");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "The endpoint bound to any address should match");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1000), connection, "SimpleLookup should find the connection");
+
+  Ipv6EndPoint *client = demux.Allocate ();
+  NS_TEST_EXPECT_MSG_EQ (client->GetLocalPort (), 49153, "The first ephemeral port is 49153");
+  client->SetLocalAddress (local);
+  client->SetPeer (peer, 22);
+  found = demux.Lookup (local, 49153, peer, 22, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match the client");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), client, "The client should match after its peer is set");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (Ipv6Address::GetAny (), 49153), false, "The client is no longer bound to any address");
+
+  demux.Allocate (49154);
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate ()->GetLocalPort (), 49155, "The ephemeral port in use should be skipped");
+
+  demux.DeAllocate (connection);
+  found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "One endpoint should match after the connection is removed");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), bound, "The bound endpoint should match after the connection is removed");
+  demux.DeAllocate (bound);
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 is no longer in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 3, "Three endpoints should remain");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/socket.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the lazy install of the transport protocols.
+ *
+ * The protocols of a node are created by its first socket of the matching
+ * type, and a datagram goes through the lazily created UDP protocols.
+ */
+class InternetStackHelperLazyTestCase : public TestCase
+{
+public:
+  InternetStackHelperLazyTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive a datagram
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  uint32_t m_received; //!< Number of datagrams received
+};
+
+InternetStackHelperLazyTestCase::InternetStackHelperLazyTestCase ()
+  : TestCase ("Check the lazy install of the transport protocols"),
+    m_received (0)
+{
+}
+
+void
+InternetStackHelperLazyTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+InternetStackHelperLazyTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetLazyTransportInstall (true);
+  internet.Install (nodes);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_NE (nodes.Get (i)->GetObject<UdpSocketFactory> (), 0, "A UDP socket factory should be installed");
+      NS_TEST_EXPECT_MSG_NE (nodes.Get (i)->GetObject<TcpSocketFactory> (), 0, "A TCP socket factory should be installed");
+      NS_TEST_EXPECT_MSG_EQ (nodes.Get (i)->GetObject<UdpL4Protocol> (), 0, "UDP should not be created yet");
+      NS_TEST_EXPECT_MSG_EQ (nodes.Get (i)->GetObject<TcpL4Protocol> (), 0, "TCP should not be created yet");
+    }
+
+  uint16_t port = 9;
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  sink->SetRecvCallback (MakeCallback (&InternetStackHelperLazyTestCase::Receive, this));
+  Ptr<UdpL4Protocol> udp = nodes.Get (1)->GetObject<UdpL4Protocol> ();
+  NS_TEST_EXPECT_MSG_NE (udp, 0, "The first UDP socket should create UDP");
+  NS_TEST_EXPECT_MSG_EQ (nodes.Get (1)->GetObject<TcpL4Protocol> (), 0, "A UDP socket should not create TCP");
+  NS_TEST_EXPECT_MSG_EQ (nodes.Get (0)->GetObject<UdpL4Protocol> (), 0, "UDP should be created on the socket node only");
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  source->Connect (InetSocketAddress (interfaces.GetAddress (1), port));
+  source->Send (Create<Packet> (100));
+
+  Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  NS_TEST_EXPECT_MSG_EQ (nodes.Get (1)->GetObject<UdpL4Protocol> (), udp, "The next UDP sockets should use the same UDP");
+  Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  NS_TEST_EXPECT_MSG_NE (nodes.Get (1)->GetObject<TcpL4Protocol> (), 0, "The first TCP socket should create TCP");
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 1, "The datagram should be received");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the memory footprint report of InternetStackHelper.
+ */
+class InternetStackHelperFootprintTestCase : public TestCase
+{
+public:
+  InternetStackHelperFootprintTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Sum the footprint of all the components
+   * \param footprint the footprint by component
+   * \returns the total footprint
+   */
+  static uint32_t Total (const std::map<std::string, uint32_t> &footprint);
+};
+
+InternetStackHelperFootprintTestCase::InternetStackHelperFootprintTestCase ()
+  : TestCase ("Check the memory footprint report")
+{
+}
+
+uint32_t
+InternetStackHelperFootprintTestCase::Total (const std::map<std::string, uint32_t> &footprint)
+{
+  uint32_t total = 0;
+  for (std::map<std::string, uint32_t>::const_iterator it = footprint.begin (); it != footprint.end (); it++)
+    {
+      total += it->second;
+    }
+  return total;
+}
+
+void
+InternetStackHelperFootprintTestCase::DoRun (void)
+{
+  Ptr<Node> full = CreateObject<Node> ();
+  Ptr<Node> lazy = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (full);
+  internet.SetLazyTransportInstall (true);
+  internet.Install (lazy);
+
+  std::map<std::string, uint32_t> fullFootprint = InternetStackHelper::GetMemoryFootprint (full);
+  std::map<std::string, uint32_t> lazyFootprint = InternetStackHelper::GetMemoryFootprint (lazy);
+
+  NS_TEST_EXPECT_MSG_EQ (fullFootprint.count ("ns3::Node"), 0, "The node should not be a component");
+  NS_TEST_EXPECT_MSG_EQ (fullFootprint.count ("ns3::UdpL4Protocol"), 1, "UDP should be reported");
+  NS_TEST_EXPECT_MSG_EQ (fullFootprint.count ("ns3::TcpL4Protocol"), 1, "TCP should be reported");
+  NS_TEST_EXPECT_MSG_EQ (lazyFootprint.count ("ns3::UdpL4Protocol"), 0, "UDP should not be reported");
+  NS_TEST_EXPECT_MSG_EQ (lazyFootprint.count ("ns3::LazyUdpSocketFactory"), 1, "The lazy factory should be reported");
+  // the loopback interface and its ARP cache belong to IPv4
+  NS_TEST_EXPECT_MSG_GT (fullFootprint["ns3::Ipv4L3Protocol"], Ipv4L3Protocol::GetTypeId ().GetSize (),
+                         "The IPv4 interfaces should be counted");
+  NS_TEST_EXPECT_MSG_LT (Total (lazyFootprint), Total (fullFootprint), "The lazy install should be smaller");
+
+  Socket::CreateSocket (lazy, UdpSocketFactory::GetTypeId ());
+  lazyFootprint = InternetStackHelper::GetMemoryFootprint (lazy);
+  NS_TEST_EXPECT_MSG_EQ (lazyFootprint.count ("ns3::UdpL4Protocol"), 1, "UDP should be reported once created");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief InternetStackHelper TestSuite
+ */
+class InternetStackHelperTestSuite : public TestSuite
+{
+public:
+  InternetStackHelperTestSuite ();
+};
+
+InternetStackHelperTestSuite::InternetStackHelperTestSuite ()
+  : TestSuite ("internet-stack-helper", UNIT)
+{
+  AddTestCase (new InternetStackHelperLazyTestCase, TestCase::QUICK);
+  AddTestCase (new InternetStackHelperFootprintTestCase, TestCase::QUICK);
+}
+
+static InternetStackHelperTestSuite g_internetStackHelperTestSuite; //!< Static variable for test initialization
@@ -332,6 +332,64 @@ AddressCollisionTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 address range collision Test
+ */
+class AddressRangeCollisionTestCase : public TestCase
+{
+public:
+  AddressRangeCollisionTestCase ();
+private:
+  void DoRun (void);
+  void DoTeardown (void);
+};
+
+AddressRangeCollisionTestCase::AddressRangeCollisionTestCase ()
+  : TestCase ("Make sure that the address range collision logic works.")
+{
+}
+
+void
+AddressRangeCollisionTestCase::DoTeardown (void)
+{
+  Ipv4AddressGenerator::Reset ();
+  Simulator::Destroy ();
+}
+void
+AddressRangeCollisionTestCase::DoRun (void)
+{
+  Ipv4AddressGenerator::TestMode ();
+  bool added = Ipv4AddressGenerator::AddAllocated ("0.0.0.10", "0.0.0.19");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "range should get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.30", "0.0.0.39");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "range should get allocated");
+
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.5", "0.0.0.10");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "range overlapping the start of a block should not get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.19", "0.0.0.25");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "range overlapping the end of a block should not get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.1", "0.0.0.50");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "range covering blocks should not get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.15");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "address in a block should not get allocated");
+
+  // fill the gap between the two blocks, which are merged
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.20", "0.0.0.29");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "range between blocks should get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.25");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "address in the merged block should not get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.9");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "address before the merged block should get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.40");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "address after the merged block should get allocated");
+  added = Ipv4AddressGenerator::AddAllocated ("0.0.0.9", "0.0.0.40");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "merged block should not get allocated again");
+}
+
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -353,6 +411,7 @@ Ipv4AddressGeneratorTestSuite::Ipv4AddressGeneratorTestSuite ()
   AddTestCase (new NetworkAndAddressTestCase (), TestCase::QUICK);
   AddTestCase (new ExampleAddressGeneratorTestCase (), TestCase::QUICK);
   AddTestCase (new AddressCollisionTestCase (), TestCase::QUICK);
+  AddTestCase (new AddressRangeCollisionTestCase (), TestCase::QUICK);
 }
 
 static Ipv4AddressGeneratorTestSuite g_ipv4AddressGeneratorTestSuite; //!< Static variable for test initialization
@@ -15,6 +15,8 @@
  */
 
 #include <vector>
+#include <algorithm>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -41,6 +43,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
 #include "ns3/bridge-helper.h"
 
 using namespace ns3;
@@ -1244,6 +1247,355 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the parallel and the incremental SPF calculations
+ * build the same routes as the sequential one.
+ */
+class Ipv4GlobalRoutingSpfTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingSpfTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the routes of the global routing tables of the nodes.
+   * \param sorted whether to sort the routes of each node
+   * \returns the routes, one string per route, node by node
+   */
+  std::vector<std::vector<std::string> > GetRoutes (bool sorted) const;
+
+  /**
+   * \brief Recompute the routes, incrementally and from scratch, and check
+   * that both give the same routes.
+   * \param change a description of the topology change
+   */
+  void CheckRecompute (std::string change);
+
+  NodeContainer m_nodes; //!< the nodes
+};
+
+Ipv4GlobalRoutingSpfTestCase::Ipv4GlobalRoutingSpfTestCase ()
+  : TestCase ("Parallel and incremental SPF calculations")
+{
+}
+
+std::vector<std::vector<std::string> >
+Ipv4GlobalRoutingSpfTestCase::GetRoutes (bool sorted) const
+{
+  std::vector<std::vector<std::string> > routes;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<GlobalRouter> router = m_nodes.Get (i)->GetObject<GlobalRouter> ();
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      std::vector<std::string> table;
+      for (uint32_t j = 0; j < gr->GetNRoutes (); j++)
+        {
+          std::ostringstream oss;
+          oss << *gr->GetRoute (j);
+          table.push_back (oss.str ());
+        }
+      if (sorted)
+        {
+          std::sort (table.begin (), table.end ());
+        }
+      routes.push_back (table);
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingSpfTestCase::CheckRecompute (std::string change)
+{
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (true));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::vector<std::string> > incremental = GetRoutes (true);
+
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (false));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::vector<std::string> > full = GetRoutes (true);
+  for (uint32_t i = 0; i < full.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((incremental[i] == full[i]), true,
+                             "Incremental SPF differs on node " << i << " after " << change);
+    }
+
+  // Keep the SPF trees of the new topology for the next change
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (true));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+}
+
+// Test program for this topology, with equal and unequal cost paths:
+//
+//   4x4 grid of routers n0..n15, linked by point-to-point links
+//   n15 with an extra /32 address on an interface without channel
+//   n16, n17 and n19 on a LAN, and n17-n19 on a point-to-point link
+//   n18, a stub router linked to n16
+//
+// The global route manager does not support equal cost paths to a LAN
+// which is not adjacent to the root, hence the LAN is not linked to the
+// grid.
+//
+void
+Ipv4GlobalRoutingSpfTestCase::DoRun (void)
+{
+  m_nodes.Create (20);
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<NetDeviceContainer> links;
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      if (i % 4 != 3)
+        {
+          links.push_back (p2pHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get (i + 1))));
+        }
+      if (i < 12)
+        {
+          links.push_back (p2pHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get (i + 4))));
+        }
+    }
+  links.push_back (p2pHelper.Install (NodeContainer (m_nodes.Get (16), m_nodes.Get (18))));
+  links.push_back (p2pHelper.Install (NodeContainer (m_nodes.Get (17), m_nodes.Get (19))));
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      ipv4.Assign (links[i]);
+      ipv4.NewNetwork ();
+    }
+
+  SimpleNetDeviceHelper lanHelper;
+  NetDeviceContainer lan = lanHelper.Install (NodeContainer (m_nodes.Get (16), m_nodes.Get (17), m_nodes.Get (19)));
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  ipv4.Assign (lan);
+
+  Ptr<SimpleNetDevice> stubDevice = CreateObject<SimpleNetDevice> ();
+  stubDevice->SetAddress (Mac48Address::Allocate ());
+  m_nodes.Get (15)->AddDevice (stubDevice);
+  Ptr<Ipv4> ipv4Stub = m_nodes.Get (15)->GetObject<Ipv4> ();
+  int32_t stubIf = ipv4Stub->AddInterface (stubDevice);
+  ipv4Stub->AddAddress (stubIf, Ipv4InterfaceAddress (Ipv4Address ("172.16.1.1"), Ipv4Mask ("/32")));
+  ipv4Stub->SetUp (stubIf);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::vector<std::string> > sequential = GetRoutes (false);
+
+  // The parallel calculation installs the same routes, in the same order
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::vector<std::string> > parallel = GetRoutes (false);
+  for (uint32_t i = 0; i < sequential.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((parallel[i] == sequential[i]), true,
+                             "Parallel SPF differs on node " << i);
+    }
+  NS_TEST_EXPECT_MSG_GT (sequential[7].size (), 20, "Node 7 should have routes to all the networks");
+
+  // Keep the SPF trees, then change the topology
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (true));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+
+  ipv4Stub->RemoveAddress (stubIf, 0);
+  ipv4Stub->AddAddress (stubIf, Ipv4InterfaceAddress (Ipv4Address ("172.16.2.1"), Ipv4Mask ("/24")));
+  CheckRecompute ("the address of a stub interface is changed");
+
+  Ptr<Ipv4> ipv4n6 = m_nodes.Get (6)->GetObject<Ipv4> ();
+  ipv4n6->SetMetric (2, 3);
+  CheckRecompute ("a metric is changed");
+
+  Ptr<Ipv4> ipv4n5 = m_nodes.Get (5)->GetObject<Ipv4> ();
+  ipv4n5->SetDown (2);
+  CheckRecompute ("a link goes down");
+
+  Ptr<Ipv4> ipv4n17 = m_nodes.Get (17)->GetObject<Ipv4> ();
+  ipv4n17->SetDown (2);
+  CheckRecompute ("a router leaves the LAN");
+
+  Ptr<Ipv4> ipv4n16 = m_nodes.Get (16)->GetObject<Ipv4> ();
+  ipv4n16->SetMetric (1, 5);
+  CheckRecompute ("the metric towards a stub router is changed");
+
+  ipv4n5->SetUp (2);
+  ipv4n17->SetUp (2);
+  ipv4Stub->SetDown (stubIf);
+  CheckRecompute ("links go up and a stub interface goes down");
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (false));
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the compact route storage gives the same routes as the
+ * default one, and that it aggregates host routes.
+ */
+class Ipv4GlobalRoutingCompactTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingCompactTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Build a grid of routers, populate their routing tables and look
+   * up the routes from each router to each address.
+   * \param compact whether to use the compact route storage
+   * \param bytes [out] the memory used by the routes of all the routers
+   * \returns the gateway and the interface of each route, router by router
+   */
+  std::vector<std::string> GetGridRoutes (bool compact, uint64_t &bytes);
+};
+
+Ipv4GlobalRoutingCompactTestCase::Ipv4GlobalRoutingCompactTestCase ()
+  : TestCase ("Compact global route storage")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingCompactTestCase::GetGridRoutes (bool compact, uint64_t &bytes)
+{
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::CompactRoutes", BooleanValue (compact));
+  NodeContainer nodes;
+  nodes.Create (16);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      if (i % 4 != 3)
+        {
+          ipv4.Assign (p2pHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (i + 1))));
+          ipv4.NewNetwork ();
+        }
+      if (i < 12)
+        {
+          ipv4.Assign (p2pHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (i + 4))));
+          ipv4.NewNetwork ();
+        }
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  std::vector<Ipv4Address> addresses;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4> ip = nodes.Get (i)->GetObject<Ipv4> ();
+      for (uint32_t j = 1; j < ip->GetNInterfaces (); j++)
+        {
+          addresses.push_back (ip->GetAddress (j, 0).GetLocal ());
+        }
+    }
+
+  std::vector<std::string> routes;
+  bytes = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      bytes += gr->GetMemoryUsage ();
+      for (uint32_t j = 0; j < addresses.size (); j++)
+        {
+          Ipv4Header header;
+          header.SetDestination (addresses[j]);
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> route = gr->RouteOutput (Create<Packet> (), header, 0, sockerr);
+          std::ostringstream oss;
+          oss << i << " " << addresses[j];
+          if (route)
+            {
+              oss << " " << route->GetGateway () << " " << route->GetOutputDevice ()->GetIfIndex ();
+            }
+          routes.push_back (oss.str ());
+        }
+    }
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::CompactRoutes", BooleanValue (false));
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingCompactTestCase::DoRun (void)
+{
+  uint64_t defaultBytes;
+  uint64_t compactBytes;
+  std::vector<std::string> defaultRoutes = GetGridRoutes (false, defaultBytes);
+  std::vector<std::string> compactRoutes = GetGridRoutes (true, compactBytes);
+  NS_TEST_ASSERT_MSG_EQ (compactRoutes.size (), defaultRoutes.size (), "Both grids should have the same addresses");
+  for (uint32_t i = 0; i < defaultRoutes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (compactRoutes[i], defaultRoutes[i], "The compact storage gives another route");
+    }
+  NS_TEST_EXPECT_MSG_LT (compactBytes, defaultBytes, "The compact storage should use less memory");
+
+  //
+  // Host routes to a whole /24 with the same next hop are aggregated, and
+  // split again when one of them is removed.
+  //
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t interface = ipv4->AddInterface (device);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address ("192.168.0.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (interface);
+
+  Ptr<Ipv4GlobalRouting> gr = CreateObject<Ipv4GlobalRouting> ();
+  gr->SetAttribute ("CompactRoutes", BooleanValue (true));
+  gr->SetIpv4 (ipv4);
+  Ipv4Address gateway ("192.168.0.2");
+  for (uint32_t i = 0; i < 256; i++)
+    {
+      gr->AddHostRouteTo (Ipv4Address (Ipv4Address ("10.0.0.0").Get () + i), gateway, interface);
+    }
+  gr->AddHostRouteTo (Ipv4Address ("10.0.1.5"), Ipv4Address ("192.168.0.3"), interface);
+  NS_TEST_EXPECT_MSG_EQ (gr->GetNRoutes (), 2, "The host routes to 10.0.0.0/24 should be aggregated");
+  NS_TEST_EXPECT_MSG_EQ (gr->GetRoute (0)->GetDestNetworkMask ().GetPrefixLength (), 24, "The aggregated route should be to a /24");
+
+  Ipv4Header header;
+  Socket::SocketErrno sockerr;
+  header.SetDestination (Ipv4Address ("10.0.0.77"));
+  Ptr<Ipv4Route> route = gr->RouteOutput (Create<Packet> (), header, 0, sockerr);
+  NS_TEST_ASSERT_MSG_EQ ((route != 0), true, "There should be a route to 10.0.0.77");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gateway, "The route to 10.0.0.77 should be through 192.168.0.2");
+  NS_TEST_EXPECT_MSG_EQ (route->GetDestination (), Ipv4Address ("10.0.0.77"), "The route should be to the host");
+  header.SetDestination (Ipv4Address ("10.0.1.6"));
+  NS_TEST_EXPECT_MSG_EQ ((gr->RouteOutput (Create<Packet> (), header, 0, sockerr) == 0), true, "There should be no route to 10.0.1.6");
+
+  NS_TEST_EXPECT_MSG_EQ (gr->RemoveHostRouteTo (Ipv4Address ("10.0.0.77"), Ipv4Address ("192.168.0.3"), interface),
+                         false, "There is no route to 10.0.0.77 through 192.168.0.3");
+  NS_TEST_EXPECT_MSG_EQ (gr->RemoveHostRouteTo (Ipv4Address ("10.0.0.77"), gateway, interface),
+                         true, "The route to 10.0.0.77 should be removed");
+  NS_TEST_EXPECT_MSG_EQ (gr->GetNRoutes (), 9, "The /24 should be split in 8 prefixes, besides the route to 10.0.1.5");
+  header.SetDestination (Ipv4Address ("10.0.0.77"));
+  NS_TEST_EXPECT_MSG_EQ ((gr->RouteOutput (Create<Packet> (), header, 0, sockerr) == 0), true, "There should be no route to 10.0.0.77");
+  header.SetDestination (Ipv4Address ("10.0.0.78"));
+  NS_TEST_EXPECT_MSG_EQ ((gr->RouteOutput (Create<Packet> (), header, 0, sockerr) != 0), true, "There should be a route to 10.0.0.78");
+
+  gr->AddHostRouteTo (Ipv4Address ("10.0.0.77"), gateway, interface);
+  NS_TEST_EXPECT_MSG_EQ (gr->GetNRoutes (), 2, "The host routes to 10.0.0.0/24 should be aggregated again");
+  gr->RemoveAllRoutes ();
+  NS_TEST_EXPECT_MSG_EQ (gr->GetNRoutes (), 0, "There should be no route left");
+
+  gr->Dispose ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1619,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingSpfTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingCompactTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -303,6 +303,64 @@ AddressCollision6TestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 address range collision Test
+ */
+class AddressRangeCollision6TestCase : public TestCase
+{
+public:
+  AddressRangeCollision6TestCase ();
+private:
+  void DoRun (void);
+  void DoTeardown (void);
+};
+
+AddressRangeCollision6TestCase::AddressRangeCollision6TestCase ()
+  : TestCase ("Make sure that the address range collision logic works.")
+{
+}
+
+void
+AddressRangeCollision6TestCase::DoTeardown (void)
+{
+  Ipv6AddressGenerator::Reset ();
+  Simulator::Destroy ();
+}
+void
+AddressRangeCollision6TestCase::DoRun (void)
+{
+  Ipv6AddressGenerator::TestMode ();
+  bool added = Ipv6AddressGenerator::AddAllocated ("0::0:10", "0::0:19");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "range should get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:30", "0::0:39");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "range should get allocated");
+
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:5", "0::0:10");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "range overlapping the start of a block should not get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:19", "0::0:25");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "range overlapping the end of a block should not get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:1", "0::0:50");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "range covering blocks should not get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:15");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "address in a block should not get allocated");
+
+  // fill the gap between the two blocks, which are merged
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:20", "0::0:29");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "range between blocks should get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:25");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "address in the merged block should not get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:9");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "address before the merged block should get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:40");
+  NS_TEST_EXPECT_MSG_EQ (added, true, "address after the merged block should get allocated");
+  added = Ipv6AddressGenerator::AddAllocated ("0::0:9", "0::0:40");
+  NS_TEST_EXPECT_MSG_EQ (added, false, "merged block should not get allocated again");
+}
+
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -320,6 +378,7 @@ public:
     AddTestCase (new NetworkAndAddress6TestCase (), TestCase::QUICK);
     AddTestCase (new ExampleAddress6GeneratorTestCase (), TestCase::QUICK);
     AddTestCase (new AddressCollision6TestCase (), TestCase::QUICK);
+    AddTestCase (new AddressRangeCollision6TestCase (), TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/socket.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ndisc-cache.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that NeighborCacheHelper removes address resolution.
+ *
+ * Three nodes share a link.  One of them sends a datagram to each of the
+ * other ones.  With populated caches, the datagrams take only the channel
+ * delay and no ARP frame is exchanged; otherwise, the addresses are
+ * resolved first.
+ */
+class NeighborCacheTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param ipv6 whether to use IPv6 instead of IPv4
+   * \param populate whether to populate the neighbor caches
+   */
+  NeighborCacheTestCase (bool ipv6, bool populate);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send a datagram to each destination
+   * \param socket the sending socket
+   * \param destinations the destinations
+   */
+  void Send (Ptr<Socket> socket, std::vector<Address> destinations);
+  /**
+   * \brief Receive a datagram
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Count an ARP frame
+   * \param device the receiving device
+   * \param packet the frame
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \param to the destination address
+   * \param type the packet type
+   */
+  void ArpReceived (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                    const Address &from, const Address &to, NetDevice::PacketType type);
+
+  bool m_ipv6;          //!< Use IPv6
+  bool m_populate;      //!< Populate the neighbor caches
+  Time m_sendTime;      //!< Time the datagrams are sent
+  Time m_maxDelay;      //!< Largest delay of the datagrams
+  uint32_t m_received;  //!< Number of datagrams received
+  uint32_t m_arpFrames; //!< Number of ARP frames received
+};
+
+NeighborCacheTestCase::NeighborCacheTestCase (bool ipv6, bool populate)
+  : TestCase (std::string ("Check ") + (ipv6 ? "IPv6" : "IPv4")
+              + (populate ? " with populated neighbor caches" : " with address resolution")),
+    m_ipv6 (ipv6),
+    m_populate (populate),
+    m_received (0),
+    m_arpFrames (0)
+{
+}
+
+void
+NeighborCacheTestCase::Send (Ptr<Socket> socket, std::vector<Address> destinations)
+{
+  for (std::vector<Address>::iterator it = destinations.begin (); it != destinations.end (); it++)
+    {
+      socket->SendTo (Create<Packet> (100), 0, *it);
+    }
+}
+
+void
+NeighborCacheTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+      m_maxDelay = Max (m_maxDelay, Simulator::Now () - m_sendTime);
+    }
+}
+
+void
+NeighborCacheTestCase::ArpReceived (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                    const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  m_arpFrames++;
+}
+
+void
+NeighborCacheTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&NeighborCacheTestCase::ArpReceived, this),
+                                              ArpL3Protocol::PROT_NUMBER, device);
+    }
+
+  std::vector<Address> destinations;
+  uint16_t port = 9;
+  if (m_ipv6)
+    {
+      Ipv6AddressHelper address;
+      address.SetBase (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (devices);
+      for (uint32_t i = 1; i < nodes.GetN (); i++)
+        {
+          destinations.push_back (Inet6SocketAddress (interfaces.GetAddress (i, 1), port));
+        }
+    }
+  else
+    {
+      Ipv4AddressHelper address;
+      address.SetBase ("10.0.0.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      for (uint32_t i = 1; i < nodes.GetN (); i++)
+        {
+          destinations.push_back (InetSocketAddress (interfaces.GetAddress (i), port));
+        }
+    }
+
+  if (m_populate)
+    {
+      NeighborCacheHelper neighborCache;
+      neighborCache.PopulateNeighborCache ();
+
+      if (m_ipv6)
+        {
+          Ptr<Ipv6L3Protocol> ipv6 = nodes.Get (0)->GetObject<Ipv6L3Protocol> ();
+          Ptr<NdiscCache> cache = ipv6->GetInterface (1)->GetNdiscCache ();
+          Ipv6Address neighbor = Inet6SocketAddress::ConvertFrom (destinations[0]).GetIpv6 ();
+          NS_TEST_ASSERT_MSG_NE (cache->Lookup (neighbor), 0, "The neighbor should be in the cache");
+          NS_TEST_EXPECT_MSG_EQ (cache->Lookup (neighbor)->IsPermanent (), true, "The entry should be permanent");
+          NS_TEST_EXPECT_MSG_EQ (cache->Lookup (neighbor)->GetMacAddress (), devices.Get (1)->GetAddress (), "Wrong MAC address");
+        }
+      else
+        {
+          Ptr<Ipv4L3Protocol> ipv4 = nodes.Get (0)->GetObject<Ipv4L3Protocol> ();
+          Ptr<ArpCache> cache = ipv4->GetInterface (1)->GetArpCache ();
+          Ipv4Address neighbor = InetSocketAddress::ConvertFrom (destinations[0]).GetIpv4 ();
+          NS_TEST_ASSERT_MSG_NE (cache->Lookup (neighbor), 0, "The neighbor should be in the cache");
+          NS_TEST_EXPECT_MSG_EQ (cache->Lookup (neighbor)->IsPermanent (), true, "The entry should be permanent");
+          NS_TEST_EXPECT_MSG_EQ (cache->Lookup (neighbor)->GetMacAddress (), devices.Get (1)->GetAddress (), "Wrong MAC address");
+        }
+    }
+
+  for (uint32_t i = 1; i < nodes.GetN (); i++)
+    {
+      Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (i), UdpSocketFactory::GetTypeId ());
+      if (m_ipv6)
+        {
+          sink->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), port));
+        }
+      else
+        {
+          sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+        }
+      sink->SetRecvCallback (MakeCallback (&NeighborCacheTestCase::Receive, this));
+    }
+
+  // IPv6 addresses are usable once duplicate address detection is over
+  m_sendTime = Seconds (5);
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  Simulator::Schedule (m_sendTime, &NeighborCacheTestCase::Send, this, source, destinations);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, destinations.size (), "All the datagrams should be received");
+  if (m_populate)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_maxDelay, MilliSeconds (1), "The datagrams should only take the channel delay");
+      NS_TEST_EXPECT_MSG_EQ (m_arpFrames, 0, "No ARP frame should be exchanged");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_GT (m_maxDelay, MilliSeconds (1), "The addresses should be resolved first");
+      if (!m_ipv6)
+        {
+          NS_TEST_EXPECT_MSG_GT (m_arpFrames, 0, "ARP frames should be exchanged");
+        }
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief NeighborCacheHelper TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite ();
+};
+
+NeighborCacheTestSuite::NeighborCacheTestSuite ()
+  : TestSuite ("neighbor-cache", UNIT)
+{
+  AddTestCase (new NeighborCacheTestCase (false, true), TestCase::QUICK);
+  AddTestCase (new NeighborCacheTestCase (false, false), TestCase::QUICK);
+  AddTestCase (new NeighborCacheTestCase (true, true), TestCase::QUICK);
+  AddTestCase (new NeighborCacheTestCase (true, false), TestCase::QUICK);
+}
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,359 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Compare PrefixTrie lookups with a linear scan of the prefixes.
+ */
+class PrefixTrieTestCase : public TestCase
+{
+public:
+  /**
+   * \param bits the length of the addresses, 32 or 128
+   */
+  PrefixTrieTestCase (uint8_t bits);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param prefix a prefix
+   * \param length the length of the prefix
+   * \param address an address
+   * \return true if the address matches the prefix
+   */
+  static bool IsMatch (uint8_t const *prefix, uint8_t length, uint8_t const *address);
+
+  uint8_t m_bits; //!< length of the addresses
+};
+
+PrefixTrieTestCase::PrefixTrieTestCase (uint8_t bits)
+  : TestCase (bits == 32 ? "Check PrefixTrie against a linear scan, IPv4" : "Check PrefixTrie against a linear scan, IPv6"),
+    m_bits (bits)
+{
+}
+
+bool
+PrefixTrieTestCase::IsMatch (uint8_t const *prefix, uint8_t length, uint8_t const *address)
+{
+  for (uint32_t i = 0; i < length; i++)
+    {
+      uint8_t mask = 0x80 >> (i % 8);
+      if ((prefix[i / 8] & mask) != (address[i / 8] & mask))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+PrefixTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (m_bits);
+  uint32_t bytes = m_bits / 8;
+
+  //
+  // Random prefixes, drawn around a few base addresses so that they share
+  // long common parts, with duplicates.
+  //
+  std::vector<std::vector<uint8_t> > bases;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      std::vector<uint8_t> base (16);
+      for (uint32_t j = 0; j < bytes; j++)
+        {
+          base[j] = rng->GetInteger (0, 255);
+        }
+      bases.push_back (base);
+    }
+
+  PrefixTrie<uint32_t> trie;
+  std::vector<std::vector<uint8_t> > prefixes;
+  std::vector<uint8_t> lengths;
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      std::vector<uint8_t> prefix = bases[rng->GetInteger (0, 3)];
+      prefix[rng->GetInteger (0, bytes - 1)] ^= rng->GetInteger (0, 255);
+      uint8_t length = rng->GetInteger (0, m_bits);
+      if (i % 10 == 0 && i > 0)
+        {
+          // same prefix as a previous one
+          prefix = prefixes[i - 1];
+          length = lengths[i - 1];
+        }
+      prefixes.push_back (prefix);
+      lengths.push_back (length);
+      trie.Insert (&prefix[0], length, i);
+    }
+
+  PrefixTrie<uint32_t>::Match matches[PrefixTrie<uint32_t>::MAX_MATCHES];
+  bool same = true;
+  for (uint32_t i = 0; i < 2000 && same; i++)
+    {
+      std::vector<uint8_t> address = (i % 2) ? prefixes[rng->GetInteger (0, 499)] : bases[rng->GetInteger (0, 3)];
+      address[rng->GetInteger (0, bytes - 1)] ^= 1 << rng->GetInteger (0, 7);
+
+      std::vector<uint32_t> expected;
+      for (uint32_t length = 0; length <= m_bits; length++)
+        {
+          for (uint32_t j = 0; j < prefixes.size (); j++)
+            {
+              if (lengths[j] == length && IsMatch (&prefixes[j][0], length, &address[0]))
+                {
+                  expected.push_back (j);
+                }
+            }
+        }
+
+      std::vector<uint32_t> found;
+      uint32_t n = trie.Lookup (&address[0], m_bits, matches);
+      for (uint32_t k = 0; k < n; k++)
+        {
+          for (uint32_t j = 0; j < matches[k].values->size (); j++)
+            {
+              uint32_t value = (*matches[k].values)[j];
+              same = same && lengths[value] == matches[k].length;
+              found.push_back (value);
+            }
+        }
+      same = same && found == expected;
+    }
+  NS_TEST_EXPECT_MSG_EQ (same, true, "PrefixTrie lookup differs from a linear scan");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check some corner cases of PrefixTrie.
+ */
+class PrefixTrieCornerCasesTestCase : public TestCase
+{
+public:
+  PrefixTrieCornerCasesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PrefixTrieCornerCasesTestCase::PrefixTrieCornerCasesTestCase ()
+  : TestCase ("Check PrefixTrie corner cases")
+{
+}
+
+void
+PrefixTrieCornerCasesTestCase::DoRun (void)
+{
+  PrefixTrie<uint32_t> trie;
+  PrefixTrie<uint32_t>::Match matches[33];
+  uint8_t address[4];
+  uint8_t prefix[4];
+
+  Ipv4Address ("10.1.2.3").Serialize (address);
+  NS_TEST_EXPECT_MSG_EQ (trie.Lookup (address, 32, matches), 0, "An empty trie has no match");
+
+  // the bits beyond the length of a prefix are ignored
+  Ipv4Address ("10.1.255.255").Serialize (prefix);
+  trie.Insert (prefix, 16, 1);
+  Ipv4Address ("0.0.0.0").Serialize (prefix);
+  trie.Insert (prefix, 0, 0);
+  Ipv4Address ("10.1.2.3").Serialize (prefix);
+  trie.Insert (prefix, 32, 3);
+  trie.Insert (prefix, 32, 4);
+  Ipv4Address ("10.1.2.0").Serialize (prefix);
+  trie.Insert (prefix, 24, 2);
+
+  uint32_t n = trie.Lookup (address, 32, matches);
+  NS_TEST_EXPECT_MSG_EQ (n, 4, "10.1.2.3 should match 4 prefixes");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (matches[0].length), 0, "The default route should be the shortest match");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (matches[3].length), 32, "The host route should be the longest match");
+  NS_TEST_EXPECT_MSG_EQ (matches[3].values->size (), 2, "The host route should hold two values");
+  NS_TEST_EXPECT_MSG_EQ ((*matches[3].values)[0], 3, "The values should be in insertion order");
+
+  Ipv4Address ("10.1.3.3").Serialize (address);
+  n = trie.Lookup (address, 32, matches);
+  NS_TEST_EXPECT_MSG_EQ (n, 2, "10.1.3.3 should match 2 prefixes");
+  NS_TEST_EXPECT_MSG_EQ ((*matches[1].values)[0], 1, "10.1.3.3 should match 10.1.0.0/16");
+
+  trie.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (trie.Lookup (address, 32, matches), 0, "A cleared trie has no match");
+  NS_TEST_EXPECT_MSG_EQ (trie.GetNNodes (), 1, "A cleared trie has only its root");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routing protocols indexed by a PrefixTrie still
+ * find the routes with a non-contiguous mask, which are not in the trie.
+ *
+ * The routes of this test go out on interface 1, 2 or 3 of a node, so
+ * that the interface of the route found tells which route was selected.
+ */
+class PrefixTrieNonContiguousMaskTestCase : public TestCase
+{
+public:
+  PrefixTrieNonContiguousMaskTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param routing the routing protocol
+   * \param dest the destination
+   * \returns the interface of the route to dest, or 0 if there is none
+   */
+  uint32_t RouteOutput (Ptr<Ipv4RoutingProtocol> routing, Ipv4Address dest);
+  /**
+   * \param routing the routing protocol
+   * \param dest the destination
+   * \returns the interface of the route to dest, or 0 if there is none
+   */
+  uint32_t RouteOutput (Ptr<Ipv6RoutingProtocol> routing, Ipv6Address dest);
+
+  Ptr<Ipv4> m_ipv4; //!< the IPv4 stack of the node
+  Ptr<Ipv6> m_ipv6; //!< the IPv6 stack of the node
+};
+
+PrefixTrieNonContiguousMaskTestCase::PrefixTrieNonContiguousMaskTestCase ()
+  : TestCase ("Check the lookup of routes with a non-contiguous mask")
+{
+}
+
+uint32_t
+PrefixTrieNonContiguousMaskTestCase::RouteOutput (Ptr<Ipv4RoutingProtocol> routing, Ipv4Address dest)
+{
+  Ipv4Header header;
+  header.SetDestination (dest);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+  return route == 0 ? 0 : m_ipv4->GetInterfaceForDevice (route->GetOutputDevice ());
+}
+
+uint32_t
+PrefixTrieNonContiguousMaskTestCase::RouteOutput (Ptr<Ipv6RoutingProtocol> routing, Ipv6Address dest)
+{
+  Ipv6Header header;
+  header.SetDestinationAddress (dest);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv6Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+  return route == 0 ? 0 : m_ipv6->GetInterfaceForDevice (route->GetOutputDevice ());
+}
+
+void
+PrefixTrieNonContiguousMaskTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  m_ipv4 = node->GetObject<Ipv4> ();
+  m_ipv6 = node->GetObject<Ipv6> ();
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      uint32_t interface = m_ipv4->AddInterface (device);
+      std::ostringstream address;
+      address << "192.168." << i << ".1";
+      m_ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (address.str ().c_str ()), Ipv4Mask ("/24")));
+      m_ipv4->SetUp (interface);
+      interface = m_ipv6->AddInterface (device);
+      m_ipv6->SetUp (interface);
+    }
+
+  // 10.x.2.x matches the non-contiguous mask, which competes as a /24
+  Ptr<Ipv4StaticRouting> ipv4Static = CreateObject<Ipv4StaticRouting> ();
+  ipv4Static->SetIpv4 (m_ipv4);
+  ipv4Static->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+  ipv4Static->AddNetworkRouteTo (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.0.255.0"), 2);
+  ipv4Static->AddNetworkRouteTo (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 3);
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv4Static, Ipv4Address ("10.5.3.7")), 1, "10.5.3.7 should match 10.0.0.0/8");
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv4Static, Ipv4Address ("10.5.2.7")), 2, "10.5.2.7 should match the non-contiguous mask");
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv4Static, Ipv4Address ("10.1.2.7")), 3, "The last route of the same length should win");
+  ipv4Static->AddNetworkRouteTo (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.0.255.0"), 2);
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv4Static, Ipv4Address ("10.1.2.7")), 2, "The last route of the same length should win");
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv4Static, Ipv4Address ("11.5.2.7")), 0, "11.5.2.7 should not match any route");
+
+  // Global routing picks the first matching network route in list order
+  Ptr<Ipv4GlobalRouting> ipv4Global = CreateObject<Ipv4GlobalRouting> ();
+  ipv4Global->SetIpv4 (m_ipv4);
+  ipv4Global->AddNetworkRouteTo (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.0.255.0"), 2);
+  ipv4Global->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv4Global, Ipv4Address ("10.5.2.7")), 2, "10.5.2.7 should match the non-contiguous mask");
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv4Global, Ipv4Address ("10.5.3.7")), 1, "10.5.3.7 should match 10.0.0.0/8");
+
+  // 3001:x:5:: matches the non-contiguous prefix, which competes as a /32
+  Ptr<Ipv6StaticRouting> ipv6Static = CreateObject<Ipv6StaticRouting> ();
+  ipv6Static->SetIpv6 (m_ipv6);
+  ipv6Static->AddNetworkRouteTo (Ipv6Address ("3001::"), Ipv6Prefix (16), 1);
+  ipv6Static->AddNetworkRouteTo (Ipv6Address ("3001:0:5::"), Ipv6Prefix ("ffff:0:ffff::"), 2);
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv6Static, Ipv6Address ("3001:7:6::1")), 1, "3001:7:6::1 should match 3001::/16");
+  NS_TEST_EXPECT_MSG_EQ (RouteOutput (ipv6Static, Ipv6Address ("3001:7:5::1")), 2, "3001:7:5::1 should match the non-contiguous prefix");
+
+  ipv4Static = 0;
+  ipv4Global = 0;
+  ipv6Static = 0;
+  m_ipv4 = 0;
+  m_ipv6 = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ();
+};
+
+PrefixTrieTestSuite::PrefixTrieTestSuite ()
+  : TestSuite ("prefix-trie", UNIT)
+{
+  AddTestCase (new PrefixTrieCornerCasesTestCase, TestCase::QUICK);
+  AddTestCase (new PrefixTrieNonContiguousMaskTestCase, TestCase::QUICK);
+  AddTestCase (new PrefixTrieTestCase (32), TestCase::QUICK);
+  AddTestCase (new PrefixTrieTestCase (128), TestCase::QUICK);
+}
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
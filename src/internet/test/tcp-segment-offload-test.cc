@@ -0,0 +1,436 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/socket.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/error-model.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
+#include "ns3/queue-disc.h"
+#include "ns3/traffic-control-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Transfer data with TCP segmentation offload and check what each
+ * hop sends.
+ *
+ * With IPv4, the data crosses a router: the sender and the router send on
+ * devices that either carry super-segments or not.  With IPv6, the two
+ * nodes are on the same link.  The received data must be intact, and the
+ * packets sent on a device without segmentation offload must not be larger
+ * than a segment.
+ *
+ * Super-segments may also be lost on the first link, either by the
+ * receiving device or by a short queue disc of the sender.  The lost
+ * data must then be retransmitted one segment at a time.
+ */
+class TcpSegmentOffloadTestCase : public TestCase
+{
+public:
+  /// Packet losses on the first link
+  enum Loss
+  {
+    NO_LOSS,     //!< No loss
+    RX_ERRORS,   //!< Some packets are dropped by the receiving device
+    QUEUE_DROPS  //!< The queue disc of the sender holds few packets
+  };
+
+  /**
+   * \brief Constructor
+   * \param ipv6 whether to use IPv6 instead of IPv4
+   * \param firstOffload whether the devices of the first link carry super-segments
+   * \param secondOffload whether the devices of the second link carry super-segments
+   * \param loss the packet losses on the first link
+   */
+  TcpSegmentOffloadTestCase (bool ipv6, bool firstOffload, bool secondOffload, Loss loss = NO_LOSS);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Add a SimpleNetDevice on each node of a link
+   * \param a first node
+   * \param b second node
+   * \param offload whether the devices carry super-segments
+   * \returns the devices
+   */
+  NetDeviceContainer AddLink (Ptr<Node> a, Ptr<Node> b, bool offload);
+  /**
+   * \brief Send as much data as possible
+   * \param socket the sending socket
+   * \param available the space available in the transmit buffer
+   */
+  void SendData (Ptr<Socket> socket, uint32_t available);
+  /**
+   * \brief Accept a connection
+   * \param socket the accepted socket
+   * \param from the peer address
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Receive and check data
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Record the TCP packets sent by the sender
+   * \param packet the payload
+   * \param header the TCP header
+   * \param socket the socket
+   */
+  void TcpTx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+  /**
+   * \brief Record the IPv4 packets sent by a node
+   * \param packet the packet
+   * \param ipv4 the IPv4 protocol of the node
+   * \param interface the interface index
+   */
+  void Ipv4Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * \brief Record the IPv6 packets sent by a node
+   * \param packet the packet
+   * \param ipv6 the IPv6 protocol of the node
+   * \param interface the interface index
+   */
+  void Ipv6Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface);
+  /**
+   * \brief Record a packet lost on the first link
+   * \param packet the packet
+   */
+  void Drop (Ptr<const Packet> packet);
+  /**
+   * \brief Record a packet dropped by the queue disc of the sender
+   * \param item the queue disc item
+   */
+  void QueueDiscDrop (Ptr<const QueueDiscItem> item);
+
+  bool m_ipv6;                  //!< Use IPv6
+  bool m_firstOffload;          //!< Offload on the first link
+  bool m_secondOffload;         //!< Offload on the second link
+  Loss m_loss;                  //!< Losses on the first link
+  uint32_t m_segmentSize;       //!< TCP segment size
+  uint32_t m_totalBytes;        //!< Bytes to transfer
+  uint32_t m_sentBytes;         //!< Bytes written to the sending socket
+  uint32_t m_receivedBytes;     //!< Bytes read from the receiving socket
+  bool m_intact;                //!< Whether the received data matches the sent data
+  uint32_t m_maxTcpTx;          //!< Largest payload sent by the sender socket
+  std::map<uint32_t, uint32_t> m_maxIpTx; //!< Largest data packet sent by each node
+  SequenceNumber32 m_highTx;    //!< Highest sequence number sent by the sender socket
+  uint32_t m_retransmissions;   //!< Number of data packets sent again
+  uint32_t m_maxRetransmission; //!< Largest payload sent again
+  uint32_t m_drops;             //!< Number of packets lost on the first link
+  uint32_t m_maxDrop;           //!< Largest packet lost on the first link
+};
+
+TcpSegmentOffloadTestCase::TcpSegmentOffloadTestCase (bool ipv6, bool firstOffload, bool secondOffload, Loss loss)
+  : TestCase (std::string ("Check TCP segmentation offload over ") + (ipv6 ? "IPv6" : "IPv4")
+              + (firstOffload ? ", offload" : ", no offload")
+              + (ipv6 ? "" : (secondOffload ? " then offload" : " then no offload"))
+              + (loss == RX_ERRORS ? ", with receive errors" : "")
+              + (loss == QUEUE_DROPS ? ", with queue drops" : "")),
+    m_ipv6 (ipv6),
+    m_firstOffload (firstOffload),
+    m_secondOffload (secondOffload),
+    m_loss (loss),
+    m_segmentSize (1000),
+    m_totalBytes (300000),
+    m_sentBytes (0),
+    m_receivedBytes (0),
+    m_intact (true),
+    m_maxTcpTx (0),
+    m_highTx (0),
+    m_retransmissions (0),
+    m_maxRetransmission (0),
+    m_drops (0),
+    m_maxDrop (0)
+{
+}
+
+NetDeviceContainer
+TcpSegmentOffloadTestCase::AddLink (Ptr<Node> a, Ptr<Node> b, bool offload)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices;
+  Ptr<Node> nodes[2] = { a, b };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+      device->SetAttribute ("SegmentOffload", BooleanValue (offload));
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes[i]->AddDevice (device);
+      devices.Add (device);
+    }
+  return devices;
+}
+
+void
+TcpSegmentOffloadTestCase::SendData (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sentBytes < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (std::min (m_totalBytes - m_sentBytes, socket->GetTxAvailable ()), 4096U);
+      uint8_t data[4096];
+      for (uint32_t i = 0; i < size; i++)
+        {
+          data[i] = (m_sentBytes + i) % 251;
+        }
+      int sent = socket->Send (data, size, 0);
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sentBytes += sent;
+    }
+  if (m_sentBytes == m_totalBytes)
+    {
+      socket->Close ();
+    }
+}
+
+void
+TcpSegmentOffloadTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpSegmentOffloadTestCase::Receive, this));
+}
+
+void
+TcpSegmentOffloadTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      uint32_t size = packet->GetSize ();
+      uint8_t *data = new uint8_t[size];
+      packet->CopyData (data, size);
+      for (uint32_t i = 0; i < size; i++)
+        {
+          m_intact = m_intact && data[i] == (m_receivedBytes + i) % 251;
+        }
+      delete [] data;
+      m_receivedBytes += size;
+    }
+}
+
+void
+TcpSegmentOffloadTestCase::TcpTx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  m_maxTcpTx = std::max (m_maxTcpTx, packet->GetSize ());
+  if (packet->GetSize () == 0)
+    {
+      return;
+    }
+  if (header.GetSequenceNumber () < m_highTx)
+    {
+      m_retransmissions++;
+      m_maxRetransmission = std::max (m_maxRetransmission, packet->GetSize ());
+    }
+  m_highTx = std::max (m_highTx, header.GetSequenceNumber () + packet->GetSize ());
+}
+
+void
+TcpSegmentOffloadTestCase::Ipv4Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  uint32_t node = ipv4->GetObject<Node> ()->GetId ();
+  m_maxIpTx[node] = std::max (m_maxIpTx[node], packet->GetSize ());
+}
+
+void
+TcpSegmentOffloadTestCase::Ipv6Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  uint32_t node = ipv6->GetObject<Node> ()->GetId ();
+  m_maxIpTx[node] = std::max (m_maxIpTx[node], packet->GetSize ());
+}
+
+void
+TcpSegmentOffloadTestCase::Drop (Ptr<const Packet> packet)
+{
+  m_drops++;
+  m_maxDrop = std::max (m_maxDrop, packet->GetSize ());
+}
+
+void
+TcpSegmentOffloadTestCase::QueueDiscDrop (Ptr<const QueueDiscItem> item)
+{
+  m_drops++;
+  m_maxDrop = std::max (m_maxDrop, item->GetSize ());
+}
+
+void
+TcpSegmentOffloadTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (m_ipv6 ? 2 : 3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ptr<Node> sender = nodes.Get (0);
+  Ptr<Node> receiver = nodes.Get (nodes.GetN () - 1);
+
+  Address receiverAddress;
+  Address any;
+  uint16_t port = 50000;
+  if (m_ipv6)
+    {
+      NetDeviceContainer devices = AddLink (sender, receiver, m_firstOffload);
+      Ipv6AddressHelper address;
+      address.SetBase (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (devices);
+      receiverAddress = Inet6SocketAddress (interfaces.GetAddress (1, 1), port);
+      any = Inet6SocketAddress (Ipv6Address::GetAny (), port);
+      sender->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpSegmentOffloadTestCase::Ipv6Tx, this));
+    }
+  else
+    {
+      Ipv4AddressHelper address;
+      address.SetBase ("10.0.1.0", "255.255.255.0");
+      NetDeviceContainer devices = AddLink (sender, nodes.Get (1), m_firstOffload);
+      address.Assign (devices);
+      if (m_loss == RX_ERRORS)
+        {
+          // Drop a few packets once the congestion window has grown
+          Ptr<ReceiveListErrorModel> errorModel = CreateObject<ReceiveListErrorModel> ();
+          std::list<uint32_t> drops;
+          drops.push_back (20);
+          drops.push_back (21);
+          drops.push_back (40);
+          errorModel->SetList (drops);
+          devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (errorModel));
+          devices.Get (1)->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&TcpSegmentOffloadTestCase::Drop, this));
+        }
+      else if (m_loss == QUEUE_DROPS)
+        {
+          // Hold a single packet in the device and in the queue disc, so
+          // that a burst of super-segments overflows the queue disc
+          DynamicCast<SimpleNetDevice> (devices.Get (0))->GetQueue ()->SetAttribute ("MaxPackets", UintegerValue (1));
+          TrafficControlHelper tch;
+          tch.Uninstall (devices.Get (0));
+          tch.SetRootQueueDisc ("ns3::PfifoFastQueueDisc", "Limit", UintegerValue (1));
+          QueueDiscContainer queueDiscs = tch.Install (devices.Get (0));
+          queueDiscs.Get (0)->TraceConnectWithoutContext ("Drop", MakeCallback (&TcpSegmentOffloadTestCase::QueueDiscDrop, this));
+        }
+      address.SetBase ("10.0.2.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (AddLink (nodes.Get (1), receiver, m_secondOffload));
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+      receiverAddress = InetSocketAddress (interfaces.GetAddress (1), port);
+      any = InetSocketAddress (Ipv4Address::GetAny (), port);
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          nodes.Get (i)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpSegmentOffloadTestCase::Ipv4Tx, this));
+        }
+    }
+
+  Ptr<Socket> listener = Socket::CreateSocket (receiver, TcpSocketFactory::GetTypeId ());
+  listener->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  listener->Bind (any);
+  listener->Listen ();
+  listener->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&TcpSegmentOffloadTestCase::Accept, this));
+
+  Ptr<Socket> source = Socket::CreateSocket (sender, TcpSocketFactory::GetTypeId ());
+  source->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  source->SetAttribute ("SegmentOffload", UintegerValue (16));
+  source->SetAttribute ("SndBufSize", UintegerValue (m_totalBytes));
+  source->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpSegmentOffloadTestCase::TcpTx, this));
+  source->SetSendCallback (MakeCallback (&TcpSegmentOffloadTestCase::SendData, this));
+  // IPv6 addresses are usable once duplicate address detection is over
+  Time start = Seconds (m_ipv6 ? 2 : 1);
+  Simulator::Schedule (start, &Socket::Connect, source, receiverAddress);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_receivedBytes, m_totalBytes, "All the data should be received");
+  NS_TEST_EXPECT_MSG_EQ (m_intact, true, "The received data should match the sent data");
+  NS_TEST_EXPECT_MSG_GT (m_maxTcpTx, 2 * m_segmentSize, "The sender should send super-segments");
+
+  // IP, TCP and timestamp option headers
+  uint32_t headers = (m_ipv6 ? 40 : 20) + 20 + 12;
+  uint32_t maxSegment = m_segmentSize + headers;
+  if (m_firstOffload)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_maxIpTx[0], maxSegment, "Super-segments should be sent on the first link");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_maxIpTx[0], maxSegment, "Only segments should be sent on the first link");
+    }
+  if (!m_ipv6 && m_secondOffload)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((m_maxIpTx[1] > maxSegment), m_firstOffload, "Super-segments should be forwarded on the second link");
+    }
+  else if (!m_ipv6)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_maxIpTx[1], maxSegment, "Only segments should be sent on the second link");
+    }
+  if (m_loss != NO_LOSS)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_maxDrop, maxSegment, "A super-segment should be lost");
+      NS_TEST_EXPECT_MSG_GT (m_retransmissions, 0, "The lost data should be retransmitted");
+      NS_TEST_EXPECT_MSG_EQ (m_maxRetransmission, m_segmentSize, "Retransmissions should be single segments");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP segmentation offload TestSuite
+ */
+class TcpSegmentOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentOffloadTestSuite ();
+};
+
+TcpSegmentOffloadTestSuite::TcpSegmentOffloadTestSuite ()
+  : TestSuite ("tcp-segment-offload", UNIT)
+{
+  AddTestCase (new TcpSegmentOffloadTestCase (false, true, true), TestCase::QUICK);
+  AddTestCase (new TcpSegmentOffloadTestCase (false, true, false), TestCase::QUICK);
+  AddTestCase (new TcpSegmentOffloadTestCase (false, false, false), TestCase::QUICK);
+  AddTestCase (new TcpSegmentOffloadTestCase (true, false, false), TestCase::QUICK);
+  AddTestCase (new TcpSegmentOffloadTestCase (true, true, false), TestCase::QUICK);
+  AddTestCase (new TcpSegmentOffloadTestCase (false, true, true, TcpSegmentOffloadTestCase::RX_ERRORS), TestCase::QUICK);
+  AddTestCase (new TcpSegmentOffloadTestCase (false, true, false, TcpSegmentOffloadTestCase::RX_ERRORS), TestCase::QUICK);
+  AddTestCase (new TcpSegmentOffloadTestCase (false, true, true, TcpSegmentOffloadTestCase::QUEUE_DROPS), TestCase::QUICK);
+}
+
+static TcpSegmentOffloadTestSuite g_tcpSegmentOffloadTestSuite; //!< Static variable for test initialization
@@ -49,6 +49,8 @@ private:
   void TestNextSeg ();
   /** \brief Test the scoreboard with emulated SACK */
   void TestUpdateScoreboardWithCraftedSACK ();
+  /** \brief Test the scoreboard of a large window against RFC 6675 */
+  void TestLargeWindowScoreboard ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -83,6 +85,14 @@ TcpTxBufferTestCase::DoRun ()
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestUpdateScoreboardWithCraftedSACK, this);
 
+  /*
+   * Large window, with a hole every ten segments:
+   * -> IsLost and BytesInFlight match a direct implementation of RFC 6675
+   * -> they still match after retransmissions, cumulative ACKs and new data
+   */
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindowScoreboard, this);
+
   Simulator::Run ();
   Simulator::Destroy ();
 }
@@ -390,6 +400,128 @@ TcpTxBufferTestCase::TestUpdateScoreboardWithCraftedSACK ()
                          "Data inside the buffer");
 }
 
+/**
+ * \brief Bytes in flight of equally sized segments, computed as in RFC 6675
+ * \param sacked SACK flag of each segment
+ * \param retrans retransmission flag of each segment
+ * \param first first segment still in the buffer
+ * \param segmentSize size of each segment
+ * \param lost output, the segments deemed lost
+ * \return the pipe
+ */
+static uint32_t
+ReferencePipe (const std::vector<bool> &sacked, const std::vector<bool> &retrans,
+               uint32_t first, uint32_t segmentSize, std::vector<bool> *lost)
+{
+  uint32_t pipe = 0;
+  lost->assign (sacked.size (), false);
+  for (uint32_t i = first; i < sacked.size (); ++i)
+    {
+      if (sacked[i])
+        {
+          continue;
+        }
+      uint32_t count = 0;
+      for (uint32_t j = i + 1; j < sacked.size (); ++j)
+        {
+          count += sacked[j];
+        }
+      (*lost)[i] = count >= 3;
+      if (!(*lost)[i] || retrans[i])
+        {
+          pipe += segmentSize;
+        }
+    }
+  return pipe;
+}
+
+void
+TcpTxBufferTestCase::TestLargeWindowScoreboard ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  uint32_t segmentSize = 1000;
+  uint32_t segments = 2000;
+  std::vector<bool> sacked (segments, false);
+  std::vector<bool> retrans (segments, false);
+  std::vector<bool> lost;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetMaxBufferSize (segments * segmentSize);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Add (Create<Packet> (segments * segmentSize)), true,
+                         "The data should fit in the buffer");
+
+  for (uint32_t i = 0; i < segments / 2; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (3, segmentSize), segments / 2 * segmentSize,
+                         "All the data sent should be in flight");
+
+  // Every segment but one out of ten is SACKed
+  for (uint32_t i = 0; i < segments / 2; i += 10)
+    {
+      TcpOptionSack::SackList sackList;
+      sackList.push_back (TcpOptionSack::SackBlock (head + (segmentSize * (i + 1)),
+                                                    head + (segmentSize * (i + 10))));
+      txBuf.Update (sackList);
+      for (uint32_t j = i + 1; j < i + 10; ++j)
+        {
+          sacked[j] = true;
+        }
+    }
+  sacked.resize (segments / 2);
+  retrans.resize (segments / 2);
+
+  uint32_t pipe = ReferencePipe (sacked, retrans, 0, segmentSize, &lost);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (3, segmentSize), pipe,
+                         "The pipe differs from RFC 6675");
+  for (uint32_t i = 0; i < sacked.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * i), 3, segmentSize), lost[i],
+                             "IsLost differs from RFC 6675 for segment " << i);
+    }
+
+  // Retransmit the first lost segments
+  for (uint32_t k = 0; k < 10; ++k)
+    {
+      SequenceNumber32 next;
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&next, 3, segmentSize, true), true,
+                             "There should be a segment to retransmit");
+      NS_TEST_ASSERT_MSG_EQ (next, head + (segmentSize * 10 * k),
+                             "The lowest lost segment should be retransmitted");
+      txBuf.CopyFromSequence (segmentSize, next);
+      retrans[10 * k] = true;
+      pipe = ReferencePipe (sacked, retrans, 0, segmentSize, &lost);
+      NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (3, segmentSize), pipe,
+                             "The pipe differs from RFC 6675 after a retransmission");
+    }
+
+  // Cumulative ACK of the first 50 segments, then new data
+  txBuf.DiscardUpTo (head + (segmentSize * 50));
+  pipe = ReferencePipe (sacked, retrans, 50, segmentSize, &lost);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (3, segmentSize), pipe,
+                         "The pipe differs from RFC 6675 after a cumulative ACK");
+  for (uint32_t i = segments / 2; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+      sacked.push_back (false);
+      retrans.push_back (false);
+    }
+  pipe = ReferencePipe (sacked, retrans, 50, segmentSize, &lost);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (3, segmentSize), pipe,
+                         "The pipe differs from RFC 6675 after sending new data");
+  for (uint32_t i = 50; i < sacked.size (); i += 7)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * i), 3, segmentSize), lost[i],
+                             "IsLost differs from RFC 6675 for segment " << i);
+    }
+
+  txBuf.DiscardUpTo (head + (segmentSize * segments));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (3, segmentSize), 0,
+                         "Nothing should be in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0, "Data inside the buffer");
+}
+
 void
 TcpTxBufferTestCase::TestTransmittedBlock ()
 {
@@ -47,6 +47,16 @@ AsciiLrWpanMacTransmitSinkWithContext (
   std::string context,
   Ptr<const Packet> p)
 {
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', context, p);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -60,6 +70,16 @@ AsciiLrWpanMacTransmitSinkWithoutContext (
   Ptr<OutputStreamWrapper> stream,
   Ptr<const Packet> p)
 {
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', p);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/packet.h>
+#include <ns3/simulator.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/output-stream-wrapper.h>
+#include <ns3/capture-filter.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/lr-wpan-helper.h>
+#include <ns3/lr-wpan-net-device.h>
+#include <ns3/mac16-address.h>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup lr-wpan-test
+ * \ingroup tests
+ *
+ * \brief Check that the ascii traces of LrWpanHelper honor its capture
+ * filter.
+ *
+ * Node 0 sends a small and a large frame to node 1.  Both are traced on
+ * a stream without filter, and only the large one on a stream whose
+ * filter only accepts large packets.
+ */
+class LrWpanAsciiCaptureFilterTestCase : public TestCase
+{
+public:
+  LrWpanAsciiCaptureFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the lines of a trace for an event.
+   * \param trace the ascii trace
+   * \param event the event character
+   * \returns the number of lines starting with \p event
+   */
+  static uint32_t CountEvents (std::string const &trace, char event);
+};
+
+LrWpanAsciiCaptureFilterTestCase::LrWpanAsciiCaptureFilterTestCase ()
+  : TestCase ("Test the capture filter of the 802.15.4 ascii traces")
+{
+}
+
+uint32_t
+LrWpanAsciiCaptureFilterTestCase::CountEvents (std::string const &trace, char event)
+{
+  std::istringstream lines (trace);
+  std::string line;
+  uint32_t count = 0;
+  while (std::getline (lines, line))
+    {
+      if (line.size () > 1 && line[0] == event && line[1] == ' ')
+        {
+          ++count;
+        }
+    }
+  return count;
+}
+
+void
+LrWpanAsciiCaptureFilterTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  LrWpanHelper lrWpanHelper;
+  NetDeviceContainer devices = lrWpanHelper.Install (nodes);
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<LrWpanNetDevice> dev = DynamicCast<LrWpanNetDevice> (devices.Get (i));
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (i, 0, 0));
+      dev->GetPhy ()->SetMobility (mobility);
+      nodes.Get (i)->AggregateObject (mobility);
+    }
+  lrWpanHelper.AssociateToPan (devices, 0);
+
+  std::ostringstream all;
+  std::ostringstream large;
+  lrWpanHelper.EnableAscii (Create<OutputStreamWrapper> (&all), devices);
+  lrWpanHelper.SetAsciiCaptureFilter (Create<CaptureFilter> ("greater 60"));
+  lrWpanHelper.EnableAscii (Create<OutputStreamWrapper> (&large), devices);
+
+  McpsDataRequestParams params;
+  params.m_srcAddrMode = SHORT_ADDR;
+  params.m_dstAddrMode = SHORT_ADDR;
+  params.m_dstPanId = 0;
+  params.m_dstAddr = Mac16Address ("00:02");
+  params.m_msduHandle = 0;
+  Ptr<LrWpanNetDevice> dev0 = DynamicCast<LrWpanNetDevice> (devices.Get (0));
+  Simulator::Schedule (Seconds (0.1), &LrWpanMac::McpsDataRequest, dev0->GetMac (), params, Create<Packet> (20));
+  Simulator::Schedule (Seconds (0.2), &LrWpanMac::McpsDataRequest, dev0->GetMac (), params, Create<Packet> (100));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (all.str (), 't'), 2, "Both frames should be traced without filter");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (all.str (), 'r'), 2, "Both frames should be traced without filter");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (large.str (), 't'), 1, "Only the large frame should pass the filter");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (large.str (), 'r'), 1, "Only the large frame should pass the filter");
+}
+
+/**
+ * \ingroup lr-wpan-test
+ * \ingroup tests
+ *
+ * \brief LrWpan ascii trace TestSuite
+ */
+class LrWpanAsciiTraceTestSuite : public TestSuite
+{
+public:
+  LrWpanAsciiTraceTestSuite ();
+};
+
+LrWpanAsciiTraceTestSuite::LrWpanAsciiTraceTestSuite ()
+  : TestSuite ("lr-wpan-ascii-trace", UNIT)
+{
+  AddTestCase (new LrWpanAsciiCaptureFilterTestCase, TestCase::QUICK);
+}
+
+static LrWpanAsciiTraceTestSuite g_lrWpanAsciiTraceTestSuite; //!< Static variable for test initialization
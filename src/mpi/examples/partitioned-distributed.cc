@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * PartitionedDistributed lets the DistributedPartitionHelper assign the
+ * nodes to the logical processors, instead of giving their system id
+ * when they are created.
+ *
+ * The topology is a ring of clusters.  Each cluster is a router with
+ * leaf nodes attached by 2ms links, and the routers are joined by 20ms
+ * links.  The routers are given twice the load of the leaves.
+ *
+ *   l ---\                     /--- l
+ *   l ---- r0 ------20ms----- r1 ---- l
+ *   l ---/  |                  |\--- l
+ *           |                  |
+ *          ...      ...       ...
+ *
+ * The helper keeps the clusters whole as long as this leaves the logical
+ * processors balanced, so that only the 20ms links are cut.
+ *
+ * The first leaf of the first cluster sends packets to the first leaf of
+ * the last cluster, which outputs logging information when it receives
+ * them.
+ *
+ * With --processes=N, the simulation forks N local processes which
+ * communicate through shared memory, and does not need mpirun.
+ *
+ * With --maxBatchSize=B, the packets sent to another system are batched
+ * in messages of at most about B bytes (0 sends each packet in its own
+ * message).  The program fails if the sink does not receive all the
+ * packets sent.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/distributed-partition-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PartitionedDistributed");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nClusters = 4;
+  uint32_t nLeaves = 8;
+  uint32_t processes = 0;
+  bool nullmsg = false;
+  uint32_t maxBatchSize = 65536;
+  uint32_t maxBytes = 2048;
+
+  // Parse command line
+  CommandLine cmd;
+  cmd.AddValue ("clusters", "Number of clusters", nClusters);
+  cmd.AddValue ("leaves", "Number of leaf nodes per cluster", nLeaves);
+  cmd.AddValue ("processes", "Number of local processes to fork, instead of using MPI", processes);
+  cmd.AddValue ("nullmsg", "Enable the use of null-message synchronization", nullmsg);
+  cmd.AddValue ("maxBatchSize", "Size in bytes above which the batch of packets to a system is sent", maxBatchSize);
+  cmd.AddValue ("maxBytes", "Number of bytes sent to the sink", maxBytes);
+  cmd.Parse (argc, argv);
+
+  // Distributed simulation setup; by default use granted time window algorithm.
+  if (nullmsg)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::NullMessageSimulatorImpl"));
+      Config::SetDefault ("ns3::NullMessageSimulatorImpl::MaxBatchSize", UintegerValue (maxBatchSize));
+    }
+  else
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::DistributedSimulatorImpl"));
+      Config::SetDefault ("ns3::DistributedSimulatorImpl::MaxBatchSize", UintegerValue (maxBatchSize));
+    }
+
+  // Enable parallel simulator, either on local processes or with the
+  // command line arguments
+  if (processes > 0)
+    {
+      MpiInterface::Enable (processes);
+    }
+  else
+    {
+      MpiInterface::Enable (&argc, &argv);
+    }
+
+  LogComponentEnable ("PacketSink", LOG_LEVEL_INFO);
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  if (nClusters < 2)
+    {
+      std::cout << "This simulation requires at least 2 clusters." << std::endl;
+      return 1;
+    }
+
+  Config::SetDefault ("ns3::OnOffApplication::PacketSize", UintegerValue (512));
+  Config::SetDefault ("ns3::OnOffApplication::DataRate", StringValue ("1Mbps"));
+  Config::SetDefault ("ns3::OnOffApplication::MaxBytes", UintegerValue (maxBytes));
+
+  // Create all the nodes on system 0, and describe the topology to the
+  // partition helper.
+  NodeContainer routers;
+  routers.Create (nClusters);
+  std::vector<NodeContainer> leaves (nClusters);
+
+  DistributedPartitionHelper partition;
+  partition.AddNodes (routers, 2.0);
+  for (uint32_t i = 0; i < nClusters; ++i)
+    {
+      leaves[i].Create (nLeaves);
+      for (uint32_t j = 0; j < nLeaves; ++j)
+        {
+          partition.AddLink (leaves[i].Get (j), routers.Get (i), MilliSeconds (2));
+        }
+      partition.AddLink (routers.Get (i), routers.Get ((i + 1) % nClusters), MilliSeconds (20));
+    }
+
+  // Assign the system ids before the devices are installed, so that the
+  // links between systems use remote channels.
+  partition.Partition (systemCount);
+  if (systemId == 0)
+    {
+      for (uint32_t s = 0; s < systemCount; ++s)
+        {
+          std::cout << "System " << s << " load " << partition.GetLoad (s) << std::endl;
+        }
+      std::cout << "Lookahead " << partition.GetLookahead ().GetSeconds () << "s" << std::endl;
+    }
+
+  PointToPointHelper routerLink;
+  routerLink.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  routerLink.SetChannelAttribute ("Delay", StringValue ("20ms"));
+
+  PointToPointHelper leafLink;
+  leafLink.SetDeviceAttribute ("DataRate", StringValue ("1Mbps"));
+  leafLink.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  InternetStackHelper stack;
+  Ipv4NixVectorHelper nixRouting;
+  stack.SetRoutingHelper (nixRouting); // has effect on the next Install ()
+  stack.InstallAll ();
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer sinkInterfaces;
+  for (uint32_t i = 0; i < nClusters; ++i)
+    {
+      address.Assign (routerLink.Install (routers.Get (i), routers.Get ((i + 1) % nClusters)));
+      address.NewNetwork ();
+      for (uint32_t j = 0; j < nLeaves; ++j)
+        {
+          Ipv4InterfaceContainer ifc = address.Assign (leafLink.Install (leaves[i].Get (j), routers.Get (i)));
+          address.NewNetwork ();
+          if (i == nClusters - 1 && j == 0)
+            {
+              sinkInterfaces.Add (ifc.Get (0));
+            }
+        }
+    }
+
+  // Create the applications on the systems which own their node
+  uint16_t port = 50000;
+  Ptr<Node> sinkNode = leaves[nClusters - 1].Get (0);
+  Ptr<PacketSink> sink;
+  if (sinkNode->GetSystemId () == systemId)
+    {
+      PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory",
+                                   InetSocketAddress (Ipv4Address::GetAny (), port));
+      ApplicationContainer sinkApp = sinkHelper.Install (sinkNode);
+      sinkApp.Start (Seconds (1.0));
+      sinkApp.Stop (Seconds (5));
+      sink = DynamicCast<PacketSink> (sinkApp.Get (0));
+    }
+
+  Ptr<Node> clientNode = leaves[0].Get (0);
+  if (clientNode->GetSystemId () == systemId)
+    {
+      OnOffHelper clientHelper ("ns3::UdpSocketFactory",
+                                InetSocketAddress (sinkInterfaces.GetAddress (0), port));
+      clientHelper.SetAttribute
+        ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+      clientHelper.SetAttribute
+        ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+      ApplicationContainer clientApp = clientHelper.Install (clientNode);
+      clientApp.Start (Seconds (1.0));
+      clientApp.Stop (Seconds (5));
+    }
+
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+
+  bool ok = true;
+  if (sink)
+    {
+      std::cout << "Sink received " << sink->GetTotalRx () << " bytes" << std::endl;
+      ok = sink->GetTotalRx () == maxBytes;
+    }
+
+  // Report the messages sent to the neighbors of this system, which must
+  // at least have received its Null Messages
+  if (nullmsg)
+    {
+      uint64_t sent = 0;
+      for (uint32_t s = 0; s < systemCount; ++s)
+        {
+          uint64_t data = MpiInterface::GetDataMessagesSent (s);
+          uint64_t null = MpiInterface::GetNullMessagesSent (s);
+          if (data + null > 0)
+            {
+              std::cout << "System " << systemId << " sent " << data << " data and "
+                        << null << " null messages to system " << s << std::endl;
+            }
+          sent += data + null;
+        }
+      ok = ok && sent > 0;
+    }
+
+  Simulator::Destroy ();
+  // Exit the parallel execution environment
+  MpiInterface::Disable ();
+  return ok ? 0 : 1;
+}
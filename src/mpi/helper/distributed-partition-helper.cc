@@ -0,0 +1,701 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+#include "distributed-partition-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DistributedPartitionHelper");
+
+namespace {
+
+/// Marks an unmatched or unassigned vertex
+const uint32_t NONE = std::numeric_limits<uint32_t>::max ();
+
+/// Weight of an edge whose delay is equal to the lookahead
+const int64_t EDGE_WEIGHT_SCALE = 1000;
+
+/// The coarsening stops at this number of vertices per system
+const uint32_t COARSEN_VERTICES_PER_SYSTEM = 15;
+
+/// The maximum number of refinement passes at each level
+const uint32_t MAX_REFINE_PASSES = 8;
+
+/// A weighted edge
+struct Edge
+{
+  uint32_t u;   //!< The first vertex
+  uint32_t v;   //!< The second vertex
+  int64_t w;    //!< The weight
+};
+
+/// A weighted undirected graph, in compressed adjacency form
+struct Graph
+{
+  std::vector<double> vwgt;      //!< The vertex weights
+  std::vector<uint32_t> xadj;    //!< The first edge of each vertex, and the number of edges
+  std::vector<uint32_t> adjncy;  //!< The neighbour of each edge
+  std::vector<int64_t> adjwgt;   //!< The weight of each edge
+
+  /// \returns the number of vertices
+  uint32_t GetN (void) const
+  {
+    return vwgt.size ();
+  }
+};
+
+/**
+ * Build a graph, merging the parallel edges and dropping the loops.
+ *
+ * \param vwgt the vertex weights
+ * \param edges the edges, each given in a single direction
+ * \returns the graph
+ */
+Graph
+BuildGraph (const std::vector<double> &vwgt, const std::vector<Edge> &edges)
+{
+  uint32_t n = vwgt.size ();
+  std::vector<std::vector<std::pair<uint32_t, int64_t> > > adj (n);
+  for (std::vector<Edge>::const_iterator i = edges.begin (); i != edges.end (); ++i)
+    {
+      if (i->u != i->v)
+        {
+          adj[i->u].push_back (std::make_pair (i->v, i->w));
+          adj[i->v].push_back (std::make_pair (i->u, i->w));
+        }
+    }
+
+  Graph g;
+  g.vwgt = vwgt;
+  g.xadj.reserve (n + 1);
+  g.xadj.push_back (0);
+  for (uint32_t u = 0; u < n; ++u)
+    {
+      std::sort (adj[u].begin (), adj[u].end ());
+      for (uint32_t j = 0; j < adj[u].size (); ++j)
+        {
+          if (j > 0 && adj[u][j].first == adj[u][j - 1].first)
+            {
+              g.adjwgt.back () += adj[u][j].second;
+            }
+          else
+            {
+              g.adjncy.push_back (adj[u][j].first);
+              g.adjwgt.push_back (adj[u][j].second);
+            }
+        }
+      g.xadj.push_back (g.adjncy.size ());
+    }
+  return g;
+}
+
+/// Orders the vertices by increasing weight, then by index
+struct LighterVertex
+{
+  /**
+   * \param vwgt the vertex weights
+   */
+  LighterVertex (const std::vector<double> &vwgt)
+    : m_vwgt (vwgt)
+  {
+  }
+  /**
+   * \param a a vertex
+   * \param b another vertex
+   * \returns true if a comes before b
+   */
+  bool operator() (uint32_t a, uint32_t b) const
+  {
+    return m_vwgt[a] < m_vwgt[b] || (m_vwgt[a] == m_vwgt[b] && a < b);
+  }
+  const std::vector<double> &m_vwgt;  //!< The vertex weights
+};
+
+/**
+ * Coarsen a graph by collapsing the vertices matched along their
+ * heaviest edge.
+ *
+ * \param g the graph
+ * \param maxVertexWeight the maximum weight of a collapsed vertex
+ * \param cmap the vertex of the coarse graph of each vertex of g
+ * \returns the coarse graph
+ */
+Graph
+Coarsen (const Graph &g, double maxVertexWeight, std::vector<uint32_t> &cmap)
+{
+  uint32_t n = g.GetN ();
+  std::vector<uint32_t> order (n);
+  for (uint32_t u = 0; u < n; ++u)
+    {
+      order[u] = u;
+    }
+  std::sort (order.begin (), order.end (), LighterVertex (g.vwgt));
+
+  std::vector<uint32_t> match (n, NONE);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t u = order[i];
+      if (match[u] != NONE)
+        {
+          continue;
+        }
+      uint32_t best = u;
+      int64_t bestWeight = 0;
+      for (uint32_t e = g.xadj[u]; e < g.xadj[u + 1]; ++e)
+        {
+          uint32_t v = g.adjncy[e];
+          if (match[v] == NONE && g.adjwgt[e] > bestWeight
+              && g.vwgt[u] + g.vwgt[v] <= maxVertexWeight)
+            {
+              best = v;
+              bestWeight = g.adjwgt[e];
+            }
+        }
+      match[u] = best;
+      match[best] = u;
+    }
+
+  cmap.assign (n, NONE);
+  std::vector<double> vwgt;
+  for (uint32_t u = 0; u < n; ++u)
+    {
+      if (cmap[u] == NONE)
+        {
+          cmap[u] = vwgt.size ();
+          cmap[match[u]] = vwgt.size ();
+          vwgt.push_back (match[u] == u ? g.vwgt[u] : g.vwgt[u] + g.vwgt[match[u]]);
+        }
+    }
+  std::vector<Edge> edges;
+  for (uint32_t u = 0; u < n; ++u)
+    {
+      for (uint32_t e = g.xadj[u]; e < g.xadj[u + 1]; ++e)
+        {
+          if (u < g.adjncy[e])
+            {
+              Edge edge = { cmap[u], cmap[g.adjncy[e]], g.adjwgt[e] };
+              edges.push_back (edge);
+            }
+        }
+    }
+  return BuildGraph (vwgt, edges);
+}
+
+/**
+ * Compute an initial partition by growing the parts one after the other
+ * from a seed vertex, adding the vertex most connected to the part until
+ * its weight reaches the target.  The last part takes the remaining
+ * vertices.
+ *
+ * \param g the graph
+ * \param nParts the number of parts
+ * \param target the target weight of each part
+ * \param part the part of each vertex
+ */
+void
+GrowPartition (const Graph &g, uint32_t nParts, double target, std::vector<uint32_t> &part)
+{
+  uint32_t n = g.GetN ();
+  part.assign (n, NONE);
+  uint32_t seed = 0;
+  for (uint32_t p = 0; p + 1 < nParts; ++p)
+    {
+      double weight = 0;
+      std::vector<int64_t> conn (n, 0);
+      // the frontier, by decreasing connectivity to the part
+      std::set<std::pair<int64_t, uint32_t> > frontier;
+      while (weight < target)
+        {
+          uint32_t u;
+          if (!frontier.empty ())
+            {
+              u = frontier.begin ()->second;
+              frontier.erase (frontier.begin ());
+            }
+          else
+            {
+              while (seed < n && part[seed] != NONE)
+                {
+                  ++seed;
+                }
+              if (seed == n)
+                {
+                  return;
+                }
+              u = seed;
+            }
+          part[u] = p;
+          weight += g.vwgt[u];
+          for (uint32_t e = g.xadj[u]; e < g.xadj[u + 1]; ++e)
+            {
+              uint32_t v = g.adjncy[e];
+              if (part[v] == NONE)
+                {
+                  frontier.erase (std::make_pair (-conn[v], v));
+                  conn[v] += g.adjwgt[e];
+                  frontier.insert (std::make_pair (-conn[v], v));
+                }
+            }
+        }
+    }
+  for (uint32_t u = 0; u < n; ++u)
+    {
+      if (part[u] == NONE)
+        {
+          part[u] = nParts - 1;
+        }
+    }
+}
+
+/**
+ * Improve a partition by moving the vertices to the neighbouring part
+ * which reduces most the weight of the cut edges, as long as the weight
+ * of that part stays below the maximum.  Moves which do not change the
+ * cut are done if they improve the balance, and the vertices of the parts
+ * heavier than the maximum are moved even if this increases the cut.
+ *
+ * \param g the graph
+ * \param nParts the number of parts
+ * \param maxPartWeight the maximum weight of a part
+ * \param part the part of each vertex
+ */
+void
+RefinePartition (const Graph &g, uint32_t nParts, double maxPartWeight, std::vector<uint32_t> &part)
+{
+  uint32_t n = g.GetN ();
+  std::vector<double> partWeight (nParts, 0);
+  for (uint32_t u = 0; u < n; ++u)
+    {
+      partWeight[part[u]] += g.vwgt[u];
+    }
+
+  std::vector<int64_t> conn (nParts, 0);
+  for (uint32_t pass = 0; pass < MAX_REFINE_PASSES; ++pass)
+    {
+      bool moved = false;
+      for (uint32_t u = 0; u < n; ++u)
+        {
+          uint32_t own = part[u];
+          bool overweight = partWeight[own] > maxPartWeight;
+          bool boundary = false;
+          for (uint32_t e = g.xadj[u]; e < g.xadj[u + 1]; ++e)
+            {
+              conn[part[g.adjncy[e]]] += g.adjwgt[e];
+              boundary |= part[g.adjncy[e]] != own;
+            }
+
+          uint32_t best = own;
+          if (boundary || overweight)
+            {
+              int64_t bestGain = 0;
+              for (uint32_t q = 0; q < nParts; ++q)
+                {
+                  if (q == own || (conn[q] == 0 && !overweight)
+                      || partWeight[q] + g.vwgt[u] > maxPartWeight)
+                    {
+                      continue;
+                    }
+                  int64_t gain = conn[q] - conn[own];
+                  if (best == own)
+                    {
+                      if (gain > 0 || overweight
+                          || (gain == 0 && partWeight[q] + g.vwgt[u] < partWeight[own]))
+                        {
+                          best = q;
+                          bestGain = gain;
+                        }
+                    }
+                  else if (gain > bestGain
+                           || (gain == bestGain && partWeight[q] < partWeight[best]))
+                    {
+                      best = q;
+                      bestGain = gain;
+                    }
+                }
+            }
+
+          for (uint32_t e = g.xadj[u]; e < g.xadj[u + 1]; ++e)
+            {
+              conn[part[g.adjncy[e]]] = 0;
+            }
+          if (best != own)
+            {
+              part[u] = best;
+              partWeight[own] -= g.vwgt[u];
+              partWeight[best] += g.vwgt[u];
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+}
+
+/**
+ * Partition a graph with a multilevel algorithm.
+ *
+ * \param g the graph
+ * \param nParts the number of parts
+ * \param imbalance the allowed imbalance
+ * \param part the part of each vertex
+ */
+void
+MultilevelPartition (const Graph &g, uint32_t nParts, double imbalance, std::vector<uint32_t> &part)
+{
+  double total = 0;
+  for (uint32_t u = 0; u < g.GetN (); ++u)
+    {
+      total += g.vwgt[u];
+    }
+  double target = total / nParts;
+  double maxPartWeight = target * (1 + imbalance);
+  uint32_t coarsenTo = COARSEN_VERTICES_PER_SYSTEM * nParts;
+  double maxVertexWeight = 1.5 * total / coarsenTo;
+
+  std::vector<Graph> graphs (1, g);
+  std::vector<std::vector<uint32_t> > cmaps;
+  while (graphs.back ().GetN () > coarsenTo)
+    {
+      std::vector<uint32_t> cmap;
+      Graph coarse = Coarsen (graphs.back (), maxVertexWeight, cmap);
+      uint32_t n = graphs.back ().GetN ();
+      if (coarse.GetN () == n)
+        {
+          break;
+        }
+      graphs.push_back (coarse);
+      cmaps.push_back (cmap);
+      NS_LOG_LOGIC ("Coarsened " << n << " vertices to " << coarse.GetN ());
+      if (coarse.GetN () > 0.9 * n)
+        {
+          break;
+        }
+    }
+
+  GrowPartition (graphs.back (), nParts, target, part);
+  RefinePartition (graphs.back (), nParts, maxPartWeight, part);
+  for (uint32_t level = cmaps.size (); level > 0; --level)
+    {
+      const std::vector<uint32_t> &cmap = cmaps[level - 1];
+      std::vector<uint32_t> finePart (cmap.size ());
+      for (uint32_t u = 0; u < cmap.size (); ++u)
+        {
+          finePart[u] = part[cmap[u]];
+        }
+      part.swap (finePart);
+      RefinePartition (graphs[level - 1], nParts, maxPartWeight, part);
+    }
+}
+
+/**
+ * \param parent the parent of each element of a union-find structure
+ * \param u an element
+ * \returns the representative of the set of u
+ */
+uint32_t
+Find (std::vector<uint32_t> &parent, uint32_t u)
+{
+  while (parent[u] != u)
+    {
+      parent[u] = parent[parent[u]];
+      u = parent[u];
+    }
+  return u;
+}
+
+/**
+ * \param parent the parent of each element of a union-find structure
+ * \param u an element
+ * \param v another element
+ */
+void
+Union (std::vector<uint32_t> &parent, uint32_t u, uint32_t v)
+{
+  u = Find (parent, u);
+  v = Find (parent, v);
+  if (u != v)
+    {
+      parent[std::max (u, v)] = std::min (u, v);
+    }
+}
+
+/**
+ * Check whether sets of nodes can be assigned to the parts without
+ * exceeding their maximum weight, by assigning the heaviest sets first to
+ * the lightest part.
+ *
+ * \param weights the weight of each set
+ * \param nParts the number of parts
+ * \param maxPartWeight the maximum weight of a part
+ * \returns true if the sets fit in the parts
+ */
+bool
+CanBalance (std::vector<double> weights, uint32_t nParts, double maxPartWeight)
+{
+  std::sort (weights.begin (), weights.end ());
+  std::vector<double> partWeight (nParts, 0);
+  for (std::vector<double>::reverse_iterator i = weights.rbegin (); i != weights.rend (); ++i)
+    {
+      std::vector<double>::iterator lightest = std::min_element (partWeight.begin (), partWeight.end ());
+      *lightest += *i;
+      if (*lightest > maxPartWeight)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+} // anonymous namespace
+
+DistributedPartitionHelper::DistributedPartitionHelper ()
+  : m_imbalance (0.05),
+    m_lookahead (Time::Max ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DistributedPartitionHelper::SetImbalance (double imbalance)
+{
+  NS_LOG_FUNCTION (this << imbalance);
+  NS_ABORT_MSG_IF (imbalance < 0, "The imbalance must be positive");
+  m_imbalance = imbalance;
+}
+
+uint32_t
+DistributedPartitionHelper::GetIndex (Ptr<Node> node)
+{
+  std::map<uint32_t, uint32_t>::const_iterator it = m_indices.find (node->GetId ());
+  if (it != m_indices.end ())
+    {
+      return it->second;
+    }
+  uint32_t index = m_nodes.size ();
+  m_indices[node->GetId ()] = index;
+  m_nodes.push_back (node);
+  m_loads.push_back (1.0);
+  return index;
+}
+
+void
+DistributedPartitionHelper::AddNode (Ptr<Node> node, double load)
+{
+  NS_LOG_FUNCTION (this << node << load);
+  NS_ABORT_MSG_IF (load < 0, "The load of a node must be positive");
+  m_loads[GetIndex (node)] = load;
+}
+
+void
+DistributedPartitionHelper::AddNodes (NodeContainer nodes, double load)
+{
+  NS_LOG_FUNCTION (this << load);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      AddNode (*i, load);
+    }
+}
+
+void
+DistributedPartitionHelper::AddLink (Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+  NS_LOG_FUNCTION (this << a << b << delay);
+  NS_ABORT_MSG_IF (delay.IsStrictlyNegative (), "The delay of a link must be positive");
+  Link link;
+  link.a = GetIndex (a);
+  link.b = GetIndex (b);
+  link.delay = delay;
+  m_links.push_back (link);
+}
+
+void
+DistributedPartitionHelper::AddChannel (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<uint32_t> channel;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      channel.push_back (GetIndex (*i));
+    }
+  m_channels.push_back (channel);
+}
+
+void
+DistributedPartitionHelper::Partition (uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << systemCount);
+  NS_ABORT_MSG_IF (systemCount == 0, "The number of systems must be positive");
+
+  uint32_t n = m_nodes.size ();
+  double total = 0;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      total += m_loads[i];
+    }
+  double maxPartWeight = total / systemCount * (1 + m_imbalance);
+
+  // The nodes of the shared channels and of the zero delay links always
+  // go together.
+  std::vector<uint32_t> tied (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      tied[i] = i;
+    }
+  for (std::vector<std::vector<uint32_t> >::const_iterator c = m_channels.begin (); c != m_channels.end (); ++c)
+    {
+      for (uint32_t j = 1; j < c->size (); ++j)
+        {
+          Union (tied, (*c)[0], (*c)[j]);
+        }
+    }
+  std::vector<Time> delays;
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      if (l->delay.IsZero ())
+        {
+          Union (tied, l->a, l->b);
+        }
+      else
+        {
+          delays.push_back (l->delay);
+        }
+    }
+  std::sort (delays.begin (), delays.end ());
+  delays.erase (std::unique (delays.begin (), delays.end ()), delays.end ());
+
+  // Find the largest delay such that the nodes can still be balanced when
+  // the shorter links are not cut.
+  Time threshold = delays.empty () ? Time (0) : delays.front ();
+  std::vector<uint32_t> group = tied;
+  uint32_t lo = 0;
+  uint32_t hi = delays.size ();
+  while (lo + 1 < hi)
+    {
+      uint32_t mid = (lo + hi) / 2;
+      std::vector<uint32_t> parent = tied;
+      for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+        {
+          if (l->delay < delays[mid])
+            {
+              Union (parent, l->a, l->b);
+            }
+        }
+      std::vector<double> weights (n, 0);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          weights[Find (parent, i)] += m_loads[i];
+        }
+      if (CanBalance (weights, systemCount, maxPartWeight))
+        {
+          lo = mid;
+          threshold = delays[mid];
+          group.swap (parent);
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+  NS_LOG_LOGIC ("Links shorter than " << threshold << " are not cut");
+
+  // Build the graph of the groups of nodes, with the longer links weighted
+  // by the inverse of their delay.
+  std::vector<uint32_t> vertex (n, NONE);
+  std::vector<double> vwgt;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t root = Find (group, i);
+      if (vertex[root] == NONE)
+        {
+          vertex[root] = vwgt.size ();
+          vwgt.push_back (0);
+        }
+      vertex[i] = vertex[root];
+      vwgt[vertex[i]] += m_loads[i];
+    }
+  std::vector<Edge> edges;
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      if (vertex[l->a] != vertex[l->b])
+        {
+          double weight = EDGE_WEIGHT_SCALE * threshold.GetDouble () / l->delay.GetDouble ();
+          Edge edge = { vertex[l->a], vertex[l->b], std::max<int64_t> (1, std::floor (weight + 0.5)) };
+          edges.push_back (edge);
+        }
+    }
+
+  std::vector<uint32_t> part (vwgt.size (), 0);
+  if (systemCount > 1 && !vwgt.empty ())
+    {
+      MultilevelPartition (BuildGraph (vwgt, edges), systemCount, m_imbalance, part);
+    }
+
+  m_systemIds.assign (n, 0);
+  m_systemLoads.assign (systemCount, 0);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_systemIds[i] = part[vertex[i]];
+      m_systemLoads[m_systemIds[i]] += m_loads[i];
+      if (m_nodes[i]->GetNDevices () > 0)
+        {
+          NS_LOG_WARN ("Node " << m_nodes[i]->GetId () << " already has devices");
+        }
+      m_nodes[i]->SetAttribute ("SystemId", UintegerValue (m_systemIds[i]));
+    }
+  m_lookahead = Time::Max ();
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      if (m_systemIds[l->a] != m_systemIds[l->b])
+        {
+          m_lookahead = std::min (m_lookahead, l->delay);
+        }
+    }
+  NS_LOG_LOGIC ("Lookahead " << m_lookahead);
+}
+
+uint32_t
+DistributedPartitionHelper::GetSystemId (Ptr<Node> node) const
+{
+  std::map<uint32_t, uint32_t>::const_iterator it = m_indices.find (node->GetId ());
+  NS_ABORT_MSG_IF (it == m_indices.end (), "Node " << node->GetId () << " was not added");
+  NS_ABORT_MSG_IF (it->second >= m_systemIds.size (), "Node " << node->GetId () << " was not partitioned");
+  return m_systemIds[it->second];
+}
+
+Time
+DistributedPartitionHelper::GetLookahead (void) const
+{
+  return m_lookahead;
+}
+
+double
+DistributedPartitionHelper::GetLoad (uint32_t systemId) const
+{
+  NS_ABORT_MSG_IF (systemId >= m_systemLoads.size (), "Invalid system id " << systemId);
+  return m_systemLoads[systemId];
+}
+
+} // namespace ns3
@@ -28,14 +28,13 @@
 #include "ns3/node-container.h"
 #include "ns3/ptr.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <algorithm>
 #include <cmath>
-
-#ifdef NS3_MPI
-#include <mpi.h>
-#endif
+#include <vector>
 
 namespace ns3 {
 
@@ -85,6 +84,15 @@ DistributedSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Mpi")
     .AddConstructor<DistributedSimulatorImpl> ()
+    .AddAttribute ("MaxBatchSize",
+                   "The maximum size in bytes of the messages batching the packets "
+                   "sent to another task during a time window; a batch is sent at "
+                   "the end of the window or as soon as it reaches this size, and "
+                   "a size of 0 sends each packet in its own message",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&DistributedSimulatorImpl::SetMaxBatchSize,
+                                         &DistributedSimulatorImpl::GetMaxBatchSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -93,17 +101,12 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
   m_myId = MpiInterface::GetSystemId ();
   m_systemCount = MpiInterface::GetSize ();
 
   // Allocate the LBTS message buffer
   m_pLBTS = new LbtsMessage[m_systemCount];
   m_grantedTime = Seconds (0);
-#else
-  NS_UNUSED (m_systemCount);
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 
   m_stop = false;
   m_globalFinished = false;
@@ -165,7 +168,6 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
   if (MpiInterface::GetSize () <= 1)
     {
       m_lookAhead = Seconds (0);
@@ -249,8 +251,7 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
    * per unit of simulation time in order to equalize the amount of
    * work per time window.
    */
-  long sendbuf;
-  long recvbuf;
+  int64_t sendbuf;
 
   /* Tasks with no inter-task links do not contribute to max */
   if (m_lookAhead == GetMaximumSimulationTime ())
@@ -262,7 +263,13 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
       sendbuf  = m_lookAhead.GetInteger ();
     }
 
-  MPI_Allreduce (&sendbuf, &recvbuf, 1, MPI_LONG, MPI_MAX, MPI_COMM_WORLD);
+  std::vector<int64_t> lookAheads (m_systemCount);
+  GrantedTimeWindowMpiInterface::AllGather (&sendbuf, &lookAheads[0], sizeof (sendbuf));
+  int64_t recvbuf = 0;
+  for (uint32_t i = 0; i < m_systemCount; ++i)
+    {
+      recvbuf = std::max (recvbuf, lookAheads[i]);
+    }
 
   /* For nodes that did not compute a lookahead use max from ranks
    * that did compute a value.  An edge case occurs if all nodes have
@@ -275,10 +282,6 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
       m_lookAhead = Time (recvbuf);
       m_grantedTime = m_lookAhead;
     }
-
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 }
 
 void
@@ -370,7 +373,6 @@ DistributedSimulatorImpl::Run (void)
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
   CalculateLookAhead ();
   m_stop = false;
   while (!m_globalFinished)
@@ -385,7 +387,9 @@ DistributedSimulatorImpl::Run (void)
       if (nextTime > m_grantedTime || IsLocalFinished () )
         {
           // Can't process next event, calculate a new LBTS
-          // First receive any pending messages
+          // First send the packets batched during the window
+          GrantedTimeWindowMpiInterface::FlushMessages ();
+          // Then receive any pending messages
           GrantedTimeWindowMpiInterface::ReceiveMessages ();
           // reset next time
           nextTime = Next ();
@@ -395,8 +399,7 @@ DistributedSimulatorImpl::Run (void)
           LbtsMessage lMsg (GrantedTimeWindowMpiInterface::GetRxCount (), GrantedTimeWindowMpiInterface::GetTxCount (), 
                             m_myId, IsLocalFinished (), nextTime);
           m_pLBTS[m_myId] = lMsg;
-          MPI_Allgather (&lMsg, sizeof (LbtsMessage), MPI_BYTE, m_pLBTS,
-                         sizeof (LbtsMessage), MPI_BYTE, MPI_COMM_WORLD);
+          GrantedTimeWindowMpiInterface::AllGather (&lMsg, m_pLBTS, sizeof (LbtsMessage));
           Time smallestTime = m_pLBTS[0].GetSmallestTime ();
           // The totRx and totTx counts insure there are no transient
           // messages;  If totRx != totTx, there are transients,
@@ -443,9 +446,19 @@ DistributedSimulatorImpl::Run (void)
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
   NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+}
+
+void
+DistributedSimulatorImpl::SetMaxBatchSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  GrantedTimeWindowMpiInterface::SetMaxBatchSize (size);
+}
+
+uint32_t
+DistributedSimulatorImpl::GetMaxBatchSize (void) const
+{
+  return GrantedTimeWindowMpiInterface::GetMaxBatchSize ();
 }
 
 uint32_t DistributedSimulatorImpl::GetSystemId () const
@@ -643,4 +656,10 @@ DistributedSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+void
+DistributedSimulatorImpl::SetContext (uint32_t context)
+{
+  m_currentContext = context;
+}
+
 } // namespace ns3
@@ -126,11 +126,20 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
+  virtual void SetContext (uint32_t context);
 
 private:
   virtual void DoDispose (void);
   void CalculateLookAhead (void);
   bool IsLocalFinished (void) const;
+  /**
+   * \param size the maximum size of the batches of packets sent to a task
+   */
+  void SetMaxBatchSize (uint32_t size);
+  /**
+   * \return the maximum size of the batches of packets sent to a task
+   */
+  uint32_t GetMaxBatchSize (void) const;
 
   void ProcessOneEvent (void);
   uint64_t NextTs (void) const;
@@ -22,11 +22,13 @@
 
 #include <iostream>
 #include <iomanip>
-#include <list>
+#include <cstring>
 
 #include "granted-time-window-mpi-interface.h"
 #include "mpi-receiver.h"
 #include "mpi-interface.h"
+#include "mpi-transport.h"
+#include "shared-memory-transport.h"
 
 #include "ns3/node.h"
 #include "ns3/node-list.h"
@@ -35,58 +37,29 @@
 #include "ns3/simulator-impl.h"
 #include "ns3/nstime.h"
 #include "ns3/log.h"
-
-#ifdef NS3_MPI
-#include <mpi.h>
-#endif
+#include "ns3/packet.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GrantedTimeWindowMpiInterface");
 
-SentBuffer::SentBuffer ()
-{
-  m_buffer = 0;
-  m_request = 0;
-}
-
-SentBuffer::~SentBuffer ()
-{
-  delete [] m_buffer;
-}
-
-uint8_t*
-SentBuffer::GetBuffer ()
-{
-  return m_buffer;
-}
-
-void
-SentBuffer::SetBuffer (uint8_t* buffer)
-{
-  m_buffer = buffer;
-}
-
-#ifdef NS3_MPI
-MPI_Request*
-SentBuffer::GetRequest ()
-{
-  return &m_request;
-}
-#endif
-
 uint32_t              GrantedTimeWindowMpiInterface::m_sid = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_size = 1;
 bool                  GrantedTimeWindowMpiInterface::m_initialized = false;
 bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
-std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
-
-#ifdef NS3_MPI
-MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
-char**       GrantedTimeWindowMpiInterface::m_pRxBuffers;
-#endif
+uint32_t              GrantedTimeWindowMpiInterface::m_maxBatchSize = 65536;
+std::vector<std::vector<uint8_t> > GrantedTimeWindowMpiInterface::m_txBatches;
+std::vector<uint32_t> GrantedTimeWindowMpiInterface::m_txBatchPackets;
+std::vector<uint8_t>  GrantedTimeWindowMpiInterface::m_rxBuffer;
+ParallelTransport*    GrantedTimeWindowMpiInterface::m_transport = 0;
+
+/**
+ * Size of the header of a packet record: the time, dest node, dest
+ * device and size of the serialized packet
+ */
+static const uint32_t RECORD_HEADER_SIZE = sizeof (uint64_t) + 3 * sizeof (uint32_t);
 
 TypeId 
 GrantedTimeWindowMpiInterface::GetTypeId (void)
@@ -103,16 +76,9 @@ GrantedTimeWindowMpiInterface::Destroy ()
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
-  for (uint32_t i = 0; i < GetSize (); ++i)
-    {
-      delete [] m_pRxBuffers[i];
-    }
-  delete [] m_pRxBuffers;
-  delete [] m_requests;
-
-  m_pendingTx.clear ();
-#endif
+  m_txBatches.clear ();
+  m_txBatchPackets.clear ();
+  m_rxBuffer.clear ();
 }
 
 uint32_t
@@ -127,6 +93,19 @@ GrantedTimeWindowMpiInterface::GetTxCount ()
   return m_txCount;
 }
 
+void
+GrantedTimeWindowMpiInterface::SetMaxBatchSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (size);
+  m_maxBatchSize = size;
+}
+
+uint32_t
+GrantedTimeWindowMpiInterface::GetMaxBatchSize ()
+{
+  return m_maxBatchSize;
+}
+
 uint32_t
 GrantedTimeWindowMpiInterface::GetSystemId ()
 {
@@ -165,26 +144,32 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
 {
   NS_LOG_FUNCTION (this << pargc << pargv); 
 
-#ifdef NS3_MPI
-  // Initialize the MPI interface
-  MPI_Init (pargc, pargv);
-  MPI_Barrier (MPI_COMM_WORLD);
-  MPI_Comm_rank (MPI_COMM_WORLD, reinterpret_cast <int *> (&m_sid));
-  MPI_Comm_size (MPI_COMM_WORLD, reinterpret_cast <int *> (&m_size));
+  MpiTransport* transport = new MpiTransport ();
+  transport->Enable (pargc, pargv);
+  Initialize (transport);
+}
+
+void
+GrantedTimeWindowMpiInterface::Enable (uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << systemCount);
+
+  SharedMemoryTransport* transport = new SharedMemoryTransport ();
+  transport->Enable (systemCount);
+  Initialize (transport);
+}
+
+void
+GrantedTimeWindowMpiInterface::Initialize (ParallelTransport* transport)
+{
+  m_transport = transport;
+  m_sid = transport->GetSystemId ();
+  m_size = transport->GetSize ();
   m_enabled = true;
   m_initialized = true;
-  // Post a non-blocking receive for all peers
-  m_pRxBuffers = new char*[m_size];
-  m_requests = new MPI_Request[m_size];
-  for (uint32_t i = 0; i < GetSize (); ++i)
-    {
-      m_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
-      MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[i]);
-    }
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  // One batch of packets per peer
+  m_txBatches.resize (m_size);
+  m_txBatchPackets.resize (m_size, 0);
 }
 
 void
@@ -192,98 +177,127 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
 {
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
-#ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
+  // Find the system id for the destination node
+  Ptr<Node> destNode = NodeList::GetNode (node);
+  uint32_t nodeSysId = destNode->GetSystemId ();
 
+  std::vector<uint8_t> &batch = m_txBatches[nodeSysId];
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
+  if (!batch.empty () && batch.size () + RECORD_HEADER_SIZE + serializedSize > m_maxBatchSize)
+    {
+      Flush (nodeSysId);
+    }
+
+  // Add the time, dest node, dest device and size
+  uint32_t offset = batch.size ();
+  batch.resize (offset + RECORD_HEADER_SIZE + serializedSize);
+  uint8_t* buffer = &batch[offset];
   uint64_t t = rxTime.GetInteger ();
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = t;
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = node;
-  *pData++ = dev;
+  std::memcpy (buffer, &t, sizeof (t));
+  buffer += sizeof (t);
+  std::memcpy (buffer, &node, sizeof (node));
+  buffer += sizeof (node);
+  std::memcpy (buffer, &dev, sizeof (dev));
+  buffer += sizeof (dev);
+  std::memcpy (buffer, &serializedSize, sizeof (serializedSize));
+  buffer += sizeof (serializedSize);
   // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
+  p->Serialize (buffer, serializedSize);
+  m_txBatchPackets[nodeSysId]++;
 
-  // Find the system id for the destination node
-  Ptr<Node> destNode = NodeList::GetNode (node);
-  uint32_t nodeSysId = destNode->GetSystemId ();
-
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (i->GetRequest ()));
-  m_txCount++;
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  if (batch.size () >= m_maxBatchSize)
+    {
+      Flush (nodeSysId);
+    }
 }
 
 void
-GrantedTimeWindowMpiInterface::ReceiveMessages ()
-{ 
-  NS_LOG_FUNCTION_NOARGS ();
+GrantedTimeWindowMpiInterface::Flush (uint32_t rank)
+{
+  NS_LOG_FUNCTION (rank);
 
-#ifdef NS3_MPI
-  // Poll the non-block reads to see if data arrived
-  while (true)
+  std::vector<uint8_t> &batch = m_txBatches[rank];
+  if (batch.empty ())
     {
-      int flag = 0;
-      int index = 0;
-      MPI_Status status;
+      return;
+    }
 
-      MPI_Testany (MpiInterface::GetSize (), m_requests, &index, &flag, &status);
-      if (!flag)
-        {
-          break;        // No more messages
-        }
-      int count;
-      MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
+  NS_LOG_LOGIC ("Sending " << m_txBatchPackets[rank] << " packets in " << batch.size () << " bytes to rank " << rank);
+  m_transport->Send (rank, &batch[0], batch.size ());
+  m_txCount += m_txBatchPackets[rank];
 
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
+  // Keep the capacity of the batch for the next window
+  batch.clear ();
+  m_txBatchPackets[rank] = 0;
+}
 
-      Time rxTime (time);
+void
+GrantedTimeWindowMpiInterface::FlushMessages ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
 
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
+  for (uint32_t rank = 0; rank < m_txBatches.size (); ++rank)
+    {
+      Flush (rank);
+    }
+}
 
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
+void
+GrantedTimeWindowMpiInterface::ReceiveMessages ()
+{ 
+  NS_LOG_FUNCTION_NOARGS ();
 
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
+  // Poll for messages, each one batching several packets
+  uint32_t rank;
+  while (m_transport->Receive (false, rank, m_rxBuffer))
+    {
+      const uint8_t* pData = m_rxBuffer.empty () ? 0 : &m_rxBuffer[0];
+      const uint8_t* pEnd = pData + m_rxBuffer.size ();
+      while (pData < pEnd)
         {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          m_rxCount++; // Count this receive
+
+          // Get the meta data first
+          uint64_t time;
+          uint32_t node;
+          uint32_t dev;
+          uint32_t size;
+          std::memcpy (&time, pData, sizeof (time));
+          pData += sizeof (time);
+          std::memcpy (&node, pData, sizeof (node));
+          pData += sizeof (node);
+          std::memcpy (&dev, pData, sizeof (dev));
+          pData += sizeof (dev);
+          std::memcpy (&size, pData, sizeof (size));
+          pData += sizeof (size);
+          NS_ASSERT (pData + size <= pEnd);
+
+          Time rxTime (time);
+
+          Ptr<Packet> p = Create<Packet> (pData, size, true);
+          pData += size;
+
+          // Find the correct node/device to schedule receive event
+          Ptr<Node> pNode = NodeList::GetNode (node);
+          Ptr<MpiReceiver> pMpiRec = 0;
+          uint32_t nDevices = pNode->GetNDevices ();
+          for (uint32_t i = 0; i < nDevices; ++i)
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+              if (pThisDev->GetIfIndex () == dev)
+                {
+                  pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                  break;
+                }
             }
-        }
-
-      NS_ASSERT (pNode && pMpiRec);
 
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
+          NS_ASSERT (pNode && pMpiRec);
 
-      // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[index]);
+          // Schedule the rx event
+          Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                          &MpiReceiver::Receive, pMpiRec, p);
+        }
     }
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 }
 
 void
@@ -291,23 +305,15 @@ GrantedTimeWindowMpiInterface::TestSendComplete ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-#ifdef NS3_MPI
-  std::list<SentBuffer>::iterator i = m_pendingTx.begin ();
-  while (i != m_pendingTx.end ())
-    {
-      MPI_Status status;
-      int flag = 0;
-      MPI_Test (i->GetRequest (), &flag, &status);
-      std::list<SentBuffer>::iterator current = i; // Save current for erasing
-      i++;                                    // Advance to next
-      if (flag)
-        { // This message is complete
-          m_pendingTx.erase (current);
-        }
-    }
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  m_transport->TestSendComplete ();
+}
+
+void
+GrantedTimeWindowMpiInterface::AllGather (const void* sendBuffer, void* recvBuffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (sendBuffer << recvBuffer << size);
+
+  m_transport->AllGather (sendBuffer, recvBuffer, size);
 }
 
 void
@@ -315,22 +321,12 @@ GrantedTimeWindowMpiInterface::Disable ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-#ifdef NS3_MPI
-  int flag = 0;
-  MPI_Initialized (&flag);
-  if (flag)
-    {
-      MPI_Finalize ();
-      m_enabled = false;
-      m_initialized = false;
-    }
-  else
-    {
-      NS_FATAL_ERROR ("Cannot disable MPI environment without Initializing it first");
-    }
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  NS_ASSERT (m_transport);
+  m_transport->Disable ();
+  delete m_transport;
+  m_transport = 0;
+  m_enabled = false;
+  m_initialized = false;
 }
 
 
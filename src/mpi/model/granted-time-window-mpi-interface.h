@@ -24,60 +24,17 @@
 #define NS3_GRANTED_TIME_WINDOW_MPI_INTERFACE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
 
 #include "parallel-communication-interface.h"
 
-#ifdef NS3_MPI
-#include "mpi.h"
-#else
-typedef void* MPI_Request;
-#endif
-
 namespace ns3 {
 
-/**
- * maximum MPI message size for easy
- * buffer creation
- */
-const uint32_t MAX_MPI_MSG_SIZE = 2000;
-
-/**
- * \ingroup mpi
- *
- * \brief Tracks non-blocking sends
- *
- * This class is used to keep track of the asynchronous non-blocking
- * sends that have been posted.
- */
-class SentBuffer
-{
-public:
-  SentBuffer ();
-  ~SentBuffer ();
-
-  /**
-   * \return pointer to sent buffer
-   */
-  uint8_t* GetBuffer ();
-  /**
-   * \param buffer pointer to sent buffer
-   */
-  void SetBuffer (uint8_t* buffer);
-  /**
-   * \return MPI request
-   */
-  MPI_Request* GetRequest ();
-
-private:
-  uint8_t* m_buffer;
-  MPI_Request m_request;
-};
-
 class Packet;
+class ParallelTransport;
 
 /**
  * \ingroup mpi
@@ -87,6 +44,12 @@ class Packet;
  * Implements the interface used by the singleton parallel controller
  * to interface between NS3 and the communications layer being
  * used for inter-task packet transfers.
+ *
+ * The packets sent to a task are batched into a single message, which
+ * is sent at the end of the time window, or as soon as it reaches the
+ * maximum batch size.  The messages are exchanged through MPI, or
+ * through shared memory between local processes (see
+ * SharedMemoryTransport).
  */
 class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -98,11 +61,11 @@ public:
    */
   virtual void Destroy ();
   /**
-   * \return MPI rank
+   * \return system id (MPI rank)
    */
   virtual uint32_t GetSystemId ();
   /**
-   * \return MPI size (number of systems)
+   * \return number of systems (MPI size)
    */
   virtual uint32_t GetSize ();
   /**
@@ -117,7 +80,14 @@ public:
    */
   virtual void Enable (int* pargc, char*** pargv);
   /**
-   * Terminates the MPI environment by calling MPI_Finalize
+   * \param systemCount number of systems
+   *
+   * Sets up the shared memory interface between systemCount local
+   * processes
+   */
+  virtual void Enable (uint32_t systemCount);
+  /**
+   * Terminates the parallel environment, e.g., by calling MPI_Finalize
    * This function must be called after Destroy ()
    * It also resets m_initialized, m_enabled
    */
@@ -128,9 +98,23 @@ public:
    * \param node destination node
    * \param dev destination device
    *
-   * Serialize and send a packet to the specified node and net device
+   * Serialize a packet to the specified node and net device, and add
+   * it to the batch of packets for the task of the node
+   *
+   * \internal
+   * A message is a sequence of packet records, each made of:
+   *
+   * uint64_t time the packet should be delivered
+   * uint32_t node id of destination
+   * uint32_t dev id on destination
+   * uint32_t size of the serialized packet
+   * uint8_t[] serialized packet
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Send the batches of packets to all the tasks
+   */
+  static void FlushMessages ();
   /**
    * Check for received messages complete
    */
@@ -147,8 +131,41 @@ public:
    * \return transmitted count in packets
    */
   static uint32_t GetTxCount ();
+  /**
+   * \param size the maximum size of a batch, in bytes
+   *
+   * A batch is sent as soon as it reaches this size; a batch size of 0
+   * sends each packet in its own message.
+   */
+  static void SetMaxBatchSize (uint32_t size);
+  /**
+   * \return the maximum size of a batch, in bytes
+   */
+  static uint32_t GetMaxBatchSize ();
+  /**
+   * \param sendBuffer the data of this task
+   * \param recvBuffer the data of all the tasks, by system id
+   * \param size the size of the data of each task, in bytes
+   *
+   * Gather the data of all the tasks, in all the tasks
+   */
+  static void AllGather (const void* sendBuffer, void* recvBuffer, uint32_t size);
 
 private:
+  /**
+   * \param transport the transport of the messages
+   *
+   * Set up the interface once the transport is enabled
+   */
+  static void Initialize (ParallelTransport* transport);
+
+  /**
+   * \param rank the task to send the batch to
+   *
+   * Send the batch of packets to a task, if it is not empty
+   */
+  static void Flush (uint32_t rank);
+
   static uint32_t m_sid;
   static uint32_t m_size;
 
@@ -160,14 +177,20 @@ private:
   static bool     m_initialized;
   static bool     m_enabled;
 
-  // Pending non-blocking receives
-  static MPI_Request* m_requests;
+  // Maximum size of a batch, in bytes
+  static uint32_t m_maxBatchSize;
+
+  // Batches of serialized packets, per destination task
+  static std::vector<std::vector<uint8_t> > m_txBatches;
+
+  // Number of packets in each batch
+  static std::vector<uint32_t> m_txBatchPackets;
 
-  // Data buffers for non-blocking reads
-  static char**   m_pRxBuffers;
+  // Data buffer for receives
+  static std::vector<uint8_t> m_rxBuffer;
 
-  // List of pending non-blocking sends
-  static std::list<SentBuffer> m_pendingTx;
+  // Transport of the messages between tasks
+  static ParallelTransport* m_transport;
 };
 
 } // namespace ns3
@@ -26,6 +26,8 @@
 #include <ns3/log.h>
 
 #include "null-message-mpi-interface.h"
+#include "remote-channel-bundle.h"
+#include "remote-channel-bundle-manager.h"
 #include "granted-time-window-mpi-interface.h"
 
 namespace ns3 {
@@ -73,7 +75,7 @@ MpiInterface::IsEnabled ()
 }
 
 void
-MpiInterface::Enable (int* pargc, char*** pargv)
+MpiInterface::CreateInterface ()
 {
   StringValue simulationTypeValue;
   bool useDefault = true;
@@ -104,10 +106,22 @@ MpiInterface::Enable (int* pargc, char*** pargv)
                          StringValue ("ns3::DistributedSimulatorImpl"));
       NS_LOG_WARN ("SimulatorImplementationType was set to non-parallel simulator; setting type to ns3::DistributedSimulatorImp");
     }
+}
 
+void
+MpiInterface::Enable (int* pargc, char*** pargv)
+{
+  CreateInterface ();
   g_parallelCommunicationInterface->Enable (pargc, pargv);
 }
 
+void
+MpiInterface::Enable (uint32_t systemCount)
+{
+  CreateInterface ();
+  g_parallelCommunicationInterface->Enable (systemCount);
+}
+
 void
 MpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
 {
@@ -115,6 +129,34 @@ MpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint
   g_parallelCommunicationInterface->SendPacket (p, rxTime, node, dev);
 }
 
+uint64_t
+MpiInterface::GetNullMessagesSent (uint32_t systemId)
+{
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (systemId);
+  return bundle ? bundle->GetNullMessagesSent () : 0;
+}
+
+uint64_t
+MpiInterface::GetDataMessagesSent (uint32_t systemId)
+{
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (systemId);
+  return bundle ? bundle->GetDataMessagesSent () : 0;
+}
+
+uint64_t
+MpiInterface::GetNullMessagesReceived (uint32_t systemId)
+{
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (systemId);
+  return bundle ? bundle->GetNullMessagesReceived () : 0;
+}
+
+uint64_t
+MpiInterface::GetDataMessagesReceived (uint32_t systemId)
+{
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (systemId);
+  return bundle ? bundle->GetDataMessagesReceived () : 0;
+}
+
 
 void
 MpiInterface::Disable ()
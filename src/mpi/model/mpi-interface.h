@@ -80,6 +80,19 @@ public:
    * Enable is invoked.
    */
   static void Enable (int* pargc, char*** pargv);
+  /**
+   * \param systemCount number of parallel tasks
+   *
+   * \brief Sets up parallel communication interface between local
+   * processes, without MPI.
+   *
+   * The calling process forks systemCount - 1 processes, which
+   * exchange messages through shared memory; Enable returns in each of
+   * them, with system ids 0 to systemCount - 1.  The processes must not
+   * have started threads yet.  SimulatorImplementationType attribute in
+   * ns3::GlobalValues must be set before Enable is invoked.
+   */
+  static void Enable (uint32_t systemCount);
   /**
    * Terminates the parallel environment.
    * This function must be called after Destroy ()
@@ -94,7 +107,42 @@ public:
    * Serialize and send a packet to the specified node and net device
    */
   static void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * \param systemId the system id of a remote task
+   * \return number of Null Messages sent to the remote task
+   *
+   * The message counts are only kept by the NullMessageSimulatorImpl,
+   * for the tasks linked to this one by a remote channel.  They are 0
+   * otherwise, and are reset by Simulator::Destroy.
+   */
+  static uint64_t GetNullMessagesSent (uint32_t systemId);
+  /**
+   * \param systemId the system id of a remote task
+   * \return number of messages with packets sent to the remote task
+   *
+   * \see GetNullMessagesSent
+   */
+  static uint64_t GetDataMessagesSent (uint32_t systemId);
+  /**
+   * \param systemId the system id of a remote task
+   * \return number of Null Messages received from the remote task
+   *
+   * \see GetNullMessagesSent
+   */
+  static uint64_t GetNullMessagesReceived (uint32_t systemId);
+  /**
+   * \param systemId the system id of a remote task
+   * \return number of messages with packets received from the remote task
+   *
+   * \see GetNullMessagesSent
+   */
+  static uint64_t GetDataMessagesReceived (uint32_t systemId);
 private:
+  /**
+   * Instantiate the communication interface for the
+   * SimulatorImplementationType attribute
+   */
+  static void CreateInterface ();
 
   /**
    * Static instance of the instantiated parallel controller.
@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+
+#include "mpi-transport.h"
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MpiTransport");
+
+SentBuffer::SentBuffer ()
+{
+  m_buffer = 0;
+  m_request = 0;
+}
+
+SentBuffer::~SentBuffer ()
+{
+  delete [] m_buffer;
+}
+
+uint8_t*
+SentBuffer::GetBuffer ()
+{
+  return m_buffer;
+}
+
+void
+SentBuffer::SetBuffer (uint8_t* buffer)
+{
+  m_buffer = buffer;
+}
+
+MPI_Request*
+SentBuffer::GetRequest ()
+{
+  return &m_request;
+}
+
+MpiTransport::MpiTransport ()
+  : m_sid (0),
+    m_size (1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MpiTransport::Enable (int* pargc, char*** pargv)
+{
+  NS_LOG_FUNCTION (this << pargc << pargv);
+
+#ifdef NS3_MPI
+  // Initialize the MPI interface
+  MPI_Init (pargc, pargv);
+  MPI_Barrier (MPI_COMM_WORLD);
+
+  // SystemId and Size are unit32_t in interface but MPI uses int so convert.
+  int mpiSystemId;
+  int mpiSize;
+  MPI_Comm_rank (MPI_COMM_WORLD, &mpiSystemId);
+  MPI_Comm_size (MPI_COMM_WORLD, &mpiSize);
+
+  m_sid = mpiSystemId;
+  m_size = mpiSize;
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+uint32_t
+MpiTransport::GetSystemId ()
+{
+  return m_sid;
+}
+
+uint32_t
+MpiTransport::GetSize ()
+{
+  return m_size;
+}
+
+void
+MpiTransport::Send (uint32_t rank, const uint8_t* buffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << rank << size);
+
+#ifdef NS3_MPI
+  SentBuffer sendBuf;
+  m_pendingTx.push_back (sendBuf);
+  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
+
+  uint8_t* copy = new uint8_t[size];
+  std::memcpy (copy, buffer, size);
+  i->SetBuffer (copy);
+
+  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), size, MPI_CHAR, rank,
+             0, MPI_COMM_WORLD, (i->GetRequest ()));
+#endif
+}
+
+bool
+MpiTransport::Receive (bool blocking, uint32_t &rank, std::vector<uint8_t> &message)
+{
+  NS_LOG_FUNCTION (this << blocking);
+
+#ifdef NS3_MPI
+  int flag = 0;
+  MPI_Status status;
+  if (blocking)
+    {
+      MPI_Probe (MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
+      flag = 1; /* Wait always implies message was received */
+    }
+  else
+    {
+      MPI_Iprobe (MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &flag, &status);
+    }
+  if (!flag)
+    {
+      return false;
+    }
+
+  int count;
+  MPI_Get_count (&status, MPI_CHAR, &count);
+  message.resize (count);
+  MPI_Recv (count ? &message[0] : 0, count, MPI_CHAR, status.MPI_SOURCE, 0,
+            MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  rank = status.MPI_SOURCE;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+MpiTransport::TestSendComplete ()
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  std::list<SentBuffer>::iterator i = m_pendingTx.begin ();
+  while (i != m_pendingTx.end ())
+    {
+      MPI_Status status;
+      int flag = 0;
+      MPI_Test (i->GetRequest (), &flag, &status);
+      std::list<SentBuffer>::iterator current = i; // Save current for erasing
+      i++;                                    // Advance to next
+      if (flag)
+        { // This message is complete
+          m_pendingTx.erase (current);
+        }
+    }
+#endif
+}
+
+void
+MpiTransport::AllGather (const void* sendBuffer, void* recvBuffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+
+#ifdef NS3_MPI
+  MPI_Allgather (const_cast<void *> (sendBuffer), size, MPI_BYTE, recvBuffer,
+                 size, MPI_BYTE, MPI_COMM_WORLD);
+#endif
+}
+
+void
+MpiTransport::Disable ()
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  int flag = 0;
+  MPI_Initialized (&flag);
+  if (flag)
+    {
+      for (std::list<SentBuffer>::iterator i = m_pendingTx.begin ();
+           i != m_pendingTx.end ();
+           ++i)
+        {
+          MPI_Cancel (i->GetRequest ());
+          MPI_Request_free (i->GetRequest ());
+        }
+
+      MPI_Finalize ();
+      m_pendingTx.clear ();
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Cannot disable MPI environment without Initializing it first");
+    }
+#endif
+}
+
+} // namespace ns3
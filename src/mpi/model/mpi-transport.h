@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MPI_TRANSPORT_H
+#define NS3_MPI_TRANSPORT_H
+
+#include <stdint.h>
+#include <list>
+#include <vector>
+
+#include "parallel-transport.h"
+
+#ifdef NS3_MPI
+#include "mpi.h"
+#else
+typedef void* MPI_Request;
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Tracks non-blocking sends
+ *
+ * This class is used to keep track of the asynchronous non-blocking
+ * sends that have been posted.
+ */
+class SentBuffer
+{
+public:
+  SentBuffer ();
+  ~SentBuffer ();
+
+  /**
+   * \return pointer to sent buffer
+   */
+  uint8_t* GetBuffer ();
+  /**
+   * \param buffer pointer to sent buffer
+   */
+  void SetBuffer (uint8_t* buffer);
+  /**
+   * \return MPI request
+   */
+  MPI_Request* GetRequest ();
+
+private:
+  uint8_t* m_buffer;
+  MPI_Request m_request;
+};
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Exchange the messages of a parallel simulation through MPI
+ */
+class MpiTransport : public ParallelTransport
+{
+public:
+  MpiTransport ();
+
+  /**
+   * \param pargc number of command line arguments
+   * \param pargv command line arguments
+   *
+   * Initialize MPI
+   */
+  void Enable (int* pargc, char*** pargv);
+
+  virtual uint32_t GetSystemId ();
+  virtual uint32_t GetSize ();
+  virtual void Send (uint32_t rank, const uint8_t* buffer, uint32_t size);
+  virtual bool Receive (bool blocking, uint32_t &rank, std::vector<uint8_t> &message);
+  virtual void TestSendComplete ();
+  virtual void AllGather (const void* sendBuffer, void* recvBuffer, uint32_t size);
+  /**
+   * Cancel the pending sends and terminate the MPI environment by
+   * calling MPI_Finalize
+   */
+  virtual void Disable ();
+
+private:
+  uint32_t m_sid;
+  uint32_t m_size;
+
+  // List of pending non-blocking sends
+  std::list<SentBuffer> m_pendingTx;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MPI_TRANSPORT_H */
@@ -24,6 +24,8 @@
 #include "null-message-simulator-impl.h"
 #include "remote-channel-bundle-manager.h"
 #include "remote-channel-bundle.h"
+#include "mpi-transport.h"
+#include "shared-memory-transport.h"
 
 #include "ns3/mpi-receiver.h"
 #include "ns3/node.h"
@@ -32,77 +34,40 @@
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
-
-#ifdef NS3_MPI
-#include <mpi.h>
-#endif
+#include "ns3/packet.h"
 
 #include <iostream>
 #include <iomanip>
-#include <list>
+#include <cstring>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NullMessageMpiInterface");
 
 /**
- * maximum MPI message size for easy
- * buffer creation
+ * Size of the header of a packet record: the time, dest node, dest
+ * device and size of the serialized packet
  */
-#ifdef NS3_MPI
-const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
-#endif
-
-NullMessageSentBuffer::NullMessageSentBuffer ()
-{
-  m_buffer = 0;
-  m_request = 0;
-}
-
-NullMessageSentBuffer::~NullMessageSentBuffer ()
-{
-  delete [] m_buffer;
-}
-
-uint8_t*
-NullMessageSentBuffer::GetBuffer ()
-{
-  return m_buffer;
-}
-
-void
-NullMessageSentBuffer::SetBuffer (uint8_t* buffer)
-{
-  m_buffer = buffer;
-}
+const uint32_t NULL_MESSAGE_RECORD_HEADER_SIZE = sizeof (uint64_t) + 3 * sizeof (uint32_t);
 
-MPI_Request*
-NullMessageSentBuffer::GetRequest ()
-{
-  return &m_request;
-}
+/**
+ * Size of the guarantee time at the start of a message
+ */
+const uint32_t NULL_MESSAGE_GUARANTEE_SIZE = sizeof (uint64_t);
 
 uint32_t              NullMessageMpiInterface::g_sid = 0;
 uint32_t              NullMessageMpiInterface::g_size = 1;
 uint32_t              NullMessageMpiInterface::g_numNeighbors = 0;
 bool                  NullMessageMpiInterface::g_initialized = false;
 bool                  NullMessageMpiInterface::g_enabled = false;
-std::list<NullMessageSentBuffer> NullMessageMpiInterface::g_pendingTx;
+ParallelTransport*    NullMessageMpiInterface::g_transport = 0;
 
-MPI_Request* NullMessageMpiInterface::g_requests;
-char**       NullMessageMpiInterface::g_pRxBuffers;
+std::vector<std::vector<uint8_t> > NullMessageMpiInterface::g_txBatches;
+std::vector<uint8_t> NullMessageMpiInterface::g_rxBuffer;
 
 NullMessageMpiInterface::NullMessageMpiInterface ()
 {
   NS_LOG_FUNCTION (this);
-
-#ifndef NS3_MPI
-  /*
-   * This class can only be constructed if MPI is available.  Fail if an 
-   * attempt is made to instantiate this class without MPI.
-   */
-  NS_FATAL_ERROR ("Must compile with MPI if Null Message simulator is used, see --enable-mpi option for waf");
-#endif
 }
 
 NullMessageMpiInterface::~NullMessageMpiInterface ()
@@ -145,52 +110,44 @@ void
 NullMessageMpiInterface::Enable (int* pargc, char*** pargv)
 {
   NS_LOG_FUNCTION (this << *pargc);
-#ifdef NS3_MPI
 
-  // Initialize the MPI interface
-  MPI_Init (pargc, pargv);
-  MPI_Barrier (MPI_COMM_WORLD);
+  MpiTransport* transport = new MpiTransport ();
+  transport->Enable (pargc, pargv);
+  Initialize (transport);
+}
 
-  // SystemId and Size are unit32_t in interface but MPI uses int so convert.
-  int mpiSystemId;
-  int mpiSize;
-  MPI_Comm_rank (MPI_COMM_WORLD, &mpiSystemId);
-  MPI_Comm_size (MPI_COMM_WORLD, &mpiSize);
+void
+NullMessageMpiInterface::Enable (uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << systemCount);
+
+  SharedMemoryTransport* transport = new SharedMemoryTransport ();
+  transport->Enable (systemCount);
+  Initialize (transport);
+}
 
-  g_sid = mpiSystemId;
-  g_size = mpiSize;
+void
+NullMessageMpiInterface::Initialize (ParallelTransport* transport)
+{
+  g_transport = transport;
+  g_sid = transport->GetSystemId ();
+  g_size = transport->GetSize ();
 
   g_enabled = true;
   g_initialized = true;
-
-#endif
 }
 
 void 
 NullMessageMpiInterface::InitializeSendReceiveBuffers(void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-#ifdef NS3_MPI
   NS_ASSERT (g_enabled);
 
   g_numNeighbors = RemoteChannelBundleManager::Size();
 
-  // Post a non-blocking receive for all peers
-  g_requests = new MPI_Request[g_numNeighbors];
-  g_pRxBuffers = new char*[g_numNeighbors];
-  int index = 0;
-  for (uint32_t rank = 0; rank < g_size; ++rank)
-    {
-      Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(rank);
-      if (bundle) 
-        {
-          g_pRxBuffers[index] = new char[NULL_MESSAGE_MAX_MPI_MSG_SIZE];
-          MPI_Irecv (g_pRxBuffers[index], NULL_MESSAGE_MAX_MPI_MSG_SIZE, MPI_CHAR, rank, 0,
-                     MPI_COMM_WORLD, &g_requests[index]);
-          ++index;
-        }
-    }
-#endif
+  // One batch of packets per peer; messages are received as they
+  // are probed, whatever their size
+  g_txBatches.assign (g_size, std::vector<uint8_t> (NULL_MESSAGE_GUARANTEE_SIZE));
 }
 
 void
@@ -200,72 +157,109 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 
   NS_ASSERT (g_enabled);
 
-#ifdef NS3_MPI
-
   // Find the system id for the destination node
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
 
-  NullMessageSentBuffer sendBuf;
-  g_pendingTx.push_back (sendBuf);
-  std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
+  // The channel is busy until the packet is serialized
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (nodeSysId);
+  NS_ASSERT (bundle);
+  bundle->NotifyPacketSent (destNode->GetDevice (dev)->GetChannel ()->GetId (), rxTime);
 
+  uint32_t maxBatchSize = NullMessageSimulatorImpl::GetInstance ()->m_maxBatchSize;
+  std::vector<uint8_t> &batch = g_txBatches[nodeSysId];
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint32_t bufferSize = serializedSize + ( 2 * sizeof (uint64_t) ) + ( 2 * sizeof (uint32_t) );
-  uint8_t* buffer =  new uint8_t[bufferSize];
-  iter->SetBuffer (buffer);
-  // Add the time, dest node and dest device
+  if (batch.size () > NULL_MESSAGE_GUARANTEE_SIZE
+      && batch.size () + NULL_MESSAGE_RECORD_HEADER_SIZE + serializedSize > maxBatchSize)
+    {
+      Flush (nodeSysId);
+    }
+
+  // Add the time, dest node, dest device and size
+  uint32_t offset = batch.size ();
+  batch.resize (offset + NULL_MESSAGE_RECORD_HEADER_SIZE + serializedSize);
+  uint8_t* buffer = &batch[offset];
   uint64_t t = rxTime.GetInteger ();
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = t;
+  std::memcpy (buffer, &t, sizeof (t));
+  buffer += sizeof (t);
+  std::memcpy (buffer, &node, sizeof (node));
+  buffer += sizeof (node);
+  std::memcpy (buffer, &dev, sizeof (dev));
+  buffer += sizeof (dev);
+  std::memcpy (buffer, &serializedSize, sizeof (serializedSize));
+  buffer += sizeof (serializedSize);
+  // Serialize the packet
+  p->Serialize (buffer, serializedSize);
+
+  if (batch.size () >= maxBatchSize)
+    {
+      Flush (nodeSysId);
+    }
+}
 
-  Time guarantee_update = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (nodeSysId);
-  *pTime++ = guarantee_update.GetTimeStep ();
+void
+NullMessageMpiInterface::SendMessage (uint32_t rank, const Time& guaranteeUpdate)
+{
+  NS_LOG_FUNCTION (rank << guaranteeUpdate.GetTimeStep ());
 
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = node;
-  *pData++ = dev;
-  // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
+  std::vector<uint8_t> &batch = g_txBatches[rank];
 
-  MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (iter->GetRequest ()));
+  // Add the guarantee time, before the batched packets
+  uint64_t guarantee = guaranteeUpdate.GetInteger ();
+  std::memcpy (&batch[0], &guarantee, sizeof (guarantee));
 
-  NullMessageSimulatorImpl::GetInstance ()->RescheduleNullMessageEvent (nodeSysId);
+  NS_LOG_LOGIC ("Sending " << batch.size () << " bytes to rank " << rank);
+  g_transport->Send (rank, &batch[0], batch.size ());
 
-#endif
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (rank);
+  NS_ASSERT (bundle);
+  bundle->NotifyMessageSent (guaranteeUpdate, batch.size () > NULL_MESSAGE_GUARANTEE_SIZE);
+
+  // Keep the capacity of the batch for the next packets
+  batch.resize (NULL_MESSAGE_GUARANTEE_SIZE);
 }
 
 void
-NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle)
+NullMessageMpiInterface::Flush (uint32_t rank)
 {
-  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << bundle);
+  NS_LOG_FUNCTION (rank);
+
+  if (g_txBatches[rank].size () == NULL_MESSAGE_GUARANTEE_SIZE)
+    {
+      return;
+    }
+
+  Time guarantee_update = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (rank);
+  SendMessage (rank, guarantee_update);
+
+  NullMessageSimulatorImpl::GetInstance ()->RescheduleNullMessageEvent (rank);
+}
+
+void
+NullMessageMpiInterface::FlushMessages ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
 
   NS_ASSERT (g_enabled);
 
-#ifdef NS3_MPI
+  for (uint32_t rank = 0; rank < g_txBatches.size (); ++rank)
+    {
+      Flush (rank);
+    }
+}
 
-  NullMessageSentBuffer sendBuf;
-  g_pendingTx.push_back (sendBuf);
-  std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
+void
+NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle)
+{
+  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << bundle);
 
-  uint32_t bufferSize = 2 * sizeof (uint64_t) + 2 * sizeof (uint32_t);
-  uint8_t* buffer =  new uint8_t[bufferSize];
-  iter->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = 0;
-  *pTime++ = guarantee_update.GetInteger ();
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = 0;
-  *pData++ = 0;
+  NS_ASSERT (g_enabled);
 
   // Find the system id for the destination MPI rank
   uint32_t nodeSysId = bundle->GetSystemId ();
 
-  MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (iter->GetRequest ()));
-#endif
+  // The packets batched for the rank, if any, are sent in the Null Message
+  SendMessage (nodeSysId, guarantee_update);
 }
 
 void
@@ -293,98 +287,79 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
 
   NS_ASSERT (g_enabled);
 
-#ifdef NS3_MPI
-
-  // stop flag set to true when no more messages are found to
-  // process.
-  bool stop = false;
-
-
   if (!g_numNeighbors) {
     // Not communicating with anyone.
     return;
   }
 
-  do
+  // When blocking, return after the first message; otherwise receive
+  // the messages until none is found.
+  uint32_t rank;
+  while (g_transport->Receive (blocking, rank, g_rxBuffer))
     {
-      int messageReceived = 0;
-      int index = 0;
-      MPI_Status status;
-
-      if (blocking)
+      // Get the guarantee time first
+      NS_ASSERT (g_rxBuffer.size () >= NULL_MESSAGE_GUARANTEE_SIZE);
+      const uint8_t* pData = &g_rxBuffer[0];
+      const uint8_t* pEnd = pData + g_rxBuffer.size ();
+      uint64_t guaranteeUpdate;
+      std::memcpy (&guaranteeUpdate, pData, sizeof (guaranteeUpdate));
+      pData += sizeof (guaranteeUpdate);
+
+      // A Null Message has no packet
+      while (pData < pEnd)
         {
-          MPI_Waitany (g_numNeighbors, g_requests, &index, &status);
-          messageReceived = 1; /* Wait always implies message was received */
-          stop = true;
-        }
-      else
-        {
-          MPI_Testany (g_numNeighbors, g_requests, &index, &messageReceived, &status);
-        }
-
-      if (messageReceived)
-        {
-          int count;
-          MPI_Get_count (&status, MPI_CHAR, &count);
-
-          // Get the meta data first
-          uint64_t* pTime = reinterpret_cast<uint64_t *> (g_pRxBuffers[index]);
-          uint64_t time = *pTime++;
-          uint64_t guaranteeUpdate = *pTime++;
-
-          uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-          uint32_t node = *pData++;
-          uint32_t dev  = *pData++;
+          uint64_t time;
+          uint32_t node;
+          uint32_t dev;
+          uint32_t size;
+          std::memcpy (&time, pData, sizeof (time));
+          pData += sizeof (time);
+          std::memcpy (&node, pData, sizeof (node));
+          pData += sizeof (node);
+          std::memcpy (&dev, pData, sizeof (dev));
+          pData += sizeof (dev);
+          std::memcpy (&size, pData, sizeof (size));
+          pData += sizeof (size);
+          NS_ASSERT (pData + size <= pEnd);
 
           Time rxTime (time);
 
-          // rxtime == 0 means this is a Null Message
-          if (rxTime > Time (0))
-            {
-              count -= sizeof (time) + sizeof (guaranteeUpdate) + sizeof (node) + sizeof (dev);
-
-              Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
+          Ptr<Packet> p = Create<Packet> (pData, size, true);
+          pData += size;
 
-              // Find the correct node/device to schedule receive event
-              Ptr<Node> pNode = NodeList::GetNode (node);
-              Ptr<MpiReceiver> pMpiRec = 0;
-              uint32_t nDevices = pNode->GetNDevices ();
-              for (uint32_t i = 0; i < nDevices; ++i)
+          // Find the correct node/device to schedule receive event
+          Ptr<Node> pNode = NodeList::GetNode (node);
+          Ptr<MpiReceiver> pMpiRec = 0;
+          uint32_t nDevices = pNode->GetNDevices ();
+          for (uint32_t i = 0; i < nDevices; ++i)
+            {
+              Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+              if (pThisDev->GetIfIndex () == dev)
                 {
-                  Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-                  if (pThisDev->GetIfIndex () == dev)
-                    {
-                      pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-                      break;
-                    }
+                  pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                  break;
                 }
-              NS_ASSERT (pNode && pMpiRec);
-
-              // Schedule the rx event
-              Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                              &MpiReceiver::Receive, pMpiRec, p);
-
             }
+          NS_ASSERT (pNode && pMpiRec);
 
-          // Update guarantee time for both packet receives and Null Messages.
-          Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (status.MPI_SOURCE);
-          NS_ASSERT (bundle);
+          // Schedule the rx event
+          Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                          &MpiReceiver::Receive, pMpiRec, p);
 
-          bundle->SetGuaranteeTime (Time (guaranteeUpdate));
+        }
 
-          // Re-queue the next read
-          MPI_Irecv (g_pRxBuffers[index], NULL_MESSAGE_MAX_MPI_MSG_SIZE, MPI_CHAR, status.MPI_SOURCE, 0,
-                     MPI_COMM_WORLD, &g_requests[index]);
+      // Update guarantee time for both packet receives and Null Messages.
+      Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (rank);
+      NS_ASSERT (bundle);
 
-        }
-      else
+      bundle->SetGuaranteeTime (Time (guaranteeUpdate));
+      bundle->NotifyMessageReceived (g_rxBuffer.size () > NULL_MESSAGE_GUARANTEE_SIZE);
+
+      if (blocking)
         {
-          // if non-blocking and no message received in testany then stop message loop
-          stop = true;
+          break;
         }
     }
-  while (!stop);
-#endif
 }
 
 void
@@ -394,21 +369,7 @@ NullMessageMpiInterface::TestSendComplete ()
 
   NS_ASSERT (g_enabled);
 
-#ifdef NS3_MPI
-  std::list<NullMessageSentBuffer>::iterator iter = g_pendingTx.begin ();
-  while (iter != g_pendingTx.end ())
-    {
-      MPI_Status status;
-      int flag = 0;
-      MPI_Test (iter->GetRequest (), &flag, &status);
-      std::list<NullMessageSentBuffer>::iterator current = iter; // Save current for erasing
-      ++iter; // Advance to next
-      if (flag)
-        { // This message is complete
-          g_pendingTx.erase (current);
-        }
-    }
-#endif
+  g_transport->TestSendComplete ();
 }
 
 void
@@ -416,46 +377,16 @@ NullMessageMpiInterface::Disable ()
 {
   NS_LOG_FUNCTION (this);
 
-#ifdef NS3_MPI
-  int flag = 0;
-  MPI_Initialized (&flag);
-  if (flag)
-    {
+  NS_ASSERT (g_transport);
+  g_transport->Disable ();
+  delete g_transport;
+  g_transport = 0;
 
-      for (std::list<NullMessageSentBuffer>::iterator iter = g_pendingTx.begin ();
-           iter != g_pendingTx.end ();
-           ++iter)
-        {
-          MPI_Cancel (iter->GetRequest ());
-          MPI_Request_free (iter->GetRequest ());
-        }
+  g_txBatches.clear ();
+  g_rxBuffer.clear ();
 
-      for (uint32_t i = 0; i < g_numNeighbors; ++i)
-        {
-          MPI_Cancel (&g_requests[i]);
-          MPI_Request_free (&g_requests[i]);
-        }
-
-      MPI_Finalize ();
-
-      for (uint32_t i = 0; i < g_numNeighbors; ++i)
-        {
-          delete [] g_pRxBuffers[i];
-        }
-      delete [] g_pRxBuffers;
-      delete [] g_requests;
-
-      g_pendingTx.clear ();
-
-      g_enabled = false;
-      g_initialized = false;
-
-    }
-  else
-    {
-      NS_FATAL_ERROR ("Cannot disable MPI environment without Initializing it first");
-    }
-#endif
+  g_enabled = false;
+  g_initialized = false;
 }
 
 } // namespace ns3
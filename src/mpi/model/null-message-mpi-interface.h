@@ -27,63 +27,22 @@
 #include <ns3/nstime.h>
 #include <ns3/buffer.h>
 
-#ifdef NS3_MPI
-#include "mpi.h"
-#else
-typedef void* MPI_Request;
-#endif
-
-#include <list>
+#include <vector>
 
 namespace ns3 {
 
 class RemoteChannelBundle;
 class Packet;
-
-/**
- * \ingroup mpi
- *
- * \brief Non-blocking send buffers for Null Message implementation.
- * 
- * One buffer is allocated for each non-blocking send.
- */
-class NullMessageSentBuffer
-{
-public:
-  NullMessageSentBuffer ();
-  ~NullMessageSentBuffer ();
-
-  /**
-   * \return pointer to sent buffer
-   */
-  uint8_t* GetBuffer ();
-  /**
-   * \param buffer pointer to sent buffer
-   */
-  void SetBuffer (uint8_t* buffer);
-  /**
-   * \return MPI request
-   */
-  MPI_Request* GetRequest ();
-
-private:
-
-  /**
-   * Buffer for send.
-   */
-  uint8_t* m_buffer;
-
-  /**
-   * MPI request posted for the send.
-   */
-  MPI_Request m_request;
-};
+class ParallelTransport;
 
 /**
  * \ingroup mpi
  *
  * \brief Interface between ns-3 and MPI for the Null Message
  * distributed simulation implementation.
+ *
+ * The messages are exchanged through MPI, or through shared memory
+ * between local processes (see SharedMemoryTransport).
  */
 class NullMessageMpiInterface : public ParallelCommunicationInterface
 {
@@ -112,13 +71,19 @@ public:
    * \param pargc number of command line arguments
    * \param pargv command line arguments
    *
-   * Sets up interface.   Calls MPI Init and 
-   * posts receives.
+   * Sets up interface.   Calls MPI Init.
    */
   virtual void Enable (int* pargc, char*** pargv);
   /**
-   * Terminates the MPI environment by calling MPI_Finalize This
-   * function must be called after Destroy ().  Resets m_initialized
+   * \param systemCount number of systems
+   *
+   * Sets up the shared memory interface between systemCount local
+   * processes.
+   */
+  virtual void Enable (uint32_t systemCount);
+  /**
+   * Terminates the parallel environment, e.g., by calling MPI_Finalize.
+   * This function must be called after Destroy ().  Resets m_initialized
    * and m_enabled.
    */
   virtual void Disable ();
@@ -128,15 +93,20 @@ public:
    * \param node destination node
    * \param dev destination device
    *
-   * Serialize and send a packet to the specified node and net device.
+   * Serialize a packet to the specified node and net device, and add
+   * it to the batch of packets for the task of the node.  The batch is
+   * sent with the next Null Message to the task, before blocking for
+   * messages, or as soon as it reaches the maximum batch size (see
+   * NullMessageSimulatorImpl::MaxBatchSize).
    *
    * \internal
-   * The MPI buffer format packs a delivery information and the serialized packet.
+   * The MPI buffer format packs the guarantee time for the Null
+   * Message algorithm, followed by a record for each packet:
    *
-   * uint64_t time the packed should be delivered
-   * uint64_t guarantee time for the Null Message algorithm.
+   * uint64_t time the packet should be delivered
    * uint32_t node id of destination
    * unit32_t dev id on destination
+   * uint32_t size of the serialized packet
    * uint8_t[] serialized packet
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
@@ -152,17 +122,14 @@ public:
    *
    * Null Messages are sent when a packet has not been sent across
    * this bundle in order to allow time advancement on the remote
-   * MPI task.
+   * MPI task.  If packets are batched for the remote MPI task, they
+   * are sent in the Null Message.
    *
    * \internal
-   * The Null Message MPI buffer format is based on the format for sending a packet with
-   * several fields set to 0 to signal that it is a Null Message.  Overloading the normal packet
-   * format simplifies receive logic.
+   * The Null Message MPI buffer format is the format for sending a batch of
+   * packets, with no packet.
    *
-   * uint64_t 0 must be zero for Null Message
    * uint64_t guarantee time
-   * uint32_t 0 must be zero for Null Message
-   * uint32_t 0 must be zero for Null Message
    */
   static void SendNullMessage (const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
   /**
@@ -179,6 +146,10 @@ public:
    * Check for completed sends
    */
   static void TestSendComplete ();
+  /**
+   * Send the batches of packets to all the neighbor tasks.
+   */
+  static void FlushMessages ();
 
   /**
    * \brief Initialize send and receive buffers.
@@ -190,6 +161,13 @@ public:
 
 private:
 
+  /**
+   * \param transport the transport of the messages
+   *
+   * Set up the interface once the transport is enabled
+   */
+  static void Initialize (ParallelTransport* transport);
+
   /**
    * Check for received messages complete.  Will block until message
    * has been received if blocking flag is true.  When blocking will
@@ -199,6 +177,23 @@ private:
    */
   static void ReceiveMessages (bool blocking = false);
 
+  /**
+   * \param rank the task to send the message to
+   * \param guaranteeUpdate guarantee update time for the Null Message
+   *
+   * Send the batch of packets to a task, possibly empty, with a
+   * guarantee time.
+   */
+  static void SendMessage (uint32_t rank, const Time& guaranteeUpdate);
+
+  /**
+   * \param rank the task to send the batch to
+   *
+   * Send the batch of packets to a task, if it is not empty, and
+   * reschedule the Null Message event of the task.
+   */
+  static void Flush (uint32_t rank);
+
   // System ID (rank) for this task
   static uint32_t g_sid;
 
@@ -211,14 +206,15 @@ private:
   static bool     g_initialized;
   static bool     g_enabled;
 
-  // Pending non-blocking receives
-  static MPI_Request* g_requests;
+  // Batches of serialized packets, per destination task, after room
+  // for the guarantee time
+  static std::vector<std::vector<uint8_t> > g_txBatches;
 
-  // Data buffers for non-blocking receives
-  static char**   g_pRxBuffers;
+  // Data buffer for receives
+  static std::vector<uint8_t> g_rxBuffer;
 
-  // List of pending non-blocking sends
-  static std::list<NullMessageSentBuffer> g_pendingTx;
+  // Transport of the messages between tasks
+  static ParallelTransport* g_transport;
 };
 
 } // namespace ns3
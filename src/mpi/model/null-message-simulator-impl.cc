@@ -32,6 +32,7 @@
 #include <ns3/channel.h>
 #include <ns3/node-container.h>
 #include <ns3/double.h>
+#include <ns3/uinteger.h>
 #include <ns3/ptr.h>
 #include <ns3/pointer.h>
 #include <ns3/assert.h>
@@ -61,13 +62,20 @@ NullMessageSimulatorImpl::GetTypeId (void)
                    DoubleValue (1.0),
                    MakeDoubleAccessor (&NullMessageSimulatorImpl::m_schedulerTune),
                    MakeDoubleChecker<double> (0.01,1.0))
+    .AddAttribute ("MaxBatchSize",
+                   "The maximum size in bytes of the messages batching the packets "
+                   "sent to a neighbor task; a batch is sent with the next Null Message, "
+                   "before blocking for messages, or as soon as it reaches this size, "
+                   "and a size of 0 sends each packet in its own message",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&NullMessageSimulatorImpl::m_maxBatchSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 NullMessageSimulatorImpl::NullMessageSimulatorImpl ()
 {
-#ifdef NS3_MPI
   NS_LOG_FUNCTION (this);
 
   m_myId = MpiInterface::GetSystemId ();
@@ -90,10 +98,6 @@ NullMessageSimulatorImpl::NullMessageSimulatorImpl ()
 
   NS_ASSERT (g_instance == 0);
   g_instance = this;
-
-#else
-  NS_FATAL_ERROR ("Can't use Null Message simulator without MPI compiled in");
-#endif
 }
 
 NullMessageSimulatorImpl::~NullMessageSimulatorImpl ()
@@ -266,9 +270,8 @@ NullMessageSimulatorImpl::ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bun
 {
   NS_LOG_FUNCTION (this << bundle);
 
-  Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
-
-  bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
+  bundle->SetEventId (Simulator::Schedule (CalculateNullMessageDelay (bundle),
+                                           &NullMessageSimulatorImpl::NullMessageEventHandler,
                                            this, PeekPointer(bundle)));
 }
 
@@ -279,10 +282,22 @@ NullMessageSimulatorImpl::RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> b
 
   Simulator::Cancel (bundle->GetEventId ());
 
+  bundle->SetEventId (Simulator::Schedule (CalculateNullMessageDelay (bundle),
+                                           &NullMessageSimulatorImpl::NullMessageEventHandler,
+                                           this, PeekPointer(bundle)));
+}
+
+Time
+NullMessageSimulatorImpl::CalculateNullMessageDelay (Ptr<RemoteChannelBundle> bundle)
+{
   Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
 
-  bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
-                                           this, PeekPointer(bundle)));
+  // The remote task does not need a new guarantee time before it reaches
+  // the one it was sent.  Wait until a new Null Message can extend it by
+  // the channel delay, which is earlier than the guarantee time so that
+  // the tasks cannot wait for each other.
+  Time renewal = bundle->GetSentGuaranteeTime () - bundle->GetDelay () - Now ();
+  return Max (delay, renewal);
 }
 
 void
@@ -322,6 +337,16 @@ NullMessageSimulatorImpl::Run (void)
           HandleArrivingMessagesBlocking ();
         }
     }
+
+  // Report the messages exchanged with each neighbor
+  for (uint32_t i = 0; i < m_systemCount; ++i)
+    {
+      Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (i);
+      if (bundle)
+        {
+          NS_LOG_INFO (*bundle);
+        }
+    }
 }
 
 void
@@ -342,6 +367,10 @@ NullMessageSimulatorImpl::HandleArrivingMessagesBlocking (void)
 {
   NS_LOG_FUNCTION (this);
 
+  // Send the batched packets before waiting for the neighbors, which
+  // may be waiting for them
+  NullMessageMpiInterface::FlushMessages ();
+
   NullMessageMpiInterface::ReceiveMessagesBlocking ();
 
   CalculateSafeTime ();
@@ -575,19 +604,25 @@ NullMessageSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+void
+NullMessageSimulatorImpl::SetContext (uint32_t context)
+{
+  m_currentContext = context;
+}
+
 Time NullMessageSimulatorImpl::CalculateGuaranteeTime (uint32_t nodeSysId)
 {
   Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (nodeSysId);
   NS_ASSERT (bundle);
 
-  return Min (NullMessageSimulatorImpl::GetInstance ()->Next (), GetSafeTime ()) + bundle->GetDelay ();
+  return bundle->GetEarliestArrivalTime (Min (NullMessageSimulatorImpl::GetInstance ()->Next (), GetSafeTime ()));
 }
 
 void NullMessageSimulatorImpl::NullMessageEventHandler(RemoteChannelBundle* bundle)
 {
   NS_LOG_FUNCTION (this << bundle);
 
-  Time time = Min (Next (), GetSafeTime ()) + bundle->GetDelay ();
+  Time time = bundle->GetEarliestArrivalTime (Min (Next (), GetSafeTime ()));
   NullMessageMpiInterface::SendNullMessage (time, bundle);
 
   ScheduleNullMessageEvent (bundle);
@@ -71,6 +71,7 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
+  virtual void SetContext (uint32_t context);
 
   /**
    * \return singleton instance
@@ -147,6 +148,17 @@ private:
    */
   void RescheduleNullMessageEvent (uint32_t nodeSysId);
 
+  /**
+   * \param bundle Bundle to schedule Null Message event for
+   *
+   * \return delay until the next Null Message event for the bundle
+   *
+   * The Null Message is sent after a fraction of the bundle delay set
+   * by SchedulerTune, or later if the last guarantee time sent to the
+   * remote task is further ahead.
+   */
+  Time CalculateNullMessageDelay (Ptr<RemoteChannelBundle> bundle);
+
   /**
    * \param systemId SystemID to compute guarentee time for
    *
@@ -163,7 +175,7 @@ private:
    *
    * Null message event handler.   Scheduled to send a null message
    * for the specified bundle at regular intervals.   Will canceled
-   * and rescheduled when packets are sent.
+   * and rescheduled when batches of packets are sent.
    */
   void NullMessageEventHandler(RemoteChannelBundle* bundle);
 
@@ -201,6 +213,12 @@ private:
    */
   double m_schedulerTune;
 
+  /*
+   * Maximum size in bytes of the batches of packets sent to a
+   * neighbor task.
+   */
+  uint32_t m_maxBatchSize;
+
   /*
    * Singleton instance.
    */
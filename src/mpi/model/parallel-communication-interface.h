@@ -76,6 +76,13 @@ public:
    * Sets up parallel communication interface
    */
   virtual void Enable (int* pargc, char*** pargv) = 0;
+  /**
+   * \param systemCount number of parallel tasks
+   *
+   * Sets up parallel communication interface between systemCount
+   * local processes, forked from the calling process
+   */
+  virtual void Enable (uint32_t systemCount) = 0;
   /**
    * Terminates the parallel environment.
    * This function must be called after Destroy ()
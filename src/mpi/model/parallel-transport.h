@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_PARALLEL_TRANSPORT_H
+#define NS3_PARALLEL_TRANSPORT_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Pure virtual base class for the exchange of messages between
+ * the tasks of a parallel simulation.
+ *
+ * The ParallelCommunicationInterface implementations format the
+ * messages and implement the synchronization algorithm; they use a
+ * transport to move the messages between tasks, either MPI
+ * (MpiTransport) or shared memory between local processes
+ * (SharedMemoryTransport).
+ */
+class ParallelTransport
+{
+public:
+  virtual ~ParallelTransport () {}
+  /**
+   * \return the system id (rank) of this task
+   */
+  virtual uint32_t GetSystemId () = 0;
+  /**
+   * \return the number of tasks
+   */
+  virtual uint32_t GetSize () = 0;
+  /**
+   * \param rank the destination task
+   * \param buffer the message
+   * \param size the size of the message, in bytes
+   *
+   * Send a message without blocking.  The message is copied, and it is
+   * delivered after the messages previously sent to the same task.
+   */
+  virtual void Send (uint32_t rank, const uint8_t* buffer, uint32_t size) = 0;
+  /**
+   * \param blocking true to wait until a message is received
+   * \param rank the source task of the message received
+   * \param message the message received; its size is set to the size
+   *        of the message
+   * \return true if a message was received
+   */
+  virtual bool Receive (bool blocking, uint32_t &rank, std::vector<uint8_t> &message) = 0;
+  /**
+   * Check for completed sends
+   */
+  virtual void TestSendComplete () = 0;
+  /**
+   * \param sendBuffer the data of this task
+   * \param recvBuffer the data of all the tasks, by system id
+   * \param size the size of the data of each task, in bytes
+   *
+   * Gather the data of all the tasks, in all the tasks.
+   */
+  virtual void AllGather (const void* sendBuffer, void* recvBuffer, uint32_t size) = 0;
+  /**
+   * Terminate the parallel environment
+   */
+  virtual void Disable () = 0;
+};
+
+} // namespace ns3
+
+#endif /* NS3_PARALLEL_TRANSPORT_H */
@@ -42,21 +42,34 @@ TypeId RemoteChannelBundle::GetTypeId (void)
 RemoteChannelBundle::RemoteChannelBundle ()
   : m_remoteSystemId (-1),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_sentGuaranteeTime (0),
+    m_nullMessagesSent (0),
+    m_dataMessagesSent (0),
+    m_nullMessagesReceived (0),
+    m_dataMessagesReceived (0)
 {
 }
 
 RemoteChannelBundle::RemoteChannelBundle (const uint32_t remoteSystemId)
   : m_remoteSystemId (remoteSystemId),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_sentGuaranteeTime (0),
+    m_nullMessagesSent (0),
+    m_dataMessagesSent (0),
+    m_nullMessagesReceived (0),
+    m_dataMessagesReceived (0)
 {
 }
 
 void
 RemoteChannelBundle::AddChannel (Ptr<Channel> channel, Time delay)
 {
-  m_channels[channel->GetId ()] = channel;
+  ChannelState &state = m_channels[channel->GetId ()];
+  state.channel = channel;
+  state.delay = delay;
+  state.lastRxTime = Time (0);
   m_delay = ns3::Min (m_delay, delay);
 }
 
@@ -86,6 +99,87 @@ RemoteChannelBundle::GetDelay (void) const
   return m_delay;
 }
 
+void
+RemoteChannelBundle::NotifyPacketSent (uint32_t channelId, Time rxTime)
+{
+  std::map < uint32_t, ChannelState >::iterator state = m_channels.find (channelId);
+  NS_ASSERT (state != m_channels.end ());
+
+  state->second.lastRxTime = ns3::Max (state->second.lastRxTime, rxTime);
+}
+
+Time
+RemoteChannelBundle::GetEarliestArrivalTime (Time start) const
+{
+  Time arrival = NS_TIME_INFINITY;
+  for (std::map < uint32_t, ChannelState >::const_iterator state = m_channels.begin ();
+       state != m_channels.end ();
+       ++state)
+    {
+      // The next packet is sent once the previous one is serialized
+      Time channelArrival = ns3::Max (start + state->second.delay, state->second.lastRxTime);
+      arrival = ns3::Min (arrival, channelArrival);
+    }
+  return arrival;
+}
+
+void
+RemoteChannelBundle::NotifyMessageSent (Time guarantee, bool hasPackets)
+{
+  m_sentGuaranteeTime = guarantee;
+  if (hasPackets)
+    {
+      ++m_dataMessagesSent;
+    }
+  else
+    {
+      ++m_nullMessagesSent;
+    }
+}
+
+void
+RemoteChannelBundle::NotifyMessageReceived (bool hasPackets)
+{
+  if (hasPackets)
+    {
+      ++m_dataMessagesReceived;
+    }
+  else
+    {
+      ++m_nullMessagesReceived;
+    }
+}
+
+Time
+RemoteChannelBundle::GetSentGuaranteeTime (void) const
+{
+  return m_sentGuaranteeTime;
+}
+
+uint64_t
+RemoteChannelBundle::GetNullMessagesSent (void) const
+{
+  return m_nullMessagesSent;
+}
+
+uint64_t
+RemoteChannelBundle::GetDataMessagesSent (void) const
+{
+  return m_dataMessagesSent;
+}
+
+uint64_t
+RemoteChannelBundle::GetNullMessagesReceived (void) const
+{
+  return m_nullMessagesReceived;
+}
+
+uint64_t
+RemoteChannelBundle::GetDataMessagesReceived (void) const
+{
+  return m_dataMessagesReceived;
+}
+
 void
 RemoteChannelBundle::SetEventId (EventId id)
 {
@@ -115,12 +209,16 @@ std::ostream& operator<< (std::ostream& out, ns3::RemoteChannelBundle& bundle )
   out << "RemoteChannelBundle Rank = " << bundle.m_remoteSystemId
       << ", GuaranteeTime = "  << bundle.m_guaranteeTime
       << ", Delay = " << bundle.m_delay << std::endl;
+  out << "\tMessages sent: " << bundle.m_dataMessagesSent << " data, "
+      << bundle.m_nullMessagesSent << " null" << std::endl;
+  out << "\tMessages received: " << bundle.m_dataMessagesReceived << " data, "
+      << bundle.m_nullMessagesReceived << " null" << std::endl;
   
-  for (std::map < uint32_t, Ptr < Channel > > ::const_iterator pair = bundle.m_channels.begin ();
+  for (std::map < uint32_t, RemoteChannelBundle::ChannelState > ::const_iterator pair = bundle.m_channels.begin ();
        pair != bundle.m_channels.end ();
        ++pair)
     {
-      out << "\t" << (*pair).second << std::endl;
+      out << "\t" << (*pair).second.channel << std::endl;
     }
   
   return out;
@@ -84,6 +84,70 @@ public:
    */
   Time GetDelay (void) const;
 
+  /**
+   * \param channelId the id of the channel the packet was sent on
+   * \param rxTime the time the packet is received by the remote node
+   *
+   * Record that a packet was sent on a channel of this bundle.  The
+   * channel is busy serializing the packet until rxTime minus its
+   * delay, so that the next packet on the channel cannot be received
+   * before rxTime.
+   */
+  void NotifyPacketSent (uint32_t channelId, Time rxTime);
+
+  /**
+   * \param start the earliest time a packet can be sent from this task
+   * \return the earliest time a packet sent from start can be received
+   * along any channel in this bundle
+   *
+   * This is the guarantee time to send to the remote task.  It is start
+   * plus the delay of the channel, unless the channel is still
+   * serializing a previous packet.
+   */
+  Time GetEarliestArrivalTime (Time start) const;
+
+  /**
+   * \param guarantee the guarantee time sent to the remote task
+   * \param hasPackets true if packets were sent along with the
+   * guarantee time, false for a Null Message
+   *
+   * Record a message sent to the remote task.
+   */
+  void NotifyMessageSent (Time guarantee, bool hasPackets);
+
+  /**
+   * \param hasPackets true if the message held packets, false for a
+   * Null Message
+   *
+   * Record a message received from the remote task.
+   */
+  void NotifyMessageReceived (bool hasPackets);
+
+  /**
+   * \return the last guarantee time sent to the remote task
+   */
+  Time GetSentGuaranteeTime (void) const;
+
+  /**
+   * \return number of Null Messages sent to the remote task
+   */
+  uint64_t GetNullMessagesSent (void) const;
+
+  /**
+   * \return number of messages with packets sent to the remote task
+   */
+  uint64_t GetDataMessagesSent (void) const;
+
+  /**
+   * \return number of Null Messages received from the remote task
+   */
+  uint64_t GetNullMessagesReceived (void) const;
+
+  /**
+   * \return number of messages with packets received from the remote task
+   */
+  uint64_t GetDataMessagesReceived (void) const;
+
   /**
    * Set the event ID of the Null Message send event current scheduled
    * for this channel.
@@ -115,6 +179,16 @@ public:
   friend std::ostream& operator<< (std::ostream& out, ns3::RemoteChannelBundle& bundle );
 
 private:
+  /*
+   * State of a channel of the bundle.
+   */
+  struct ChannelState
+  {
+    Ptr<Channel> channel;
+    Time delay;       // Latency of the channel
+    Time lastRxTime;  // Receive time of the last packet sent on the channel
+  };
+
   /*
    * Remote rank.
    */
@@ -125,7 +199,7 @@ private:
    *
    * Would be more efficient to use unordered_map when C++11 is adopted by NS3.
    */
-  std::map < uint32_t, Ptr < Channel > > m_channels;
+  std::map < uint32_t, ChannelState > m_channels;
 
   /*
    * Guarentee time for the incoming Channels from MPI task remote_rank.
@@ -144,6 +218,19 @@ private:
    */
   EventId m_nullEventId;
 
+  /*
+   * Last guarantee time sent to MPI task remote_rank.
+   */
+  Time m_sentGuaranteeTime;
+
+  /*
+   * Counts of the messages exchanged with MPI task remote_rank.
+   */
+  uint64_t m_nullMessagesSent;
+  uint64_t m_dataMessagesSent;
+  uint64_t m_nullMessagesReceived;
+  uint64_t m_dataMessagesReceived;
+
 };
 
 }
@@ -0,0 +1,438 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shared-memory-transport.h"
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedMemoryTransport");
+
+/// Size of the data of a ring buffer, in bytes; a power of two
+static const uint32_t RING_SIZE = 1 << 20;
+
+/// Size of the slot of each task for AllGather, in bytes
+static const uint32_t GATHER_SLOT_SIZE = 256;
+
+/// Size of a cache line, to keep the indices of a ring apart
+static const uint32_t CACHE_LINE_SIZE = 64;
+
+/// Number of waits between checks that the other tasks are running
+static const uint32_t CHECK_PEERS_PERIOD = 1024;
+
+/// Number of waits after which a task sleeps instead of yielding
+static const uint32_t MAX_YIELDS = 16384;
+
+/// A single producer, single consumer ring buffer
+struct SharedMemoryTransport::Ring
+{
+  std::atomic<uint64_t> head;   //!< The number of bytes written, by the producer
+  uint8_t pad1[CACHE_LINE_SIZE - sizeof (std::atomic<uint64_t>)];  //!< Padding
+  std::atomic<uint64_t> tail;   //!< The number of bytes read, by the consumer
+  uint8_t pad2[CACHE_LINE_SIZE - sizeof (std::atomic<uint64_t>)];  //!< Padding
+  uint8_t data[RING_SIZE];      //!< The data
+};
+
+/// The barrier, followed by the AllGather slots
+struct SharedMemoryTransport::Control
+{
+  std::atomic<uint32_t> count;      //!< The number of tasks in the barrier
+  uint8_t pad1[CACHE_LINE_SIZE - sizeof (std::atomic<uint32_t>)];  //!< Padding
+  std::atomic<uint32_t> generation; //!< Incremented when all the tasks reached the barrier
+  uint8_t pad2[CACHE_LINE_SIZE - sizeof (std::atomic<uint32_t>)];  //!< Padding
+};
+
+/**
+ * \param head the number of bytes written in the ring
+ * \param tail the number of bytes read from the ring
+ * \param data the data of the ring
+ * \param buffer the data to write
+ * \param size the size of the data
+ * \return the number of bytes written, as far as the ring has room
+ */
+static uint32_t
+WriteRing (std::atomic<uint64_t> &head, std::atomic<uint64_t> &tail, uint8_t* data,
+           const uint8_t* buffer, uint32_t size)
+{
+  uint64_t written = head.load (std::memory_order_relaxed);
+  uint64_t room = RING_SIZE - (written - tail.load (std::memory_order_acquire));
+  uint32_t count = std::min<uint64_t> (size, room);
+  uint32_t position = written & (RING_SIZE - 1);
+  uint32_t first = std::min (count, RING_SIZE - position);
+  std::memcpy (data + position, buffer, first);
+  std::memcpy (data, buffer + first, count - first);
+  head.store (written + count, std::memory_order_release);
+  return count;
+}
+
+/**
+ * \param head the number of bytes written in the ring
+ * \param tail the number of bytes read from the ring
+ * \param data the data of the ring
+ * \param buffer the buffer to read to
+ * \param size the size of the buffer
+ * \return the number of bytes read, as far as the ring has data
+ */
+static uint32_t
+ReadRing (std::atomic<uint64_t> &head, std::atomic<uint64_t> &tail, const uint8_t* data,
+          uint8_t* buffer, uint32_t size)
+{
+  uint64_t read = tail.load (std::memory_order_relaxed);
+  uint64_t available = head.load (std::memory_order_acquire) - read;
+  uint32_t count = std::min<uint64_t> (size, available);
+  uint32_t position = read & (RING_SIZE - 1);
+  uint32_t first = std::min (count, RING_SIZE - position);
+  std::memcpy (buffer, data + position, first);
+  std::memcpy (buffer + first, data, count - first);
+  tail.store (read + count, std::memory_order_release);
+  return count;
+}
+
+SharedMemoryTransport::SharedMemoryTransport ()
+  : m_sid (0),
+    m_size (1),
+    m_region (0),
+    m_regionSize (0),
+    m_parent (0),
+    m_nextSource (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SharedMemoryTransport::~SharedMemoryTransport ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_region)
+    {
+      munmap (m_region, m_regionSize);
+    }
+}
+
+void
+SharedMemoryTransport::Enable (uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << systemCount);
+  NS_ABORT_MSG_IF (systemCount == 0, "The number of systems must be positive");
+
+  m_size = systemCount;
+  m_regionSize = sizeof (Control) + m_size * GATHER_SLOT_SIZE
+    + static_cast<std::size_t> (m_size) * m_size * sizeof (Ring);
+  void* region = mmap (0, m_regionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  NS_ABORT_MSG_IF (region == MAP_FAILED, "Can't map the shared memory: " << std::strerror (errno));
+  m_region = static_cast<uint8_t*> (region);
+
+  Control* control = new (m_region) Control;
+  control->count.store (0);
+  control->generation.store (0);
+  NS_ABORT_MSG_UNLESS (control->count.is_lock_free (), "Shared memory transport needs lock-free atomics");
+  for (uint32_t source = 0; source < m_size; ++source)
+    {
+      for (uint32_t destination = 0; destination < m_size; ++destination)
+        {
+          Ring* ring = new (GetRing (source, destination)) Ring;
+          ring->head.store (0);
+          ring->tail.store (0);
+          NS_ABORT_MSG_UNLESS (ring->head.is_lock_free (), "Shared memory transport needs lock-free atomics");
+        }
+    }
+  m_pendingTx.resize (m_size);
+  PartialReceive rx;
+  rx.headerRead = 0;
+  rx.read = 0;
+  m_rx.resize (m_size, rx);
+
+  // Do not duplicate the buffered output in the child processes
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  m_parent = getpid ();
+  for (uint32_t sid = 1; sid < m_size; ++sid)
+    {
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Can't fork the process of system " << sid << ": " << std::strerror (errno));
+      if (pid == 0)
+        {
+          m_sid = sid;
+          m_children.clear ();
+          break;
+        }
+      m_children.push_back (pid);
+    }
+  NS_LOG_LOGIC ("System " << m_sid << " of " << m_size << " in process " << getpid ());
+}
+
+uint32_t
+SharedMemoryTransport::GetSystemId ()
+{
+  return m_sid;
+}
+
+uint32_t
+SharedMemoryTransport::GetSize ()
+{
+  return m_size;
+}
+
+SharedMemoryTransport::Ring*
+SharedMemoryTransport::GetRing (uint32_t source, uint32_t destination)
+{
+  uint8_t* rings = m_region + sizeof (Control) + m_size * GATHER_SLOT_SIZE;
+  return reinterpret_cast<Ring*> (rings + (static_cast<std::size_t> (source) * m_size + destination) * sizeof (Ring));
+}
+
+void
+SharedMemoryTransport::Send (uint32_t rank, const uint8_t* buffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << rank << size);
+  NS_ASSERT (rank < m_size && rank != m_sid);
+
+  std::deque<PendingSend> &pending = m_pendingTx[rank];
+  uint8_t header[sizeof (uint32_t)];
+  std::memcpy (header, &size, sizeof (size));
+  uint32_t headerWritten = 0;
+  uint32_t written = 0;
+  if (pending.empty ())
+    {
+      // Write as much as possible right away
+      Ring* ring = GetRing (m_sid, rank);
+      headerWritten = WriteRing (ring->head, ring->tail, ring->data, header, sizeof (header));
+      if (headerWritten == sizeof (header))
+        {
+          written = WriteRing (ring->head, ring->tail, ring->data, buffer, size);
+        }
+    }
+  if (headerWritten < sizeof (header) || written < size)
+    {
+      pending.push_back (PendingSend ());
+      PendingSend &rest = pending.back ();
+      rest.offset = 0;
+      rest.data.assign (header + headerWritten, header + sizeof (header));
+      rest.data.insert (rest.data.end (), buffer + written, buffer + size);
+    }
+}
+
+void
+SharedMemoryTransport::Progress (uint32_t rank)
+{
+  std::deque<PendingSend> &pending = m_pendingTx[rank];
+  Ring* ring = GetRing (m_sid, rank);
+  while (!pending.empty ())
+    {
+      PendingSend &front = pending.front ();
+      front.offset += WriteRing (ring->head, ring->tail, ring->data,
+                                 &front.data[front.offset], front.data.size () - front.offset);
+      if (front.offset < front.data.size ())
+        {
+          return;
+        }
+      pending.pop_front ();
+    }
+}
+
+bool
+SharedMemoryTransport::Poll (uint32_t rank, std::vector<uint8_t> &message)
+{
+  PartialReceive &rx = m_rx[rank];
+  Ring* ring = GetRing (rank, m_sid);
+  if (rx.headerRead < sizeof (rx.header))
+    {
+      rx.headerRead += ReadRing (ring->head, ring->tail, ring->data,
+                                 rx.header + rx.headerRead, sizeof (rx.header) - rx.headerRead);
+      if (rx.headerRead < sizeof (rx.header))
+        {
+          return false;
+        }
+      uint32_t size;
+      std::memcpy (&size, rx.header, sizeof (size));
+      rx.data.resize (size);
+      rx.read = 0;
+    }
+  if (rx.read < rx.data.size ())
+    {
+      rx.read += ReadRing (ring->head, ring->tail, ring->data,
+                           &rx.data[rx.read], rx.data.size () - rx.read);
+      if (rx.read < rx.data.size ())
+        {
+          return false;
+        }
+    }
+  // Keep the buffer of the previous message for the next one
+  message.swap (rx.data);
+  rx.headerRead = 0;
+  rx.read = 0;
+  return true;
+}
+
+bool
+SharedMemoryTransport::Receive (bool blocking, uint32_t &rank, std::vector<uint8_t> &message)
+{
+  NS_LOG_FUNCTION (this << blocking);
+
+  uint32_t spins = 0;
+  while (true)
+    {
+      TestSendComplete ();
+      // Poll the tasks in turn, so that none of them is starved
+      for (uint32_t i = 0; i < m_size; ++i)
+        {
+          uint32_t source = (m_nextSource + i) % m_size;
+          if (source != m_sid && Poll (source, message))
+            {
+              rank = source;
+              m_nextSource = (source + 1) % m_size;
+              return true;
+            }
+        }
+      if (!blocking)
+        {
+          return false;
+        }
+      Wait (spins);
+    }
+}
+
+void
+SharedMemoryTransport::TestSendComplete ()
+{
+  for (uint32_t rank = 0; rank < m_size; ++rank)
+    {
+      if (rank != m_sid)
+        {
+          Progress (rank);
+        }
+    }
+}
+
+void
+SharedMemoryTransport::Barrier ()
+{
+  Control* control = reinterpret_cast<Control*> (m_region);
+  uint32_t generation = control->generation.load (std::memory_order_acquire);
+  if (control->count.fetch_add (1, std::memory_order_acq_rel) + 1 == m_size)
+    {
+      control->count.store (0, std::memory_order_relaxed);
+      control->generation.store (generation + 1, std::memory_order_release);
+    }
+  else
+    {
+      uint32_t spins = 0;
+      while (control->generation.load (std::memory_order_acquire) == generation)
+        {
+          // Keep the pending messages flowing while waiting
+          TestSendComplete ();
+          Wait (spins);
+        }
+    }
+}
+
+void
+SharedMemoryTransport::AllGather (const void* sendBuffer, void* recvBuffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ABORT_MSG_IF (size > GATHER_SLOT_SIZE, "AllGather of more than " << GATHER_SLOT_SIZE << " bytes");
+
+  uint8_t* slots = m_region + sizeof (Control);
+  std::memcpy (slots + m_sid * GATHER_SLOT_SIZE, sendBuffer, size);
+  Barrier ();
+  for (uint32_t sid = 0; sid < m_size; ++sid)
+    {
+      std::memcpy (static_cast<uint8_t*> (recvBuffer) + sid * size, slots + sid * GATHER_SLOT_SIZE, size);
+    }
+  // Do not let a task overwrite its slot before all the tasks read it
+  Barrier ();
+}
+
+void
+SharedMemoryTransport::Wait (uint32_t &spins)
+{
+  ++spins;
+  if (spins % CHECK_PEERS_PERIOD == 0)
+    {
+      if (m_sid != 0)
+        {
+          NS_ABORT_MSG_IF (getppid () != m_parent, "The process of system 0 terminated");
+        }
+      for (uint32_t i = 0; i < m_children.size (); ++i)
+        {
+          int status;
+          if (m_children[i] != 0 && waitpid (m_children[i], &status, WNOHANG) == m_children[i])
+            {
+              m_children[i] = 0;
+              NS_ABORT_MSG_UNLESS (WIFEXITED (status) && WEXITSTATUS (status) == 0,
+                                   "The process of system " << i + 1 << " terminated abnormally");
+            }
+        }
+    }
+  if (spins < MAX_YIELDS)
+    {
+      sched_yield ();
+    }
+  else
+    {
+      usleep (100);
+    }
+}
+
+void
+SharedMemoryTransport::Disable ()
+{
+  NS_LOG_FUNCTION (this);
+
+  bool failed = false;
+  for (uint32_t i = 0; i < m_children.size (); ++i)
+    {
+      if (m_children[i] == 0)
+        {
+          continue;
+        }
+      int status;
+      pid_t pid;
+      do
+        {
+          pid = waitpid (m_children[i], &status, 0);
+        }
+      while (pid < 0 && errno == EINTR);
+      if (pid < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_ERROR ("The process of system " << i + 1 << " terminated abnormally");
+          failed = true;
+        }
+    }
+  m_children.clear ();
+  m_pendingTx.clear ();
+  m_rx.clear ();
+  munmap (m_region, m_regionSize);
+  m_region = 0;
+  NS_ABORT_MSG_IF (failed, "A system of the parallel simulation failed");
+}
+
+} // namespace ns3
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_SHARED_MEMORY_TRANSPORT_H
+#define NS3_SHARED_MEMORY_TRANSPORT_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <sys/types.h>
+
+#include "parallel-transport.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Exchange the messages of a parallel simulation between local
+ * processes, through shared memory
+ *
+ * Enable () maps an anonymous shared memory region, then forks the
+ * processes of the other tasks, which all share the region.  Each
+ * ordered pair of tasks has a single producer, single consumer ring
+ * buffer in the region, through which the messages are streamed: a
+ * message larger than the ring is written piecewise, as the
+ * destination reads it.  Sends never block; when a ring is full, the
+ * rest of the message is kept by the sender and written whenever the
+ * transport is used later on.  The region also holds a barrier and a
+ * slot per task for AllGather ().
+ *
+ * The task which called Enable () is task 0; it waits for the others to
+ * terminate in Disable ().
+ */
+class SharedMemoryTransport : public ParallelTransport
+{
+public:
+  SharedMemoryTransport ();
+  virtual ~SharedMemoryTransport ();
+
+  /**
+   * \param systemCount the number of tasks
+   *
+   * Map the shared memory region and fork systemCount - 1 processes.
+   * This method returns in each process, with a different system id.
+   */
+  void Enable (uint32_t systemCount);
+
+  virtual uint32_t GetSystemId ();
+  virtual uint32_t GetSize ();
+  virtual void Send (uint32_t rank, const uint8_t* buffer, uint32_t size);
+  virtual bool Receive (bool blocking, uint32_t &rank, std::vector<uint8_t> &message);
+  virtual void TestSendComplete ();
+  virtual void AllGather (const void* sendBuffer, void* recvBuffer, uint32_t size);
+  /**
+   * Unmap the shared memory region.  Task 0 waits for the processes of
+   * the other tasks to terminate.
+   */
+  virtual void Disable ();
+
+private:
+  struct Ring;
+  struct Control;
+
+  /// A message, or the rest of a message, waiting for room in a ring
+  struct PendingSend
+  {
+    std::vector<uint8_t> data;  //!< The message, preceded by its size
+    uint32_t offset;            //!< The number of bytes already written
+  };
+
+  /// The message being read from a ring
+  struct PartialReceive
+  {
+    uint8_t header[sizeof (uint32_t)]; //!< The size of the message
+    uint32_t headerRead;        //!< The number of bytes of the size read
+    uint32_t read;              //!< The number of bytes of the message read
+    std::vector<uint8_t> data;  //!< The message
+  };
+
+  /**
+   * \param source the source task
+   * \param destination the destination task
+   * \return the ring from source to destination
+   */
+  Ring* GetRing (uint32_t source, uint32_t destination);
+  /**
+   * \param rank the destination task
+   *
+   * Write the pending messages to a task, as far as its ring has room
+   */
+  void Progress (uint32_t rank);
+  /**
+   * \param rank the source task
+   * \param message the message received
+   * \return true if a complete message was read from the task
+   */
+  bool Poll (uint32_t rank, std::vector<uint8_t> &message);
+  /**
+   * Wait for all the tasks to reach the barrier
+   */
+  void Barrier ();
+  /**
+   * \param spins the number of waits so far
+   *
+   * Yield the processor while waiting for the other tasks, and check
+   * that they are still running.
+   */
+  void Wait (uint32_t &spins);
+
+  uint32_t m_sid;                  //!< The system id of this task
+  uint32_t m_size;                 //!< The number of tasks
+  uint8_t* m_region;               //!< The shared memory region
+  std::size_t m_regionSize;        //!< The size of the shared memory region
+  pid_t m_parent;                  //!< The process of task 0
+  std::vector<pid_t> m_children;   //!< The processes of the other tasks, in task 0
+  uint32_t m_nextSource;           //!< The first task to poll in the next Receive ()
+  std::vector<std::deque<PendingSend> > m_pendingTx;  //!< The pending messages, per destination
+  std::vector<PartialReceive> m_rx;                   //!< The message being read, per source
+};
+
+} // namespace ns3
+
+#endif /* NS3_SHARED_MEMORY_TRANSPORT_H */
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/distributed-partition-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief Check that two clusters of nodes joined by long links are
+ * assigned to two systems, and that a node with a larger load is balanced
+ * against several lighter nodes.
+ */
+class DistributedPartitionClustersTestCase : public TestCase
+{
+public:
+  DistributedPartitionClustersTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DistributedPartitionClustersTestCase::DistributedPartitionClustersTestCase ()
+  : TestCase ("Check the partition of two clusters and of unequal loads")
+{
+}
+
+void
+DistributedPartitionClustersTestCase::DoRun (void)
+{
+  // Two rings of ten nodes with 1ms links, joined by two 50ms links
+  NodeContainer clusters[2];
+  DistributedPartitionHelper partition;
+  for (uint32_t c = 0; c < 2; ++c)
+    {
+      clusters[c].Create (10);
+      for (uint32_t i = 0; i < 10; ++i)
+        {
+          partition.AddLink (clusters[c].Get (i), clusters[c].Get ((i + 1) % 10), MilliSeconds (1));
+        }
+    }
+  partition.AddLink (clusters[0].Get (0), clusters[1].Get (5), MilliSeconds (50));
+  partition.AddLink (clusters[0].Get (5), clusters[1].Get (0), MilliSeconds (50));
+  partition.Partition (2);
+
+  NS_TEST_ASSERT_MSG_EQ (partition.GetLookahead (), MilliSeconds (50), "The short links should not be cut");
+  NS_TEST_ASSERT_MSG_EQ (partition.GetLoad (0), 10, "The systems should be balanced");
+  NS_TEST_ASSERT_MSG_EQ (partition.GetLoad (1), 10, "The systems should be balanced");
+  for (uint32_t c = 0; c < 2; ++c)
+    {
+      uint32_t systemId = clusters[c].Get (0)->GetSystemId ();
+      for (uint32_t i = 0; i < 10; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (clusters[c].Get (i)->GetSystemId (), systemId, "A cluster should not be split");
+          NS_TEST_ASSERT_MSG_EQ (partition.GetSystemId (clusters[c].Get (i)), systemId, "Inconsistent system id");
+        }
+    }
+  NS_TEST_ASSERT_MSG_NE (clusters[0].Get (0)->GetSystemId (), clusters[1].Get (0)->GetSystemId (),
+                         "The clusters should be on different systems");
+
+  // A line of four nodes, the first one being as loaded as the three others
+  NodeContainer line;
+  line.Create (4);
+  DistributedPartitionHelper linePartition;
+  linePartition.AddNode (line.Get (0), 3);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      linePartition.AddLink (line.Get (i), line.Get (i + 1), MilliSeconds (10));
+    }
+  linePartition.Partition (2);
+
+  NS_TEST_ASSERT_MSG_EQ (linePartition.GetLoad (0), 3, "The systems should be balanced");
+  NS_TEST_ASSERT_MSG_EQ (linePartition.GetLoad (1), 3, "The systems should be balanced");
+  NS_TEST_ASSERT_MSG_NE (line.Get (0)->GetSystemId (), line.Get (1)->GetSystemId (),
+                         "The loaded node should be alone");
+  NS_TEST_ASSERT_MSG_EQ (line.Get (1)->GetSystemId (), line.Get (3)->GetSystemId (),
+                         "The light nodes should be together");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief Check that the nodes of a shared channel and of a zero delay
+ * link are assigned to the same system.
+ */
+class DistributedPartitionTiesTestCase : public TestCase
+{
+public:
+  DistributedPartitionTiesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DistributedPartitionTiesTestCase::DistributedPartitionTiesTestCase ()
+  : TestCase ("Check that shared channels and zero delay links are not cut")
+{
+}
+
+void
+DistributedPartitionTiesTestCase::DoRun (void)
+{
+  // A line of four nodes with 1ms links, whose ends are on a shared
+  // channel with a fifth node, itself linked to a sixth one without delay.
+  NodeContainer nodes;
+  nodes.Create (6);
+  DistributedPartitionHelper partition;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      partition.AddLink (nodes.Get (i), nodes.Get (i + 1), MilliSeconds (1));
+    }
+  partition.AddChannel (NodeContainer (nodes.Get (0), nodes.Get (3), nodes.Get (4)));
+  partition.AddLink (nodes.Get (4), nodes.Get (5), Seconds (0));
+  partition.Partition (2);
+
+  NS_TEST_ASSERT_MSG_EQ (nodes.Get (0)->GetSystemId (), nodes.Get (3)->GetSystemId (), "Shared channel split");
+  NS_TEST_ASSERT_MSG_EQ (nodes.Get (0)->GetSystemId (), nodes.Get (4)->GetSystemId (), "Shared channel split");
+  NS_TEST_ASSERT_MSG_EQ (nodes.Get (4)->GetSystemId (), nodes.Get (5)->GetSystemId (), "Zero delay link cut");
+  NS_TEST_ASSERT_MSG_EQ (nodes.Get (1)->GetSystemId (), nodes.Get (2)->GetSystemId (), "Unneeded cut");
+  NS_TEST_ASSERT_MSG_NE (nodes.Get (0)->GetSystemId (), nodes.Get (1)->GetSystemId (), "Unbalanced partition");
+  NS_TEST_ASSERT_MSG_EQ (partition.GetLookahead (), MilliSeconds (1), "Wrong lookahead");
+
+  DistributedPartitionHelper single;
+  single.AddNodes (nodes);
+  single.AddLink (nodes.Get (0), nodes.Get (1), MilliSeconds (1));
+  single.Partition (1);
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (nodes.Get (i)->GetSystemId (), 0, "A single system should get all the nodes");
+    }
+  NS_TEST_ASSERT_MSG_EQ (single.GetLookahead (), Time::Max (), "No link should be cut");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief Check the balance and the cut of the partition of a grid.
+ */
+class DistributedPartitionGridTestCase : public TestCase
+{
+public:
+  DistributedPartitionGridTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DistributedPartitionGridTestCase::DistributedPartitionGridTestCase ()
+  : TestCase ("Check the partition of a grid")
+{
+}
+
+void
+DistributedPartitionGridTestCase::DoRun (void)
+{
+  const uint32_t side = 16;
+  const uint32_t systems = 4;
+  NodeContainer nodes;
+  nodes.Create (side * side);
+  DistributedPartitionHelper partition;
+  for (uint32_t x = 0; x < side; ++x)
+    {
+      for (uint32_t y = 0; y < side; ++y)
+        {
+          if (x + 1 < side)
+            {
+              partition.AddLink (nodes.Get (x * side + y), nodes.Get ((x + 1) * side + y), MilliSeconds (2));
+            }
+          if (y + 1 < side)
+            {
+              partition.AddLink (nodes.Get (x * side + y), nodes.Get (x * side + y + 1), MilliSeconds (2));
+            }
+        }
+    }
+  partition.Partition (systems);
+
+  for (uint32_t s = 0; s < systems; ++s)
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (partition.GetLoad (s), 1.05 * side * side / systems, "Unbalanced system " << s);
+    }
+  uint32_t cut = 0;
+  for (uint32_t x = 0; x < side; ++x)
+    {
+      for (uint32_t y = 0; y < side; ++y)
+        {
+          uint32_t systemId = nodes.Get (x * side + y)->GetSystemId ();
+          NS_TEST_ASSERT_MSG_LT (systemId, systems, "Invalid system id");
+          if (x + 1 < side && nodes.Get ((x + 1) * side + y)->GetSystemId () != systemId)
+            {
+              ++cut;
+            }
+          if (y + 1 < side && nodes.Get (x * side + y + 1)->GetSystemId () != systemId)
+            {
+              ++cut;
+            }
+        }
+    }
+  // Cutting the grid in four squares cuts 32 links, and a random
+  // assignment about 360.
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (cut, 64, "Too many cut links");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief DistributedPartitionHelper TestSuite
+ */
+class DistributedPartitionHelperTestSuite : public TestSuite
+{
+public:
+  DistributedPartitionHelperTestSuite ();
+};
+
+DistributedPartitionHelperTestSuite::DistributedPartitionHelperTestSuite ()
+  : TestSuite ("distributed-partition-helper", UNIT)
+{
+  AddTestCase (new DistributedPartitionClustersTestCase, TestCase::QUICK);
+  AddTestCase (new DistributedPartitionTiesTestCase, TestCase::QUICK);
+  AddTestCase (new DistributedPartitionGridTestCase, TestCase::QUICK);
+}
+
+static DistributedPartitionHelperTestSuite g_distributedPartitionHelperTestSuite; //!< Static variable for test initialization
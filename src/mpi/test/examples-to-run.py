@@ -0,0 +1,25 @@
+#! /usr/bin/env python
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+
+# A list of C++ examples to run in order to ensure that they remain
+# buildable and runnable over time.  Each tuple in the list contains
+#
+#     (example_name, do_run, do_valgrind_run).
+#
+# See test.py for more information.
+cpp_examples = [
+    ("partitioned-distributed --processes=2", "True", "False"),
+    ("partitioned-distributed --processes=2 --nullmsg", "True", "False"),
+    ("partitioned-distributed --processes=2 --maxBytes=20480 --maxBatchSize=250", "True", "False"),
+    ("partitioned-distributed --processes=2 --maxBytes=20480 --maxBatchSize=250 --nullmsg", "True", "False"),
+    ("partitioned-distributed --processes=2 --maxBatchSize=0", "True", "False"),
+    ("partitioned-distributed --processes=2 --maxBatchSize=0 --nullmsg", "True", "False"),
+]
+
+# A list of Python examples to run in order to ensure that they remain
+# runnable over time.  Each tuple in the list contains
+#
+#     (example_name, do_run).
+#
+# See test.py for more information.
+python_examples = []
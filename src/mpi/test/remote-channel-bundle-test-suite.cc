@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-channel.h"
+#include "../model/remote-channel-bundle.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief Check the earliest arrival time of a bundle of two channels,
+ * before and after packets are sent on them.
+ */
+class RemoteChannelBundleArrivalTestCase : public TestCase
+{
+public:
+  RemoteChannelBundleArrivalTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RemoteChannelBundleArrivalTestCase::RemoteChannelBundleArrivalTestCase ()
+  : TestCase ("Check the earliest arrival time of a remote channel bundle")
+{
+}
+
+void
+RemoteChannelBundleArrivalTestCase::DoRun (void)
+{
+  Ptr<RemoteChannelBundle> bundle = CreateObject<RemoteChannelBundle> (1);
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetSize (), 0, "A new bundle should be empty");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetSystemId (), 1, "Wrong remote system id");
+
+  Ptr<SimpleChannel> fast = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> slow = CreateObject<SimpleChannel> ();
+  bundle->AddChannel (fast, MilliSeconds (2));
+  bundle->AddChannel (slow, MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetSize (), 2, "Both channels should be in the bundle");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetDelay (), MilliSeconds (2), "The delay should be the smallest one");
+
+  // Without packets in flight, the fastest channel bounds the arrival
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetEarliestArrivalTime (Seconds (1)), Seconds (1) + MilliSeconds (2),
+                         "The bound should be the start plus the smallest delay");
+
+  // A packet in flight on the slow channel arrives after the bound of the
+  // fast channel, which still wins
+  bundle->NotifyPacketSent (slow->GetId (), Seconds (1) + MilliSeconds (8));
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetEarliestArrivalTime (Seconds (1)), Seconds (1) + MilliSeconds (2),
+                         "The fast channel should still bound the arrival");
+
+  // A packet on the fast channel pushes its bound to the reception time
+  bundle->NotifyPacketSent (fast->GetId (), Seconds (1) + MilliSeconds (5));
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetEarliestArrivalTime (Seconds (1)), Seconds (1) + MilliSeconds (5),
+                         "The bound should be the last reception time on the fast channel");
+
+  // An earlier reception time does not move the bound back
+  bundle->NotifyPacketSent (fast->GetId (), Seconds (1) + MilliSeconds (3));
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetEarliestArrivalTime (Seconds (1)), Seconds (1) + MilliSeconds (5),
+                         "The last reception time should never decrease");
+
+  // Once the fast channel is busy longer than the delay of the slow one,
+  // the slow channel bounds the arrival
+  bundle->NotifyPacketSent (fast->GetId (), Seconds (1) + MilliSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetEarliestArrivalTime (Seconds (1)), Seconds (1) + MilliSeconds (10),
+                         "The slow channel should bound the arrival");
+
+  // Past all reception times, the delays bound the arrival again
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetEarliestArrivalTime (Seconds (2)), Seconds (2) + MilliSeconds (2),
+                         "The bound should be the start plus the smallest delay");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief Check the message counters and the sent guarantee time of a
+ * remote channel bundle.
+ */
+class RemoteChannelBundleMessagesTestCase : public TestCase
+{
+public:
+  RemoteChannelBundleMessagesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RemoteChannelBundleMessagesTestCase::RemoteChannelBundleMessagesTestCase ()
+  : TestCase ("Check the message counters of a remote channel bundle")
+{
+}
+
+void
+RemoteChannelBundleMessagesTestCase::DoRun (void)
+{
+  Ptr<RemoteChannelBundle> bundle = CreateObject<RemoteChannelBundle> (3);
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetSentGuaranteeTime (), Time (0), "No guarantee should have been sent");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetNullMessagesSent (), 0, "No message should have been sent");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetDataMessagesSent (), 0, "No message should have been sent");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetNullMessagesReceived (), 0, "No message should have been received");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetDataMessagesReceived (), 0, "No message should have been received");
+
+  bundle->NotifyMessageSent (MilliSeconds (10), false);
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetSentGuaranteeTime (), MilliSeconds (10), "Wrong sent guarantee time");
+  bundle->NotifyMessageSent (MilliSeconds (20), true);
+  bundle->NotifyMessageSent (MilliSeconds (30), true);
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetSentGuaranteeTime (), MilliSeconds (30), "Wrong sent guarantee time");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetNullMessagesSent (), 1, "Wrong number of null messages sent");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetDataMessagesSent (), 2, "Wrong number of data messages sent");
+
+  bundle->NotifyMessageReceived (false);
+  bundle->NotifyMessageReceived (false);
+  bundle->NotifyMessageReceived (false);
+  bundle->NotifyMessageReceived (true);
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetNullMessagesReceived (), 3, "Wrong number of null messages received");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetDataMessagesReceived (), 1, "Wrong number of data messages received");
+
+  // Receiving does not change the sent counters
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetNullMessagesSent (), 1, "Wrong number of null messages sent");
+  NS_TEST_ASSERT_MSG_EQ (bundle->GetDataMessagesSent (), 2, "Wrong number of data messages sent");
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief RemoteChannelBundle TestSuite
+ */
+class RemoteChannelBundleTestSuite : public TestSuite
+{
+public:
+  RemoteChannelBundleTestSuite ();
+};
+
+RemoteChannelBundleTestSuite::RemoteChannelBundleTestSuite ()
+  : TestSuite ("remote-channel-bundle", UNIT)
+{
+  AddTestCase (new RemoteChannelBundleArrivalTestCase, TestCase::QUICK);
+  AddTestCase (new RemoteChannelBundleMessagesTestCase, TestCase::QUICK);
+}
+
+static RemoteChannelBundleTestSuite g_remoteChannelBundleTestSuite; //!< Static variable for test initialization
@@ -35,6 +35,23 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TraceHelper");
 
+/**
+ * The pcapng file which PcapHelper::CreateFile currently redirects to, if any.
+ */
+static Ptr<PcapNgFileWrapper> g_pcapNgRedirect = 0;
+/**
+ * The file name prefix stripped from interface names while redirecting.
+ */
+static std::string g_pcapNgPrefix;
+/**
+ * The capture filter copied to the pcap files created by PcapHelper::CreateFile, if any.
+ */
+static Ptr<CaptureFilter> g_pcapCaptureFilter = 0;
+/**
+ * The capture filter copied to the streams created by AsciiTraceHelper::CreateFileStream, if any.
+ */
+static Ptr<CaptureFilter> g_asciiCaptureFilter = 0;
+
 PcapHelper::PcapHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -56,6 +73,29 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  if (g_pcapCaptureFilter)
+    {
+      file->SetCaptureFilter (g_pcapCaptureFilter->Copy ());
+    }
+
+  if (g_pcapNgRedirect)
+    {
+      std::string name = filename;
+      std::string prefix = g_pcapNgPrefix + "-";
+      if (g_pcapNgPrefix.size () && name.compare (0, prefix.size (), prefix) == 0)
+        {
+          name.erase (0, prefix.size ());
+        }
+      std::string suffix = ".pcap";
+      if (name.size () > suffix.size () 
+          && name.compare (name.size () - suffix.size (), suffix.size (), suffix) == 0)
+        {
+          name.erase (name.size () - suffix.size ());
+        }
+      file->AttachToPcapNg (g_pcapNgRedirect, dataLinkType, snapLen, name);
+      return file;
+    }
+
   file->Open (filename, filemode);
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
@@ -76,6 +116,31 @@ PcapHelper::CreateFile (
   return file;
 }
 
+Ptr<PcapNgFileWrapper>
+PcapHelper::CreatePcapNgFile (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->Open (filename);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+
+  //
+  // As with pcap files, ownership is shared by the wrappers of all the
+  // interfaces declared in the file; the file is closed when the last
+  // trace sink using it is destroyed.
+  //
+  return file;
+}
+
+void
+PcapHelper::SetPcapNgRedirect (Ptr<PcapNgFileWrapper> file, std::string prefix)
+{
+  NS_LOG_FUNCTION (file << prefix);
+  g_pcapNgRedirect = file;
+  g_pcapNgPrefix = prefix;
+}
+
 std::string
 PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -193,6 +258,10 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   NS_LOG_FUNCTION (filename << filemode);
 
   Ptr<OutputStreamWrapper> StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
+  if (g_asciiCaptureFilter)
+    {
+      StreamWrapper->SetCaptureFilter (g_asciiCaptureFilter->Copy ());
+    }
 
   //
   // Note that the ascii trace helper promptly forgets all about the trace file.
@@ -208,6 +277,16 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<OutputStreamWrapper>
+AsciiTraceHelper::CreateBinaryFileStream (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+
+  Ptr<OutputStreamWrapper> StreamWrapper = CreateFileStream (filename, std::ios::out | std::ios::binary);
+  StreamWrapper->SetBinaryTrace (Create<BinaryTraceWriter> (StreamWrapper->GetStream ()));
+  return StreamWrapper;
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -310,6 +389,16 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('+', p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -317,6 +406,16 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('+', context, p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -336,6 +435,16 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -343,6 +452,16 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('d', context, p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -363,6 +482,16 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('-', p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -370,6 +499,16 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('-', context, p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -387,6 +526,16 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -394,13 +543,29 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', context, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
+  //
+  // The device helpers create their files through PcapHelper::CreateFile,
+  // which gives each file its own copy of the filter.
+  //
+  g_pcapCaptureFilter = m_captureFilter;
   EnablePcapInternal (prefix, nd, promiscuous, explicitFilename);
+  g_pcapCaptureFilter = 0;
 }
 
 void 
@@ -462,6 +627,49 @@ PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t d
     }
 }
 
+void
+PcapHelperForDevice::SetPcapCaptureFilter (Ptr<CaptureFilter> filter)
+{
+  m_captureFilter = filter;
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (std::string filename, NetDeviceContainer d, bool promiscuous)
+{
+  PcapHelper pcapHelper;
+  Ptr<PcapNgFileWrapper> file = pcapHelper.CreatePcapNgFile (filename);
+
+  //
+  // The device helpers create one pcap file per device through
+  // PcapHelper::CreateFile.  Redirect those files to interfaces of the
+  // shared pcapng file while they are being created.
+  //
+  PcapHelper::SetPcapNgRedirect (file, filename);
+  EnablePcap (filename, d, promiscuous);
+  PcapHelper::SetPcapNgRedirect (0);
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (std::string filename, NodeContainer n, bool promiscuous)
+{
+  NetDeviceContainer devs;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+    }
+  EnablePcapNg (filename, devs, promiscuous);
+}
+
+void
+PcapHelperForDevice::EnablePcapNgAll (std::string filename, bool promiscuous)
+{
+  EnablePcapNg (filename, NodeContainer::GetGlobal (), promiscuous);
+}
+
 //
 // Public API
 //
@@ -477,7 +685,7 @@ AsciiTraceHelperForDevice::EnableAscii (std::string prefix, Ptr<NetDevice> nd, b
 void 
 AsciiTraceHelperForDevice::EnableAscii (Ptr<OutputStreamWrapper> stream, Ptr<NetDevice> nd)
 {
-  EnableAsciiInternal (stream, std::string (), nd, false);
+  EnableAsciiImpl (stream, std::string (), nd, false);
 }
 
 //
@@ -498,6 +706,36 @@ AsciiTraceHelperForDevice::EnableAscii (Ptr<OutputStreamWrapper> stream, std::st
   EnableAsciiImpl (stream, std::string (), ndName, false);
 }
 
+void
+AsciiTraceHelperForDevice::SetAsciiCaptureFilter (Ptr<CaptureFilter> filter)
+{
+  m_captureFilter = filter;
+}
+
+//
+// Private API
+//
+void
+AsciiTraceHelperForDevice::EnableAsciiImpl (
+  Ptr<OutputStreamWrapper> stream,
+  std::string prefix,
+  Ptr<NetDevice> nd,
+  bool explicitFilename)
+{
+  //
+  // A stream provided by the user is shared by all the devices it traces,
+  // and so is its filter.  Streams created by the device helper through
+  // AsciiTraceHelper::CreateFileStream get their own copy of the filter.
+  //
+  if (stream && m_captureFilter && stream->GetCaptureFilter () == 0)
+    {
+      stream->SetCaptureFilter (m_captureFilter->Copy ());
+    }
+  g_asciiCaptureFilter = m_captureFilter;
+  EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+  g_asciiCaptureFilter = 0;
+}
+
 //
 // Private API
 //
@@ -509,7 +747,7 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
   bool explicitFilename)
 {
   Ptr<NetDevice> nd = Names::Find<NetDevice> (ndName);
-  EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+  EnableAsciiImpl (stream, prefix, nd, explicitFilename);
 }
 
 //
@@ -539,7 +777,7 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std
   for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
     {
       Ptr<NetDevice> dev = *i;
-      EnableAsciiInternal (stream, prefix, dev, false);
+      EnableAsciiImpl (stream, prefix, dev, false);
     }
 }
 
@@ -645,7 +883,7 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
 
       Ptr<NetDevice> nd = node->GetDevice (deviceid);
 
-      EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+      EnableAsciiImpl (stream, prefix, nd, explicitFilename);
       return;
     }
 }
@@ -24,7 +24,9 @@
 #include "ns3/node-container.h"
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/capture-filter.h"
 
 namespace ns3 {
 
@@ -109,6 +111,29 @@ public:
                                    DataLinkType dataLinkType,
                                    uint32_t snapLen = std::numeric_limits<uint32_t>::max (),
                                    int32_t tzCorrection = 0);
+
+  /**
+   * @brief Create and initialize a pcapng file which can hold the captures
+   * of many devices.
+   *
+   * @param filename file name
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> CreatePcapNgFile (std::string filename);
+
+  /**
+   * @brief Redirect the files subsequently created by CreateFile () to
+   * interfaces of a shared pcapng file.
+   *
+   * While a redirection is active, CreateFile () does not create any file;
+   * the returned wrapper instead declares a new interface in the shared
+   * file, named after the requested file name with \p prefix and the
+   * ".pcap" extension stripped.
+   *
+   * @param file the shared pcapng file, or 0 to stop redirecting
+   * @param prefix the file name prefix that device helpers will use
+   */
+  static void SetPcapNgRedirect (Ptr<PcapNgFileWrapper> file, std::string prefix = "");
   /**
    * @brief Hook a trace source to the default trace sink
    * 
@@ -222,6 +247,20 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create an output stream which records a binary trace.
+   *
+   * The returned stream can be passed to the EnableAscii methods of the
+   * device helpers in place of a text stream.  The default trace sinks then
+   * record each event in the compact format of BinaryTraceWriter instead
+   * of formatting it; the text trace can be regenerated offline with the
+   * print-binary-trace program.
+   *
+   * @param filename file name
+   * @returns a smart pointer to the output stream
+   */
+  Ptr<OutputStreamWrapper> CreateBinaryFileStream (std::string filename);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -632,6 +671,55 @@ public:
    * @param promiscuous If true capture all possible packets available at the device.
    */
   void EnablePcapAll (std::string prefix, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device in the container which is of
+   * the appropriate type, writing all the captures in a single file.
+   *
+   * Each device is declared as a separate interface of the pcapng file,
+   * named after the node and device (see PcapHelper::GetFilenameFromDevice).
+   *
+   * @param filename Name of the pcapng file.
+   * @param d container of devices
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (std::string filename, NetDeviceContainer d, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate
+   * type) in the nodes provided in the container, writing all the captures
+   * in a single file.
+   *
+   * @param filename Name of the pcapng file.
+   * @param n container of nodes.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (std::string filename, NodeContainer n, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate
+   * type) in the set of all nodes created in the simulation, writing all the
+   * captures in a single file.
+   *
+   * @param filename Name of the pcapng file.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNgAll (std::string filename, bool promiscuous = false);
+
+  /**
+   * @brief Only record the packets accepted by a capture filter in the pcap
+   * files enabled from now on by this helper.
+   *
+   * Each pcap file gets its own copy of the filter, so that sampling is
+   * done independently on each device.  Packets which are filtered out
+   * are never serialized.
+   *
+   * @param filter The capture filter, or 0 to record every packet.
+   */
+  void SetPcapCaptureFilter (Ptr<CaptureFilter> filter);
+
+private:
+  Ptr<CaptureFilter> m_captureFilter; //!< capture filter given to new pcap files
 };
 
 /**
@@ -798,6 +886,19 @@ public:
    */
   void EnableAscii (Ptr<OutputStreamWrapper> stream, uint32_t nodeid, uint32_t deviceid);
 
+  /**
+   * @brief Only record the packets accepted by a capture filter in the ascii
+   * traces enabled from now on by this helper.
+   *
+   * Each trace file created by the helper gets its own copy of the filter.
+   * A stream provided by the user gets a single copy, shared by all the
+   * devices it traces, unless it already has a filter.  Packets which are
+   * filtered out are never formatted.
+   *
+   * @param filter The capture filter, or 0 to record every packet.
+   */
+  void SetAsciiCaptureFilter (Ptr<CaptureFilter> filter);
+
 private:
   /**
    * @brief Enable ascii trace output on the device specified by a global
@@ -863,6 +964,8 @@ private:
    * @param explicitFilename Treat the prefix as an explicit filename if true
    */
   void EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
+
+  Ptr<CaptureFilter> m_captureFilter; //!< capture filter given to new ascii traces
 };
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -34,6 +35,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class QueueDiscItem;
 
 /**
  * \ingroup network
@@ -260,6 +262,21 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param items the packets to send, with their destination address and
+   *        protocol number, in order
+   *
+   *  Called by the traffic control layer to hand a burst of packets over to
+   *  the Network Device.  The packets are sent as if by successive calls to
+   *  Send, until all of them are sent or the device transmission queue of
+   *  the next packet is stopped.  Each packet which is sent is consumed by
+   *  the device, even if it is dropped.  The default implementation calls
+   *  Send for each packet; devices may override this method to do less work
+   *  per packet.
+   *
+   * \return the number of packets sent, which are the first ones of the burst
+   */
+  virtual uint32_t SendBulk (const std::vector<Ptr<QueueDiscItem> > &items);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/ethernet-trailer.h"
+#include "ns3/binary-trace.h"
+#include "ns3/trace-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that a binary trace is printed exactly as the ascii trace.
+ */
+class BinaryTraceTestCase : public TestCase
+{
+public:
+  BinaryTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Trace a packet to both the text and the binary streams.
+   * \param event the kind of event: '+', '-', 'd' or 'r'
+   * \param context the context, or empty for none
+   * \param p the packet
+   */
+  void Trace (char event, std::string context, Ptr<const Packet> p);
+
+  Ptr<OutputStreamWrapper> m_text;    //!< ascii trace
+  Ptr<OutputStreamWrapper> m_binary;  //!< binary trace
+};
+
+BinaryTraceTestCase::BinaryTraceTestCase ()
+  : TestCase ("Check that binary traces are printed as ascii traces")
+{
+}
+
+void
+BinaryTraceTestCase::Trace (char event, std::string context, Ptr<const Packet> p)
+{
+  Ptr<OutputStreamWrapper> streams[] = { m_text, m_binary };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      switch (event)
+        {
+        case '+':
+          if (context.empty ())
+            {
+              AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (streams[i], p);
+            }
+          else
+            {
+              AsciiTraceHelper::DefaultEnqueueSinkWithContext (streams[i], context, p);
+            }
+          break;
+        case '-':
+          AsciiTraceHelper::DefaultDequeueSinkWithContext (streams[i], context, p);
+          break;
+        case 'd':
+          AsciiTraceHelper::DefaultDropSinkWithoutContext (streams[i], p);
+          break;
+        case 'r':
+          AsciiTraceHelper::DefaultReceiveSinkWithContext (streams[i], context, p);
+          break;
+        }
+    }
+}
+
+void
+BinaryTraceTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+
+  std::string filename = CreateTempDirFilename ("binary-trace-test.bin");
+  std::ostringstream text;
+  AsciiTraceHelper ascii;
+  m_text = Create<OutputStreamWrapper> (&text);
+  m_binary = ascii.CreateBinaryFileStream (filename);
+
+  Ptr<Packet> p1 = Create<Packet> (100);
+  EthernetHeader header;
+  header.SetLengthType (0x0800);
+  p1->AddHeader (header);
+  EthernetTrailer trailer;
+  p1->AddTrailer (trailer);
+  Ptr<Packet> p2 = Create<Packet> (1000);
+  Ptr<Packet> fragment = p1->CreateFragment (0, 30);
+
+  std::string ctx1 = "/NodeList/0/DeviceList/1/$ns3::PointToPointNetDevice/TxQueue/Enqueue";
+  std::string ctx2 = "/NodeList/3/DeviceList/0/$ns3::CsmaNetDevice/MacRx";
+  Simulator::Schedule (Seconds (0), &BinaryTraceTestCase::Trace, this, '+', ctx1, p1);
+  Simulator::Schedule (MicroSeconds (1234567), &BinaryTraceTestCase::Trace, this, '-', ctx1, p1);
+  Simulator::Schedule (NanoSeconds (2000000001), &BinaryTraceTestCase::Trace, this, 'r', ctx2, p1);
+  Simulator::Schedule (Seconds (3.5), &BinaryTraceTestCase::Trace, this, '+', "", p2);
+  Simulator::Schedule (Seconds (100), &BinaryTraceTestCase::Trace, this, 'd', "", fragment);
+  Simulator::Schedule (Seconds (100), &BinaryTraceTestCase::Trace, this, 'r', ctx2, p2);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  //
+  // Releasing the stream flushes the binary trace.
+  //
+  m_text = 0;
+  m_binary = 0;
+
+  std::ostringstream printed;
+  BinaryTraceReader reader (filename);
+  BinaryTraceReader::Record record;
+  uint32_t records = 0;
+  while (reader.Read (record))
+    {
+      BinaryTraceReader::Print (printed, record);
+      ++records;
+    }
+  NS_TEST_EXPECT_MSG_EQ (records, 6, "Bad number of records");
+  NS_TEST_EXPECT_MSG_EQ (printed.str (), text.str (), "Binary trace not printed as ascii trace");
+
+  //
+  // The sinks of the IP layers record the interface index with the event.
+  //
+  filename = CreateTempDirFilename ("binary-trace-interface-test.bin");
+  Ptr<OutputStreamWrapper> stream = ascii.CreateBinaryFileStream (filename);
+  stream->GetBinaryTrace ()->Write ('t', ctx1, p1, 2);
+  stream->GetBinaryTrace ()->Write ('r', p2);
+  stream = 0;
+
+  BinaryTraceReader interfaceReader (filename);
+  NS_TEST_ASSERT_MSG_EQ (interfaceReader.Read (record), true, "Missing record");
+  NS_TEST_EXPECT_MSG_EQ (record.interface, 2, "Bad interface index");
+  NS_TEST_EXPECT_MSG_EQ (record.context, ctx1, "Bad context");
+  NS_TEST_ASSERT_MSG_EQ (interfaceReader.Read (record), true, "Missing record");
+  NS_TEST_EXPECT_MSG_EQ (record.interface, BinaryTraceWriter::NO_INTERFACE, "Unexpected interface index");
+  NS_TEST_EXPECT_MSG_EQ (record.uid, p2->GetUid (), "Bad packet uid");
+  NS_TEST_EXPECT_MSG_EQ (interfaceReader.Read (record), false, "Unexpected record");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace test suite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite g_binaryTraceTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,311 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/capture-filter.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/pcap-file.h"
+#include "ns3/pcap-file-wrapper.h"
+
+using namespace ns3;
+
+/// Pcap data link type of Ethernet
+static const uint32_t DLT_EN10MB = 1;
+/// Pcap data link type of PPP
+static const uint32_t DLT_PPP = 9;
+
+/**
+ * \brief Build the IPv4 and UDP headers of a test datagram.
+ * \param buf [out] 28 bytes
+ * \param src source address, host order
+ * \param dst destination address, host order
+ * \param sport UDP source port
+ * \param dport UDP destination port
+ * \param proto IPv4 protocol
+ */
+static void
+BuildIpv4 (uint8_t *buf, uint32_t src, uint32_t dst, uint16_t sport, uint16_t dport, uint8_t proto = 17)
+{
+  std::memset (buf, 0, 28);
+  buf[0] = 0x45;
+  buf[3] = 28;
+  buf[8] = 64;
+  buf[9] = proto;
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      buf[12 + i] = src >> (24 - 8 * i);
+      buf[16 + i] = dst >> (24 - 8 * i);
+    }
+  buf[20] = sport >> 8;
+  buf[21] = sport;
+  buf[22] = dport >> 8;
+  buf[23] = dport;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check the compiled expressions on Ethernet and PPP frames.
+ */
+class CaptureFilterExpressionTestCase : public TestCase
+{
+public:
+  CaptureFilterExpressionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Check whether an expression accepts a frame.
+   * \param expression the expression
+   * \param frame the frame
+   * \param length the frame length
+   * \param dlt the data link type of the frame
+   * \returns true if the frame is accepted
+   */
+  bool Check (std::string expression, uint8_t const *frame, uint32_t length, uint32_t dlt);
+};
+
+CaptureFilterExpressionTestCase::CaptureFilterExpressionTestCase ()
+  : TestCase ("Check capture filter expressions")
+{
+}
+
+bool
+CaptureFilterExpressionTestCase::Check (std::string expression, uint8_t const *frame, uint32_t length, uint32_t dlt)
+{
+  CaptureFilter filter (expression);
+  return filter.Accept (frame, length, dlt);
+}
+
+void
+CaptureFilterExpressionTestCase::DoRun (void)
+{
+  //
+  // A UDP datagram from 10.1.1.1:49153 to 10.1.2.2:9 in an Ethernet frame.
+  //
+  uint8_t frame[14 + 28];
+  std::memset (frame, 0, 14);
+  frame[12] = 0x08;
+  BuildIpv4 (frame + 14, 0x0a010101, 0x0a010202, 49153, 9);
+
+  NS_TEST_EXPECT_MSG_EQ (Check ("", frame, sizeof (frame), DLT_EN10MB), true, "Empty expression accepts everything");
+  NS_TEST_EXPECT_MSG_EQ (Check ("ip", frame, sizeof (frame), DLT_EN10MB), true, "IPv4 frame");
+  NS_TEST_EXPECT_MSG_EQ (Check ("ip6 or arp", frame, sizeof (frame), DLT_EN10MB), false, "Not IPv6 nor ARP");
+  NS_TEST_EXPECT_MSG_EQ (Check ("udp", frame, sizeof (frame), DLT_EN10MB), true, "UDP datagram");
+  NS_TEST_EXPECT_MSG_EQ (Check ("tcp", frame, sizeof (frame), DLT_EN10MB), false, "Not TCP");
+  NS_TEST_EXPECT_MSG_EQ (Check ("proto 17", frame, sizeof (frame), DLT_EN10MB), true, "Protocol 17");
+  NS_TEST_EXPECT_MSG_EQ (Check ("host 10.1.2.2", frame, sizeof (frame), DLT_EN10MB), true, "Destination host");
+  NS_TEST_EXPECT_MSG_EQ (Check ("src host 10.1.2.2", frame, sizeof (frame), DLT_EN10MB), false, "Not the source host");
+  NS_TEST_EXPECT_MSG_EQ (Check ("dst host 10.1.2.2", frame, sizeof (frame), DLT_EN10MB), true, "Destination host");
+  NS_TEST_EXPECT_MSG_EQ (Check ("src net 10.1.0.0/16", frame, sizeof (frame), DLT_EN10MB), true, "Source net");
+  NS_TEST_EXPECT_MSG_EQ (Check ("src net 10.1.2.0/24", frame, sizeof (frame), DLT_EN10MB), false, "Not the source net");
+  NS_TEST_EXPECT_MSG_EQ (Check ("net 10.1.2.0/23", frame, sizeof (frame), DLT_EN10MB), true, "Odd prefix length");
+  NS_TEST_EXPECT_MSG_EQ (Check ("port 9", frame, sizeof (frame), DLT_EN10MB), true, "Port");
+  NS_TEST_EXPECT_MSG_EQ (Check ("udp dst port 9", frame, sizeof (frame), DLT_EN10MB), true, "UDP destination port");
+  NS_TEST_EXPECT_MSG_EQ (Check ("tcp port 9", frame, sizeof (frame), DLT_EN10MB), false, "Not a TCP port");
+  NS_TEST_EXPECT_MSG_EQ (Check ("src port 9", frame, sizeof (frame), DLT_EN10MB), false, "Not the source port");
+  NS_TEST_EXPECT_MSG_EQ (Check ("less 42", frame, sizeof (frame), DLT_EN10MB), true, "Length at most 42");
+  NS_TEST_EXPECT_MSG_EQ (Check ("greater 43", frame, sizeof (frame), DLT_EN10MB), false, "Length below 43");
+  NS_TEST_EXPECT_MSG_EQ (Check ("udp and not port 80", frame, sizeof (frame), DLT_EN10MB), true, "Negation");
+  NS_TEST_EXPECT_MSG_EQ (Check ("!(udp && port 9) || arp", frame, sizeof (frame), DLT_EN10MB), false, "Symbolic operators");
+  NS_TEST_EXPECT_MSG_EQ (Check ("arp or udp and port 10", frame, sizeof (frame), DLT_EN10MB), false, "'and' binds tighter than 'or'");
+  NS_TEST_EXPECT_MSG_EQ (Check ("(arp or udp) and port 9", frame, sizeof (frame), DLT_EN10MB), true, "Parentheses");
+
+  //
+  // A TCP segment from 192.168.0.1:80 in a PPP frame.
+  //
+  uint8_t ppp[2 + 28];
+  ppp[0] = 0x00;
+  ppp[1] = 0x21;
+  BuildIpv4 (ppp + 2, 0xc0a80001, 0x0a000001, 80, 1024, 6);
+  NS_TEST_EXPECT_MSG_EQ (Check ("tcp src port 80", ppp, sizeof (ppp), DLT_PPP), true, "TCP source port over PPP");
+  NS_TEST_EXPECT_MSG_EQ (Check ("host 192.168.0.1", ppp, sizeof (ppp), DLT_PPP), true, "Host over PPP");
+
+  //
+  // Unknown framing never matches protocol primitives.
+  //
+  NS_TEST_EXPECT_MSG_EQ (Check ("ip", ppp, sizeof (ppp), CaptureFilter::DLT_UNKNOWN), false, "No metadata");
+  NS_TEST_EXPECT_MSG_EQ (Check ("not ip", ppp, sizeof (ppp), CaptureFilter::DLT_UNKNOWN), true, "No metadata");
+
+  //
+  // A packet traced with a separate Ethernet header.
+  //
+  EthernetHeader eth;
+  eth.SetLengthType (0x0800);
+  Ptr<Packet> p = Create<Packet> (frame + 14, 28);
+  CaptureFilter filter ("udp port 9 and host 10.1.1.1");
+  NS_TEST_EXPECT_MSG_EQ (filter.Accept (p, DLT_EN10MB, &eth), true, "Packet with separate header");
+  filter.SetExpression ("tcp");
+  NS_TEST_EXPECT_MSG_EQ (filter.Accept (p, DLT_EN10MB, &eth), false, "Packet with separate header");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check sampling and time windows.
+ */
+class CaptureFilterSamplingTestCase : public TestCase
+{
+public:
+  CaptureFilterSamplingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Offer a packet to a filter and count it if accepted.
+   * \param filter the filter
+   */
+  void Offer (Ptr<CaptureFilter> filter);
+
+  uint32_t m_accepted; //!< number of accepted packets
+};
+
+CaptureFilterSamplingTestCase::CaptureFilterSamplingTestCase ()
+  : TestCase ("Check capture filter sampling and time windows"),
+    m_accepted (0)
+{
+}
+
+void
+CaptureFilterSamplingTestCase::Offer (Ptr<CaptureFilter> filter)
+{
+  if (filter->Accept (Create<Packet> (100)))
+    {
+      ++m_accepted;
+    }
+}
+
+void
+CaptureFilterSamplingTestCase::DoRun (void)
+{
+  Ptr<CaptureFilter> filter = Create<CaptureFilter> ();
+  filter->SetSampling (3);
+  bool expected[] = { true, false, false, true, false, false, true };
+  for (uint32_t i = 0; i < sizeof (expected) / sizeof (expected[0]); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (filter->Accept (Create<Packet> (100)), expected[i], "Bad sample " << i);
+    }
+
+  Ptr<CaptureFilter> copy = filter->Copy ();
+  NS_TEST_EXPECT_MSG_EQ (copy->Accept (Create<Packet> (100)), true, "Copies restart sampling");
+  NS_TEST_EXPECT_MSG_EQ (filter->Accept (Create<Packet> (100)), false, "Copies have their own counter");
+
+  //
+  // Only the packets offered at 1, 2 and 3 seconds are in the window.
+  //
+  filter = Create<CaptureFilter> ("greater 50");
+  filter->SetTimeWindow (Seconds (1), Seconds (4));
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &CaptureFilterSamplingTestCase::Offer, this, filter);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_accepted, 3, "Time window not applied");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that pcap files only record the packets accepted by their filter.
+ */
+class CaptureFilterPcapTestCase : public TestCase
+{
+public:
+  CaptureFilterPcapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CaptureFilterPcapTestCase::CaptureFilterPcapTestCase ()
+  : TestCase ("Check capture filters on pcap files")
+{
+}
+
+void
+CaptureFilterPcapTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("capture-filter-test.pcap");
+
+  Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  file->Open (filename, std::ios::out);
+  file->Init (DLT_PPP);
+  Ptr<CaptureFilter> filter = Create<CaptureFilter> ("udp dst port 9");
+  filter->SetSampling (2);
+  file->SetCaptureFilter (filter);
+
+  //
+  // Ten datagrams alternately to ports 9 and 10; the five sent to port 9
+  // match the expression and three of them are sampled.
+  //
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      uint8_t ppp[2 + 28];
+      ppp[0] = 0x00;
+      ppp[1] = 0x21;
+      BuildIpv4 (ppp + 2, 0x0a010101, 0x0a010202, 49153, 9 + i % 2);
+      file->Write (Seconds (i), ppp, sizeof (ppp));
+    }
+  file->Close ();
+
+  PcapFile check;
+  check.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (check.Fail (), false, "Unable to open " << filename);
+  uint8_t data[64];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  uint32_t records = 0;
+  while (true)
+    {
+      check.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      if (check.Eof () || check.Fail ())
+        {
+          break;
+        }
+      NS_TEST_EXPECT_MSG_EQ (tsSec % 4, 0, "Unexpected packet recorded at " << tsSec << "s");
+      ++records;
+    }
+  check.Close ();
+  NS_TEST_EXPECT_MSG_EQ (records, 3, "Filter not applied to the pcap file");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Capture filter test suite
+ */
+class CaptureFilterTestSuite : public TestSuite
+{
+public:
+  CaptureFilterTestSuite ();
+};
+
+CaptureFilterTestSuite::CaptureFilterTestSuite ()
+  : TestSuite ("capture-filter", UNIT)
+{
+  AddTestCase (new CaptureFilterExpressionTestCase, TestCase::QUICK);
+  AddTestCase (new CaptureFilterSamplingTestCase, TestCase::QUICK);
+  AddTestCase (new CaptureFilterPcapTestCase, TestCase::QUICK);
+}
+
+static CaptureFilterTestSuite g_captureFilterTestSuite; //!< Static variable for test initialization
@@ -38,6 +38,7 @@
 #include "ns3/pointer.h"
 #include "ns3/double.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/rng-seed-manager.h"
 
 using namespace ns3;
@@ -262,6 +263,170 @@ BurstErrorModelSimple::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_drops, 260 , "Wrong number of drops.");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that skip-ahead sampling in RateErrorModel yields the expected
+ * packet error rates.
+ */
+class SkipAheadErrorModelTest : public TestCase
+{
+public:
+  SkipAheadErrorModelTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the corrupted packets.
+   * \param em The error model.
+   * \param packets The number of packets.
+   * \param size The size of the packets.
+   * \return The number of corrupted packets.
+   */
+  uint32_t CountErrors (Ptr<ErrorModel> em, uint32_t packets, uint32_t size);
+};
+
+SkipAheadErrorModelTest::SkipAheadErrorModelTest ()
+  : TestCase ("Skip-ahead sampling in RateErrorModel")
+{
+}
+
+uint32_t
+SkipAheadErrorModelTest::CountErrors (Ptr<ErrorModel> em, uint32_t packets, uint32_t size)
+{
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      if (em->IsCorrupt (Create<Packet> (size)))
+        {
+          errors++;
+        }
+    }
+  return errors;
+}
+
+void
+SkipAheadErrorModelTest::DoRun (void)
+{
+  Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+  em->SetAttribute ("SkipAhead", BooleanValue (true));
+  em->AssignStreams (60);
+
+  em->SetUnit (RateErrorModel::ERROR_UNIT_BIT);
+  em->SetRate (0);
+  NS_TEST_EXPECT_MSG_EQ (CountErrors (em, 1000, 1000), 0, "No packet should be corrupted");
+  em->SetRate (1);
+  NS_TEST_EXPECT_MSG_EQ (CountErrors (em, 1000, 1000), 1000, "All packets should be corrupted");
+
+  // PER = 1 - (1 - 1e-5)^8000 = 0.0769, about 769 +- 27 errors
+  em->SetRate (1e-5);
+  uint32_t errors = CountErrors (em, 10000, 1000);
+  NS_TEST_EXPECT_MSG_EQ_TOL (errors, 769, 100, "Wrong number of bit errors");
+
+  // PER = 1 - (1 - 1e-3)^100 = 0.0952, about 952 +- 29 errors
+  em->SetUnit (RateErrorModel::ERROR_UNIT_BYTE);
+  em->SetRate (1e-3);
+  errors = CountErrors (em, 10000, 100);
+  NS_TEST_EXPECT_MSG_EQ_TOL (errors, 952, 100, "Wrong number of byte errors");
+
+  em->SetUnit (RateErrorModel::ERROR_UNIT_PACKET);
+  em->SetRate (0.1);
+  errors = CountErrors (em, 10000, 100);
+  NS_TEST_EXPECT_MSG_EQ_TOL (errors, 1000, 100, "Wrong number of packet errors");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * GilbertElliottErrorModel unit tests.
+ */
+class GilbertElliottErrorModelTest : public TestCase
+{
+public:
+  GilbertElliottErrorModelTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GilbertElliottErrorModelTest::GilbertElliottErrorModelTest ()
+  : TestCase ("Loss rate and burst length of GilbertElliottErrorModel")
+{
+}
+
+void
+GilbertElliottErrorModelTest::DoRun (void)
+{
+  Ptr<GilbertElliottErrorModel> em = CreateObject<GilbertElliottErrorModel> ();
+  em->SetAttribute ("GoodToBad", DoubleValue (0.01));
+  em->SetAttribute ("BadToGood", DoubleValue (0.1));
+  em->AssignStreams (61);
+
+  // Packet unit, all packets lost in the Bad state: the loss rate is the
+  // fraction of time in the Bad state, 0.01 / (0.01 + 0.1), and the mean
+  // burst length is 1 / 0.1
+  uint32_t losses = 0;
+  uint32_t bursts = 0;
+  bool lost = false;
+  for (uint32_t i = 0; i < 100000; i++)
+    {
+      bool bad = em->IsBad ();
+      bool corrupt = em->IsCorrupt (Create<Packet> (100));
+      NS_TEST_ASSERT_MSG_EQ (corrupt, bad, "Only packets sent in the Bad state should be lost");
+      if (corrupt)
+        {
+          losses++;
+          if (!lost)
+            {
+              bursts++;
+            }
+        }
+      lost = corrupt;
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (losses / 100000.0, 0.0909, 0.01, "Wrong loss rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (losses / static_cast<double> (bursts), 10, 1, "Wrong mean burst length");
+
+  // Bit unit: compare with a per-bit simulation of the same chain
+  em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_BIT"));
+  em->SetAttribute ("GoodToBad", DoubleValue (1e-4));
+  em->SetAttribute ("BadToGood", DoubleValue (1e-2));
+  em->SetAttribute ("GoodErrorRate", DoubleValue (1e-6));
+  em->SetAttribute ("BadErrorRate", DoubleValue (1e-2));
+  em->Reset ();
+
+  Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable> ();
+  uv->SetStream (62);
+  bool bad = false;
+  uint32_t expected = 0;
+  losses = 0;
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      if (em->IsCorrupt (Create<Packet> (100)))
+        {
+          losses++;
+        }
+      bool corrupt = false;
+      for (uint32_t bit = 0; bit < 800; bit++)
+        {
+          if (uv->GetValue () < (bad ? 1e-2 : 1e-6))
+            {
+              corrupt = true;
+            }
+          if (uv->GetValue () < (bad ? 1e-2 : 1e-4))
+            {
+              bad = !bad;
+            }
+        }
+      if (corrupt)
+        {
+          expected++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (losses, expected, expected / 5, "Loss rate differs from the per-bit simulation");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -283,6 +448,8 @@ ErrorModelTestSuite::ErrorModelTestSuite ()
 {
   AddTestCase (new ErrorModelSimple, TestCase::QUICK);
   AddTestCase (new BurstErrorModelSimple, TestCase::QUICK);
+  AddTestCase (new SkipAheadErrorModelTest, TestCase::QUICK);
+  AddTestCase (new GilbertElliottErrorModelTest, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
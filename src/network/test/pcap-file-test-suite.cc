@@ -21,10 +21,14 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcapng-file.h"
 
 using namespace ns3;
 
@@ -1086,6 +1090,185 @@ ReadFileTestCase::DoRun (void)
   f.Close ();
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that writing through a write buffer, with
+ * or without a background thread, produces the same file as unbuffered
+ * writes.
+ */
+class BufferedWriteTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param async Whether to write the buffers from a background thread.
+   */
+  BufferedWriteTestCase (bool async);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_async; //!< Whether to write the buffers from a background thread
+};
+
+BufferedWriteTestCase::BufferedWriteTestCase (bool async)
+  : TestCase (async ? "Check that PcapFile asynchronous buffered writes work"
+                    : "Check that PcapFile buffered writes work"),
+    m_async (async)
+{
+}
+
+void
+BufferedWriteTestCase::DoRun (void)
+{
+  std::string knownFilename = CreateDataDirFilename ("known.pcap");
+  PcapFile known;
+  known.Open (knownFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (known.Fail (), false, "Open (" << knownFilename << 
+                         ", \"std::ios::in\") returns error");
+
+  std::string filename = CreateTempDirFilename (m_async ? "buffered-async.pcap" : "buffered.pcap");
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << 
+                         ", \"std::ios::out\") returns error");
+  f.Init (known.GetDataLinkType (), known.GetSnapLen ());
+  //
+  // Use a buffer smaller than some of the packets, so that the buffers are
+  // handed off many times and have to grow.
+  //
+  f.SetWriteBuffer (100, m_async);
+
+  uint8_t data[PcapFile::SNAPLEN_DEFAULT];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  uint32_t packets = 0;
+  for (;;)
+    {
+      known.Read (data, sizeof(data), tsSec, tsUsec, inclLen, origLen, readLen);
+      if (known.Fail ())
+        {
+          break;
+        }
+      f.Write (tsSec, tsUsec, data, readLen);
+      ++packets;
+    }
+  NS_TEST_ASSERT_MSG_EQ (packets, N_KNOWN_PACKETS, "Unexpected number of packets read from known good pcap file");
+  known.Close ();
+  f.Close ();
+
+  uint32_t sec (0), usec (0);
+  packets = 0;
+  bool diff = PcapFile::Diff (knownFilename, filename, sec, usec, packets);
+  NS_TEST_EXPECT_MSG_EQ (diff, false, "Buffered copy of known good pcap file differs at packet " << packets);
+  NS_TEST_EXPECT_MSG_EQ (packets, N_KNOWN_PACKETS, "Unexpected number of packets in buffered copy");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that PcapNgFile writes well formed blocks.
+ */
+class PcapNgWriteTestCase : public TestCase
+{
+public:
+  PcapNgWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapNgWriteTestCase::PcapNgWriteTestCase ()
+  : TestCase ("Check that PcapNgFile writes a well formed pcapng file")
+{
+}
+
+void
+PcapNgWriteTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("test.pcapng");
+  PcapNgFile f;
+  f.Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ") returns error");
+  f.Init ();
+  uint32_t if0 = f.AddInterface (9, 65535, "0-0");
+  uint32_t if1 = f.AddInterface (1, 10, "1-0");
+  NS_TEST_ASSERT_MSG_EQ (if0, 0, "Unexpected identifier for first interface");
+  NS_TEST_ASSERT_MSG_EQ (if1, 1, "Unexpected identifier for second interface");
+
+  uint8_t data[43];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i;
+    }
+  f.Write (if0, 5000000001ULL, data, 43);
+  f.Write (if1, 7, data, 43);
+  f.Write (if0, 8, data, 1);
+  f.Close ();
+
+  //
+  // Walk the blocks in the file.  Every block starts with its type and its
+  // total length, which is repeated at the end of the block.
+  //
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  std::vector<uint8_t> contents ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  std::vector<uint32_t> types;
+  std::vector<std::vector<uint8_t> > blocks;
+  uint32_t offset = 0;
+  while (offset + 12 <= contents.size ())
+    {
+      uint32_t type, len, trailer;
+      std::memcpy (&type, &contents[offset], 4);
+      std::memcpy (&len, &contents[offset + 4], 4);
+      NS_TEST_ASSERT_MSG_EQ ((len % 4), 0, "Block length is not a multiple of 4");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + len, contents.size (), "Block extends past end of file");
+      std::memcpy (&trailer, &contents[offset + len - 4], 4);
+      NS_TEST_ASSERT_MSG_EQ (trailer, len, "Block lengths at start and end of block differ");
+      types.push_back (type);
+      blocks.push_back (std::vector<uint8_t> (contents.begin () + offset, contents.begin () + offset + len));
+      offset += len;
+    }
+  NS_TEST_ASSERT_MSG_EQ (offset, contents.size (), "Trailing bytes at end of file");
+  NS_TEST_ASSERT_MSG_EQ (types.size (), 6, "Unexpected number of blocks");
+
+  uint32_t magic;
+  std::memcpy (&magic, &blocks[0][8], 4);
+  NS_TEST_EXPECT_MSG_EQ (types[0], 0x0a0d0d0a, "First block is not a section header");
+  NS_TEST_EXPECT_MSG_EQ (magic, 0x1a2b3c4d, "Bad byte order magic");
+
+  uint16_t linkType;
+  NS_TEST_EXPECT_MSG_EQ (types[1], 1, "Second block is not an interface description");
+  std::memcpy (&linkType, &blocks[1][8], 2);
+  NS_TEST_EXPECT_MSG_EQ (linkType, 9, "Bad link type for first interface");
+  NS_TEST_EXPECT_MSG_EQ (types[2], 1, "Third block is not an interface description");
+  std::memcpy (&linkType, &blocks[2][8], 2);
+  NS_TEST_EXPECT_MSG_EQ (linkType, 1, "Bad link type for second interface");
+
+  uint32_t expectedIf[] = { 0, 1, 0 };
+  uint64_t expectedTs[] = { 5000000001ULL, 7, 8 };
+  uint32_t expectedCapLen[] = { 43, 10, 1 };
+  uint32_t expectedOrigLen[] = { 43, 43, 1 };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      std::vector<uint8_t> const &b = blocks[3 + i];
+      uint32_t interface, tsHigh, tsLow, capLen, origLen;
+      std::memcpy (&interface, &b[8], 4);
+      std::memcpy (&tsHigh, &b[12], 4);
+      std::memcpy (&tsLow, &b[16], 4);
+      std::memcpy (&capLen, &b[20], 4);
+      std::memcpy (&origLen, &b[24], 4);
+      NS_TEST_EXPECT_MSG_EQ (types[3 + i], 6, "Block " << 3 + i << " is not an enhanced packet block");
+      NS_TEST_EXPECT_MSG_EQ (interface, expectedIf[i], "Bad interface in packet " << i);
+      uint64_t ts = ((uint64_t)tsHigh << 32) | tsLow;
+      NS_TEST_EXPECT_MSG_EQ (ts, expectedTs[i], "Bad timestamp in packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (capLen, expectedCapLen[i], "Bad captured length in packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (origLen, expectedOrigLen[i], "Bad original length in packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (std::memcmp (&b[28], data, capLen), 0, "Bad data in packet " << i);
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1350,9 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new BufferedWriteTestCase (false), TestCase::QUICK);
+  AddTestCase (new BufferedWriteTestCase (true), TestCase::QUICK);
+  AddTestCase (new PcapNgWriteTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/ring-buffer-queue.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/enum.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Ring Buffer Queue Test Case
+ */
+class RingBufferQueueTestCase : public TestCase
+{
+public:
+  RingBufferQueueTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+RingBufferQueueTestCase::RingBufferQueueTestCase ()
+  : TestCase ("Sanity check on the ring buffer queue implementation")
+{
+}
+
+void
+RingBufferQueueTestCase::DoRun (void)
+{
+  Ptr<RingBufferQueue<Packet> > queue = CreateObject<RingBufferQueue<Packet> > ();
+  queue->SetMaxPackets (3);
+
+  Ptr<Packet> p1, p2, p3, p4;
+  p1 = Create<Packet> ();
+  p2 = Create<Packet> ();
+  p3 = Create<Packet> ();
+  p4 = Create<Packet> ();
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 0, "The ring should not be allocated yet");
+  NS_TEST_EXPECT_MSG_EQ ((queue->Peek () == 0), true, "The queue should be empty");
+
+  queue->Enqueue (p1);
+  queue->Enqueue (p2);
+  queue->Enqueue (p3);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "There should be three packets in there");
+  queue->Enqueue (p4); // will be dropped
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "There should be still three packets in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 1, "One packet should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 3, "The ring should hold 3 packets");
+
+  Ptr<Packet> packet;
+
+  packet = queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), p1->GetUid (), "was this the first packet ?");
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), p2->GetUid (), "The second packet should be at the head");
+
+  packet = queue->Remove ();
+  NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), p2->GetUid (), "Was this the second packet ?");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 2, "The removed packet should be counted as dropped");
+
+  packet = queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), p3->GetUid (), "Was this the third packet ?");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "There should be no packets in there");
+
+  packet = queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
+
+  //
+  // In byte mode the ring holds as many items as there are bytes.
+  //
+  queue = CreateObject<RingBufferQueue<Packet> > ();
+  queue->SetMode (QueueBase::QUEUE_MODE_BYTES);
+  queue->SetMaxBytes (100);
+  std::vector<Ptr<Packet> > items;
+  for (uint32_t i = 0; i < 110; i++)
+    {
+      items.push_back (Create<Packet> (1));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->EnqueueBulk (items), 100, "100 packets should fit in 100 bytes");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 100, "The ring should hold 100 items");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 10, "10 packets should have been dropped");
+
+  std::vector<Ptr<Packet> > out;
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBulk (out, 60), 60, "60 packets should have been dequeued");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBulk (out, 60), 40, "40 packets should have been dequeued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "The queue should be empty");
+  bool inOrder = true;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      inOrder = inOrder && (out[i] == items[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (inOrder, true, "The packets should have been dequeued in order");
+
+  //
+  // The ring never grows beyond its capacity; the items which do not fit
+  // are dropped.
+  //
+  queue = CreateObject<RingBufferQueue<Packet> > ();
+  queue->SetAttribute ("Capacity", UintegerValue (50));
+  queue->SetMode (QueueBase::QUEUE_MODE_BYTES);
+  queue->SetMaxBytes (100);
+  NS_TEST_EXPECT_MSG_EQ (queue->EnqueueBulk (items), 50, "50 packets should fit in the ring");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 50, "The ring should hold 50 items");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 60, "60 packets should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 50, "The queue should hold 50 bytes");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that a RingBufferQueue behaves exactly as a DropTailQueue
+ */
+class RingBufferQueueEquivalenceTestCase : public TestCase
+{
+public:
+  RingBufferQueueEquivalenceTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+RingBufferQueueEquivalenceTestCase::RingBufferQueueEquivalenceTestCase ()
+  : TestCase ("Check that a ring buffer queue behaves as a drop tail queue")
+{
+}
+
+void
+RingBufferQueueEquivalenceTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  Ptr<Queue<Packet> > queues[2];
+  queues[0] = CreateObject<DropTailQueue<Packet> > ();
+  queues[1] = CreateObject<RingBufferQueue<Packet> > ();
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      queues[i]->SetMode (QueueBase::QUEUE_MODE_BYTES);
+      queues[i]->SetMaxBytes (5000);
+    }
+
+  bool same = true;
+  for (uint32_t step = 0; step < 2000 && same; step++)
+    {
+      uint32_t action = rng->GetInteger (0, 3);
+      if (action <= 1)
+        {
+          Ptr<Packet> p = Create<Packet> (rng->GetInteger (1, 1500));
+          same = queues[0]->Enqueue (p) == queues[1]->Enqueue (p);
+        }
+      else if (action == 2)
+        {
+          Ptr<Packet> p0 = queues[0]->Dequeue ();
+          Ptr<Packet> p1 = queues[1]->Dequeue ();
+          same = p0 == p1;
+        }
+      else
+        {
+          uint32_t n = rng->GetInteger (0, 5);
+          std::vector<Ptr<Packet> > v0, v1;
+          same = queues[0]->DequeueBulk (v0, n) == queues[1]->DequeueBulk (v1, n) && v0 == v1;
+        }
+      same = same && queues[0]->GetNBytes () == queues[1]->GetNBytes ()
+        && queues[0]->GetNPackets () == queues[1]->GetNPackets ()
+        && queues[0]->GetTotalDroppedBytes () == queues[1]->GetTotalDroppedBytes ()
+        && queues[0]->GetTotalReceivedPackets () == queues[1]->GetTotalReceivedPackets ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (same, true, "The queues diverged");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Ring Buffer Queue TestSuite
+ */
+class RingBufferQueueTestSuite : public TestSuite
+{
+public:
+  RingBufferQueueTestSuite ()
+    : TestSuite ("ring-buffer-queue", UNIT)
+  {
+    AddTestCase (new RingBufferQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferQueueEquivalenceTestCase (), TestCase::QUICK);
+  }
+};
+
+static RingBufferQueueTestSuite g_ringBufferQueueTestSuite; //!< Static variable for test initialization
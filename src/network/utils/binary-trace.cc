@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "binary-trace.h"
+#include "buffered-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTrace");
+
+//
+// File layout, in host byte order.  Every record starts and ends on a
+// 32-bit boundary, which Packet::Serialize requires.
+//
+//   file header:    magic (4), version (2), time resolution (1), pad (1)
+//   context record: CONTEXT_RECORD (1), pad (3), id (4), length (4),
+//                   string (length, padded)
+//   event record:   EVENT_RECORD (1), event (1), pad (2), context id (4),
+//                   time step (8), packet uid (8), size (4), interface (4),
+//                   serialized packet (size, padded)
+//
+const uint32_t BINARY_TRACE_MAGIC = 0x6e734254;   /**< Identifies a binary trace */
+const uint16_t BINARY_TRACE_VERSION = 2;          /**< Version of the file layout */
+const uint8_t CONTEXT_RECORD = 1;                 /**< Record defining a context string */
+const uint8_t EVENT_RECORD = 2;                   /**< Record of a trace event */
+const uint32_t FILE_HEADER_SIZE = 8;              /**< Size of the file header */
+const uint32_t CONTEXT_HEADER_SIZE = 12;          /**< Size of a context record, without the string */
+const uint32_t EVENT_HEADER_SIZE = 32;            /**< Size of an event record, without the packet */
+const uint32_t NO_CONTEXT = 0xffffffff;           /**< Context id of events without context */
+
+/**
+ * \brief Round a length up to a 32-bit boundary.
+ * \param len the length
+ * \returns the padded length
+ */
+static uint32_t
+PadLength (uint32_t len)
+{
+  return (len + 3) & ~3U;
+}
+
+const uint32_t BinaryTraceWriter::NO_INTERFACE;
+
+BinaryTraceWriter::BinaryTraceWriter (std::ostream *os, uint32_t bufferSize, bool async)
+  : m_writer (new BufferedFileWriter (os, bufferSize, async))
+{
+  NS_LOG_FUNCTION (this << os << bufferSize << async);
+  uint8_t *buf = m_writer->Reserve (FILE_HEADER_SIZE);
+  uint8_t resolution = Time::GetResolution ();
+  std::memcpy (buf, &BINARY_TRACE_MAGIC, 4);
+  std::memcpy (buf + 4, &BINARY_TRACE_VERSION, 2);
+  buf[6] = resolution;
+  buf[7] = 0;
+}
+
+BinaryTraceWriter::~BinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  delete m_writer;
+  m_writer = 0;
+}
+
+void
+BinaryTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_writer->Flush ();
+}
+
+uint32_t
+BinaryTraceWriter::Intern (std::string const &context)
+{
+  std::map<std::string, uint32_t>::const_iterator it = m_contexts.find (context);
+  if (it != m_contexts.end ())
+    {
+      return it->second;
+    }
+
+  uint32_t id = m_contexts.size ();
+  m_contexts.insert (std::make_pair (context, id));
+
+  uint32_t length = context.size ();
+  uint8_t *buf = m_writer->Reserve (CONTEXT_HEADER_SIZE + PadLength (length));
+  std::memset (buf, 0, CONTEXT_HEADER_SIZE + PadLength (length));
+  buf[0] = CONTEXT_RECORD;
+  std::memcpy (buf + 4, &id, 4);
+  std::memcpy (buf + 8, &length, 4);
+  std::memcpy (buf + CONTEXT_HEADER_SIZE, context.data (), length);
+  return id;
+}
+
+void
+BinaryTraceWriter::Write (char event, Ptr<const Packet> p, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << event << p << interface);
+  DoWrite (event, NO_CONTEXT, p, interface);
+}
+
+void
+BinaryTraceWriter::Write (char event, std::string const &context, Ptr<const Packet> p,
+                          uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << event << context << p << interface);
+  DoWrite (event, Intern (context), p, interface);
+}
+
+void
+BinaryTraceWriter::DoWrite (char event, uint32_t contextId, Ptr<const Packet> p, uint32_t interface)
+{
+  int64_t time = Simulator::Now ().GetTimeStep ();
+  uint64_t uid = p->GetUid ();
+  uint32_t size = p->GetSerializedSize ();
+
+  //
+  // Serialize the packet directly into the write buffer.
+  //
+  uint8_t *buf = m_writer->Reserve (EVENT_HEADER_SIZE + PadLength (size));
+  buf[0] = EVENT_RECORD;
+  buf[1] = event;
+  buf[2] = 0;
+  buf[3] = 0;
+  std::memcpy (buf + 4, &contextId, 4);
+  std::memcpy (buf + 8, &time, 8);
+  std::memcpy (buf + 16, &uid, 8);
+  std::memcpy (buf + 24, &size, 4);
+  std::memcpy (buf + 28, &interface, 4);
+  uint32_t ok = p->Serialize (buf + EVENT_HEADER_SIZE, size);
+  NS_ASSERT_MSG (ok, "BinaryTraceWriter::Write(): unable to serialize packet " << uid);
+  std::memset (buf + EVENT_HEADER_SIZE + size, 0, PadLength (size) - size);
+}
+
+BinaryTraceReader::BinaryTraceReader (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  NS_ABORT_MSG_IF (m_file.fail (), "BinaryTraceReader: unable to open " << filename);
+
+  uint8_t header[FILE_HEADER_SIZE];
+  m_file.read (reinterpret_cast<char *> (header), FILE_HEADER_SIZE);
+  uint32_t magic;
+  uint16_t version;
+  std::memcpy (&magic, header, 4);
+  std::memcpy (&version, header + 4, 2);
+  NS_ABORT_MSG_IF (m_file.fail () || magic != BINARY_TRACE_MAGIC,
+                   "BinaryTraceReader: " << filename << " is not a binary trace");
+  NS_ABORT_MSG_IF (version != BINARY_TRACE_VERSION,
+                   "BinaryTraceReader: unsupported version " << version << " in " << filename);
+  m_resolution = static_cast<Time::Unit> (header[6]);
+}
+
+Time::Unit
+BinaryTraceReader::GetResolution (void) const
+{
+  return m_resolution;
+}
+
+bool
+BinaryTraceReader::Read (Record &record)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (Time::GetResolution () != m_resolution,
+                   "BinaryTraceReader: the trace was written with another time resolution");
+
+  while (true)
+    {
+      uint8_t header[EVENT_HEADER_SIZE];
+      m_file.read (reinterpret_cast<char *> (header), 4);
+      if (m_file.eof ())
+        {
+          return false;
+        }
+      if (header[0] == CONTEXT_RECORD)
+        {
+          m_file.read (reinterpret_cast<char *> (header + 4), CONTEXT_HEADER_SIZE - 4);
+          uint32_t id, length;
+          std::memcpy (&id, header + 4, 4);
+          std::memcpy (&length, header + 8, 4);
+          NS_ABORT_MSG_IF (m_file.fail () || id != m_contexts.size (), "BinaryTraceReader: corrupted context record");
+          std::string context (PadLength (length), '\0');
+          m_file.read (&context[0], context.size ());
+          context.resize (length);
+          m_contexts.push_back (context);
+          continue;
+        }
+
+      NS_ABORT_MSG_IF (header[0] != EVENT_RECORD, "BinaryTraceReader: corrupted record");
+      m_file.read (reinterpret_cast<char *> (header + 4), EVENT_HEADER_SIZE - 4);
+      uint32_t contextId, size;
+      int64_t time;
+      std::memcpy (&contextId, header + 4, 4);
+      std::memcpy (&time, header + 8, 8);
+      std::memcpy (&record.uid, header + 16, 8);
+      std::memcpy (&size, header + 24, 4);
+      std::memcpy (&record.interface, header + 28, 4);
+
+      m_buffer.resize (PadLength (size) + 4);
+      m_file.read (reinterpret_cast<char *> (&m_buffer[0]), PadLength (size));
+      NS_ABORT_MSG_IF (m_file.fail (), "BinaryTraceReader: truncated event record");
+
+      record.event = header[1];
+      record.time = TimeStep (time);
+      record.hasContext = contextId != NO_CONTEXT;
+      if (record.hasContext)
+        {
+          NS_ABORT_MSG_IF (contextId >= m_contexts.size (), "BinaryTraceReader: unknown context " << contextId);
+          record.context = m_contexts[contextId];
+        }
+      else
+        {
+          record.context.clear ();
+        }
+      record.packet = Create<Packet> (&m_buffer[0], size, true);
+      return true;
+    }
+}
+
+void
+BinaryTraceReader::Print (std::ostream &os, Record const &record)
+{
+  //
+  // This must match the ascii trace sinks, see for example
+  // AsciiTraceHelper::DefaultEnqueueSinkWithContext.
+  //
+  os << record.event << " " << record.time.GetSeconds () << " ";
+  if (record.hasContext)
+    {
+      os << record.context;
+      if (record.interface != BinaryTraceWriter::NO_INTERFACE)
+        {
+          // See INTERFACE_CONTEXT in internet-stack-helper.cc
+          os << "(" << record.interface << ")";
+        }
+      os << " ";
+    }
+  os << *record.packet << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <string>
+#include <map>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Packet;
+class BufferedFileWriter;
+
+/**
+ * \brief Write packet trace events in a compact binary format.
+ *
+ * Ascii traces format the time, the trace context and the full
+ * Packet::Print output of every event, which costs far more than
+ * simulating the event itself.  A BinaryTraceWriter records the same
+ * information without formatting anything: each event stores its kind
+ * (the '+', '-', 'd', 'r'... character of the ascii trace), the raw
+ * simulation time, an identifier of its context string, the packet uid and
+ * the serialized packet (Packet::Serialize, which includes the metadata
+ * used by Packet::Print).  Trace sinks of the IP layers also record the
+ * index of the interface of the event.  Each context string is written
+ * only once, the first time it is seen.  Records are accumulated in a BufferedFileWriter.
+ *
+ * The ascii text can be regenerated offline with BinaryTraceReader, or with
+ * the print-binary-trace program which wraps it, and is identical to what
+ * the ascii trace sinks would have written.
+ *
+ * Binary traces are usually obtained with
+ * AsciiTraceHelper::CreateBinaryFileStream () and the EnableAscii methods
+ * of the device helpers, whose default sinks write to the binary trace
+ * attached to their stream.
+ *
+ * The file is written in host byte order; it is meant to be read back on
+ * the machine (or at least the architecture) which wrote it.
+ */
+class BinaryTraceWriter : public SimpleRefCount<BinaryTraceWriter>
+{
+public:
+  /// Interface index of the events which are not related to an interface
+  static const uint32_t NO_INTERFACE = 0xffffffff;
+
+  /**
+   * \brief Start a binary trace on an open stream.
+   *
+   * \param os The stream, opened in binary mode.  It must outlive the writer.
+   * \param bufferSize The size of the in-memory write buffer.
+   * \param async If true, the buffer is written by a background thread.
+   */
+  BinaryTraceWriter (std::ostream *os, uint32_t bufferSize = 1 << 20, bool async = false);
+  ~BinaryTraceWriter ();
+
+  /**
+   * \brief Record an event without context.
+   *
+   * \param event The kind of event, as the character used in ascii traces.
+   * \param p The traced packet.
+   * \param interface The index of the interface of the event, if any.
+   */
+  void Write (char event, Ptr<const Packet> p, uint32_t interface = NO_INTERFACE);
+
+  /**
+   * \brief Record an event with a context string.
+   *
+   * \param event The kind of event, as the character used in ascii traces.
+   * \param context The trace context.
+   * \param p The traced packet.
+   * \param interface The index of the interface of the event, if any.
+   */
+  void Write (char event, std::string const &context, Ptr<const Packet> p,
+              uint32_t interface = NO_INTERFACE);
+
+  /**
+   * \brief Write all buffered records to the stream.
+   */
+  void Flush (void);
+
+private:
+  /**
+   * \brief Record an event.
+   *
+   * \param event The kind of event.
+   * \param contextId The identifier of the context, or NO_CONTEXT.
+   * \param p The traced packet.
+   * \param interface The index of the interface of the event, or NO_INTERFACE.
+   */
+  void DoWrite (char event, uint32_t contextId, Ptr<const Packet> p, uint32_t interface);
+
+  /**
+   * \param context A context string.
+   * \returns the identifier of the string, writing its definition first if
+   * it has not been seen before.
+   */
+  uint32_t Intern (std::string const &context);
+
+  BufferedFileWriter *m_writer;                   //!< buffered output
+  std::map<std::string, uint32_t> m_contexts;     //!< identifiers of the context strings
+};
+
+/**
+ * \brief Read back a binary trace written by BinaryTraceWriter.
+ *
+ * The packets of the trace are rebuilt with their metadata, so that a
+ * program linked with the modules which defined the traced headers can
+ * print them exactly as the ascii trace sinks do.
+ */
+class BinaryTraceReader
+{
+public:
+  /// One event of a binary trace
+  struct Record
+  {
+    char event;               //!< kind of event
+    Time time;                //!< simulation time of the event
+    bool hasContext;          //!< true if the event has a context
+    std::string context;      //!< trace context, if any
+    uint32_t interface;       //!< interface index, or BinaryTraceWriter::NO_INTERFACE
+    uint64_t uid;             //!< packet uid
+    Ptr<Packet> packet;       //!< rebuilt packet
+  };
+
+  /**
+   * \brief Open a binary trace.
+   *
+   * The program aborts if the file cannot be opened or is not a binary
+   * trace.  The time resolution of the trace must be the current one.
+   *
+   * \param filename The name of the binary trace file.
+   */
+  BinaryTraceReader (std::string const &filename);
+
+  /**
+   * \brief Read the next event.
+   *
+   * \param record [out] The event.
+   * \returns false at the end of the trace.
+   */
+  bool Read (Record &record);
+
+  /**
+   * \returns the time resolution used by the trace.
+   */
+  Time::Unit GetResolution (void) const;
+
+  /**
+   * \brief Print an event as the ascii trace sinks do.
+   *
+   * As the ascii sinks of InternetStackHelper, the interface index, if
+   * any, is printed after the context, and not without context.
+   *
+   * \param os The output stream.
+   * \param record The event.
+   */
+  static void Print (std::ostream &os, Record const &record);
+
+private:
+  std::ifstream m_file;                   //!< binary trace file
+  Time::Unit m_resolution;                //!< time resolution of the trace
+  std::vector<std::string> m_contexts;    //!< context strings, by identifier
+  std::vector<uint8_t> m_buffer;          //!< serialized packet being read
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_H */
@@ -0,0 +1,249 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/core-config.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "buffered-file-writer.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif /* HAVE_PTHREAD_H */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BufferedFileWriter");
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * Upper bound on the time spent blocked in a condition wait before the
+ * shared state is checked again, in ns.  SystemCondition does not let us
+ * test the shared state and wait atomically, so this bounds the cost of a
+ * wakeup that slips between the test and the wait.
+ */
+static const uint64_t WAIT_TIMEOUT = 1000000;
+#endif /* HAVE_PTHREAD_H */
+
+BufferedFileWriter::BufferedFileWriter (std::ostream *os, uint32_t bufferSize, bool async)
+  : m_os (os),
+    m_active (0),
+    m_used (0),
+    m_async (false),
+    m_thread (0),
+    m_mutex (0),
+    m_work (0),
+    m_idle (0),
+    m_pending (0),
+    m_pendingSize (0),
+    m_stop (false)
+{
+  NS_LOG_FUNCTION (this << os << bufferSize << async);
+  NS_ASSERT (os != 0);
+  NS_ASSERT (bufferSize > 0);
+  m_buffers[0].resize (bufferSize);
+
+#ifdef HAVE_PTHREAD_H
+  if (async)
+    {
+      m_buffers[1].resize (bufferSize);
+      m_mutex = new SystemMutex ();
+      m_work = new SystemCondition ();
+      m_idle = new SystemCondition ();
+      m_async = true;
+      m_thread = Create<SystemThread> (MakeCallback (&BufferedFileWriter::DoWrite, this));
+      m_thread->Start ();
+    }
+#else
+  NS_LOG_WARN ("Threads are not available; writing synchronously");
+#endif /* HAVE_PTHREAD_H */
+}
+
+BufferedFileWriter::~BufferedFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+#ifdef HAVE_PTHREAD_H
+  if (m_async)
+    {
+      m_mutex->Lock ();
+      m_stop = true;
+      m_mutex->Unlock ();
+      m_work->SetCondition (true);
+      m_work->Signal ();
+      m_thread->Join ();
+      m_thread = 0;
+      delete m_idle;
+      delete m_work;
+      delete m_mutex;
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+uint32_t
+BufferedFileWriter::GetBufferSize (void) const
+{
+  return m_buffers[m_active].size ();
+}
+
+bool
+BufferedFileWriter::IsAsync (void) const
+{
+  return m_async;
+}
+
+uint8_t *
+BufferedFileWriter::Reserve (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  std::vector<uint8_t> &buffer = m_buffers[m_active];
+  if (m_used + size > buffer.size ())
+    {
+      HandOff ();
+      if (size > m_buffers[m_active].size ())
+        {
+          //
+          // Both buffers must be able to hold the record, and the other
+          // buffer may still be in the hands of the background thread.
+          //
+          WaitIdle ();
+          NS_LOG_LOGIC ("Growing buffers to " << size << " bytes");
+          m_buffers[0].resize (size);
+          if (m_async)
+            {
+              m_buffers[1].resize (size);
+            }
+        }
+    }
+  uint8_t *start = &m_buffers[m_active][0] + m_used;
+  m_used += size;
+  return start;
+}
+
+void
+BufferedFileWriter::Write (uint8_t const *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &data << size);
+  if (size == 0)
+    {
+      return;
+    }
+  std::memcpy (Reserve (size), data, size);
+}
+
+void
+BufferedFileWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  HandOff ();
+  WaitIdle ();
+  m_os->flush ();
+}
+
+void
+BufferedFileWriter::HandOff (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_used == 0)
+    {
+      return;
+    }
+  if (!m_async)
+    {
+      m_os->write ((const char *)&m_buffers[m_active][0], m_used);
+      m_used = 0;
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  //
+  // Only one buffer may be in flight, so wait for the previous one before
+  // handing over the active buffer and switching to the other one.
+  //
+  WaitIdle ();
+  m_mutex->Lock ();
+  m_pending = m_active;
+  m_pendingSize = m_used;
+  m_mutex->Unlock ();
+  m_work->SetCondition (true);
+  m_work->Signal ();
+  m_active = 1 - m_active;
+  m_used = 0;
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+BufferedFileWriter::WaitIdle (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (!m_async)
+    {
+      return;
+    }
+  for (;;)
+    {
+      m_idle->SetCondition (false);
+      m_mutex->Lock ();
+      bool idle = m_pendingSize == 0;
+      m_mutex->Unlock ();
+      if (idle)
+        {
+          return;
+        }
+      m_idle->TimedWait (WAIT_TIMEOUT);
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+BufferedFileWriter::DoWrite (void)
+{
+  //
+  // This runs in the background thread; ns-3 logging is not thread-safe,
+  // so nothing is logged here.
+  //
+#ifdef HAVE_PTHREAD_H
+  for (;;)
+    {
+      m_work->SetCondition (false);
+      m_mutex->Lock ();
+      uint32_t index = m_pending;
+      uint32_t size = m_pendingSize;
+      bool stop = m_stop;
+      m_mutex->Unlock ();
+
+      if (size > 0)
+        {
+          m_os->write ((const char *)&m_buffers[index][0], size);
+          m_mutex->Lock ();
+          m_pendingSize = 0;
+          m_mutex->Unlock ();
+          m_idle->SetCondition (true);
+          m_idle->Signal ();
+          continue;
+        }
+      if (stop)
+        {
+          return;
+        }
+      m_work->TimedWait (WAIT_TIMEOUT);
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+} // namespace ns3
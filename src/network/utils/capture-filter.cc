@@ -0,0 +1,843 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ipv6-address.h"
+#include "capture-filter.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CaptureFilter");
+
+/// Ethertype of IPv4
+static const uint16_t ETH_IPV4 = 0x0800;
+/// Ethertype of IPv6
+static const uint16_t ETH_IPV6 = 0x86dd;
+/// Ethertype of ARP
+static const uint16_t ETH_ARP = 0x0806;
+
+/// Pcap data link types understood by the filter
+enum
+{
+  DLT_NULL = 0,
+  DLT_EN10MB = 1,
+  DLT_PPP = 9,
+  DLT_RAW = 101,
+  DLT_IEEE802_11 = 105,
+  DLT_LINUX_SLL = 113,
+  DLT_IEEE802_11_RADIO = 127
+};
+
+/**
+ * Number of bytes following the start of the network header which are
+ * needed to extract every field: a maximum size IPv4 header and the
+ * transport ports.
+ */
+static const uint32_t NETWORK_BYTES = 64;
+/**
+ * Number of bytes copied from the start of a packet when the data link
+ * type is known: enough for every supported link header (including a
+ * radiotap header) and NETWORK_BYTES.
+ */
+static const uint32_t LINK_PREFIX_BYTES = 128 + NETWORK_BYTES;
+
+/**
+ * \brief Read a big endian 16-bit value.
+ * \param buf the value location
+ * \returns the value
+ */
+static uint16_t
+ReadNtoh16 (uint8_t const *buf)
+{
+  return (buf[0] << 8) | buf[1];
+}
+
+class CaptureFilter::Parser
+{
+public:
+  /**
+   * Constructor
+   * \param expression the expression to compile
+   * \param program [out] the compiled program
+   */
+  Parser (std::string const &expression, std::vector<Instruction> &program);
+
+  /**
+   * \brief Compile the whole expression.
+   */
+  void Compile (void);
+
+private:
+  /// Compile an "or" expression
+  void ParseOr (void);
+  /// Compile an "and" expression
+  void ParseAnd (void);
+  /// Compile a "not" expression
+  void ParseNot (void);
+  /// Compile a parenthesized expression or a primitive
+  void ParsePrimary (void);
+  /**
+   * \brief Compile the rest of a port primitive.
+   * \param dir direction qualifier
+   * \param proto protocol qualifier
+   */
+  void ParsePort (Direction dir, uint8_t proto);
+  /**
+   * \brief Compile the rest of a host, net or port primitive.
+   * \param dir direction qualifier
+   */
+  void ParseAddress (Direction dir);
+  /**
+   * \returns the next token, without consuming it; empty at the end
+   */
+  std::string const & Peek (void) const;
+  /**
+   * \returns the next token, consuming it; aborts at the end
+   */
+  std::string Next (void);
+  /**
+   * \param token a token
+   * \returns the value of a numeric token; aborts if not numeric
+   */
+  uint32_t Number (std::string const &token) const;
+  /**
+   * \brief Parse an IPv4 or IPv6 address into an instruction.
+   * \param token the address
+   * \param insn [out] the instruction
+   */
+  void Address (std::string const &token, Instruction &insn) const;
+  /**
+   * \brief Append an instruction to the program.
+   * \param insn the instruction
+   */
+  void Emit (Instruction const &insn);
+  /**
+   * \brief Append an operator to the program.
+   * \param op the operator
+   */
+  void Emit (Opcode op);
+
+  std::string m_expression;               //!< expression being compiled
+  std::vector<std::string> m_tokens;      //!< tokens of the expression
+  uint32_t m_next;                        //!< index of the next token
+  std::vector<Instruction> &m_program;    //!< compiled program
+};
+
+CaptureFilter::Parser::Parser (std::string const &expression, std::vector<Instruction> &program)
+  : m_expression (expression),
+    m_next (0),
+    m_program (program)
+{
+  std::string::size_type i = 0;
+  while (i < expression.size ())
+    {
+      char c = expression[i];
+      if (c == ' ' || c == '\t' || c == '\n')
+        {
+          ++i;
+        }
+      else if (c == '(' || c == ')' || c == '!')
+        {
+          m_tokens.push_back (std::string (1, c));
+          ++i;
+        }
+      else if ((c == '&' || c == '|') && i + 1 < expression.size () && expression[i + 1] == c)
+        {
+          m_tokens.push_back (std::string (2, c));
+          i += 2;
+        }
+      else
+        {
+          std::string::size_type start = i;
+          while (i < expression.size () && std::strchr (" \t\n()!&|", expression[i]) == 0)
+            {
+              ++i;
+            }
+          NS_ABORT_MSG_IF (i == start, "CaptureFilter: unexpected character '" << c
+                           << "' in \"" << expression << "\"");
+          m_tokens.push_back (expression.substr (start, i - start));
+        }
+    }
+}
+
+void
+CaptureFilter::Parser::Compile (void)
+{
+  if (m_tokens.empty ())
+    {
+      return;
+    }
+  ParseOr ();
+  NS_ABORT_MSG_IF (m_next != m_tokens.size (), "CaptureFilter: unexpected \"" << Peek ()
+                   << "\" in \"" << m_expression << "\"");
+}
+
+std::string const &
+CaptureFilter::Parser::Peek (void) const
+{
+  static const std::string end;
+  return m_next < m_tokens.size () ? m_tokens[m_next] : end;
+}
+
+std::string
+CaptureFilter::Parser::Next (void)
+{
+  NS_ABORT_MSG_IF (m_next >= m_tokens.size (), "CaptureFilter: unexpected end of \"" << m_expression << "\"");
+  return m_tokens[m_next++];
+}
+
+uint32_t
+CaptureFilter::Parser::Number (std::string const &token) const
+{
+  char *end;
+  unsigned long value = std::strtoul (token.c_str (), &end, 0);
+  NS_ABORT_MSG_IF (token.empty () || *end != 0 || value > 0xffffffffUL,
+                   "CaptureFilter: \"" << token << "\" is not a number in \"" << m_expression << "\"");
+  return value;
+}
+
+void
+CaptureFilter::Parser::Address (std::string const &token, Instruction &insn) const
+{
+  if (token.find (':') != std::string::npos)
+    {
+      Ipv6Address (token.c_str ()).Serialize (insn.addr);
+      insn.addrLen = 16;
+      return;
+    }
+  std::string::size_type start = 0;
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      std::string::size_type end = token.find ('.', start);
+      NS_ABORT_MSG_IF ((end == std::string::npos) != (i == 3), "CaptureFilter: \"" << token
+                       << "\" is not an address in \"" << m_expression << "\"");
+      uint32_t byte = Number (token.substr (start, end == std::string::npos ? end : end - start));
+      NS_ABORT_MSG_IF (byte > 255, "CaptureFilter: \"" << token << "\" is not an address in \""
+                       << m_expression << "\"");
+      insn.addr[i] = byte;
+      start = end + 1;
+    }
+  insn.addrLen = 4;
+}
+
+void
+CaptureFilter::Parser::Emit (Instruction const &insn)
+{
+  m_program.push_back (insn);
+}
+
+void
+CaptureFilter::Parser::Emit (Opcode op)
+{
+  Instruction insn;
+  std::memset (&insn, 0, sizeof (insn));
+  insn.op = op;
+  m_program.push_back (insn);
+}
+
+void
+CaptureFilter::Parser::ParseOr (void)
+{
+  ParseAnd ();
+  while (Peek () == "or" || Peek () == "||")
+    {
+      Next ();
+      ParseAnd ();
+      Emit (OP_OR);
+    }
+}
+
+void
+CaptureFilter::Parser::ParseAnd (void)
+{
+  ParseNot ();
+  while (Peek () == "and" || Peek () == "&&")
+    {
+      Next ();
+      ParseNot ();
+      Emit (OP_AND);
+    }
+}
+
+void
+CaptureFilter::Parser::ParseNot (void)
+{
+  if (Peek () == "not" || Peek () == "!")
+    {
+      Next ();
+      ParseNot ();
+      Emit (OP_NOT);
+      return;
+    }
+  ParsePrimary ();
+}
+
+void
+CaptureFilter::Parser::ParsePrimary (void)
+{
+  std::string token = Next ();
+  if (token == "(")
+    {
+      ParseOr ();
+      NS_ABORT_MSG_IF (Next () != ")", "CaptureFilter: missing ')' in \"" << m_expression << "\"");
+      return;
+    }
+
+  Instruction insn;
+  std::memset (&insn, 0, sizeof (insn));
+  insn.dir = SRC_OR_DST;
+  if (token == "ip" || token == "ip6" || token == "arp")
+    {
+      insn.op = OP_L3;
+      insn.value = token == "ip" ? ETH_IPV4 : token == "ip6" ? ETH_IPV6 : ETH_ARP;
+      Emit (insn);
+    }
+  else if (token == "tcp" || token == "udp")
+    {
+      uint8_t proto = token == "tcp" ? 6 : 17;
+      if (Peek () == "port" || Peek () == "src" || Peek () == "dst")
+        {
+          Direction dir = SRC_OR_DST;
+          if (Peek () != "port")
+            {
+              dir = Next () == "src" ? SRC : DST;
+            }
+          NS_ABORT_MSG_IF (Next () != "port", "CaptureFilter: expected \"port\" after \"" << token
+                           << "\" in \"" << m_expression << "\"");
+          ParsePort (dir, proto);
+        }
+      else
+        {
+          insn.op = OP_PROTO;
+          insn.value = proto;
+          Emit (insn);
+        }
+    }
+  else if (token == "icmp" || token == "icmp6")
+    {
+      insn.op = OP_PROTO;
+      insn.value = token == "icmp" ? 1 : 58;
+      Emit (insn);
+    }
+  else if (token == "proto")
+    {
+      insn.op = OP_PROTO;
+      insn.value = Number (Next ());
+      Emit (insn);
+    }
+  else if (token == "less" || token == "greater")
+    {
+      insn.op = token == "less" ? OP_LESS : OP_GREATER;
+      insn.value = Number (Next ());
+      Emit (insn);
+    }
+  else if (token == "src" || token == "dst")
+    {
+      ParseAddress (token == "src" ? SRC : DST);
+    }
+  else if (token == "host" || token == "net" || token == "port")
+    {
+      --m_next;
+      ParseAddress (SRC_OR_DST);
+    }
+  else
+    {
+      NS_ABORT_MSG ("CaptureFilter: unknown primitive \"" << token << "\" in \"" << m_expression << "\"");
+    }
+}
+
+void
+CaptureFilter::Parser::ParseAddress (Direction dir)
+{
+  std::string kind = Next ();
+  if (kind == "port")
+    {
+      ParsePort (dir, 0);
+      return;
+    }
+
+  Instruction insn;
+  std::memset (&insn, 0, sizeof (insn));
+  insn.dir = dir;
+  if (kind == "host")
+    {
+      insn.op = OP_HOST;
+      Address (Next (), insn);
+    }
+  else if (kind == "net")
+    {
+      std::string token = Next ();
+      std::string::size_type slash = token.find ('/');
+      NS_ABORT_MSG_IF (slash == std::string::npos, "CaptureFilter: expected A/L after \"net\" in \""
+                       << m_expression << "\"");
+      insn.op = OP_NET;
+      Address (token.substr (0, slash), insn);
+      insn.value = Number (token.substr (slash + 1));
+      NS_ABORT_MSG_IF (insn.value > insn.addrLen * 8u, "CaptureFilter: bad prefix length in \""
+                       << m_expression << "\"");
+    }
+  else
+    {
+      NS_ABORT_MSG ("CaptureFilter: expected \"host\", \"net\" or \"port\" instead of \"" << kind
+                    << "\" in \"" << m_expression << "\"");
+    }
+  Emit (insn);
+}
+
+void
+CaptureFilter::Parser::ParsePort (Direction dir, uint8_t proto)
+{
+  Instruction insn;
+  std::memset (&insn, 0, sizeof (insn));
+  insn.op = OP_PORT;
+  insn.dir = dir;
+  insn.proto = proto;
+  insn.value = Number (Next ());
+  NS_ABORT_MSG_IF (insn.value > 0xffff, "CaptureFilter: bad port in \"" << m_expression << "\"");
+  Emit (insn);
+}
+
+CaptureFilter::CaptureFilter ()
+  : m_sampling (1),
+    m_sampleCount (0),
+    m_start (Time (0)),
+    m_stop (Time::Max ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CaptureFilter::CaptureFilter (std::string const &expression)
+  : m_sampling (1),
+    m_sampleCount (0),
+    m_start (Time (0)),
+    m_stop (Time::Max ())
+{
+  NS_LOG_FUNCTION (this << expression);
+  SetExpression (expression);
+}
+
+void
+CaptureFilter::SetExpression (std::string const &expression)
+{
+  NS_LOG_FUNCTION (this << expression);
+  std::vector<Instruction> program;
+  Parser parser (expression, program);
+  parser.Compile ();
+  m_expression = expression;
+  m_program.swap (program);
+}
+
+std::string
+CaptureFilter::GetExpression (void) const
+{
+  return m_expression;
+}
+
+void
+CaptureFilter::SetSampling (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_sampling = std::max (n, 1U);
+  m_sampleCount = 0;
+}
+
+void
+CaptureFilter::SetTimeWindow (Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this << start << stop);
+  m_start = start;
+  m_stop = stop;
+}
+
+Ptr<CaptureFilter>
+CaptureFilter::Copy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<CaptureFilter> copy = Create<CaptureFilter> (*this);
+  copy->m_sampleCount = 0;
+  return copy;
+}
+
+void
+CaptureFilter::Extract (Ptr<const Packet> p, uint32_t dataLinkType, const Header *header, Fields &fields)
+{
+  fields.l3 = 0;
+  fields.proto = 0;
+  fields.addrLen = 0;
+  fields.hasPorts = false;
+
+  uint32_t headerSize = header ? header->GetSerializedSize () : 0;
+  fields.length = headerSize + p->GetSize ();
+
+  //
+  // Find out how many bytes we need from the start of the traced data.
+  //
+  uint32_t l3Offset = 0;
+  uint32_t want = LINK_PREFIX_BYTES;
+  if (dataLinkType == DLT_UNKNOWN)
+    {
+      uint32_t offset = headerSize;
+      PacketMetadata::ItemIterator i = p->BeginItem ();
+      while (i.HasNext () && fields.l3 == 0)
+        {
+          PacketMetadata::Item item = i.Next ();
+          if (item.type != PacketMetadata::Item::HEADER || item.isFragment)
+            {
+              break;
+            }
+          std::string name = item.tid.GetName ();
+          if (name == "ns3::Ipv4Header")
+            {
+              fields.l3 = ETH_IPV4;
+            }
+          else if (name == "ns3::Ipv6Header")
+            {
+              fields.l3 = ETH_IPV6;
+            }
+          else if (name == "ns3::ArpHeader")
+            {
+              fields.l3 = ETH_ARP;
+            }
+          else
+            {
+              offset += item.currentSize;
+            }
+        }
+      if (fields.l3 == 0)
+        {
+          return;
+        }
+      l3Offset = offset;
+      want = l3Offset + NETWORK_BYTES;
+    }
+  want = std::min (want, fields.length);
+
+  //
+  // Copy only the bytes we need; the rest of the packet is never touched.
+  //
+  uint8_t prefix[LINK_PREFIX_BYTES];
+  std::vector<uint8_t> large;
+  uint8_t *buf = prefix;
+  if (want > LINK_PREFIX_BYTES)
+    {
+      large.resize (want);
+      buf = &large[0];
+    }
+  uint32_t copied = 0;
+  if (header)
+    {
+      Buffer headerBuffer;
+      headerBuffer.AddAtStart (headerSize);
+      header->Serialize (headerBuffer.Begin ());
+      copied = std::min (headerSize, want);
+      headerBuffer.CopyData (buf, copied);
+    }
+  p->CopyData (buf + copied, want - copied);
+
+  Parse (buf, want, dataLinkType, l3Offset, fields);
+}
+
+void
+CaptureFilter::Parse (uint8_t const *buf, uint32_t want, uint32_t dataLinkType, uint32_t l3Offset, Fields &fields)
+{
+  if (dataLinkType != DLT_UNKNOWN)
+    {
+      uint16_t type = 0;
+      switch (dataLinkType)
+        {
+        case DLT_EN10MB:
+          if (want >= 14)
+            {
+              type = ReadNtoh16 (buf + 12);
+              l3Offset = 14;
+              if (type <= 1500 && want >= 22 && buf[14] == 0xaa && buf[15] == 0xaa && buf[16] == 0x03)
+                {
+                  // LLC/SNAP encapsulation
+                  type = ReadNtoh16 (buf + 20);
+                  l3Offset = 22;
+                }
+            }
+          break;
+        case DLT_PPP:
+          if (want >= 2)
+            {
+              uint16_t protocol = ReadNtoh16 (buf);
+              type = protocol == 0x0021 ? ETH_IPV4 : protocol == 0x0057 ? ETH_IPV6 : 0;
+              l3Offset = 2;
+            }
+          break;
+        case DLT_LINUX_SLL:
+          if (want >= 16)
+            {
+              type = ReadNtoh16 (buf + 14);
+              l3Offset = 16;
+            }
+          break;
+        case DLT_NULL:
+          if (want >= 4)
+            {
+              uint32_t family;
+              std::memcpy (&family, buf, 4);
+              type = family == 2 ? ETH_IPV4 : (family == 24 || family == 28 || family == 30) ? ETH_IPV6 : 0;
+              l3Offset = 4;
+            }
+          break;
+        case DLT_IEEE802_11_RADIO:
+        case DLT_IEEE802_11:
+          {
+            uint32_t offset = 0;
+            if (dataLinkType == DLT_IEEE802_11_RADIO && want >= 4)
+              {
+                // the radiotap header length is little endian
+                offset = buf[2] | (buf[3] << 8);
+              }
+            if (want < offset + 24 || ((buf[offset] >> 2) & 0x03) != 2)
+              {
+                // not a data frame
+                break;
+              }
+            uint32_t macHeader = 24;
+            if ((buf[offset + 1] & 0x03) == 0x03)
+              {
+                // four address frame
+                macHeader += 6;
+              }
+            if (buf[offset] & 0x80)
+              {
+                // QoS data frame
+                macHeader += 2;
+              }
+            offset += macHeader;
+            if (want >= offset + 8 && buf[offset] == 0xaa && buf[offset + 1] == 0xaa && buf[offset + 2] == 0x03)
+              {
+                type = ReadNtoh16 (buf + offset + 6);
+                l3Offset = offset + 8;
+              }
+          }
+          break;
+        case DLT_RAW:
+          if (want >= 1)
+            {
+              type = (buf[0] >> 4) == 4 ? ETH_IPV4 : (buf[0] >> 4) == 6 ? ETH_IPV6 : 0;
+            }
+          break;
+        default:
+          break;
+        }
+      fields.l3 = type;
+    }
+
+  uint8_t const *l3 = buf + l3Offset;
+  uint32_t avail = want > l3Offset ? want - l3Offset : 0;
+  uint32_t l4Offset = 0;
+  if (fields.l3 == ETH_IPV4 && avail >= 20)
+    {
+      fields.proto = l3[9];
+      fields.addrLen = 4;
+      std::memcpy (fields.src, l3 + 12, 4);
+      std::memcpy (fields.dst, l3 + 16, 4);
+      bool firstFragment = ((l3[6] & 0x1f) == 0) && (l3[7] == 0);
+      if (firstFragment)
+        {
+          l4Offset = (l3[0] & 0x0f) * 4;
+        }
+    }
+  else if (fields.l3 == ETH_IPV6 && avail >= 40)
+    {
+      fields.proto = l3[6];
+      fields.addrLen = 16;
+      std::memcpy (fields.src, l3 + 8, 16);
+      std::memcpy (fields.dst, l3 + 24, 16);
+      l4Offset = 40;
+    }
+  else if (fields.l3 == ETH_ARP && avail >= 8)
+    {
+      uint32_t hlen = l3[4];
+      if (l3[5] == 4 && avail >= 8 + 2 * hlen + 8)
+        {
+          fields.addrLen = 4;
+          std::memcpy (fields.src, l3 + 8 + hlen, 4);
+          std::memcpy (fields.dst, l3 + 8 + 2 * hlen + 4, 4);
+        }
+    }
+
+  if (l4Offset != 0 && (fields.proto == 6 || fields.proto == 17) && avail >= l4Offset + 4)
+    {
+      fields.hasPorts = true;
+      fields.srcPort = ReadNtoh16 (l3 + l4Offset);
+      fields.dstPort = ReadNtoh16 (l3 + l4Offset + 2);
+    }
+}
+
+bool
+CaptureFilter::Test (Instruction const &insn, Fields const &fields)
+{
+  switch (insn.op)
+    {
+    case OP_L3:
+      return fields.l3 == insn.value;
+    case OP_PROTO:
+      return (fields.l3 == ETH_IPV4 || fields.l3 == ETH_IPV6) && fields.proto == insn.value;
+    case OP_HOST:
+      if (fields.addrLen != insn.addrLen)
+        {
+          return false;
+        }
+      return (insn.dir != DST && std::memcmp (fields.src, insn.addr, insn.addrLen) == 0)
+             || (insn.dir != SRC && std::memcmp (fields.dst, insn.addr, insn.addrLen) == 0);
+    case OP_NET:
+      {
+        if (fields.addrLen != insn.addrLen)
+          {
+            return false;
+          }
+        bool srcMatch = insn.dir != DST;
+        bool dstMatch = insn.dir != SRC;
+        for (uint32_t bit = 0; bit < insn.value; bit += 8)
+          {
+            uint32_t i = bit / 8;
+            uint8_t mask = insn.value - bit >= 8 ? 0xff : (0xff << (8 - (insn.value - bit))) & 0xff;
+            srcMatch = srcMatch && ((fields.src[i] ^ insn.addr[i]) & mask) == 0;
+            dstMatch = dstMatch && ((fields.dst[i] ^ insn.addr[i]) & mask) == 0;
+          }
+        return srcMatch || dstMatch;
+      }
+    case OP_PORT:
+      if (!fields.hasPorts || (insn.proto != 0 && insn.proto != fields.proto))
+        {
+          return false;
+        }
+      return (insn.dir != DST && fields.srcPort == insn.value)
+             || (insn.dir != SRC && fields.dstPort == insn.value);
+    case OP_LESS:
+      return fields.length <= insn.value;
+    case OP_GREATER:
+      return fields.length >= insn.value;
+    default:
+      NS_ASSERT_MSG (false, "CaptureFilter: not a primitive");
+      return false;
+    }
+}
+
+bool
+CaptureFilter::Accept (Ptr<const Packet> p, uint32_t dataLinkType, const Header *header)
+{
+  NS_LOG_FUNCTION (this << p << dataLinkType << header);
+  if (!InTimeWindow ())
+    {
+      return false;
+    }
+  if (!m_program.empty ())
+    {
+      Fields fields;
+      Extract (p, dataLinkType, header, fields);
+      if (!Evaluate (fields))
+        {
+          return false;
+        }
+    }
+  return Sample ();
+}
+
+bool
+CaptureFilter::Accept (uint8_t const *buffer, uint32_t length, uint32_t dataLinkType)
+{
+  NS_LOG_FUNCTION (this << &buffer << length << dataLinkType);
+  if (!InTimeWindow ())
+    {
+      return false;
+    }
+  if (!m_program.empty ())
+    {
+      Fields fields;
+      fields.l3 = 0;
+      fields.proto = 0;
+      fields.addrLen = 0;
+      fields.hasPorts = false;
+      fields.length = length;
+      Parse (buffer, length, dataLinkType, 0, fields);
+      if (!Evaluate (fields))
+        {
+          return false;
+        }
+    }
+  return Sample ();
+}
+
+bool
+CaptureFilter::InTimeWindow (void) const
+{
+  Time now = Simulator::Now ();
+  return now >= m_start && now < m_stop;
+}
+
+bool
+CaptureFilter::Evaluate (Fields const &fields) const
+{
+  //
+  // The program is in postfix order; run it on a small stack of
+  // booleans.  The expressions are short, so a fixed-size stack is
+  // enough in practice and avoids allocating per packet.
+  //
+  static const uint32_t STACK_SIZE = 64;
+  bool stack[STACK_SIZE];
+  uint32_t top = 0;
+  for (std::vector<Instruction>::const_iterator i = m_program.begin (); i != m_program.end (); ++i)
+    {
+      switch (i->op)
+        {
+        case OP_AND:
+          --top;
+          stack[top - 1] = stack[top - 1] && stack[top];
+          break;
+        case OP_OR:
+          --top;
+          stack[top - 1] = stack[top - 1] || stack[top];
+          break;
+        case OP_NOT:
+          stack[top - 1] = !stack[top - 1];
+          break;
+        default:
+          NS_ABORT_MSG_IF (top == STACK_SIZE, "CaptureFilter: expression is too deeply nested");
+          stack[top++] = Test (*i, fields);
+          break;
+        }
+    }
+  NS_ASSERT (top == 1);
+  return stack[0];
+}
+
+bool
+CaptureFilter::Sample (void)
+{
+  if (m_sampling > 1)
+    {
+      bool keep = m_sampleCount == 0;
+      m_sampleCount = (m_sampleCount + 1) % m_sampling;
+      return keep;
+    }
+  return true;
+}
+
+} // namespace ns3
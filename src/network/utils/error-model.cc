@@ -61,6 +61,7 @@
  */
 
 #include <cmath>
+#include <algorithm>
 
 #include "error-model.h"
 
@@ -142,6 +143,94 @@ ErrorModel::IsEnabled (void) const
   return m_enable;
 }
 
+//
+// SkipAheadSampler
+//
+
+SkipAheadSampler::SkipAheadSampler ()
+  : m_rate (0.0),
+    m_logComplement (0.0),
+    m_valid (false),
+    m_gap (0)
+{
+}
+
+void
+SkipAheadSampler::SetRate (double rate)
+{
+  if (rate != m_rate)
+    {
+      m_rate = rate;
+      m_logComplement = std::log (1.0 - rate);
+      m_valid = false;
+    }
+}
+
+double
+SkipAheadSampler::GetRate (void) const
+{
+  return m_rate;
+}
+
+void
+SkipAheadSampler::Reset (void)
+{
+  m_valid = false;
+}
+
+uint64_t
+SkipAheadSampler::NextError (Ptr<RandomVariableStream> ranvar)
+{
+  // Keep the gaps small enough that adding a packet size cannot overflow
+  static const uint64_t NEVER = static_cast<uint64_t> (1) << 62;
+
+  if (!m_valid)
+    {
+      if (m_rate <= 0.0)
+        {
+          m_gap = NEVER;
+        }
+      else if (m_rate >= 1.0)
+        {
+          m_gap = 0;
+        }
+      else
+        {
+          // P(gap >= k) = P(v <= (1 - rate)^k) = (1 - rate)^k, v in (0,1]
+          double v = 1.0 - ranvar->GetValue ();
+          double gap = std::floor (std::log (v) / m_logComplement);
+          m_gap = (gap < static_cast<double> (NEVER)) ? static_cast<uint64_t> (gap) : NEVER;
+        }
+      m_valid = true;
+    }
+  return m_gap;
+}
+
+void
+SkipAheadSampler::Consume (uint64_t units)
+{
+  NS_ASSERT (m_valid && units <= m_gap);
+  m_gap -= units;
+}
+
+void
+SkipAheadSampler::Hit (void)
+{
+  m_valid = false;
+}
+
+bool
+SkipAheadSampler::Advance (Ptr<RandomVariableStream> ranvar, uint64_t units)
+{
+  if (NextError (ranvar) >= units)
+    {
+      Consume (units);
+      return false;
+    }
+  Hit ();
+  return true;
+}
+
 //
 // RateErrorModel
 //
@@ -168,12 +257,20 @@ TypeId RateErrorModel::GetTypeId (void)
                    StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1.0]"),
                    MakePointerAccessor (&RateErrorModel::m_ranvar),
                    MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("SkipAhead",
+                   "Draw one random variate per error, instead of one per packet. "
+                   "RanVar must then be Uniform(0,1).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RateErrorModel::m_skipAhead),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 
 RateErrorModel::RateErrorModel ()
+  : m_skipAhead (false),
+    m_sampledUnit (ERROR_UNIT_PACKET)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -234,6 +331,10 @@ RateErrorModel::DoCorrupt (Ptr<Packet> p)
     {
       return false;
     }
+  if (m_skipAhead)
+    {
+      return DoCorruptSkipAhead (p);
+    }
   switch (m_unit) 
     {
     case ERROR_UNIT_PACKET:
@@ -274,11 +375,34 @@ RateErrorModel::DoCorruptBit (Ptr<Packet> p)
   return (m_ranvar->GetValue () < per);
 }
 
+bool
+RateErrorModel::DoCorruptSkipAhead (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  if (m_unit != m_sampledUnit)
+    {
+      m_sampler.Reset ();
+      m_sampledUnit = m_unit;
+    }
+  m_sampler.SetRate (m_rate);
+
+  uint64_t units = 1;
+  if (m_unit == ERROR_UNIT_BYTE)
+    {
+      units = p->GetSize ();
+    }
+  else if (m_unit == ERROR_UNIT_BIT)
+    {
+      units = 8 * static_cast<uint64_t> (p->GetSize ());
+    }
+  return m_sampler.Advance (m_ranvar, units);
+}
+
 void 
 RateErrorModel::DoReset (void) 
 { 
   NS_LOG_FUNCTION (this);
-  /* re-initialize any state; no-op for now */ 
+  m_sampler.Reset ();
 }
 
 
@@ -411,6 +535,147 @@ BurstErrorModel::DoReset (void)
 }
 
 
+//
+// GilbertElliottErrorModel
+//
+
+NS_OBJECT_ENSURE_REGISTERED (GilbertElliottErrorModel);
+
+TypeId GilbertElliottErrorModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GilbertElliottErrorModel")
+    .SetParent<ErrorModel> ()
+    .SetGroupName("Network")
+    .AddConstructor<GilbertElliottErrorModel> ()
+    .AddAttribute ("ErrorUnit", "The error unit",
+                   EnumValue (RateErrorModel::ERROR_UNIT_PACKET),
+                   MakeEnumAccessor (&GilbertElliottErrorModel::m_unit),
+                   MakeEnumChecker (RateErrorModel::ERROR_UNIT_BIT, "ERROR_UNIT_BIT",
+                                    RateErrorModel::ERROR_UNIT_BYTE, "ERROR_UNIT_BYTE",
+                                    RateErrorModel::ERROR_UNIT_PACKET, "ERROR_UNIT_PACKET"))
+    .AddAttribute ("GoodToBad", "The probability to move to the Bad state after a unit in the Good state.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_goodToBad),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("BadToGood", "The probability to move to the Good state after a unit in the Bad state.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_badToGood),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("GoodErrorRate", "The unit error rate in the Good state.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_goodErrorRate),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("BadErrorRate", "The unit error rate in the Bad state.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_badErrorRate),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("RanVar", "The Uniform(0,1) variable attached to this error model.",
+                   StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1.0]"),
+                   MakePointerAccessor (&GilbertElliottErrorModel::m_ranvar),
+                   MakePointerChecker<RandomVariableStream> ())
+  ;
+  return tid;
+}
+
+GilbertElliottErrorModel::GilbertElliottErrorModel ()
+  : m_bad (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+GilbertElliottErrorModel::~GilbertElliottErrorModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+GilbertElliottErrorModel::IsBad (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_bad;
+}
+
+void
+GilbertElliottErrorModel::SetRandomVariable (Ptr<RandomVariableStream> ranvar)
+{
+  NS_LOG_FUNCTION (this << ranvar);
+  m_ranvar = ranvar;
+}
+
+int64_t
+GilbertElliottErrorModel::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_ranvar->SetStream (stream);
+  return 1;
+}
+
+bool
+GilbertElliottErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  if (!IsEnabled ())
+    {
+      return false;
+    }
+
+  m_transition[0].SetRate (m_goodToBad);
+  m_transition[1].SetRate (m_badToGood);
+  m_error[0].SetRate (m_goodErrorRate);
+  m_error[1].SetRate (m_badErrorRate);
+
+  uint64_t units = 1;
+  if (m_unit == RateErrorModel::ERROR_UNIT_BYTE)
+    {
+      units = p->GetSize ();
+    }
+  else if (m_unit == RateErrorModel::ERROR_UNIT_BIT)
+    {
+      units = 8 * static_cast<uint64_t> (p->GetSize ());
+    }
+
+  //
+  // Walk the packet one sojourn at a time: a state lasts for the units
+  // before its next transition, plus the unit after which it transitions.
+  //
+  bool corrupt = false;
+  while (units > 0)
+    {
+      uint32_t state = m_bad ? 1 : 0;
+      uint64_t stay = m_transition[state].NextError (m_ranvar);
+      uint64_t span = std::min (units, stay + 1);
+      if (!corrupt)
+        {
+          corrupt = m_error[state].Advance (m_ranvar, span);
+        }
+      if (span == stay + 1)
+        {
+          m_transition[state].Hit ();
+          m_bad = !m_bad;
+          NS_LOG_DEBUG ("moving to the " << (m_bad ? "Bad" : "Good") << " state");
+        }
+      else
+        {
+          m_transition[state].Consume (span);
+        }
+      units -= span;
+    }
+  return corrupt;
+}
+
+void
+GilbertElliottErrorModel::DoReset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_bad = false;
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      m_transition[i].Reset ();
+      m_error[i].Reset ();
+    }
+}
+
+
 //
 // ListErrorModel
 //
@@ -109,8 +109,9 @@ class Packet;
  *   }
  * \endcode
  *
- * Four practical error models, a RateErrorModel, a BurstErrorModel, 
- * a ListErrorModel, and a ReceiveListErrorModel, are currently implemented. 
+ * Five practical error models, a RateErrorModel, a BurstErrorModel, 
+ * a GilbertElliottErrorModel, a ListErrorModel, and a ReceiveListErrorModel,
+ * are currently implemented.
  */
 class ErrorModel : public Object
 {
@@ -164,6 +165,72 @@ private:
   bool m_enable; //!< True if the error model is enabled
 };
 
+/**
+ * \ingroup errormodel
+ * \brief Draw the positions of independent unit errors by skip-ahead.
+ *
+ * When each unit (bit, byte or packet) is errored independently with
+ * probability p, the number of correct units before the next error follows
+ * a geometric distribution.  Instead of testing every unit, this class draws
+ * that number, the "gap", from one uniform variate, and then only counts the
+ * units down.  Only one variate is drawn per error, so that the cost of
+ * low error rates does not depend on the number of units.
+ *
+ * Since the geometric distribution is memoryless, the gap may be discarded
+ * and redrawn at any unit boundary without changing the error process; this
+ * is done when the rate changes and after each error.
+ *
+ * The random variable passed to the methods must be Uniform(0,1).
+ */
+class SkipAheadSampler
+{
+public:
+  SkipAheadSampler ();
+
+  /**
+   * \param rate the probability that a unit is errored
+   */
+  void SetRate (double rate);
+  /**
+   * \returns the probability that a unit is errored
+   */
+  double GetRate (void) const;
+  /**
+   * Discard the current gap.
+   */
+  void Reset (void);
+  /**
+   * \param ranvar a Uniform(0,1) random variable
+   * \returns the number of correct units before the next error, drawing
+   * a new gap if needed
+   */
+  uint64_t NextError (Ptr<RandomVariableStream> ranvar);
+  /**
+   * Count down correct units.
+   * \param units the number of units, at most the value returned by NextError
+   */
+  void Consume (uint64_t units);
+  /**
+   * Account for the error returned by NextError.  The next gap starts
+   * after the errored unit.
+   */
+  void Hit (void);
+  /**
+   * \param ranvar a Uniform(0,1) random variable
+   * \param units a number of consecutive units
+   * \returns true if at least one of the units is errored
+   *
+   * The remaining units of a span which contains an error are not sampled.
+   */
+  bool Advance (Ptr<RandomVariableStream> ranvar, uint64_t units);
+
+private:
+  double m_rate;           //!< probability that a unit is errored
+  double m_logComplement;  //!< log (1 - m_rate)
+  bool m_valid;            //!< true if m_gap has been drawn
+  uint64_t m_gap;          //!< correct units before the next error
+};
+
 /**
  * \brief Determine which packets are errored corresponding to an underlying
  * distribution, rate, and unit.
@@ -174,8 +241,17 @@ private:
  * unit (which may be per-bit, per-byte, and per-packet).
  * Users can optionally provide a RandomVariableStream object; the default
  * is to use a Uniform(0,1) distribution.
-
- * Reset() on this model will do nothing
+ *
+ * By default, one random variate is drawn per packet, and compared with
+ * the probability that at least one of its units is errored.  If the
+ * SkipAhead attribute is set, the errors are instead drawn with a
+ * SkipAheadSampler, which only draws one variate per error: packets on a
+ * link with a low bit error rate then cost no random variate at all.  Both
+ * methods yield the same error process, but not the same realizations.
+ * SkipAhead requires the RanVar attribute to be Uniform(0,1).
+ *
+ * Reset() on this model will do nothing, unless SkipAhead is set, in
+ * which case it discards the current gap to the next error.
  *
  * IsCorrupt() will not modify the packet data buffer
  */
@@ -254,10 +330,19 @@ private:
    * \returns true if the packet is corrupted
    */
   virtual bool DoCorruptBit (Ptr<Packet> p);
+  /**
+   * Corrupt a packet by skip-ahead sampling of its units.
+   * \param p the packet to corrupt
+   * \returns true if the packet is corrupted
+   */
+  bool DoCorruptSkipAhead (Ptr<Packet> p);
   virtual void DoReset (void);
 
   enum ErrorUnit m_unit; //!< Error rate unit
   double m_rate; //!< Error rate
+  bool m_skipAhead; //!< True if errors are drawn by skip-ahead
+  enum ErrorUnit m_sampledUnit; //!< Unit of the gap held by m_sampler
+  SkipAheadSampler m_sampler; //!< Skip-ahead error positions
 
   Ptr<RandomVariableStream> m_ranvar; //!< rng stream
 };
@@ -354,6 +439,77 @@ private:
 };
 
 
+/**
+ * \brief Gilbert-Elliott burst error model
+ *
+ * A two-state Markov chain alternates between a Good and a Bad state.
+ * After each unit (bit, byte or packet, as in RateErrorModel), the chain
+ * moves from Good to Bad with probability GoodToBad, and from Bad to Good
+ * with probability BadToGood.  In each state, units are errored
+ * independently with the GoodErrorRate or BadErrorRate probability.  A
+ * packet is corrupted if at least one of its units is errored.  The long
+ * run fraction of time spent in the Bad state is
+ * GoodToBad / (GoodToBad + BadToGood).
+ *
+ * Both the sojourn times in each state and the gaps between errors are
+ * geometric, and are drawn with SkipAheadSampler objects: the cost of a
+ * packet only depends on the number of state changes and errors within
+ * it, not on its number of units.  The RanVar attribute must be Uniform(0,1).
+ *
+ * The chain starts in the Good state.  Reset() on this model brings it
+ * back to the Good state.
+ *
+ * IsCorrupt() will not modify the packet data buffer
+ */
+class GilbertElliottErrorModel : public ErrorModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  GilbertElliottErrorModel ();
+  virtual ~GilbertElliottErrorModel ();
+
+  /**
+   * \returns true if the chain is in the Bad state
+   */
+  bool IsBad (void) const;
+
+  /**
+   * \param ranvar A Uniform(0,1) random variable to generate random variates
+   */
+  void SetRandomVariable (Ptr<RandomVariableStream> ranvar);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  enum RateErrorModel::ErrorUnit m_unit; //!< Error unit
+  double m_goodToBad;       //!< Transition probability from Good to Bad
+  double m_badToGood;       //!< Transition probability from Bad to Good
+  double m_goodErrorRate;   //!< Unit error rate in the Good state
+  double m_badErrorRate;    //!< Unit error rate in the Bad state
+  bool m_bad;               //!< True if the chain is in the Bad state
+
+  SkipAheadSampler m_transition[2]; //!< Transitions out of the Good and Bad states
+  SkipAheadSampler m_error[2];      //!< Errors in the Good and Bad states
+
+  Ptr<RandomVariableStream> m_ranvar; //!< rng stream
+};
+
 /**
  * \brief Provide a list of Packet uids to corrupt
  *
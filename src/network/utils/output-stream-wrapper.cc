@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
+#include "ns3/packet.h"
 #include <fstream>
 
 namespace ns3 {
@@ -49,6 +50,8 @@ OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
+  // the binary trace flushes its buffer into the stream
+  m_binary = 0;
   FatalImpl::UnregisterStream (m_ostream);
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
@@ -61,4 +64,36 @@ OutputStreamWrapper::GetStream (void)
   return m_ostream;
 }
 
+void
+OutputStreamWrapper::SetCaptureFilter (Ptr<CaptureFilter> filter)
+{
+  NS_LOG_FUNCTION (this << filter);
+  m_filter = filter;
+}
+
+Ptr<CaptureFilter>
+OutputStreamWrapper::GetCaptureFilter (void) const
+{
+  return m_filter;
+}
+
+bool
+OutputStreamWrapper::Accept (Ptr<const Packet> p)
+{
+  return m_filter == 0 || m_filter->Accept (p);
+}
+
+void
+OutputStreamWrapper::SetBinaryTrace (Ptr<BinaryTraceWriter> binary)
+{
+  NS_LOG_FUNCTION (this << binary);
+  m_binary = binary;
+}
+
+Ptr<BinaryTraceWriter>
+OutputStreamWrapper::GetBinaryTrace (void) const
+{
+  return m_binary;
+}
+
 } // namespace ns3
@@ -23,6 +23,8 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
+#include "capture-filter.h"
+#include "binary-trace.h"
 
 namespace ns3 {
 
@@ -92,9 +94,50 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * \brief Set the capture filter of the trace written to this stream.
+   *
+   * The stream itself does not use the filter; trace sinks check it with
+   * Accept () before formatting a packet.
+   *
+   * \param filter The capture filter, or 0 to record every packet.
+   */
+  void SetCaptureFilter (Ptr<CaptureFilter> filter);
+
+  /**
+   * \returns the capture filter of this stream, or 0 if none.
+   */
+  Ptr<CaptureFilter> GetCaptureFilter (void) const;
+
+  /**
+   * \brief Check whether a traced packet should be written to this stream.
+   *
+   * \param p The traced packet.
+   * \returns true if there is no capture filter or if it accepts \p p.
+   */
+  bool Accept (Ptr<const Packet> p);
+
+  /**
+   * \brief Record the trace written to this stream in binary form.
+   *
+   * Trace sinks which support it write their events to the binary trace
+   * instead of formatting them on the stream.
+   *
+   * \param binary The binary trace, which must write to this stream.
+   */
+  void SetBinaryTrace (Ptr<BinaryTraceWriter> binary);
+
+  /**
+   * \returns the binary trace of this stream, or 0 if the stream is a text
+   * stream.
+   */
+  Ptr<BinaryTraceWriter> GetBinaryTrace (void) const;
+
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  Ptr<CaptureFilter> m_filter; //!< Capture filter, if any
+  Ptr<BinaryTraceWriter> m_binary; //!< Binary trace, if any
 };
 
 } // namespace ns3
@@ -46,12 +46,28 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("WriteBufferSize",
+                   "Size in bytes of the in-memory buffer used to batch writes to the file "
+                   "(0 writes every packet to the file immediately).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AsyncWrite",
+                   "Whether full write buffers are written to the file by a background thread "
+                   "(only used if WriteBufferSize is not 0).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asyncWrite),
+                   MakeBooleanChecker())
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_pcapNgFile (0),
+    m_pcapNgInterface (0),
+    m_dataLinkType (CaptureFilter::DLT_UNKNOWN),
+    m_filter (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +82,10 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapNgFile)
+    {
+      return m_pcapNgFile->Fail ();
+    }
   return m_file.Fail ();
 }
 
@@ -86,9 +106,38 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  //
+  // The shared pcapng file is closed when its last user releases it.
+  //
+  m_pcapNgFile = 0;
   m_file.Close ();
 }
 
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_pcapNgFile)
+    {
+      m_pcapNgFile->Flush ();
+      return;
+    }
+  m_file.Flush ();
+}
+
+void
+PcapFileWrapper::SetCaptureFilter (Ptr<CaptureFilter> filter)
+{
+  NS_LOG_FUNCTION (this << filter);
+  m_filter = filter;
+}
+
+Ptr<CaptureFilter>
+PcapFileWrapper::GetCaptureFilter (void) const
+{
+  return m_filter;
+}
+
 void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
@@ -105,6 +154,7 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   // a snaplen, we use the one provided.
   //
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
+  m_dataLinkType = dataLinkType;
   if (snapLen != std::numeric_limits<uint32_t>::max ())
     {
       m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
@@ -113,12 +163,39 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  if (m_bufferSize > 0)
+    {
+      m_file.SetWriteBuffer (m_bufferSize, m_asyncWrite);
+    }
+}
+
+void
+PcapFileWrapper::AttachToPcapNg (Ptr<PcapNgFileWrapper> file, uint32_t dataLinkType,
+                                 uint32_t snapLen, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << file << dataLinkType << snapLen << name);
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
+    {
+      snapLen = m_snapLen;
+    }
+  m_pcapNgFile = file;
+  m_dataLinkType = dataLinkType;
+  m_pcapNgInterface = file->AddInterface (dataLinkType, snapLen, name);
 }
 
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_filter && !m_filter->Accept (p, m_dataLinkType))
+    {
+      return;
+    }
+  if (m_pcapNgFile)
+    {
+      m_pcapNgFile->Write (m_pcapNgInterface, t, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +216,15 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_filter && !m_filter->Accept (p, m_dataLinkType, &header))
+    {
+      return;
+    }
+  if (m_pcapNgFile)
+    {
+      m_pcapNgFile->Write (m_pcapNgInterface, t, header, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +245,15 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_filter && !m_filter->Accept (buffer, length, m_dataLinkType))
+    {
+      return;
+    }
+  if (m_pcapNgFile)
+    {
+      m_pcapNgFile->Write (m_pcapNgInterface, t, buffer, length);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
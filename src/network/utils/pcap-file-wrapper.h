@@ -27,6 +27,8 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcapng-file-wrapper.h"
+#include "capture-filter.h"
 
 namespace ns3 {
 
@@ -109,6 +111,44 @@ public:
              uint32_t snapLen = std::numeric_limits<uint32_t>::max (), 
              int32_t tzCorrection = PcapFile::ZONE_DEFAULT);
 
+  /**
+   * Redirect all the packets written through this wrapper to a new
+   * interface of a shared pcapng file, instead of a pcap file of its own.
+   * This wrapper must not have been opened.
+   *
+   * \param file The shared pcapng file.
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param snapLen An optional maximum size for packets written to the file.
+   * If not provided, the "CaptureSize" Attribute is used.
+   * \param name The name of the interface in the pcapng file.
+   */
+  void AttachToPcapNg (Ptr<PcapNgFileWrapper> file,
+                       uint32_t dataLinkType,
+                       uint32_t snapLen = std::numeric_limits<uint32_t>::max (),
+                       std::string const &name = "");
+
+  /**
+   * Write any buffered packet to the underlying file.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Only record the packets accepted by a capture filter.
+   *
+   * The filter is checked by the Write methods before anything is
+   * serialized, so packets which are filtered out are cheap.  The filter
+   * is given the data link type of the file, which must therefore be set
+   * with Init () or AttachToPcapNg () before packets are written.
+   *
+   * \param filter The capture filter, or 0 to record every packet.
+   */
+  void SetCaptureFilter (Ptr<CaptureFilter> filter);
+
+  /**
+   * \returns the capture filter of this file, or 0 if none.
+   */
+  Ptr<CaptureFilter> GetCaptureFilter (void) const;
+
   /**
    * \brief Write the next packet to file
    * 
@@ -224,6 +264,12 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  uint32_t m_bufferSize; //!< size of the write buffer, 0 to disable buffering
+  bool     m_asyncWrite; //!< write buffers from a background thread
+  Ptr<PcapNgFileWrapper> m_pcapNgFile; //!< shared pcapng file, if packets are redirected
+  uint32_t m_pcapNgInterface; //!< interface identifier in the shared pcapng file
+  uint32_t m_dataLinkType; //!< data link type of the written packets
+  Ptr<CaptureFilter> m_filter; //!< capture filter, if any
 };
 
 } // namespace ns3
@@ -27,6 +27,7 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "buffered-file-writer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -50,7 +51,8 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writer (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -88,9 +90,40 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  delete m_writer;
+  m_writer = 0;
   m_file.close ();
 }
 
+void
+PcapFile::SetWriteBuffer (uint32_t bufferSize, bool async)
+{
+  NS_LOG_FUNCTION (this << bufferSize << async);
+  //
+  // Deleting the current writer, if any, flushes it.
+  //
+  delete m_writer;
+  m_writer = 0;
+  if (bufferSize > 0)
+    {
+      m_writer = new BufferedFileWriter (&m_file, bufferSize, async);
+    }
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer)
+    {
+      m_writer->Flush ();
+    }
+  else
+    {
+      m_file.flush ();
+    }
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -204,8 +237,13 @@ PcapFile::WriteFileHeader (void)
   NS_LOG_FUNCTION (this);
   //
   // If we're initializing the file, we need to write the pcap file header
-  // at the start of the file.
+  // at the start of the file.  Anything still buffered has to reach the
+  // file before we move the write position.
   //
+  if (m_writer)
+    {
+      m_writer->Flush ();
+    }
   m_file.seekp (0, std::ios::beg);
  
   //
@@ -403,7 +441,6 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -422,6 +459,17 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
+  if (m_writer)
+    {
+      uint8_t *buf = m_writer->Reserve (16);
+      std::memcpy (buf, &header.m_tsSec, sizeof(header.m_tsSec));
+      std::memcpy (buf + 4, &header.m_tsUsec, sizeof(header.m_tsUsec));
+      std::memcpy (buf + 8, &header.m_inclLen, sizeof(header.m_inclLen));
+      std::memcpy (buf + 12, &header.m_origLen, sizeof(header.m_origLen));
+      return inclLen;
+    }
+
+  NS_ASSERT (m_file.good ());
   m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
   m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
   m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
@@ -435,6 +483,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
+  if (m_writer)
+    {
+      m_writer->Write (data, inclLen);
+      return;
+    }
   m_file.write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -444,6 +497,11 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
+  if (m_writer)
+    {
+      p->CopyData (m_writer->Reserve (inclLen), inclLen);
+      return;
+    }
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -460,6 +518,13 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
+  if (m_writer)
+    {
+      uint8_t *buf = m_writer->Reserve (inclLen);
+      headerBuffer.CopyData (buf, toCopy);
+      p->CopyData (buf + toCopy, inclLen - toCopy);
+      return;
+    }
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
   p->CopyData (&m_file, inclLen);
@@ -477,6 +542,7 @@ PcapFile::Read (
 {
   NS_LOG_FUNCTION (this << &data <<maxBytes << tsSec << tsUsec << inclLen << origLen << readLen);
   NS_ASSERT (m_file.good ());
+  NS_ASSERT_MSG (m_writer == 0, "Reading from a pcap file with a write buffer");
 
   PcapRecordHeader header;
 
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class BufferedFileWriter;
 
 
 /**
@@ -85,6 +86,30 @@ public:
    */
   void Close (void);
 
+  /**
+   * \brief Accumulate written records in memory instead of writing them to
+   * the underlying stream one field at a time.
+   *
+   * Records are copied into a buffer of \p bufferSize bytes, which is
+   * written to the file with a single call when it fills up, on Flush ()
+   * and on Close ().  If \p async is true the buffer is written by a
+   * background thread while the caller keeps filling a second buffer.
+   *
+   * This file must have been previously opened with write permissions.
+   * Buffered records are not visible in the file until they are flushed,
+   * and are lost if the program aborts before that.
+   *
+   * \param bufferSize Size of the in-memory buffer in bytes, or 0 to
+   * disable buffering (the default).
+   * \param async Whether a background thread writes the buffers.
+   */
+  void SetWriteBuffer (uint32_t bufferSize, bool async = false);
+
+  /**
+   * \brief Write any buffered records to the underlying file.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this object.  This file must have
    * been previously opened with write permissions.
@@ -371,6 +396,7 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  BufferedFileWriter *m_writer; //!< write buffer, or 0 if writes are not buffered
 };
 
 } // namespace ns3
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "pcapng-file-wrapper.h"
+#include "pcap-file.h"
+#include "buffered-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFileWrapper");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapNgFileWrapper);
+
+TypeId
+PcapNgFileWrapper::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapNgFileWrapper")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PcapNgFileWrapper> ()
+    .AddAttribute ("CaptureSize",
+                   "Default maximum length of captured packets (cf. pcap snaplen)",
+                   UintegerValue (PcapFile::SNAPLEN_DEFAULT),
+                   MakeUintegerAccessor (&PcapNgFileWrapper::m_snapLen),
+                   MakeUintegerChecker<uint32_t> (0, PcapFile::SNAPLEN_DEFAULT))
+    .AddAttribute ("WriteBufferSize",
+                   "Size in bytes of the in-memory buffer used to batch writes to the file.",
+                   UintegerValue (BufferedFileWriter::BUFFER_SIZE_DEFAULT),
+                   MakeUintegerAccessor (&PcapNgFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("AsyncWrite",
+                   "Whether full write buffers are written to the file by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapNgFileWrapper::m_asyncWrite),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+PcapNgFileWrapper::PcapNgFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapNgFileWrapper::~PcapNgFileWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapNgFileWrapper::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.Fail ();
+}
+
+void
+PcapNgFileWrapper::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.Open (filename);
+  m_file.SetWriteBuffer (m_bufferSize, m_asyncWrite);
+  m_file.Init ();
+}
+
+void
+PcapNgFileWrapper::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Close ();
+}
+
+void
+PcapNgFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Flush ();
+}
+
+uint32_t
+PcapNgFileWrapper::AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name);
+  if (snapLen == std::numeric_limits<uint32_t>::max ())
+    {
+      snapLen = m_snapLen;
+    }
+  return m_file.AddInterface (dataLinkType, snapLen, name);
+}
+
+uint32_t
+PcapNgFileWrapper::GetNInterfaces (void) const
+{
+  return m_file.GetNInterfaces ();
+}
+
+void
+PcapNgFileWrapper::Write (uint32_t interface, Time t, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << t << p);
+  m_file.Write (interface, t.GetNanoSeconds (), p);
+}
+
+void
+PcapNgFileWrapper::Write (uint32_t interface, Time t, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << t << &header << p);
+  m_file.Write (interface, t.GetNanoSeconds (), header, p);
+}
+
+void
+PcapNgFileWrapper::Write (uint32_t interface, Time t, uint8_t const *buffer, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << interface << t << &buffer << length);
+  m_file.Write (interface, t.GetNanoSeconds (), buffer, length);
+}
+
+} // namespace ns3
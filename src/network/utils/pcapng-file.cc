@@ -0,0 +1,283 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/fatal-impl.h"
+#include "pcapng-file.h"
+#include "buffered-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFile");
+
+const uint32_t SECTION_HEADER_BLOCK = 0x0a0d0d0a;         /**< Block type of a Section Header Block */
+const uint32_t INTERFACE_DESCRIPTION_BLOCK = 0x00000001;  /**< Block type of an Interface Description Block */
+const uint32_t ENHANCED_PACKET_BLOCK = 0x00000006;        /**< Block type of an Enhanced Packet Block */
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;             /**< Identifies the byte order of a section */
+
+const uint16_t VERSION_MAJOR = 1;                         /**< Major version of the pcapng format */
+const uint16_t VERSION_MINOR = 0;                         /**< Minor version of the pcapng format */
+
+const uint16_t OPT_ENDOFOPT = 0;                          /**< End of option list */
+const uint16_t SHB_USERAPPL = 4;                          /**< Name of the writing application */
+const uint16_t IF_NAME = 2;                               /**< Name of an interface */
+const uint16_t IF_TSRESOL = 9;                            /**< Timestamp resolution of an interface */
+
+/**
+ * \brief Round a length up to the 32-bit boundary used by pcapng blocks.
+ * \param len the length
+ * \returns the padded length
+ */
+static uint32_t
+PadLength (uint32_t len)
+{
+  return (len + 3) & ~3U;
+}
+
+/**
+ * \brief Copy a 16-bit value to a possibly unaligned location.
+ * \param buf where to write
+ * \param val the value
+ * \returns the location following the value
+ */
+static uint8_t *
+WriteU16 (uint8_t *buf, uint16_t val)
+{
+  std::memcpy (buf, &val, sizeof (val));
+  return buf + sizeof (val);
+}
+
+/**
+ * \brief Copy a 32-bit value to a possibly unaligned location.
+ * \param buf where to write
+ * \param val the value
+ * \returns the location following the value
+ */
+static uint8_t *
+WriteU32 (uint8_t *buf, uint32_t val)
+{
+  std::memcpy (buf, &val, sizeof (val));
+  return buf + sizeof (val);
+}
+
+/**
+ * \brief Write a block option, padded to 32 bits.
+ * \param buf where to write
+ * \param code the option code
+ * \param value the option value
+ * \param len the length of the value
+ * \returns the location following the option
+ */
+static uint8_t *
+WriteOption (uint8_t *buf, uint16_t code, void const *value, uint16_t len)
+{
+  buf = WriteU16 (buf, code);
+  buf = WriteU16 (buf, len);
+  std::memset (buf, 0, PadLength (len));
+  if (len > 0)
+    {
+      std::memcpy (buf, value, len);
+    }
+  return buf + PadLength (len);
+}
+
+PcapNgFile::PcapNgFile ()
+  : m_file (),
+    m_writer (0)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+PcapNgFile::~PcapNgFile ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_file);
+  Close ();
+}
+
+bool
+PcapNgFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.fail ();
+}
+
+void
+PcapNgFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT (!m_file.fail ());
+
+  m_filename = filename;
+  m_file.open (filename.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  m_snapLens.clear ();
+  delete m_writer;
+  m_writer = new BufferedFileWriter (&m_file);
+}
+
+void
+PcapNgFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  delete m_writer;
+  m_writer = 0;
+  m_file.close ();
+}
+
+void
+PcapNgFile::SetWriteBuffer (uint32_t bufferSize, bool async)
+{
+  NS_LOG_FUNCTION (this << bufferSize << async);
+  NS_ASSERT_MSG (m_writer != 0, "PcapNgFile::SetWriteBuffer(): file is not open");
+  NS_ASSERT (bufferSize > 0);
+  delete m_writer;
+  m_writer = new BufferedFileWriter (&m_file, bufferSize, async);
+}
+
+void
+PcapNgFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer)
+    {
+      m_writer->Flush ();
+    }
+}
+
+void
+PcapNgFile::Init (std::string const &application)
+{
+  NS_LOG_FUNCTION (this << application);
+  NS_ASSERT_MSG (m_writer != 0, "PcapNgFile::Init(): file is not open");
+
+  uint16_t appLen = application.size ();
+  uint32_t blockLen = 24 + 4 + PadLength (appLen) + 4 + 4;
+
+  uint8_t *buf = m_writer->Reserve (blockLen);
+  buf = WriteU32 (buf, SECTION_HEADER_BLOCK);
+  buf = WriteU32 (buf, blockLen);
+  buf = WriteU32 (buf, BYTE_ORDER_MAGIC);
+  buf = WriteU16 (buf, VERSION_MAJOR);
+  buf = WriteU16 (buf, VERSION_MINOR);
+  //
+  // The section length is unknown while we are writing it.
+  //
+  int64_t sectionLen = -1;
+  std::memcpy (buf, &sectionLen, sizeof (sectionLen));
+  buf += sizeof (sectionLen);
+  buf = WriteOption (buf, SHB_USERAPPL, application.c_str (), appLen);
+  buf = WriteOption (buf, OPT_ENDOFOPT, 0, 0);
+  WriteU32 (buf, blockLen);
+}
+
+uint32_t
+PcapNgFile::AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name);
+  NS_ASSERT_MSG (m_writer != 0, "PcapNgFile::AddInterface(): file is not open");
+
+  uint16_t nameLen = name.size ();
+  uint8_t tsresol = 9;
+  uint32_t blockLen = 16 + 4 + PadLength (nameLen) + 4 + 4 + 4 + 4;
+
+  uint8_t *buf = m_writer->Reserve (blockLen);
+  buf = WriteU32 (buf, INTERFACE_DESCRIPTION_BLOCK);
+  buf = WriteU32 (buf, blockLen);
+  buf = WriteU16 (buf, dataLinkType);
+  buf = WriteU16 (buf, 0);
+  buf = WriteU32 (buf, snapLen);
+  buf = WriteOption (buf, IF_NAME, name.c_str (), nameLen);
+  buf = WriteOption (buf, IF_TSRESOL, &tsresol, sizeof (tsresol));
+  buf = WriteOption (buf, OPT_ENDOFOPT, 0, 0);
+  WriteU32 (buf, blockLen);
+
+  m_snapLens.push_back (snapLen);
+  return m_snapLens.size () - 1;
+}
+
+uint32_t
+PcapNgFile::GetNInterfaces (void) const
+{
+  return m_snapLens.size ();
+}
+
+uint8_t *
+PcapNgFile::WritePacketBlock (uint32_t interface, uint64_t timestamp, uint32_t totalLen, uint32_t &inclLen)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << totalLen);
+  NS_ASSERT_MSG (interface < m_snapLens.size (), "PcapNgFile::Write(): unknown interface " << interface);
+
+  inclLen = std::min (totalLen, m_snapLens[interface]);
+  uint32_t blockLen = 28 + PadLength (inclLen) + 4;
+
+  uint8_t *buf = m_writer->Reserve (blockLen);
+  buf = WriteU32 (buf, ENHANCED_PACKET_BLOCK);
+  buf = WriteU32 (buf, blockLen);
+  buf = WriteU32 (buf, interface);
+  buf = WriteU32 (buf, static_cast<uint32_t> (timestamp >> 32));
+  buf = WriteU32 (buf, static_cast<uint32_t> (timestamp));
+  buf = WriteU32 (buf, inclLen);
+  buf = WriteU32 (buf, totalLen);
+  //
+  // Clear the padding now; the caller only fills in the packet bytes.
+  //
+  std::memset (buf + inclLen, 0, PadLength (inclLen) - inclLen);
+  WriteU32 (buf + PadLength (inclLen), blockLen);
+  return buf;
+}
+
+void
+PcapNgFile::Write (uint32_t interface, uint64_t timestamp, uint8_t const * const data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << &data << totalLen);
+  uint32_t inclLen;
+  uint8_t *buf = WritePacketBlock (interface, timestamp, totalLen, inclLen);
+  std::memcpy (buf, data, inclLen);
+}
+
+void
+PcapNgFile::Write (uint32_t interface, uint64_t timestamp, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << p);
+  uint32_t inclLen;
+  uint8_t *buf = WritePacketBlock (interface, timestamp, p->GetSize (), inclLen);
+  p->CopyData (buf, inclLen);
+}
+
+void
+PcapNgFile::Write (uint32_t interface, uint64_t timestamp, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << timestamp << &header << p);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t inclLen;
+  uint8_t *buf = WritePacketBlock (interface, timestamp, headerSize + p->GetSize (), inclLen);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.CopyData (buf, toCopy);
+  p->CopyData (buf + toCopy, inclLen - toCopy);
+}
+
+} // namespace ns3
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+class BufferedFileWriter;
+
+/**
+ * \brief A class representing a pcapng file being written
+ *
+ * Unlike the classic pcap format handled by PcapFile, a pcapng file can
+ * hold packets captured on several interfaces, each with its own data link
+ * type and snap length.  This makes it possible to store the traces of
+ * every device of a simulation in a single file.
+ *
+ * The file is made of one Section Header Block, written by Init (), one
+ * Interface Description Block per call to AddInterface (), and one Enhanced
+ * Packet Block per written packet.  Timestamps are stored in nanoseconds
+ * (the if_tsresol option of every interface is set to 9).  All blocks are
+ * written in the byte order of the host, as allowed by the format.
+ *
+ * See https://github.com/pcapng/pcapng for the format specification.
+ *
+ * Blocks are always written through a BufferedFileWriter; use
+ * SetWriteBuffer () to change its size or to let a background thread
+ * perform the writes.
+ */
+class PcapNgFile
+{
+public:
+  PcapNgFile ();
+  ~PcapNgFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file, discarding any existing content.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * Flush any buffered block and close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Change the size of the write buffer.
+   *
+   * \param bufferSize Size of the in-memory buffer, in bytes.  Must not be 0.
+   * \param async Whether a background thread writes the buffers.
+   */
+  void SetWriteBuffer (uint32_t bufferSize, bool async = false);
+
+  /**
+   * \brief Write any buffered block to the underlying file.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Write the Section Header Block that starts the file.
+   *
+   * \param application Name of the application that wrote the file,
+   * stored in the shb_userappl option.
+   */
+  void Init (std::string const &application = "ns-3");
+
+  /**
+   * \brief Write an Interface Description Block.
+   *
+   * \param dataLinkType A data link type as defined in the pcap library.
+   * \param snapLen Maximum size of packets written on this interface.
+   * \param name Name of the interface, stored in the if_name option.
+   * \returns the identifier of the new interface, to be passed to Write ().
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name);
+
+  /**
+   * \returns the number of interfaces declared in the file.
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write a packet as an Enhanced Packet Block
+   *
+   * \param interface Interface identifier returned by AddInterface ()
+   * \param timestamp Packet timestamp, nanoseconds
+   * \param data Data buffer
+   * \param totalLen Total packet length
+   */
+  void Write (uint32_t interface, uint64_t timestamp, uint8_t const * const data, uint32_t totalLen);
+
+  /**
+   * \brief Write a packet as an Enhanced Packet Block
+   *
+   * \param interface Interface identifier returned by AddInterface ()
+   * \param timestamp Packet timestamp, nanoseconds
+   * \param p Packet to write
+   */
+  void Write (uint32_t interface, uint64_t timestamp, Ptr<const Packet> p);
+
+  /**
+   * \brief Write a packet as an Enhanced Packet Block
+   *
+   * \param interface Interface identifier returned by AddInterface ()
+   * \param timestamp Packet timestamp, nanoseconds
+   * \param header Header to write, in front of packet
+   * \param p Packet to write
+   */
+  void Write (uint32_t interface, uint64_t timestamp, const Header &header, Ptr<const Packet> p);
+
+private:
+  /**
+   * \brief Reserve room for an Enhanced Packet Block and fill everything
+   * but the packet data.
+   *
+   * \param interface Interface identifier
+   * \param timestamp Packet timestamp, nanoseconds
+   * \param totalLen Total packet length
+   * \param inclLen [out] Number of packet bytes to store in the block
+   * \returns a pointer to where the packet data must be copied
+   */
+  uint8_t * WritePacketBlock (uint32_t interface, uint64_t timestamp, uint32_t totalLen, uint32_t &inclLen);
+
+  std::string m_filename;             //!< file name
+  std::fstream m_file;                //!< file stream
+  BufferedFileWriter *m_writer;       //!< write buffer
+  std::vector<uint32_t> m_snapLens;   //!< snap length of each interface
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
@@ -32,6 +32,7 @@
 #include <string>
 #include <sstream>
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -315,6 +316,31 @@ public:
    */
   virtual Ptr<const Item> Peek (void) const = 0;
 
+  /**
+   * \brief Enqueue a batch of items.
+   *
+   * Each item is enqueued as if by a call to Enqueue, so items which do not
+   * fit are dropped individually.  Subclasses may override this method to
+   * process the batch more efficiently.
+   *
+   * \param items the items to enqueue, in order
+   * \return the number of items actually enqueued
+   */
+  virtual uint32_t EnqueueBulk (std::vector<Ptr<Item> > const &items);
+
+  /**
+   * \brief Dequeue a batch of items.
+   *
+   * This is equivalent to calling Dequeue up to \p n times, stopping when
+   * the queue is empty.  Subclasses may override this method to process the
+   * batch more efficiently.
+   *
+   * \param items the vector to which the dequeued items are appended
+   * \param n the maximum number of items to dequeue
+   * \return the number of items actually dequeued
+   */
+  virtual uint32_t DequeueBulk (std::vector<Ptr<Item> > &items, uint32_t n);
+
   /**
    * Flush the queue.
    */
@@ -386,6 +412,38 @@ protected:
    */
   Ptr<const Item> DoPeek (ConstIterator pos) const;
 
+  /**
+   * \brief Check whether an item fits in the queue, dropping it if it does not.
+   *
+   * DoEnqueue, DoDequeue and DoRemove store the items in a list managed by
+   * this class.  Subclasses which store the items in their own container
+   * call CheckEnqueue and NotifyEnqueue around the insertion of an item,
+   * and NotifyDequeue or NotifyRemove after the extraction of an item, to
+   * keep the statistics and the traces of the queue up to date.
+   *
+   * \param item the item to enqueue
+   * \return true if the item can be enqueued, false if it has been dropped
+   */
+  bool CheckEnqueue (Ptr<Item> item);
+
+  /**
+   * \brief Account for an item which has been inserted in the queue.
+   * \param item the item
+   */
+  void NotifyEnqueue (Ptr<Item> item);
+
+  /**
+   * \brief Account for an item which has been dequeued.
+   * \param item the item
+   */
+  void NotifyDequeue (Ptr<Item> item);
+
+  /**
+   * \brief Account for an item which has been removed and dropped.
+   * \param item the item
+   */
+  void NotifyRemove (Ptr<Item> item);
+
   /**
    * \brief Drop a packet before enqueue
    * \param item item that was dropped
@@ -471,31 +529,13 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  if (m_mode == QUEUE_MODE_PACKETS && (m_nPackets.Get () >= m_maxPackets))
-    {
-      NS_LOG_LOGIC ("Queue full (at max packets) -- dropping pkt");
-      DropBeforeEnqueue (item);
-      return false;
-    }
-
-  if (m_mode == QUEUE_MODE_BYTES && (m_nBytes.Get () + item->GetSize () > m_maxBytes))
+  if (!CheckEnqueue (item))
     {
-      NS_LOG_LOGIC ("Queue full (packet would exceed max bytes) -- dropping pkt");
-      DropBeforeEnqueue (item);
       return false;
     }
 
   m_packets.insert (pos, item);
-
-  uint32_t size = item->GetSize ();
-  m_nBytes += size;
-  m_nTotalReceivedBytes += size;
-
-  m_nPackets++;
-  m_nTotalReceivedPackets++;
-
-  NS_LOG_LOGIC ("m_traceEnqueue (p)");
-  m_traceEnqueue (item);
+  NotifyEnqueue (item);
 
   return true;
 }
@@ -517,14 +557,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      NotifyDequeue (item);
     }
   return item;
 }
@@ -546,15 +579,107 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
+      NotifyRemove (item);
+    }
+  return item;
+}
 
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
+template <typename Item>
+bool
+Queue<Item>::CheckEnqueue (Ptr<Item> item)
+{
+  if (m_mode == QUEUE_MODE_PACKETS && (m_nPackets.Get () >= m_maxPackets))
+    {
+      NS_LOG_LOGIC ("Queue full (at max packets) -- dropping pkt");
+      DropBeforeEnqueue (item);
+      return false;
+    }
 
-      DropAfterDequeue (item);
+  if (m_mode == QUEUE_MODE_BYTES && (m_nBytes.Get () + item->GetSize () > m_maxBytes))
+    {
+      NS_LOG_LOGIC ("Queue full (packet would exceed max bytes) -- dropping pkt");
+      DropBeforeEnqueue (item);
+      return false;
     }
-  return item;
+
+  return true;
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyEnqueue (Ptr<Item> item)
+{
+  uint32_t size = item->GetSize ();
+  m_nBytes += size;
+  m_nTotalReceivedBytes += size;
+
+  m_nPackets++;
+  m_nTotalReceivedPackets++;
+
+  NS_LOG_LOGIC ("m_traceEnqueue (p)");
+  m_traceEnqueue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyDequeue (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyRemove (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  DropAfterDequeue (item);
+}
+
+template <typename Item>
+uint32_t
+Queue<Item>::EnqueueBulk (std::vector<Ptr<Item> > const &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+  uint32_t n = 0;
+  for (typename std::vector<Ptr<Item> >::const_iterator i = items.begin (); i != items.end (); ++i)
+    {
+      if (Enqueue (*i))
+        {
+          n++;
+        }
+    }
+  return n;
+}
+
+template <typename Item>
+uint32_t
+Queue<Item>::DequeueBulk (std::vector<Ptr<Item> > &items, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  uint32_t count = 0;
+  while (count < n)
+    {
+      Ptr<Item> item = Dequeue ();
+      if (item == 0)
+        {
+          break;
+        }
+      items.push_back (item);
+      count++;
+    }
+  return count;
 }
 
 template <typename Item>
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "segment-offload-tag.h"
+#include "ns3/net-device.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentOffloadTag");
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentOffloadTag);
+
+TypeId
+SegmentOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SegmentOffloadTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+SegmentOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+SegmentOffloadTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 6;
+}
+
+void
+SegmentOffloadTag::Serialize (TagBuffer buf) const
+{
+  NS_LOG_FUNCTION (this << &buf);
+  buf.WriteU16 (m_segmentSize);
+  buf.WriteU32 (m_payloadSize);
+}
+
+void
+SegmentOffloadTag::Deserialize (TagBuffer buf)
+{
+  NS_LOG_FUNCTION (this << &buf);
+  m_segmentSize = buf.ReadU16 ();
+  m_payloadSize = buf.ReadU32 ();
+}
+
+void
+SegmentOffloadTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "SegmentSize=" << m_segmentSize << " PayloadSize=" << m_payloadSize;
+}
+
+SegmentOffloadTag::SegmentOffloadTag ()
+  : Tag (),
+    m_segmentSize (0),
+    m_payloadSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SegmentOffloadTag::SegmentOffloadTag (uint16_t segmentSize, uint32_t payloadSize)
+  : Tag (),
+    m_segmentSize (segmentSize),
+    m_payloadSize (payloadSize)
+{
+  NS_LOG_FUNCTION (this << segmentSize << payloadSize);
+}
+
+void
+SegmentOffloadTag::SetSegmentSize (uint16_t segmentSize)
+{
+  NS_LOG_FUNCTION (this << segmentSize);
+  m_segmentSize = segmentSize;
+}
+
+uint16_t
+SegmentOffloadTag::GetSegmentSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segmentSize;
+}
+
+void
+SegmentOffloadTag::SetPayloadSize (uint32_t payloadSize)
+{
+  NS_LOG_FUNCTION (this << payloadSize);
+  m_payloadSize = payloadSize;
+}
+
+uint32_t
+SegmentOffloadTag::GetPayloadSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_payloadSize;
+}
+
+uint32_t
+SegmentOffloadTag::GetSegments (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_segmentSize == 0 || m_payloadSize == 0)
+    {
+      return 1;
+    }
+  return (m_payloadSize + m_segmentSize - 1) / m_segmentSize;
+}
+
+uint32_t
+SegmentOffloadTag::GetWireSize (uint32_t packetSize) const
+{
+  NS_LOG_FUNCTION (this << packetSize);
+  NS_ASSERT_MSG (packetSize >= m_payloadSize, "The packet is smaller than its payload");
+  return m_payloadSize + GetSegments () * (packetSize - m_payloadSize);
+}
+
+bool
+SegmentOffloadTag::IsSupportedBy (Ptr<const NetDevice> device)
+{
+  NS_LOG_FUNCTION (device);
+  BooleanValue offload;
+  return device->GetAttributeFailSafe ("SegmentOffload", offload) && offload.Get ();
+}
+
+} // namespace ns3
@@ -30,6 +30,7 @@
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/net-device-queue-interface.h"
+#include "segment-offload-tag.h"
 
 namespace ns3 {
 
@@ -210,6 +211,12 @@ SimpleNetDevice::GetTypeId (void)
                    DataRateValue (DataRate ("0b/s")),
                    MakeDataRateAccessor (&SimpleNetDevice::m_bps),
                    MakeDataRateChecker ())
+    .AddAttribute ("SegmentOffload",
+                   "Whether super-segments (see SegmentOffloadTag) are sent as a single "
+                   "packet taking the transmission time of all their segments",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&SimpleNetDevice::m_segmentOffload),
+                   MakeBooleanChecker ())
     .AddTraceSource ("PhyRxDrop",
                      "Trace source indicating a packet has been dropped "
                      "by the device during reception",
@@ -487,7 +494,7 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
           Time txTime = Time (0);
           if (m_bps > DataRate (0))
             {
-              txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+              txTime = m_bps.CalculateBytesTxTime (GetWireSize (packet));
             }
           m_channel->Send (p, protocolNumber, to, from, this);
           TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
@@ -500,6 +507,29 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
   return true;
 }
 
+uint32_t
+SimpleNetDevice::SendBulk (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  Ptr<NetDeviceQueue> txq;
+  if (m_queueInterface)
+    {
+      txq = m_queueInterface->GetTxQueue (0);
+    }
+
+  uint32_t sent = 0;
+  for (; sent < items.size (); sent++)
+    {
+      if (txq && txq->IsStopped ())
+        {
+          break;
+        }
+      SendFrom (items[sent]->GetPacket (), m_address, items[sent]->GetAddress (), items[sent]->GetProtocol ());
+    }
+  return sent;
+}
+
 
 void
 SimpleNetDevice::TransmitComplete ()
@@ -527,7 +557,7 @@ SimpleNetDevice::TransmitComplete ()
       Time txTime = Time (0);
       if (m_bps > DataRate (0))
         {
-          txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+          txTime = m_bps.CalculateBytesTxTime (GetWireSize (packet));
         }
       TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
     }
@@ -535,6 +565,18 @@ SimpleNetDevice::TransmitComplete ()
   return;
 }
 
+uint32_t
+SimpleNetDevice::GetWireSize (Ptr<const Packet> packet) const
+{
+  NS_LOG_FUNCTION (this << packet);
+  SegmentOffloadTag offloadTag;
+  if (m_segmentOffload && packet->PeekPacketTag (offloadTag))
+    {
+      return offloadTag.GetWireSize (packet->GetSize ());
+    }
+  return packet->GetSize ();
+}
+
 Ptr<Node> 
 SimpleNetDevice::GetNode (void) const
 {
@@ -126,6 +126,7 @@ public:
   virtual bool IsBridge (void) const;
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual uint32_t SendBulk (const std::vector<Ptr<QueueDiscItem> > &items);
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
   virtual bool NeedsArp (void) const;
@@ -168,6 +169,16 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * \brief Get the number of bytes a packet takes on the wire
+   *
+   * A super-segment takes the size of all the segments it carries.
+   *
+   * \param packet the packet
+   * \returns the number of bytes to transmit
+   */
+  uint32_t GetWireSize (Ptr<const Packet> packet) const;
+
   bool m_linkUp; //!< Flag indicating whether or not the link is up
 
   /**
@@ -178,6 +189,7 @@ private:
 
   Ptr<Queue<Packet> > m_queue; //!< The Queue for outgoing packets.
   DataRate m_bps; //!< The device nominal Data rate. Zero means infinite
+  bool m_segmentOffload; //!< Whether super-segments are sent without being split
   EventId TransmitCompleteEvent; //!< the Tx Complete event
 
   /**
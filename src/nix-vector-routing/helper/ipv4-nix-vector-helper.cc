@@ -20,6 +20,8 @@
 
 #include "ipv4-nix-vector-helper.h"
 #include "ns3/ipv4-nix-vector-routing.h"
+#include "ns3/nix-vector-graph.h"
+#include "ns3/simulation-singleton.h"
 
 namespace ns3 {
 
@@ -47,4 +49,21 @@ Ipv4NixVectorHelper::Create (Ptr<Node> node) const
   node->AggregateObject (agent);
   return agent;
 }
+
+void
+Ipv4NixVectorHelper::PrecomputeRoutes (NodeContainer sources)
+{
+  std::vector<uint32_t> ids;
+  for (NodeContainer::Iterator i = sources.Begin (); i != sources.End (); ++i)
+    {
+      ids.push_back ((*i)->GetId ());
+    }
+  SimulationSingleton<NixVectorGraph>::Get ()->Precompute (ids);
+}
+
+void
+Ipv4NixVectorHelper::PrecomputeRoutes (void)
+{
+  PrecomputeRoutes (NodeContainer::GetGlobal ());
+}
 } // namespace ns3
@@ -23,6 +23,7 @@
 
 #include "ns3/object-factory.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/node-container.h"
 
 namespace ns3 {
 
@@ -66,6 +67,27 @@ public:
   */
   virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
+  /**
+   * \brief Compute in advance the paths from some nodes to all the others.
+   *
+   * The breadth-first search trees of the nodes are computed by as many
+   * threads as the global value "NixVectorRoutingThreads", and stored in
+   * the topology graph shared by all the nodes.  The nix-vectors of the
+   * nodes are then built without any search, until a topology change
+   * drops the trees which it modifies.  This method should be called
+   * after the addresses are assigned.
+   *
+   * \param sources the nodes which will send packets
+   */
+  static void PrecomputeRoutes (NodeContainer sources);
+
+  /**
+   * \brief Compute in advance the paths between all the nodes.
+   *
+   * \see PrecomputeRoutes (NodeContainer)
+   */
+  static void PrecomputeRoutes (void);
+
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
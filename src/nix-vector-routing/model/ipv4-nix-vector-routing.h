@@ -78,8 +78,8 @@ public:
 
   /**
    * @brief Called when run-time link topology change occurs
-   * which iterates through the node list and flushes any
-   * nix vector caches
+   * which drops the shared topology graph, so that the nix
+   * vector caches of all the nodes are flushed
    *
    * \internal
    * \c const is used here due to need to potentially flush the cache
@@ -103,16 +103,9 @@ private:
   void FlushIpv4RouteCache (void) const;
 
   /**
-   * Upon a run-time topology change caches are
-   * flushed and the total number of neighbors is
-   * reset to zero
-   */
-  void ResetTotalNeighbors (void);
-
-  /**
-   * Takes in the source node and dest IP and calls GetNodeByIp,
-   * BFS, accounting for any output interface specified, and finally
-   * BuildNixVector to return the built nix-vector
+   * Takes in the source node and dest IP and asks the shared
+   * topology graph for the nix-vector, accounting for any output
+   * interface specified
    *
    * \param source Source node
    * \param dest Destination node address
@@ -135,33 +128,6 @@ private:
    */
   Ptr<Ipv4Route> GetIpv4RouteInCache (Ipv4Address address);
 
-  /**
-   * Given a net-device returns all the adjacent net-devices,
-   * essentially getting the neighbors on that channel
-   * \param [in] netDevice the NetDevice attached to the channel.
-   * \param [in] channel the channel to check
-   * \param [out] netDeviceContainer the NetDeviceContainer of the NetDevices in the channel.
-   */
-  void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
-
-  /**
-   * Iterates through the node list and finds the one
-   * corresponding to the given Ipv4Address
-   * \param dest detination node IP
-   * \return The node with the specified IP.
-   */
-  Ptr<Node> GetNodeByIp (Ipv4Address dest);
-
-  /**
-   * Recurses the parent vector, created by BFS and actually builds the nixvector
-   * \param [in] parentVector Parent vector for retracing routes
-   * \param [in] source Source Node index
-   * \param [in] dest Destination Node index
-   * \param [out] nixVector the NixVector to be used for routing
-   * \returns true on success, false otherwise.
-   */
-  bool BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
-
   /**
    * Special variation of BuildNixVector for when a node is sending to itself
    * \param [out] nixVector the NixVector to be used for routing
@@ -176,14 +142,6 @@ private:
    */
   uint32_t FindTotalNeighbors (void);
 
-  /**
-   * Determine if the NetDevice is bridged
-   * \param nd the NetDevice to check
-   * \returns the bridging NetDevice (or null if the NetDevice is not bridged)
-   */
-  Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd) const;
-
-
   /**
    * Nix index is with respect to the neighbors.  The net-device index must be
    * derived from this
@@ -194,19 +152,12 @@ private:
   uint32_t FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp);
 
   /**
-   * \brief Breadth first search algorithm.
-   * \param [in] numberOfNodes total number of nodes
-   * \param [in] source Source Node
-   * \param [in] dest Destination Node
-   * \param [out] parentVector Parent vector for retracing routes
-   * \param [in] oif specific output interface to use from source node, if not null
-   * \returns false if dest not found, true o.w.
+   * Notifies the shared topology graph that an interface
+   * went up or down
+   * \param interface the interface index
+   * \param up whether the interface is up
    */
-  bool BFS (uint32_t numberOfNodes,
-            Ptr<Node> source,
-            Ptr<Node> dest,
-            std::vector< Ptr<Node> > & parentVector,
-            Ptr<NetDevice> oif);
+  void NotifyInterfaceChange (uint32_t interface, bool up);
 
   void DoDispose (void);
 
@@ -227,12 +178,6 @@ private:
    */
   void CheckCacheStateAndFlush (void) const;
 
-  /**
-   * Flag to mark when caches are dirty and need to be flushed.  
-   * Used for lazy cleanup of caches when there are many topology changes.
-   */
-  static bool g_isCacheDirty;
-
   /** Cache stores nix-vectors based on destination ip */
   mutable NixMap_t m_nixCache;
 
@@ -242,8 +187,11 @@ private:
   Ptr<Ipv4> m_ipv4; //!< IPv4 object
   Ptr<Node> m_node; //!< Node object
 
-  /** Total neighbors used for nix-vector to determine number of bits */
-  uint32_t m_totalNeighbors;
+  /** Epoch of the topology graph when the caches were checked */
+  mutable uint32_t m_epoch;
+
+  /** Version of the nix-vectors of the node when the caches were checked */
+  mutable uint32_t m_version;
 };
 } // namespace ns3
 
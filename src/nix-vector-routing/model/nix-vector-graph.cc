@@ -0,0 +1,595 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/ipv4.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+
+#include "nix-vector-graph.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NixVectorGraph");
+
+/**
+ * \brief The number of threads which compute the BFS trees of nix-vector routing.
+ */
+static GlobalValue g_nixThreads = GlobalValue ("NixVectorRoutingThreads",
+                                               "The number of threads which precompute the BFS trees of nix-vector routing",
+                                               UintegerValue (1),
+                                               MakeUintegerChecker<uint32_t> (1));
+
+const uint32_t NixVectorGraph::NO_NODE;
+const uint32_t NixVectorGraph::SOURCE;
+
+NixVectorGraph::TreeWorker::TreeWorker (const NixVectorGraph *graph, const std::vector<uint32_t> *sources,
+                                        std::vector<std::vector<uint32_t> > *trees, uint32_t first, uint32_t stride)
+  : m_graph (graph),
+    m_sources (sources),
+    m_trees (trees),
+    m_first (first),
+    m_stride (stride)
+{
+}
+
+void
+NixVectorGraph::TreeWorker::Run (void)
+{
+  for (uint32_t i = m_first; i < m_sources->size (); i += m_stride)
+    {
+      m_graph->ComputeTree ((*m_sources)[i], NO_NODE, (*m_trees)[i]);
+    }
+}
+
+NixVectorGraph::NixVectorGraph ()
+  : m_built (false),
+    m_nNodes (0),
+    m_epoch (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NixVectorGraph::~NixVectorGraph ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NixVectorGraph::Build (void)
+{
+  if (m_built && m_nNodes == NodeList::GetNNodes ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  if (m_built)
+    {
+      // Nodes have been created since the graph was built
+      Invalidate ();
+    }
+
+  m_nNodes = NodeList::GetNNodes ();
+  m_slotOffset.assign (1, 0);
+  m_entryOffset.assign (1, 0);
+  m_slotDevice.clear ();
+  m_slotUp.clear ();
+  m_neighborNode.clear ();
+  m_neighborDevice.clear ();
+  m_nodeByIp.clear ();
+  m_trees.assign (m_nNodes, std::vector<uint32_t> ());
+  m_oifUsed.assign (m_nNodes, 0);
+  m_version.resize (m_nNodes, 0);
+
+  for (uint32_t n = 0; n < m_nNodes; n++)
+    {
+      Ptr<Node> node = NodeList::GetNode (n);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (i);
+          bool up = true;
+          if (ipv4)
+            {
+              int32_t interface = ipv4->GetInterfaceForDevice (device);
+              up = interface >= 0 && ipv4->IsUp (interface);
+            }
+          m_slotDevice.push_back (PeekPointer (device));
+          m_slotUp.push_back (up);
+
+          Ptr<Channel> channel = device->GetChannel ();
+          if (!device->IsBridge () && channel != 0)
+            {
+              NetDeviceContainer neighbors;
+              GetAdjacentNetDevices (device, channel, neighbors);
+              for (NetDeviceContainer::Iterator it = neighbors.Begin (); it != neighbors.End (); it++)
+                {
+                  m_neighborNode.push_back ((*it)->GetNode ()->GetId ());
+                  m_neighborDevice.push_back ((*it)->GetIfIndex ());
+                }
+            }
+          m_entryOffset.push_back (m_neighborNode.size ());
+        }
+      m_slotOffset.push_back (m_slotDevice.size ());
+
+      if (ipv4)
+        {
+          for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+            {
+              for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+                {
+                  // the first node of an address wins, as in a scan of the node list
+                  m_nodeByIp.insert (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), n));
+                }
+            }
+        }
+    }
+  m_built = true;
+  NS_LOG_LOGIC ("Built the graph of " << m_nNodes << " nodes, " << m_slotDevice.size ()
+                << " devices and " << m_neighborNode.size () << " adjacencies");
+}
+
+void
+NixVectorGraph::Invalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_built = false;
+  m_trees.clear ();
+  m_nodeByIp.clear ();
+  for (std::vector<uint32_t>::iterator it = m_version.begin (); it != m_version.end (); it++)
+    {
+      (*it)++;
+    }
+  m_epoch++;
+}
+
+uint32_t
+NixVectorGraph::GetEpoch (void) const
+{
+  return m_epoch;
+}
+
+uint32_t
+NixVectorGraph::GetVersion (uint32_t node) const
+{
+  return node < m_version.size () ? m_version[node] : 0;
+}
+
+uint32_t
+NixVectorGraph::GetNTrees (void) const
+{
+  uint32_t n = 0;
+  for (std::vector<std::vector<uint32_t> >::const_iterator it = m_trees.begin (); it != m_trees.end (); it++)
+    {
+      if (!it->empty ())
+        {
+          n++;
+        }
+    }
+  return n;
+}
+
+uint32_t
+NixVectorGraph::GetNodeByIp (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  Build ();
+  std::map<Ipv4Address, uint32_t>::const_iterator it = m_nodeByIp.find (address);
+  if (it == m_nodeByIp.end ())
+    {
+      NS_LOG_ERROR ("Couldn't find dest node given the IP" << address);
+      return NO_NODE;
+    }
+  return it->second;
+}
+
+uint32_t
+NixVectorGraph::GetNNeighbors (uint32_t node)
+{
+  Build ();
+  NS_ASSERT (node < m_nNodes);
+  return m_entryOffset[m_slotOffset[node + 1]] - m_entryOffset[m_slotOffset[node]];
+}
+
+uint32_t
+NixVectorGraph::FindNetDeviceForNixIndex (uint32_t node, uint32_t nixIndex, Ipv4Address &gatewayIp)
+{
+  NS_LOG_FUNCTION (this << node << nixIndex);
+  if (nixIndex >= GetNNeighbors (node))
+    {
+      NS_LOG_ERROR ("Nix index " << nixIndex << " out of range at node " << node);
+      return 0;
+    }
+  uint32_t entry = m_entryOffset[m_slotOffset[node]] + nixIndex;
+  Ptr<NetDevice> gatewayDevice = NodeList::GetNode (m_neighborNode[entry])->GetDevice (m_neighborDevice[entry]);
+  Ptr<Ipv4> ipv4 = gatewayDevice->GetNode ()->GetObject<Ipv4> ();
+  uint32_t interfaceIndex = ipv4->GetInterfaceForDevice (gatewayDevice);
+  gatewayIp = ipv4->GetAddress (interfaceIndex, 0).GetLocal ();
+  return GetSlotOfEntry (entry) - m_slotOffset[node];
+}
+
+Ptr<NixVector>
+NixVectorGraph::GetNixVector (uint32_t source, uint32_t dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << source << dest << oif);
+  Build ();
+  NS_ASSERT (source < m_nNodes && dest < m_nNodes);
+
+  if (oif)
+    {
+      NS_ASSERT (oif->GetNode ()->GetId () == source);
+      // The nix-vectors of the source no longer depend only on its tree
+      m_oifUsed[source] = 1;
+      std::vector<uint32_t> tree;
+      ComputeTree (source, m_slotOffset[source] + oif->GetIfIndex (), tree);
+      return BuildNixVector (tree, source, dest);
+    }
+
+  if (m_trees[source].empty ())
+    {
+      ComputeTree (source, NO_NODE, m_trees[source]);
+    }
+  return BuildNixVector (m_trees[source], source, dest);
+}
+
+void
+NixVectorGraph::Precompute (const std::vector<uint32_t> &sources)
+{
+  NS_LOG_FUNCTION (this << sources.size ());
+  Build ();
+
+  std::vector<uint32_t> missing;
+  for (std::vector<uint32_t>::const_iterator it = sources.begin (); it != sources.end (); it++)
+    {
+      NS_ASSERT (*it < m_nNodes);
+      if (m_trees[*it].empty () && std::find (missing.begin (), missing.end (), *it) == missing.end ())
+        {
+          missing.push_back (*it);
+        }
+    }
+
+  std::vector<std::vector<uint32_t> > trees (missing.size ());
+  uint32_t nThreads = GetNThreads (missing.size ());
+  if (nThreads <= 1)
+    {
+      TreeWorker (this, &missing, &trees, 0, 1).Run ();
+    }
+  else
+    {
+#ifdef HAVE_PTHREAD_H
+      NS_LOG_INFO ("Computing " << missing.size () << " BFS trees in " << nThreads << " threads");
+      std::vector<TreeWorker *> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          workers.push_back (new TreeWorker (this, &missing, &trees, t, nThreads));
+          threads.push_back (Create<SystemThread> (MakeCallback (&TreeWorker::Run, workers.back ())));
+          threads.back ()->Start ();
+        }
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads[t]->Join ();
+          delete workers[t];
+        }
+#endif /* HAVE_PTHREAD_H */
+    }
+
+  for (uint32_t i = 0; i < missing.size (); i++)
+    {
+      m_trees[missing[i]].swap (trees[i]);
+    }
+}
+
+void
+NixVectorGraph::NotifyInterfaceChange (uint32_t node, uint32_t ifIndex, bool up)
+{
+  NS_LOG_FUNCTION (this << node << ifIndex << up);
+  if (!m_built)
+    {
+      m_epoch++;
+      return;
+    }
+  if (node >= m_nNodes
+      || m_slotOffset[node + 1] - m_slotOffset[node] != NodeList::GetNode (node)->GetNDevices ()
+      || ifIndex >= m_slotOffset[node + 1] - m_slotOffset[node])
+    {
+      NS_LOG_LOGIC ("New device, rebuilding the graph");
+      Invalidate ();
+      return;
+    }
+
+  uint32_t slot = m_slotOffset[node] + ifIndex;
+  if ((m_slotUp[slot] != 0) == up)
+    {
+      return;
+    }
+  m_slotUp[slot] = up;
+  m_epoch++;
+
+  for (uint32_t source = 0; source < m_nNodes; source++)
+    {
+      if (m_oifUsed[source])
+        {
+          m_oifUsed[source] = 0;
+          m_version[source]++;
+        }
+      if (!m_trees[source].empty () && IsTreeAffected (m_trees[source], node, slot, up))
+        {
+          NS_LOG_LOGIC ("Dropping the BFS tree of node " << source);
+          m_trees[source].clear ();
+          m_version[source]++;
+        }
+    }
+}
+
+bool
+NixVectorGraph::IsTreeAffected (const std::vector<uint32_t> &tree, uint32_t node, uint32_t slot, bool up) const
+{
+  if (!up)
+    {
+      // The tree changes only if it goes through the links of the slot
+      for (uint32_t entry = m_entryOffset[slot]; entry < m_entryOffset[slot + 1]; entry++)
+        {
+          if (tree[m_neighborNode[entry]] == entry)
+            {
+              return true;
+            }
+        }
+      return false;
+    }
+
+  // The links of an unreachable node are not explored
+  if (tree[node] == NO_NODE)
+    {
+      return false;
+    }
+  // A neighbor discovered at a lower depth than through the new links
+  // keeps its parent.  At the same depth, the parent depends on the order
+  // of the BFS, so the tree is computed again.
+  uint32_t depth = GetDepth (tree, node) + 1;
+  for (uint32_t entry = m_entryOffset[slot]; entry < m_entryOffset[slot + 1]; entry++)
+    {
+      uint32_t neighbor = m_neighborNode[entry];
+      if (tree[neighbor] == NO_NODE || GetDepth (tree, neighbor) >= depth)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+uint32_t
+NixVectorGraph::GetDepth (const std::vector<uint32_t> &tree, uint32_t node) const
+{
+  uint32_t depth = 0;
+  while (tree[node] != SOURCE)
+    {
+      NS_ASSERT (tree[node] != NO_NODE);
+      node = GetNodeOfSlot (GetSlotOfEntry (tree[node]));
+      depth++;
+    }
+  return depth;
+}
+
+uint32_t
+NixVectorGraph::GetSlotOfEntry (uint32_t entry) const
+{
+  // the last slot starting at or before the entry, which cannot be empty
+  return std::upper_bound (m_entryOffset.begin (), m_entryOffset.end (), entry) - m_entryOffset.begin () - 1;
+}
+
+uint32_t
+NixVectorGraph::GetNodeOfSlot (uint32_t slot) const
+{
+  return std::upper_bound (m_slotOffset.begin (), m_slotOffset.end (), slot) - m_slotOffset.begin () - 1;
+}
+
+bool
+NixVectorGraph::IsSlotUp (uint32_t slot) const
+{
+  return m_slotUp[slot] && m_slotDevice[slot]->IsLinkUp ();
+}
+
+void
+NixVectorGraph::ComputeTree (uint32_t source, uint32_t oifSlot, std::vector<uint32_t> &tree) const
+{
+  NS_LOG_FUNCTION (this << source << oifSlot);
+
+  tree.assign (m_nNodes, NO_NODE);
+  tree[source] = SOURCE;
+  // discovered nodes, the nodes with unexplored children starting at head
+  std::vector<uint32_t> queue;
+  queue.push_back (source);
+
+  for (uint32_t head = 0; head < queue.size (); head++)
+    {
+      uint32_t node = queue[head];
+      uint32_t firstSlot = m_slotOffset[node];
+      uint32_t lastSlot = m_slotOffset[node + 1];
+      // if a specific output device was given, make sure we go this way
+      if (node == source && oifSlot != NO_NODE)
+        {
+          firstSlot = oifSlot;
+          lastSlot = oifSlot + 1;
+        }
+      for (uint32_t slot = firstSlot; slot < lastSlot; slot++)
+        {
+          if (m_entryOffset[slot] == m_entryOffset[slot + 1])
+            {
+              continue;
+            }
+          if (!IsSlotUp (slot))
+            {
+              NS_LOG_LOGIC ("Interface or link down at node " << node);
+              continue;
+            }
+          for (uint32_t entry = m_entryOffset[slot]; entry < m_entryOffset[slot + 1]; entry++)
+            {
+              uint32_t neighbor = m_neighborNode[entry];
+              if (tree[neighbor] == NO_NODE)
+                {
+                  tree[neighbor] = entry;
+                  queue.push_back (neighbor);
+                }
+            }
+        }
+    }
+}
+
+Ptr<NixVector>
+NixVectorGraph::BuildNixVector (const std::vector<uint32_t> &tree, uint32_t source, uint32_t dest) const
+{
+  NS_LOG_FUNCTION (this << source << dest);
+  if (tree[dest] == NO_NODE)
+    {
+      return 0;
+    }
+
+  // walk up the tree, from the last hop to the first one
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  uint32_t node = dest;
+  while (node != source)
+    {
+      uint32_t entry = tree[node];
+      uint32_t parent = GetNodeOfSlot (GetSlotOfEntry (entry));
+      uint32_t firstEntry = m_entryOffset[m_slotOffset[parent]];
+      uint32_t totalNeighbors = m_entryOffset[m_slotOffset[parent + 1]] - firstEntry;
+      NS_LOG_LOGIC ("Adding Nix: " << entry - firstEntry << " with "
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << parent);
+      nixVector->AddNeighborIndex (entry - firstEntry, nixVector->BitCount (totalNeighbors));
+      node = parent;
+    }
+  return nixVector;
+}
+
+uint32_t
+NixVectorGraph::GetNThreads (uint32_t nJobs) const
+{
+  NS_LOG_FUNCTION (this << nJobs);
+  UintegerValue threads;
+  g_nixThreads.GetValue (threads);
+  uint32_t n = std::min (threads.Get (), static_cast<uint64_t> (nJobs));
+#ifndef HAVE_PTHREAD_H
+  n = 1;
+#endif /* HAVE_PTHREAD_H */
+  if (n > 1)
+    {
+      // The logging of the BFS is not thread-safe.
+      LogComponent::ComponentList *components = LogComponent::GetComponentList ();
+      for (LogComponent::ComponentList::const_iterator i = components->begin ();
+           i != components->end (); i++)
+        {
+          if (!i->second->IsNoneEnabled ())
+            {
+              NS_LOG_INFO ("Logging is enabled, computing the BFS trees in a single thread");
+              return 1;
+            }
+        }
+    }
+  return n;
+}
+
+void
+NixVectorGraph::GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> remoteDevice = channel->GetDevice (i);
+      if (remoteDevice != netDevice)
+        {
+          Ptr<BridgeNetDevice> bd = NetDeviceIsBridged (remoteDevice);
+          // we have a bridged device, we need to add all
+          // bridged devices
+          if (bd)
+            {
+              NS_LOG_LOGIC ("Looking through bridge ports of bridge net device " << bd);
+              for (uint32_t j = 0; j < bd->GetNBridgePorts (); ++j)
+                {
+                  Ptr<NetDevice> ndBridged = bd->GetBridgePort (j);
+                  if (ndBridged == remoteDevice)
+                    {
+                      NS_LOG_LOGIC ("That bridge port is me, don't walk backward");
+                      continue;
+                    }
+                  Ptr<Channel> chBridged = ndBridged->GetChannel ();
+                  if (chBridged == 0)
+                    {
+                      continue;
+                    }
+                  GetAdjacentNetDevices (ndBridged, chBridged, netDeviceContainer);
+                }
+            }
+          else
+            {
+              netDeviceContainer.Add (channel->GetDevice (i));
+            }
+        }
+    }
+}
+
+Ptr<BridgeNetDevice>
+NixVectorGraph::NetDeviceIsBridged (Ptr<NetDevice> nd)
+{
+  NS_LOG_FUNCTION (nd);
+
+  Ptr<Node> node = nd->GetNode ();
+  uint32_t nDevices = node->GetNDevices ();
+
+  //
+  // There is no bit on a net device that says it is being bridged, so we have
+  // to look for bridges on the node to which the device is attached.  If we
+  // find a bridge, we need to look through its bridge ports (the devices it
+  // bridges) to see if we find the device in question.
+  //
+  for (uint32_t i = 0; i < nDevices; ++i)
+    {
+      Ptr<NetDevice> ndTest = node->GetDevice (i);
+      NS_LOG_LOGIC ("Examine device " << i << " " << ndTest);
+
+      if (ndTest->IsBridge ())
+        {
+          NS_LOG_LOGIC ("device " << i << " is a bridge net device");
+          Ptr<BridgeNetDevice> bnd = ndTest->GetObject<BridgeNetDevice> ();
+          NS_ABORT_MSG_UNLESS (bnd, "NixVectorGraph::NetDeviceIsBridged (): GetObject for <BridgeNetDevice> failed");
+
+          for (uint32_t j = 0; j < bnd->GetNBridgePorts (); ++j)
+            {
+              NS_LOG_LOGIC ("Examine bridge port " << j << " " << bnd->GetBridgePort (j));
+              if (bnd->GetBridgePort (j) == nd)
+                {
+                  NS_LOG_LOGIC ("Net device " << nd << " is bridged by " << bnd);
+                  return bnd;
+                }
+            }
+        }
+    }
+  NS_LOG_LOGIC ("Net device " << nd << " is not bridged");
+  return 0;
+}
+
+} // namespace ns3
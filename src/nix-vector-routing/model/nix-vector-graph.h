@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NIX_VECTOR_GRAPH_H
+#define NIX_VECTOR_GRAPH_H
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/ptr.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nix-vector.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/net-device-container.h"
+#include "ns3/bridge-net-device.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief Topology graph shared by the nix-vector routing protocols of
+ * all the nodes.
+ *
+ * The graph is built from the node list the first time a nix-vector is
+ * needed, and stored in compact adjacency arrays: the devices of node n
+ * are the slots m_slotOffset[n] to m_slotOffset[n + 1] - 1, in the order
+ * of their ifIndex, and the neighbors reached through slot s are the
+ * entries m_entryOffset[s] to m_entryOffset[s + 1] - 1.  The nix index
+ * of a neighbor of node n is thus the position of its entry among the
+ * entries of n.  Bridge devices and devices without a channel have no
+ * entries.
+ *
+ * The BFS tree of a source node, which gives the nix-vectors from this
+ * node to all the other nodes, is computed once and cached until a
+ * topology change may modify it.  When an interface goes up or down,
+ * only the trees which use, or may start using, the links of the
+ * interface are dropped; address changes and new nodes or devices
+ * rebuild the whole graph.  The routing protocols keep their own caches
+ * of nix-vectors and routes, and flush them lazily when the epoch or
+ * the version of their node has changed (see GetEpoch and GetVersion).
+ *
+ * A single instance is used for the whole simulation, through
+ * ns3::SimulationSingleton.
+ */
+class NixVectorGraph
+{
+public:
+  NixVectorGraph ();
+  ~NixVectorGraph ();
+
+  /**
+   * \brief Find the node of an address.
+   * \param address the address
+   * \returns the id of the first node which has the address, or
+   * NixVectorGraph::NO_NODE
+   */
+  uint32_t GetNodeByIp (Ipv4Address address);
+
+  /**
+   * \brief Build a nix-vector.
+   *
+   * If an output device is given, the path is computed for this call only.
+   * Otherwise the nix-vector is read from the cached BFS tree of the
+   * source, which is computed if needed.
+   *
+   * \param source the id of the source node
+   * \param dest the id of the destination node
+   * \param oif the output device to use on the source node, or 0
+   * \returns the nix-vector, or 0 if there is no path
+   */
+  Ptr<NixVector> GetNixVector (uint32_t source, uint32_t dest, Ptr<NetDevice> oif);
+
+  /**
+   * \param node the id of a node
+   * \returns the number of neighbors of the node, which sets the number
+   * of bits of its nix indexes
+   */
+  uint32_t GetNNeighbors (uint32_t node);
+
+  /**
+   * \brief Find the output device and the gateway of a nix index.
+   * \param [in] node the id of the node
+   * \param [in] nixIndex the nix index
+   * \param [out] gatewayIp the address of the neighbor on the link
+   * \returns the index of the output device in the node
+   */
+  uint32_t FindNetDeviceForNixIndex (uint32_t node, uint32_t nixIndex, Ipv4Address &gatewayIp);
+
+  /**
+   * \brief Compute the BFS trees of some sources in advance.
+   *
+   * The trees are computed by as many threads as the global value
+   * "NixVectorRoutingThreads", if the simulator is built with thread
+   * support and no logging is enabled.
+   *
+   * \param sources the ids of the source nodes
+   */
+  void Precompute (const std::vector<uint32_t> &sources);
+
+  /**
+   * \brief Update the graph when an interface goes up or down.
+   *
+   * Only the cached BFS trees which may be modified by the change are
+   * dropped.
+   *
+   * \param node the id of the node
+   * \param ifIndex the index of the device of the interface in the node
+   * \param up whether the interface is up
+   */
+  void NotifyInterfaceChange (uint32_t node, uint32_t ifIndex, bool up);
+
+  /**
+   * \brief Drop the whole graph, which is built again on the next request.
+   */
+  void Invalidate (void);
+
+  /**
+   * \returns a counter incremented on each topology change, after which
+   * the caches of routes must be flushed
+   */
+  uint32_t GetEpoch (void) const;
+
+  /**
+   * \param node the id of a node
+   * \returns a counter incremented each time the nix-vectors from the node
+   * may have changed
+   */
+  uint32_t GetVersion (uint32_t node) const;
+
+  /**
+   * \returns the number of BFS trees in the cache
+   */
+  uint32_t GetNTrees (void) const;
+
+  /// The id returned when no node is found
+  static const uint32_t NO_NODE = 0xffffffff;
+
+private:
+  /**
+   * \brief Compute the BFS trees of some sources in a worker thread.
+   */
+  class TreeWorker
+  {
+  public:
+    /**
+     * \param graph the graph
+     * \param sources the ids of the source nodes
+     * \param trees the trees of the sources
+     * \param first the index of the first source of the worker
+     * \param stride the number of workers
+     */
+    TreeWorker (const NixVectorGraph *graph, const std::vector<uint32_t> *sources,
+                std::vector<std::vector<uint32_t> > *trees, uint32_t first, uint32_t stride);
+    /// Compute the trees of the worker
+    void Run (void);
+
+  private:
+    const NixVectorGraph *m_graph;                  //!< the graph
+    const std::vector<uint32_t> *m_sources;         //!< the ids of the source nodes
+    std::vector<std::vector<uint32_t> > *m_trees;   //!< the trees of the sources
+    uint32_t m_first;                               //!< the index of the first source
+    uint32_t m_stride;                              //!< the number of workers
+  };
+
+  /// Build the graph if it is missing or if nodes have been created
+  void Build (void);
+
+  /**
+   * \brief Compute a BFS tree.
+   *
+   * The tree stores, for each node, the entry through which the node
+   * was discovered, NO_NODE if the node is not reachable, and SOURCE for
+   * the source.  This method only reads the graph and the state of the
+   * devices, so that trees can be computed by several threads.
+   *
+   * \param [in] source the id of the source node
+   * \param [in] oifSlot the only slot to use from the source, or NO_NODE
+   * \param [out] tree the BFS tree
+   */
+  void ComputeTree (uint32_t source, uint32_t oifSlot, std::vector<uint32_t> &tree) const;
+
+  /**
+   * \brief Build a nix-vector from a BFS tree.
+   * \param tree the BFS tree of the source
+   * \param source the id of the source node
+   * \param dest the id of the destination node
+   * \returns the nix-vector, or 0 if the destination is not reachable
+   */
+  Ptr<NixVector> BuildNixVector (const std::vector<uint32_t> &tree, uint32_t source, uint32_t dest) const;
+
+  /**
+   * \brief Check whether an interface change may modify a BFS tree.
+   * \param tree the BFS tree
+   * \param node the id of the node of the interface
+   * \param slot the slot of the interface
+   * \param up whether the interface is now up
+   * \returns true if the tree must be computed again
+   */
+  bool IsTreeAffected (const std::vector<uint32_t> &tree, uint32_t node, uint32_t slot, bool up) const;
+
+  /**
+   * \param tree a BFS tree
+   * \param node the id of a node reachable in the tree
+   * \returns the number of hops from the source of the tree to the node
+   */
+  uint32_t GetDepth (const std::vector<uint32_t> &tree, uint32_t node) const;
+
+  /**
+   * \param entry an entry
+   * \returns the slot of the entry
+   */
+  uint32_t GetSlotOfEntry (uint32_t entry) const;
+
+  /**
+   * \param slot a slot
+   * \returns the id of the node of the slot
+   */
+  uint32_t GetNodeOfSlot (uint32_t slot) const;
+
+  /**
+   * \param slot a slot
+   * \returns true if the interface and the link of the slot are up
+   */
+  bool IsSlotUp (uint32_t slot) const;
+
+  /**
+   * \brief Get the number of threads which compute the trees.
+   * \param nJobs the number of trees to compute
+   * \returns the number of threads
+   */
+  uint32_t GetNThreads (uint32_t nJobs) const;
+
+  /**
+   * Given a net-device returns all the adjacent net-devices,
+   * essentially getting the neighbors on that channel
+   * \param [in] netDevice the NetDevice attached to the channel.
+   * \param [in] channel the channel to check
+   * \param [out] netDeviceContainer the NetDeviceContainer of the NetDevices in the channel.
+   */
+  static void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
+
+  /**
+   * Determine if the NetDevice is bridged
+   * \param nd the NetDevice to check
+   * \returns the bridging NetDevice (or null if the NetDevice is not bridged)
+   */
+  static Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd);
+
+  /// The tree value of the source node
+  static const uint32_t SOURCE = 0xfffffffe;
+
+  bool m_built;                               //!< whether the graph is built
+  uint32_t m_nNodes;                          //!< the number of nodes in the graph
+  std::vector<uint32_t> m_slotOffset;         //!< the first slot of each node
+  std::vector<uint32_t> m_entryOffset;        //!< the first entry of each slot
+  std::vector<NetDevice *> m_slotDevice;      //!< the device of each slot
+  std::vector<uint8_t> m_slotUp;              //!< whether the interface of each slot is up
+  std::vector<uint32_t> m_neighborNode;       //!< the neighbor node of each entry
+  std::vector<uint32_t> m_neighborDevice;     //!< the index of the neighbor device of each entry
+  std::map<Ipv4Address, uint32_t> m_nodeByIp; //!< the node of each address
+  std::vector<std::vector<uint32_t> > m_trees; //!< the BFS tree of each source, if computed
+  std::vector<uint8_t> m_oifUsed;             //!< whether a node built nix-vectors for an output device
+  std::vector<uint32_t> m_version;            //!< the version of the nix-vectors of each node
+  uint32_t m_epoch;                           //!< the topology change counter
+};
+
+} // namespace ns3
+
+#endif /* NIX_VECTOR_GRAPH_H */
@@ -0,0 +1,343 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/node-container.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/nix-vector-graph.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \defgroup nix-vector-routing-test Nix-vector routing tests
+ */
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Build a ring of nodes with nix-vector routing.
+ *
+ * Node i is linked to node i + 1 by its device 1, and to node i - 1 by
+ * its device 2; device 0 is the loopback.  Link i is 10.0.i.0/24.
+ *
+ * \param nodes the nodes of the ring
+ */
+static void
+BuildRing (NodeContainer &nodes)
+{
+  Ipv4NixVectorHelper nixRouting;
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (nixRouting);
+  internet.Install (nodes);
+
+  uint32_t n = nodes.GetN ();
+  std::vector<Ptr<SimpleNetDevice> > right (n);
+  std::vector<Ptr<SimpleNetDevice> > left (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      right[i] = CreateObject<SimpleNetDevice> ();
+      right[i]->SetAddress (Mac48Address::Allocate ());
+      nodes.Get (i)->AddDevice (right[i]);
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      left[(i + 1) % n] = CreateObject<SimpleNetDevice> ();
+      left[(i + 1) % n]->SetAddress (Mac48Address::Allocate ());
+      nodes.Get ((i + 1) % n)->AddDevice (left[(i + 1) % n]);
+    }
+  Ipv4AddressHelper address;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      right[i]->SetChannel (channel);
+      left[(i + 1) % n]->SetChannel (channel);
+      NetDeviceContainer link;
+      link.Add (right[i]);
+      link.Add (left[(i + 1) % n]);
+      std::ostringstream base;
+      base << "10.0." << i << ".0";
+      address.SetBase (base.str ().c_str (), "255.255.255.0");
+      address.Assign (link);
+    }
+}
+
+/**
+ * \param nixVector a nix-vector, or 0
+ * \returns the text of the nix-vector
+ */
+static std::string
+NixToString (Ptr<NixVector> nixVector)
+{
+  std::ostringstream oss;
+  if (nixVector)
+    {
+      oss << *nixVector;
+    }
+  else
+    {
+      oss << "none";
+    }
+  return oss.str ();
+}
+
+/**
+ * \param first the nix index at the source
+ * \param second the nix index at the next hop
+ * \returns the text of a two-hop nix-vector in a ring
+ */
+static std::string
+TwoHopNix (uint32_t first, uint32_t second)
+{
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  nixVector->AddNeighborIndex (second, 1);
+  nixVector->AddNeighborIndex (first, 1);
+  return NixToString (nixVector);
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Check the incremental invalidation of the shared BFS trees.
+ */
+class NixVectorGraphInvalidationTestCase : public TestCase
+{
+public:
+  NixVectorGraphInvalidationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NixVectorGraphInvalidationTestCase::NixVectorGraphInvalidationTestCase ()
+  : TestCase ("Check the incremental invalidation of the nix-vector BFS trees")
+{
+}
+
+void
+NixVectorGraphInvalidationTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  BuildRing (nodes);
+  NixVectorGraph *graph = SimulationSingleton<NixVectorGraph>::Get ();
+  Ptr<Ipv4> ipv4Node0 = nodes.Get (0)->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4Node2 = nodes.Get (2)->GetObject<Ipv4> ();
+  uint32_t toNode1 = ipv4Node0->GetInterfaceForDevice (nodes.Get (0)->GetDevice (1));
+  uint32_t toNode3 = ipv4Node2->GetInterfaceForDevice (nodes.Get (2)->GetDevice (1));
+
+  // 0 -> 1 -> 2: the neighbors are ordered by device
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNNeighbors (0), 2, "Each node has two neighbors");
+  NS_TEST_EXPECT_MSG_EQ (NixToString (graph->GetNixVector (0, 2, 0)), TwoHopNix (0, 0), "Path through node 1");
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNTrees (), 1, "The tree of node 0 is cached");
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNodeByIp (Ipv4Address ("10.0.1.2")), 2, "Address of node 2");
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNodeByIp (Ipv4Address ("10.0.9.1")), NixVectorGraph::NO_NODE, "Unknown address");
+  uint32_t version = graph->GetVersion (0);
+  uint32_t epoch = graph->GetEpoch ();
+
+  // the link from node 2 to node 3 is not in the tree of node 0
+  ipv4Node2->SetDown (toNode3);
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNTrees (), 1, "The tree of node 0 does not use the link");
+  ipv4Node2->SetUp (toNode3);
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNTrees (), 1, "The link does not shorten the tree of node 0");
+  NS_TEST_EXPECT_MSG_EQ (graph->GetVersion (0), version, "The nix-vectors of node 0 are kept");
+  NS_TEST_EXPECT_MSG_GT (graph->GetEpoch (), epoch, "The routes are flushed");
+
+  // the link from node 0 to node 1 is in the tree of node 0
+  ipv4Node0->SetDown (toNode1);
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNTrees (), 0, "The tree of node 0 uses the link");
+  NS_TEST_EXPECT_MSG_NE (graph->GetVersion (0), version, "The nix-vectors of node 0 are flushed");
+  NS_TEST_EXPECT_MSG_EQ (NixToString (graph->GetNixVector (0, 2, 0)), TwoHopNix (1, 1), "Path through node 3");
+  NS_TEST_EXPECT_MSG_EQ (NixToString (graph->GetNixVector (0, 2, nodes.Get (0)->GetDevice (1))), "none",
+                         "No path through a down interface");
+  ipv4Node0->SetUp (toNode1);
+  NS_TEST_EXPECT_MSG_EQ (graph->GetNTrees (), 0, "The link shortens the tree of node 0");
+  NS_TEST_EXPECT_MSG_EQ (NixToString (graph->GetNixVector (0, 2, 0)), TwoHopNix (0, 0), "Path through node 1 again");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Check that precomputed trees give the same nix-vectors.
+ */
+class NixVectorGraphPrecomputeTestCase : public TestCase
+{
+public:
+  NixVectorGraphPrecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NixVectorGraphPrecomputeTestCase::NixVectorGraphPrecomputeTestCase ()
+  : TestCase ("Check the parallel precomputation of the nix-vector BFS trees")
+{
+}
+
+void
+NixVectorGraphPrecomputeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (9);
+  BuildRing (nodes);
+
+  GlobalValue::Bind ("NixVectorRoutingThreads", UintegerValue (3));
+  NixVectorGraph precomputed;
+  std::vector<uint32_t> sources;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      sources.push_back (i);
+    }
+  precomputed.Precompute (sources);
+  GlobalValue::Bind ("NixVectorRoutingThreads", UintegerValue (1));
+  NS_TEST_EXPECT_MSG_EQ (precomputed.GetNTrees (), nodes.GetN (), "All the trees are computed");
+
+  NixVectorGraph onDemand;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < nodes.GetN (); j++)
+        {
+          if (i != j)
+            {
+              NS_TEST_EXPECT_MSG_EQ (NixToString (precomputed.GetNixVector (i, j, 0)),
+                                     NixToString (onDemand.GetNixVector (i, j, 0)),
+                                     "Same nix-vector from " << i << " to " << j);
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes follow an interface going down.
+ */
+class NixVectorRoutingInterfaceDownTestCase : public TestCase
+{
+public:
+  NixVectorRoutingInterfaceDownTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive the datagrams
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  /**
+   * \brief Send a datagram
+   * \param socket the sending socket
+   */
+  void Send (Ptr<Socket> socket);
+
+  uint32_t m_received; //!< Number of datagrams received
+};
+
+NixVectorRoutingInterfaceDownTestCase::NixVectorRoutingInterfaceDownTestCase ()
+  : TestCase ("Check the nix-vector routes after an interface goes down"),
+    m_received (0)
+{
+}
+
+void
+NixVectorRoutingInterfaceDownTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+NixVectorRoutingInterfaceDownTestCase::Send (Ptr<Socket> socket)
+{
+  socket->Send (Create<Packet> (100));
+}
+
+void
+NixVectorRoutingInterfaceDownTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  BuildRing (nodes);
+  Ipv4NixVectorHelper::PrecomputeRoutes ();
+
+  uint16_t port = 9;
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  sink->SetRecvCallback (MakeCallback (&NixVectorRoutingInterfaceDownTestCase::Receive, this));
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  source->Connect (InetSocketAddress (Ipv4Address ("10.0.1.2"), port));
+
+  // the first datagram goes through node 1, the second one through node 3
+  Ptr<Ipv4> ipv4 = nodes.Get (1)->GetObject<Ipv4> ();
+  uint32_t toNode2 = ipv4->GetInterfaceForDevice (nodes.Get (1)->GetDevice (1));
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingInterfaceDownTestCase::Send, this, source);
+  Simulator::Schedule (Seconds (2), &Ipv4::SetDown, ipv4, toNode2);
+  Simulator::Schedule (Seconds (3), &NixVectorRoutingInterfaceDownTestCase::Send, this, source);
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2, "Both datagrams should be received");
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing TestSuite
+ */
+class NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  NixVectorRoutingTestSuite ();
+};
+
+NixVectorRoutingTestSuite::NixVectorRoutingTestSuite ()
+  : TestSuite ("nix-vector-routing", UNIT)
+{
+  AddTestCase (new NixVectorGraphInvalidationTestCase, TestCase::QUICK);
+  AddTestCase (new NixVectorGraphPrecomputeTestCase, TestCase::QUICK);
+  AddTestCase (new NixVectorRoutingInterfaceDownTestCase, TestCase::QUICK);
+}
+
+static NixVectorRoutingTestSuite g_nixVectorRoutingTestSuite; //!< Static variable for test initialization
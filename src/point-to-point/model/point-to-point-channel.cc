@@ -22,6 +22,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 namespace ns3 {
 
@@ -40,6 +41,13 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("CoalesceDeliveries",
+                   "Whether the packets sent back to back on a wire are delivered by "
+                   "a single pending event, which is rescheduled at the reception time "
+                   "of each packet, instead of by one event per packet",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::m_coalesce),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,7 +65,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_coalesce (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -80,6 +89,8 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      m_link[0].m_deliver = Ptr<EventImpl> (MakeEvent (&PointToPointChannel::Deliver, this, 0), false);
+      m_link[1].m_deliver = Ptr<EventImpl> (MakeEvent (&PointToPointChannel::Deliver, this, 1), false);
     }
 }
 
@@ -96,16 +107,78 @@ PointToPointChannel::TransmitStart (
   NS_ASSERT (m_link[1].m_state != INITIALIZING);
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  Link &link = m_link[wire];
+  Time rxTime = Simulator::Now () + txTime + m_delay;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+  // Packets sent back to back are received in order, unless the delay of the
+  // channel has been reduced while they were propagating
+  if (m_coalesce && (link.m_inFlight.empty () || link.m_inFlight.back ().first <= rxTime))
+    {
+      // The packet is only copied at delivery if the sender still uses it
+      link.m_inFlight.push_back (std::make_pair (rxTime, p));
+      if (link.m_inFlight.size () == 1)
+        {
+          ScheduleDelivery (wire, txTime + m_delay);
+        }
+    }
+  else
+    {
+      Simulator::ScheduleWithContext (link.m_dst->GetNode ()->GetId (),
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      link.m_dst, p->Copy ());
+    }
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
   return true;
 }
 
+void
+PointToPointChannel::Deliver (uint32_t wire)
+{
+  NS_LOG_FUNCTION (this << wire);
+  Link &link = m_link[wire];
+  Time now = Simulator::Now ();
+  NS_ASSERT (!link.m_inFlight.empty () && link.m_inFlight.front ().first == now);
+
+  // Take the packets received now off the wire, and schedule the next
+  // delivery before their reception, so that it precedes the events that
+  // the reception schedules at the same time
+  NS_ASSERT (link.m_received.empty ());
+  while (!link.m_inFlight.empty () && link.m_inFlight.front ().first == now)
+    {
+      link.m_received.push_back (link.m_inFlight.front ().second);
+      link.m_inFlight.pop_front ();
+    }
+  if (!link.m_inFlight.empty ())
+    {
+      ScheduleDelivery (wire, link.m_inFlight.front ().first - now);
+    }
+
+  for (std::vector<Ptr<const Packet> >::iterator i = link.m_received.begin (); i != link.m_received.end (); ++i)
+    {
+      // The receiving device strips the headers of the packet, which is only
+      // copied if the sender or a trace sink still holds it
+      Ptr<const Packet> p = *i;
+      *i = 0;
+      link.m_dst->Receive (p->GetReferenceCount () == 1 ? ConstCast<Packet> (p) : p->Copy ());
+    }
+  link.m_received.clear ();
+}
+
+void
+PointToPointChannel::ScheduleDelivery (uint32_t wire, Time delay)
+{
+  NS_LOG_FUNCTION (this << wire << delay);
+  Link &link = m_link[wire];
+
+  // The same event is scheduled again for each reception time, to save its
+  // allocation.  The simulator releases a reference to the event once it
+  // has run, hence the reference taken here.
+  link.m_deliver->Ref ();
+  Simulator::ScheduleWithContext (link.m_dst->GetNode ()->GetId (), delay, PeekPointer (link.m_deliver));
+}
+
 uint32_t 
 PointToPointChannel::GetNDevices (void) const
 {
@@ -20,11 +20,15 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <deque>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
+#include "ns3/packet.h"
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+#include "ns3/event-impl.h"
 
 namespace ns3 {
 
@@ -73,6 +77,11 @@ public:
 
   /**
    * \brief Transmit a packet over this channel
+   *
+   * If the CoalesceDeliveries attribute is true, the packet is delivered by
+   * the event which delivers the packets already propagating on the same
+   * wire, if any, instead of by an event of its own.
+   *
    * \param p Packet to transmit
    * \param src Source PointToPointNetDevice
    * \param txTime Transmit time to apply
@@ -149,8 +158,27 @@ private:
   /** Each point to point link has exactly two net devices. */
   static const int N_DEVICES = 2;
 
+  /**
+   * \brief Deliver the packets propagating on a wire which are received now
+   *
+   * The delivery of the next packet, if any, is scheduled at its reception
+   * time, so that a wire has at most one delivery event pending.
+   *
+   * \param wire the wire
+   */
+  void Deliver (uint32_t wire);
+
+  /**
+   * \brief Schedule the delivery event of a wire
+   *
+   * \param wire the wire
+   * \param delay the time to the reception of the next packet
+   */
+  void ScheduleDelivery (uint32_t wire, Time delay);
+
   Time          m_delay;    //!< Propagation delay
   int32_t       m_nDevices; //!< Devices of this channel
+  bool          m_coalesce; //!< Whether the deliveries of back-to-back packets are coalesced
 
   /**
    * The trace source for the packet transmission animation events that the 
@@ -199,6 +227,13 @@ public:
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    /// The packets propagating on the wire, with their reception time, in
+    /// the order of their reception (only used if deliveries are coalesced)
+    std::deque<std::pair<Time, Ptr<const Packet> > > m_inFlight;
+    /// The packets being delivered
+    std::vector<Ptr<const Packet> > m_received;
+    /// The delivery event, which is scheduled again for each reception time
+    Ptr<EventImpl>             m_deliver;
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
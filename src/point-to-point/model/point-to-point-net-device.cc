@@ -25,9 +25,12 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/segment-offload-tag.h"
 #include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
+#include "point-to-point-load-model.h"
 #include "ppp-header.h"
 
 namespace ns3 {
@@ -63,11 +66,23 @@ PointToPointNetDevice::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&PointToPointNetDevice::m_receiveErrorModel),
                    MakePointerChecker<ErrorModel> ())
+    .AddAttribute ("LoadModel",
+                   "The model of the load of the transmitter by traffic "
+                   "which is not simulated as packets",
+                   PointerValue (),
+                   MakePointerAccessor (&PointToPointNetDevice::m_loadModel),
+                   MakePointerChecker<PointToPointLoadModel> ())
     .AddAttribute ("InterframeGap", 
                    "The time to wait between packet (frame) transmissions",
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("SegmentOffload",
+                   "Whether super-segments (see SegmentOffloadTag) are sent as a burst "
+                   "of back-to-back frames instead of being split before the device",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_segmentOffload),
+                   MakeBooleanChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -248,6 +263,7 @@ PointToPointNetDevice::DoDispose ()
   m_node = 0;
   m_channel = 0;
   m_receiveErrorModel = 0;
+  m_loadModel = 0;
   m_currentPkt = 0;
   m_queue = 0;
   m_queueInterface = 0;
@@ -284,8 +300,29 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
-  Time txCompleteTime = txTime + m_tInterframeGap;
+  Time txTime;
+  Time txCompleteTime;
+  SegmentOffloadTag offloadTag;
+  if (m_segmentOffload && p->PeekPacketTag (offloadTag))
+    {
+      // A super-segment is sent as its segments back to back, each one
+      // with its own headers and followed by an interframe gap
+      txTime = m_bps.CalculateBytesTxTime (offloadTag.GetWireSize (p->GetSize ()));
+      txCompleteTime = txTime + m_tInterframeGap * offloadTag.GetSegments ();
+    }
+  else
+    {
+      txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+      txCompleteTime = txTime + m_tInterframeGap;
+    }
+
+  if (m_loadModel)
+    {
+      // The packet waits for the traffic of the load model which is ahead of it
+      Time wait = m_loadModel->StartTransmission (p, txTime);
+      txTime += wait;
+      txCompleteTime += wait;
+    }
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
   Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
@@ -364,6 +401,13 @@ PointToPointNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
   m_receiveErrorModel = em;
 }
 
+void
+PointToPointNetDevice::SetLoadModel (Ptr<PointToPointLoadModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_loadModel = model;
+}
+
 void
 PointToPointNetDevice::Receive (Ptr<Packet> packet)
 {
@@ -567,6 +611,16 @@ PointToPointNetDevice::Send (
 
   m_macTxTrace (packet);
 
+  //
+  // The packet may be lost because the transmitter is overloaded by the
+  // traffic of the load model
+  //
+  if (m_loadModel && m_loadModel->IsLost (packet))
+    {
+      m_macTxDropTrace (packet);
+      return false;
+    }
+
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
   //
@@ -592,6 +646,59 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBulk (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  //
+  // Same as Send for each packet, but the link state and the transmission
+  // queue are looked up once for the whole burst.
+  //
+  if (IsLinkUp () == false)
+    {
+      for (uint32_t i = 0; i < items.size (); i++)
+        {
+          m_macTxDropTrace (items[i]->GetPacket ());
+        }
+      return items.size ();
+    }
+
+  Ptr<NetDeviceQueue> txq;
+  if (m_queueInterface)
+    {
+      txq = m_queueInterface->GetTxQueue (0);
+    }
+
+  uint32_t sent = 0;
+  for (; sent < items.size (); sent++)
+    {
+      if (txq && txq->IsStopped ())
+        {
+          break;
+        }
+
+      Ptr<Packet> packet = items[sent]->GetPacket ();
+      AddHeader (packet, items[sent]->GetProtocol ());
+      m_macTxTrace (packet);
+
+      if ((m_loadModel && m_loadModel->IsLost (packet)) || !m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+
+      if (m_txMachineState == READY)
+        {
+          packet = m_queue->Dequeue ();
+          m_snifferTrace (packet);
+          m_promiscSnifferTrace (packet);
+          TransmitStart (packet);
+        }
+    }
+  return sent;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
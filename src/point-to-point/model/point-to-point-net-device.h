@@ -37,6 +37,7 @@ template <typename Item> class Queue;
 class NetDeviceQueueInterface;
 class PointToPointChannel;
 class ErrorModel;
+class PointToPointLoadModel;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -138,6 +139,17 @@ public:
    */
   void SetReceiveErrorModel (Ptr<ErrorModel> em);
 
+  /**
+   * Attach a model of the load of the transmitter by traffic which is not
+   * simulated as packets.
+   *
+   * The load model may drop the packets sent to the device and delay their
+   * transmission (see PointToPointLoadModel).
+   *
+   * \param model Ptr to the load model.
+   */
+  void SetLoadModel (Ptr<PointToPointLoadModel> model);
+
   /**
    * Receive a packet from a connected PointToPointChannel.
    *
@@ -178,6 +190,7 @@ public:
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual uint32_t SendBulk (const std::vector<Ptr<QueueDiscItem> > &items);
 
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
@@ -311,6 +324,12 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * Whether super-segments (see SegmentOffloadTag) are sent as a burst of
+   * back-to-back frames rather than being split by the upper layers
+   */
+  bool           m_segmentOffload;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
@@ -330,6 +349,11 @@ private:
    */
   Ptr<ErrorModel> m_receiveErrorModel;
 
+  /**
+   * Load of the transmitter by the traffic which is not simulated as packets
+   */
+  Ptr<PointToPointLoadModel> m_loadModel;
+
   /**
    * The trace source fired when packets come into the "top" of the device
    * at the L3/L2 transition, before being queued for transmission.
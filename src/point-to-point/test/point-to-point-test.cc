@@ -24,6 +24,9 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/segment-offload-tag.h"
+#include "ns3/data-rate.h"
+#include "ns3/boolean.h"
 
 using namespace ns3;
 
@@ -101,6 +104,203 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the transmission time of a super-segment
+ *
+ * A super-segment takes the time of all its segments, each one with its
+ * own headers, unless the device does not carry super-segments.
+ */
+class PointToPointSegmentOffloadTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   * \param offload whether the device carries super-segments
+   */
+  PointToPointSegmentOffloadTest (bool offload);
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Record the end of a transmission
+   *
+   * \param p the packet
+   */
+  void TxEnd (Ptr<const Packet> p);
+
+  bool m_offload; //!< Whether the device carries super-segments
+  Time m_txEnd;   //!< End of the transmission
+};
+
+PointToPointSegmentOffloadTest::PointToPointSegmentOffloadTest (bool offload)
+  : TestCase (offload ? "PointToPoint super-segment" : "PointToPoint super-segment without offload"),
+    m_offload (offload)
+{
+}
+
+void
+PointToPointSegmentOffloadTest::TxEnd (Ptr<const Packet> p)
+{
+  m_txEnd = Simulator::Now ();
+}
+
+void
+PointToPointSegmentOffloadTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->SetAttribute ("SegmentOffload", BooleanValue (m_offload));
+  devA->TraceConnectWithoutContext ("PhyTxEnd", MakeCallback (&PointToPointSegmentOffloadTest::TxEnd, this));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  // 100 bytes of headers and 4 segments of 1000 bytes, plus the 2 bytes of
+  // the PPP header added by the device
+  Ptr<Packet> p = Create<Packet> (4100);
+  p->AddPacketTag (SegmentOffloadTag (1000, 4000));
+  Simulator::Schedule (Seconds (1.0), &PointToPointNetDevice::Send, devA, p, devA->GetBroadcast (), 0x800);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // At 8 Mbps, one byte takes one microsecond
+  uint32_t bytes = m_offload ? 4000 + 4 * 102 : 4102;
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_txEnd, Seconds (1.0) + MicroSeconds (bytes), NanoSeconds (1), "Wrong transmission time");
+}
+
+/**
+ * \brief Test the coalesced deliveries of back-to-back packets
+ *
+ * A burst of packets is received at the same times, whether the deliveries
+ * are coalesced or not, also when the delay of the channel is reduced while
+ * packets are propagating.
+ */
+class PointToPointCoalesceTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointCoalesceTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets and record their reception times
+   *
+   * \param coalesce whether the deliveries are coalesced
+   * \return the reception times
+   */
+  std::vector<Time> RunOnce (bool coalesce);
+
+  /**
+   * \brief Send packets back to back
+   *
+   * \param device the sending device
+   * \param n the number of packets
+   */
+  static void SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n);
+
+  /**
+   * \brief Record the reception of a packet
+   *
+   * \param p the packet
+   */
+  void Rx (Ptr<const Packet> p);
+
+  std::vector<Time> m_rxTimes; //!< Reception times
+};
+
+PointToPointCoalesceTest::PointToPointCoalesceTest ()
+  : TestCase ("PointToPoint coalesced deliveries")
+{
+}
+
+void
+PointToPointCoalesceTest::SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (998), device->GetBroadcast (), 0x800);
+    }
+}
+
+void
+PointToPointCoalesceTest::Rx (Ptr<const Packet> p)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+}
+
+std::vector<Time>
+PointToPointCoalesceTest::RunOnce (bool coalesce)
+{
+  m_rxTimes.clear ();
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  channel->SetAttribute ("CoalesceDeliveries", BooleanValue (coalesce));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->TraceConnectWithoutContext ("MacRx", MakeCallback (&PointToPointCoalesceTest::Rx, this));
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  // Packets of 1000 bytes take 1 ms each, hence 12 of them are propagating
+  // when the delay is halved and the following ones overtake some of them
+  Simulator::Schedule (Seconds (1.0), &PointToPointCoalesceTest::SendBurst, devA, 20);
+  Simulator::Schedule (Seconds (1.0) + MicroSeconds (12500), &PointToPointChannel::SetAttribute,
+                       channel, "Delay", TimeValue (MilliSeconds (5)));
+  Simulator::Schedule (Seconds (2.0), &PointToPointCoalesceTest::SendBurst, devA, 5);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_rxTimes;
+}
+
+void
+PointToPointCoalesceTest::DoRun (void)
+{
+  std::vector<Time> rxTimes = RunOnce (false);
+  std::vector<Time> coalescedRxTimes = RunOnce (true);
+
+  NS_TEST_ASSERT_MSG_EQ (rxTimes.size (), 25, "Wrong number of packets received");
+  NS_TEST_ASSERT_MSG_EQ (coalescedRxTimes.size (), 25, "Wrong number of packets received with coalesced deliveries");
+  for (uint32_t i = 0; i < rxTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (coalescedRxTimes[i], rxTimes[i], "Packet " << i << " received at a different time");
+    }
+  // The last packet starts 4 ms after the second burst and takes 1 ms plus the new delay
+  NS_TEST_EXPECT_MSG_EQ (coalescedRxTimes[24], Seconds (2.0) + MilliSeconds (10), "Wrong reception time");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -117,6 +317,9 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointSegmentOffloadTest (true), TestCase::QUICK);
+  AddTestCase (new PointToPointSegmentOffloadTest (false), TestCase::QUICK);
+  AddTestCase (new PointToPointCoalesceTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
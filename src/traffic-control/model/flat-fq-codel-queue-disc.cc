@@ -0,0 +1,651 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "flat-fq-codel-queue-disc.h"
+#include "codel-queue-disc.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlatFqCoDelQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (FlatFqCoDelQueueDisc);
+
+/// The index of a missing flow or packet slot
+static const uint32_t NONE = 0xffffffff;
+
+/**
+ * Performs a reciprocal divide, similar to the
+ * Linux kernel reciprocal_divide function
+ * \param A numerator
+ * \param R reciprocal of the denominator B
+ * \return the value of A/B
+ */
+static inline uint32_t ReciprocalDivide (uint32_t A, uint32_t R)
+{
+  return (uint32_t)(((uint64_t)A * R) >> 32);
+}
+
+/**
+ * \param t a time
+ * \return the time in CoDel time units
+ */
+static inline uint32_t Time2CoDel (Time t)
+{
+  return (t.GetNanoSeconds () >> CODEL_SHIFT);
+}
+
+/**
+ * \param a a time in CoDel time units
+ * \param b a time in CoDel time units
+ * \return true if a is after b
+ */
+static inline bool CoDelTimeAfter (uint32_t a, uint32_t b)
+{
+  return ((int)(a) - (int)(b) > 0);
+}
+
+/**
+ * \param a a time in CoDel time units
+ * \param b a time in CoDel time units
+ * \return true if a is after or equal to b
+ */
+static inline bool CoDelTimeAfterEq (uint32_t a, uint32_t b)
+{
+  return ((int)(a) - (int)(b) >= 0);
+}
+
+/**
+ * \param a a time in CoDel time units
+ * \param b a time in CoDel time units
+ * \return true if a is before b
+ */
+static inline bool CoDelTimeBefore (uint32_t a, uint32_t b)
+{
+  return ((int)(a) - (int)(b) < 0);
+}
+
+TypeId FlatFqCoDelQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlatFqCoDelQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FlatFqCoDelQueueDisc> ()
+    .AddAttribute ("Interval",
+                   "The CoDel algorithm interval for each flow queue",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&FlatFqCoDelQueueDisc::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Target",
+                   "The CoDel algorithm target queue delay for each flow queue",
+                   TimeValue (MilliSeconds (5)),
+                   MakeTimeAccessor (&FlatFqCoDelQueueDisc::m_target),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinBytes",
+                   "The CoDel algorithm minbytes parameter for each flow queue",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_minBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PacketLimit",
+                   "The hard limit on the real queue size, measured in packets",
+                   UintegerValue (10 * 1024),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_limit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Flows",
+                   "The number of queues into which the incoming packets are classified",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_flows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DropBatchSize",
+                   "The maximum number of packets dropped from the fat flow",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_dropBatchSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+FlatFqCoDelQueueDisc::FlatFqCoDelQueueDisc ()
+  : m_quantum (0),
+    m_overlimitDroppedPackets (0),
+    m_codelInterval (0),
+    m_codelTarget (0),
+    m_freeSlots (NONE)
+{
+  NS_LOG_FUNCTION (this);
+  m_newFlows.head = m_newFlows.tail = NONE;
+  m_oldFlows.head = m_oldFlows.tail = NONE;
+}
+
+FlatFqCoDelQueueDisc::~FlatFqCoDelQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FlatFqCoDelQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowQueues.clear ();
+  m_flowOrder.clear ();
+  m_packets.clear ();
+  m_enqueueTimes.clear ();
+  m_nextPackets.clear ();
+  m_freeSlots = NONE;
+  m_newFlows.head = m_newFlows.tail = NONE;
+  m_oldFlows.head = m_oldFlows.tail = NONE;
+  QueueDisc::DoDispose ();
+}
+
+void
+FlatFqCoDelQueueDisc::SetQuantum (uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_quantum = quantum;
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::GetNFlowQueues (void) const
+{
+  return m_flowOrder.size ();
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::GetFlowQueueNPackets (uint32_t i) const
+{
+  NS_ASSERT (i < m_flowOrder.size ());
+  return m_flowQueues[m_flowOrder[i]].nPackets;
+}
+
+int32_t
+FlatFqCoDelQueueDisc::GetFlowQueueDeficit (uint32_t i) const
+{
+  NS_ASSERT (i < m_flowOrder.size ());
+  return m_flowQueues[m_flowOrder[i]].deficit;
+}
+
+FqCoDelFlow::FlowStatus
+FlatFqCoDelQueueDisc::GetFlowQueueStatus (uint32_t i) const
+{
+  NS_ASSERT (i < m_flowOrder.size ());
+  return static_cast<FqCoDelFlow::FlowStatus> (m_flowQueues[m_flowOrder[i]].status);
+}
+
+void
+FlatFqCoDelQueueDisc::PushBack (FlowList &list, uint32_t flow)
+{
+  m_flowQueues[flow].next = NONE;
+  if (list.tail == NONE)
+    {
+      list.head = flow;
+    }
+  else
+    {
+      m_flowQueues[list.tail].next = flow;
+    }
+  list.tail = flow;
+}
+
+void
+FlatFqCoDelQueueDisc::PopFront (FlowList &list)
+{
+  NS_ASSERT (list.head != NONE);
+  uint32_t flow = list.head;
+  list.head = m_flowQueues[flow].next;
+  if (list.head == NONE)
+    {
+      list.tail = NONE;
+    }
+  m_flowQueues[flow].next = NONE;
+}
+
+void
+FlatFqCoDelQueueDisc::PushPacket (Flow &flow, Ptr<QueueDiscItem> item)
+{
+  uint32_t slot = m_freeSlots;
+  if (slot == NONE)
+    {
+      slot = m_packets.size ();
+      m_packets.push_back (item);
+      m_enqueueTimes.push_back (0);
+      m_nextPackets.push_back (NONE);
+    }
+  else
+    {
+      m_freeSlots = m_nextPackets[slot];
+      m_packets[slot] = item;
+      m_nextPackets[slot] = NONE;
+    }
+  m_enqueueTimes[slot] = Simulator::Now ().GetTimeStep ();
+
+  if (flow.tail == NONE)
+    {
+      flow.head = slot;
+    }
+  else
+    {
+      m_nextPackets[flow.tail] = slot;
+    }
+  flow.tail = slot;
+  flow.nPackets++;
+  flow.nBytes += item->GetSize ();
+}
+
+Ptr<QueueDiscItem>
+FlatFqCoDelQueueDisc::PopPacket (Flow &flow, int64_t &enqueueTime)
+{
+  uint32_t slot = flow.head;
+  if (slot == NONE)
+    {
+      return 0;
+    }
+
+  Ptr<QueueDiscItem> item = m_packets[slot];
+  enqueueTime = m_enqueueTimes[slot];
+  m_packets[slot] = 0;
+
+  flow.head = m_nextPackets[slot];
+  if (flow.head == NONE)
+    {
+      flow.tail = NONE;
+    }
+  flow.nPackets--;
+  flow.nBytes -= item->GetSize ();
+
+  m_nextPackets[slot] = m_freeSlots;
+  m_freeSlots = slot;
+  return item;
+}
+
+bool
+FlatFqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  int32_t ret = Classify (item);
+
+  if (ret == PacketFilter::PF_NO_MATCH)
+    {
+      NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
+      Drop (item);
+      return false;
+    }
+
+  uint32_t h = ret % m_flows;
+  Flow &flow = m_flowQueues[h];
+
+  if (flow.status == FqCoDelFlow::INACTIVE)
+    {
+      if (!flow.used)
+        {
+          // number the flow queues like the classes of FqCoDelQueueDisc
+          NS_LOG_DEBUG ("Using a new flow queue with index " << h);
+          flow.used = true;
+          m_flowOrder.push_back (h);
+        }
+      flow.status = FqCoDelFlow::NEW_FLOW;
+      flow.deficit = m_quantum;
+      PushBack (m_newFlows, h);
+    }
+
+  PushPacket (flow, item);
+
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
+
+  if (GetNPackets () > m_limit)
+    {
+      FqCoDelDrop ();
+    }
+
+  return true;
+}
+
+bool
+FlatFqCoDelQueueDisc::OkToDrop (Flow &flow, Ptr<QueueDiscItem> item, int64_t enqueueTime, uint32_t now)
+{
+  if (!item)
+    {
+      flow.firstAboveTime = 0;
+      return false;
+    }
+
+  uint32_t sojournTime = Time2CoDel (Simulator::Now () - TimeStep (enqueueTime));
+
+  if (CoDelTimeBefore (sojournTime, m_codelTarget) || flow.nBytes < m_minBytes)
+    {
+      // went below so we'll stay below for at least q->interval
+      flow.firstAboveTime = 0;
+      return false;
+    }
+
+  bool okToDrop = false;
+  if (flow.firstAboveTime == 0)
+    {
+      // just went above from below. If we stay above
+      // for at least q->interval we'll say it's ok to drop
+      flow.firstAboveTime = now + m_codelInterval;
+    }
+  else if (CoDelTimeAfter (now, flow.firstAboveTime))
+    {
+      okToDrop = true;
+    }
+  return okToDrop;
+}
+
+void
+FlatFqCoDelQueueDisc::NewtonStep (Flow &flow)
+{
+  uint32_t invsqrt = ((uint32_t) flow.recInvSqrt) << REC_INV_SQRT_SHIFT;
+  uint32_t invsqrt2 = ((uint64_t) invsqrt * invsqrt) >> 32;
+  uint64_t val = (3ll << 32) - ((uint64_t) flow.count * invsqrt2);
+
+  val >>= 2; /* avoid overflow */
+  val = (val * invsqrt) >> (32 - 2 + 1);
+  flow.recInvSqrt = val >> REC_INV_SQRT_SHIFT;
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::ControlLaw (const Flow &flow, uint32_t t) const
+{
+  return t + ReciprocalDivide (m_codelInterval, flow.recInvSqrt << REC_INV_SQRT_SHIFT);
+}
+
+Ptr<QueueDiscItem>
+FlatFqCoDelQueueDisc::CoDelDequeue (Flow &flow)
+{
+  NS_LOG_FUNCTION (this);
+
+  int64_t enqueueTime = 0;
+  Ptr<QueueDiscItem> item = PopPacket (flow, enqueueTime);
+  if (!item)
+    {
+      // Leave dropping state when queue is empty
+      flow.dropping = false;
+      return 0;
+    }
+  uint32_t now = Simulator::Now ().GetNanoSeconds () >> CODEL_SHIFT;
+
+  bool okToDrop = OkToDrop (flow, item, enqueueTime, now);
+
+  if (flow.dropping)
+    {
+      if (!okToDrop)
+        {
+          // sojourn time fell below target - leave dropping state
+          flow.dropping = false;
+        }
+      else if (CoDelTimeAfterEq (now, flow.dropNext))
+        {
+          while (flow.dropping && CoDelTimeAfterEq (now, flow.dropNext))
+            {
+              NS_LOG_LOGIC ("CoDel drops " << item);
+              Drop (item);
+
+              ++flow.count;
+              NewtonStep (flow);
+              item = PopPacket (flow, enqueueTime);
+
+              if (!OkToDrop (flow, item, enqueueTime, now))
+                {
+                  flow.dropping = false;
+                }
+              else
+                {
+                  flow.dropNext = ControlLaw (flow, flow.dropNext);
+                }
+            }
+        }
+    }
+  else if (okToDrop)
+    {
+      // Drop the first packet and enter dropping state unless the queue is empty
+      NS_LOG_LOGIC ("CoDel drops " << item << " and enters the dropping state");
+      Drop (item);
+
+      item = PopPacket (flow, enqueueTime);
+
+      OkToDrop (flow, item, enqueueTime, now);
+      flow.dropping = true;
+      // if min went above target close to when we last went below it
+      // assume that the drop rate that controlled the queue on the
+      // last cycle is a good starting point to control it now.
+      int delta = flow.count - flow.lastCount;
+      if (delta > 1 && CoDelTimeBefore (now - flow.dropNext, 16 * m_codelInterval))
+        {
+          flow.count = delta;
+          NewtonStep (flow);
+        }
+      else
+        {
+          flow.count = 1;
+          flow.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+        }
+      flow.lastCount = flow.count;
+      flow.dropNext = ControlLaw (flow, now);
+    }
+  return item;
+}
+
+Ptr<QueueDiscItem>
+FlatFqCoDelQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t index;
+  Ptr<QueueDiscItem> item;
+
+  do
+    {
+      bool found = false;
+
+      while (!found && m_newFlows.head != NONE)
+        {
+          index = m_newFlows.head;
+          Flow &flow = m_flowQueues[index];
+
+          if (flow.deficit <= 0)
+            {
+              flow.deficit += m_quantum;
+              flow.status = FqCoDelFlow::OLD_FLOW;
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, index);
+            }
+          else
+            {
+              NS_LOG_DEBUG ("Found a new flow with positive deficit");
+              found = true;
+            }
+        }
+
+      while (!found && m_oldFlows.head != NONE)
+        {
+          index = m_oldFlows.head;
+          Flow &flow = m_flowQueues[index];
+
+          if (flow.deficit <= 0)
+            {
+              flow.deficit += m_quantum;
+              PopFront (m_oldFlows);
+              PushBack (m_oldFlows, index);
+            }
+          else
+            {
+              NS_LOG_DEBUG ("Found an old flow with positive deficit");
+              found = true;
+            }
+        }
+
+      if (!found)
+        {
+          NS_LOG_DEBUG ("No flow found to dequeue a packet");
+          return 0;
+        }
+
+      Flow &flow = m_flowQueues[index];
+      item = CoDelDequeue (flow);
+
+      if (!item)
+        {
+          NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
+          if (m_newFlows.head != NONE)
+            {
+              flow.status = FqCoDelFlow::OLD_FLOW;
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, index);
+            }
+          else
+            {
+              flow.status = FqCoDelFlow::INACTIVE;
+              PopFront (m_oldFlows);
+            }
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Dequeued packet " << item->GetPacket ());
+        }
+    } while (item == 0);
+
+  m_flowQueues[index].deficit -= item->GetSize ();
+
+  return item;
+}
+
+Ptr<const QueueDiscItem>
+FlatFqCoDelQueueDisc::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t index = m_newFlows.head;
+  if (index == NONE)
+    {
+      index = m_oldFlows.head;
+    }
+  if (index == NONE || m_flowQueues[index].head == NONE)
+    {
+      return 0;
+    }
+  return m_packets[m_flowQueues[index].head];
+}
+
+bool
+FlatFqCoDelQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("FlatFqCoDelQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () == 0)
+    {
+      NS_LOG_ERROR ("FlatFqCoDelQueueDisc needs at least a packet filter");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("FlatFqCoDelQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  return true;
+}
+
+void
+FlatFqCoDelQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // we are at initialization time. If the user has not set a quantum value,
+  // set the quantum to the MTU of the device
+  if (!m_quantum)
+    {
+      Ptr<NetDevice> device = GetNetDevice ();
+      NS_ASSERT_MSG (device, "Device not set for the queue disc");
+      m_quantum = device->GetMtu ();
+      NS_LOG_DEBUG ("Setting the quantum to the MTU of the device: " << m_quantum);
+    }
+
+  m_codelInterval = Time2CoDel (m_interval);
+  m_codelTarget = Time2CoDel (m_target);
+
+  Flow flow;
+  flow.head = flow.tail = flow.next = NONE;
+  flow.nPackets = flow.nBytes = 0;
+  flow.deficit = 0;
+  flow.status = FqCoDelFlow::INACTIVE;
+  flow.used = false;
+  flow.dropping = false;
+  flow.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+  flow.count = flow.lastCount = 0;
+  flow.firstAboveTime = flow.dropNext = 0;
+  m_flowQueues.assign (m_flows, flow);
+  m_flowOrder.clear ();
+
+  // the packet pool grows on demand, up to the packet limit
+  uint32_t slots = std::min<uint32_t> (m_limit + 1, 1024);
+  m_packets.reserve (slots);
+  m_enqueueTimes.reserve (slots);
+  m_nextPackets.reserve (slots);
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::FqCoDelDrop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t maxBacklog = 0, index = 0;
+
+  /* Queue is full! Find the fat flow and drop packet(s) from it */
+  for (uint32_t i = 0; i < m_flowOrder.size (); i++)
+    {
+      uint32_t bytes = m_flowQueues[m_flowOrder[i]].nBytes;
+      if (bytes > maxBacklog)
+        {
+          maxBacklog = bytes;
+          index = i;
+        }
+    }
+
+  /* Our goal is to drop half of this fat flow backlog */
+  uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
+  Flow &flow = m_flowQueues[m_flowOrder[index]];
+  int64_t enqueueTime;
+  Ptr<QueueDiscItem> item;
+
+  do
+    {
+      item = PopPacket (flow, enqueueTime);
+      len += item->GetSize ();
+      Drop (item);
+    } while (++count < m_dropBatchSize && len < threshold);
+
+  m_overlimitDroppedPackets += count;
+
+  return index;
+}
+
+} // namespace ns3
@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLAT_FQ_CODEL_QUEUE_DISC
+#define FLAT_FQ_CODEL_QUEUE_DISC
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "fq-codel-queue-disc.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A FqCoDel packet queue disc with flat flow arrays
+ *
+ * This queue disc implements the same algorithm as ns3::FqCoDelQueueDisc,
+ * and dequeues and drops the same packets, but without any object per
+ * flow.  The flow queues are preallocated in an array indexed by the
+ * hash bucket, the lists of new and old flows are linked through the
+ * flows themselves, and the state of the CoDel algorithm is stored in
+ * each flow.  The packets of all the flows are stored in a single pool
+ * of slots, along with their enqueue time, so that no timestamp tag is
+ * added to them.
+ *
+ * Since the flow queues are not queue disc classes, their state is read
+ * with GetNFlowQueues and the GetFlowQueue* methods, which number the
+ * flow queues in the order of their first packet, like the classes of
+ * ns3::FqCoDelQueueDisc.
+ */
+class FlatFqCoDelQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief FlatFqCoDelQueueDisc constructor
+   */
+  FlatFqCoDelQueueDisc ();
+
+  virtual ~FlatFqCoDelQueueDisc ();
+
+  /**
+   * \brief Set the quantum value.
+   *
+   * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  void SetQuantum (uint32_t quantum);
+
+  /**
+   * \brief Get the quantum value.
+   *
+   * \returns The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  uint32_t GetQuantum (void) const;
+
+  /**
+   * \brief Get the number of flow queues which received a packet
+   * \return the number of flow queues in use
+   */
+  uint32_t GetNFlowQueues (void) const;
+
+  /**
+   * \brief Get the number of packets in a flow queue
+   * \param i the index of the flow queue, in the order of their first packet
+   * \return the number of packets in the flow queue
+   */
+  uint32_t GetFlowQueueNPackets (uint32_t i) const;
+
+  /**
+   * \brief Get the deficit of a flow queue
+   * \param i the index of the flow queue, in the order of their first packet
+   * \return the deficit of the flow queue
+   */
+  int32_t GetFlowQueueDeficit (uint32_t i) const;
+
+  /**
+   * \brief Get the status of a flow queue
+   * \param i the index of the flow queue, in the order of their first packet
+   * \return the status of the flow queue
+   */
+  FqCoDelFlow::FlowStatus GetFlowQueueStatus (uint32_t i) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const;
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief A flow queue, with its CoDel state
+   */
+  struct Flow
+  {
+    uint32_t head;            //!< the slot of the first packet
+    uint32_t tail;            //!< the slot of the last packet
+    uint32_t nPackets;        //!< the number of packets
+    uint32_t nBytes;          //!< the number of bytes
+    uint32_t next;            //!< the next flow in the list of new or old flows
+    int32_t deficit;          //!< the deficit
+    uint8_t status;           //!< the FqCoDelFlow::FlowStatus of the flow
+    bool used;                //!< whether the flow queue received a packet
+    bool dropping;            //!< true if CoDel is in dropping state
+    uint16_t recInvSqrt;      //!< CoDel reciprocal inverse square root
+    uint32_t count;           //!< CoDel number of packets dropped since entering drop state
+    uint32_t lastCount;       //!< CoDel last number of packets dropped since entering drop state
+    uint32_t firstAboveTime;  //!< CoDel time to declare sojourn time above target
+    uint32_t dropNext;        //!< CoDel time to drop next packet
+  };
+
+  /**
+   * \brief A list of flows linked through Flow::next
+   */
+  struct FlowList
+  {
+    uint32_t head;  //!< the first flow
+    uint32_t tail;  //!< the last flow
+  };
+
+  /**
+   * \brief Append a flow to a list
+   * \param list the list
+   * \param flow the index of the flow
+   */
+  void PushBack (FlowList &list, uint32_t flow);
+
+  /**
+   * \brief Remove the first flow of a list
+   * \param list the list
+   */
+  void PopFront (FlowList &list);
+
+  /**
+   * \brief Store a packet at the tail of a flow queue
+   * \param flow the flow
+   * \param item the packet
+   */
+  void PushPacket (Flow &flow, Ptr<QueueDiscItem> item);
+
+  /**
+   * \brief Remove the packet at the head of a flow queue
+   * \param [in] flow the flow
+   * \param [out] enqueueTime the enqueue time of the packet, in time steps
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<QueueDiscItem> PopPacket (Flow &flow, int64_t &enqueueTime);
+
+  /**
+   * \brief Dequeue a packet from a flow queue with the CoDel algorithm
+   * \param flow the flow
+   * \return the packet, or 0 if the flow queue is or becomes empty
+   */
+  Ptr<QueueDiscItem> CoDelDequeue (Flow &flow);
+
+  /**
+   * \brief Check if a packet may be dropped by the CoDel algorithm
+   * \param flow the flow
+   * \param item the packet, or 0
+   * \param enqueueTime the enqueue time of the packet, in time steps
+   * \param now the current time, in CoDel time units
+   * \return true if the packet may be dropped
+   */
+  bool OkToDrop (Flow &flow, Ptr<QueueDiscItem> item, int64_t enqueueTime, uint32_t now);
+
+  /**
+   * \brief Calculate the reciprocal square root of the CoDel count of a flow
+   * \param flow the flow
+   */
+  void NewtonStep (Flow &flow);
+
+  /**
+   * \brief Determine the time for the next drop of a flow
+   * \param flow the flow
+   * \param t the current drop time, in CoDel time units
+   * \return the next drop time, in CoDel time units
+   */
+  uint32_t ControlLaw (const Flow &flow, uint32_t t) const;
+
+  /**
+   * \brief Drop a packet from the head of the queue with the largest current byte count
+   * \return the index of the queue with the largest current byte count
+   */
+  uint32_t FqCoDelDrop (void);
+
+  Time m_interval;           //!< CoDel interval attribute
+  Time m_target;             //!< CoDel target attribute
+  uint32_t m_minBytes;       //!< CoDel minimum bytes in a flow queue to allow a packet drop
+  uint32_t m_limit;          //!< Maximum number of packets in the queue disc
+  uint32_t m_quantum;        //!< Deficit assigned to flows at each round
+  uint32_t m_flows;          //!< Number of flow queues
+  uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
+
+  uint32_t m_overlimitDroppedPackets; //!< Number of overlimit dropped packets
+
+  uint32_t m_codelInterval;  //!< CoDel interval, in CoDel time units
+  uint32_t m_codelTarget;    //!< CoDel target, in CoDel time units
+
+  std::vector<Flow> m_flowQueues;     //!< The flow queues, indexed by hash bucket
+  std::vector<uint32_t> m_flowOrder;  //!< The flow queues in the order of their first packet
+  FlowList m_newFlows;                //!< The list of new flows
+  FlowList m_oldFlows;                //!< The list of old flows
+
+  std::vector<Ptr<QueueDiscItem> > m_packets;  //!< The packet of each slot
+  std::vector<int64_t> m_enqueueTimes;         //!< The enqueue time of the packet of each slot
+  std::vector<uint32_t> m_nextPackets;         //!< The next slot in a flow queue or in the free list
+  uint32_t m_freeSlots;                        //!< The first free slot
+};
+
+} // namespace ns3
+
+#endif /* FLAT_FQ_CODEL_QUEUE_DISC */
@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
@@ -28,6 +29,7 @@
 #include "queue-disc.h"
 #include <ns3/drop-tail-queue.h>
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
 
 namespace ns3 {
 
@@ -99,6 +101,12 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BulkDequeue",
+                   "Whether a burst of packets may be dequeued and sent to the device at once, "
+                   "within the dynamic queue limits of its transmission queue",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QueueDisc::m_bulkDequeue),
+                   MakeBooleanChecker ())
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -144,7 +152,8 @@ QueueDisc::QueueDisc ()
      m_nTotalDroppedBytes (0),
      m_nTotalRequeuedPackets (0),
      m_nTotalRequeuedBytes (0),
-     m_running (false)
+     m_running (false),
+     m_bulkDequeue (true)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -163,7 +172,7 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_device = 0;
   m_devQueueIface = 0;
-  m_requeued = 0;
+  m_requeued.clear ();
   Object::DoDispose ();
 }
 
@@ -466,14 +475,15 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      uint32_t packets;
+      while (Restart (packets))
         {
-          quota -= 1;
-          if (quota <= 0)
+          if (packets >= quota)
             {
               /// \todo netif_schedule (q);
               break;
             }
+          quota -= packets;
         }
       RunEnd ();
     }
@@ -500,17 +510,63 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t &packets)
 {
   NS_LOG_FUNCTION (this);
+  packets = 0;
   Ptr<QueueDiscItem> item = DequeuePacket();
   if (item == 0)
     {
       NS_LOG_LOGIC ("No packet to send");
       return false;
     }
+  packets = 1;
 
-  return Transmit (item);
+  int32_t bytes = GetBulkLimit ();
+  if (bytes < 0)
+    {
+      return Transmit (item);
+    }
+
+  // As in the Linux function try_bulk_dequeue_skb, dequeue more packets as long
+  // as sending them one by one would not get the device queue stopped by its
+  // queue limits
+  std::vector<Ptr<QueueDiscItem> > items (1, item);
+  bytes -= item->GetSize ();
+  while (bytes >= 0 && items.size () < m_quota)
+    {
+      item = DequeuePacket ();
+      if (item == 0)
+        {
+          break;
+        }
+      bytes -= item->GetSize ();
+      items.push_back (item);
+    }
+  packets = items.size ();
+
+  if (packets == 1)
+    {
+      return Transmit (items[0]);
+    }
+  NS_LOG_LOGIC ("Sending a burst of " << packets << " packets");
+  return TransmitBulk (items);
+}
+
+int32_t
+QueueDisc::GetBulkLimit (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_bulkDequeue || m_devQueueIface->GetNTxQueues () != 1)
+    {
+      return -1;
+    }
+  Ptr<QueueLimits> ql = m_devQueueIface->GetTxQueue (0)->GetQueueLimits ();
+  if (ql == 0)
+    {
+      return -1;
+    }
+  return ql->Available ();
 }
 
 Ptr<QueueDiscItem>
@@ -521,15 +577,15 @@ QueueDisc::DequeuePacket ()
   Ptr<QueueDiscItem> item;
 
   // First check if there is a requeued packet
-  if (m_requeued != 0)
+  if (!m_requeued.empty ())
     {
         // If the queue where the requeued packet is destined to is not stopped, return
         // the requeued packet; otherwise, return an empty packet.
         // If the device does not support flow control, the device queue is never stopped
-        if (!m_devQueueIface->GetTxQueue (m_requeued->GetTxQueueIndex ())->IsStopped ())
+        if (!m_devQueueIface->GetTxQueue (m_requeued.front ()->GetTxQueueIndex ())->IsStopped ())
           {
-            item = m_requeued;
-            m_requeued = 0;
+            item = m_requeued.front ();
+            m_requeued.pop_front ();
 
             m_nPackets--;
             m_nBytes -= item->GetSize ();
@@ -563,7 +619,8 @@ void
 QueueDisc::Requeue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
-  m_requeued = item;
+  // requeued packets are sent again before any other packet
+  m_requeued.push_front (item);
   /// \todo netif_schedule (q);
 
   m_nPackets++;       // it's still part of the queue
@@ -622,4 +679,34 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBulk (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+  NS_ASSERT (m_devQueueIface);
+
+  // bulk dequeue is only performed on single queue devices, which make no use
+  // of the priority tag
+  SocketPriorityTag priorityTag;
+  for (uint32_t i = 0; i < items.size (); i++)
+    {
+      items[i]->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+
+  // as in Transmit, the packets taken by the device are consumed, and those
+  // following the first one which found the device queue stopped are requeued
+  uint32_t sent = m_device->SendBulk (items);
+  for (uint32_t i = items.size (); i > sent; i--)
+    {
+      Requeue (items[i - 1]);
+    }
+
+  if (sent < items.size () || GetNPackets () == 0 || m_devQueueIface->GetTxQueue (0)->IsStopped ())
+    {
+      return false;
+    }
+
+  return true;
+}
+
 } // namespace ns3
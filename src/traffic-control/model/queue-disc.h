@@ -25,6 +25,7 @@
 #include "ns3/net-device.h"
 #include "ns3/queue-item.h"
 #include <vector>
+#include <deque>
 #include "packet-filter.h"
 
 namespace ns3 {
@@ -446,9 +447,22 @@ private:
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
    * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
-   * \return true if a packet is successfully sent to the device.
+   * If bulk dequeue is possible, dequeue more packets while the queue limits of the
+   * device allow it, and send them to the device at once (by calling TransmitBulk).
+   * \param [out] packets the number of packets dequeued
+   * \return true if the packets are successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t &packets);
+
+  /**
+   * Modelled after the Linux function qdisc_avail_bulklimit (include/net/sch_generic.h)
+   * Bulk dequeue is only performed on devices with a single transmission queue
+   * which has queue limits (e.g., DynamicQueueLimits), as in Linux.
+   * \return the number of bytes the device transmission queue can accept before
+   *         being stopped by its queue limits, or a negative value if bulk dequeue
+   *         is not possible
+   */
+  int32_t GetBulkLimit (void) const;
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
@@ -472,6 +486,16 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c)
+   * for a list of packets. Sends the packets to the device (by calling
+   * NetDevice::SendBulk) and requeues those which the device did not take
+   * because its transmission queue was stopped.
+   * \param items the packets to transmit, in order
+   * \return true if the device queue is not stopped and the queue disc is not empty
+   */
+  bool TransmitBulk (const std::vector<Ptr<QueueDiscItem> > &items);
+
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
   std::vector<Ptr<InternalQueue> > m_queues;    //!< Internal queues
@@ -491,7 +515,8 @@ private:
   Ptr<NetDevice> m_device;          //!< The NetDevice on which this queue discipline is installed
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
-  Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
+  bool m_bulkDequeue;               //!< Whether packets may be dequeued in bursts
+  std::deque<Ptr<QueueDiscItem> > m_requeued;  //!< The packets that failed to be transmitted
   ParentDropCallback m_parentDropCallback;   //!< Parent drop callback
 
   /// Traced callback: fired when a packet is enqueued
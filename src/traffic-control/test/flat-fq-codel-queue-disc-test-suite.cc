@@ -0,0 +1,442 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/flat-fq-codel-queue-disc.h"
+#include "ns3/fq-codel-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Flat FqCoDel Queue Disc Test Item
+ *
+ * The protocol number of the item is its flow identifier.
+ */
+class FlatFqCoDelTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p packet
+   * \param flow the flow identifier
+   * \param id the packet identifier
+   */
+  FlatFqCoDelTestItem (Ptr<Packet> p, uint16_t flow, uint32_t id);
+  virtual ~FlatFqCoDelTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  /// \return the packet identifier
+  uint32_t GetId (void) const;
+
+private:
+  FlatFqCoDelTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  FlatFqCoDelTestItem (const FlatFqCoDelTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  FlatFqCoDelTestItem &operator = (const FlatFqCoDelTestItem &);
+  uint32_t m_id; //!< the packet identifier
+};
+
+FlatFqCoDelTestItem::FlatFqCoDelTestItem (Ptr<Packet> p, uint16_t flow, uint32_t id)
+  : QueueDiscItem (p, Address (), flow),
+    m_id (id)
+{
+}
+
+FlatFqCoDelTestItem::~FlatFqCoDelTestItem ()
+{
+}
+
+void
+FlatFqCoDelTestItem::AddHeader (void)
+{
+}
+
+bool
+FlatFqCoDelTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+FlatFqCoDelTestItem::GetId (void) const
+{
+  return m_id;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Packet filter which classifies the test items by their flow
+ * identifier, and does not match the flow identifier 0.
+ */
+class FlatFqCoDelTestFilter : public PacketFilter
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+private:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const;
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
+TypeId
+FlatFqCoDelTestFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlatFqCoDelTestFilter")
+    .SetParent<PacketFilter> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FlatFqCoDelTestFilter> ()
+  ;
+  return tid;
+}
+
+bool
+FlatFqCoDelTestFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
+{
+  return item->GetProtocol () != 0;
+}
+
+int32_t
+FlatFqCoDelTestFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  return item->GetProtocol ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Test the unclassified packets, the flows separation and the packet limit
+ */
+class FlatFqCoDelQueueDiscPacketLimit : public TestCase
+{
+public:
+  FlatFqCoDelQueueDiscPacketLimit ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a 100 bytes packet
+   * \param queue the queue disc
+   * \param flow the flow identifier
+   */
+  void AddPacket (Ptr<FlatFqCoDelQueueDisc> queue, uint16_t flow);
+};
+
+FlatFqCoDelQueueDiscPacketLimit::FlatFqCoDelQueueDiscPacketLimit ()
+  : TestCase ("Test flows separation and packet limit")
+{
+}
+
+void
+FlatFqCoDelQueueDiscPacketLimit::AddPacket (Ptr<FlatFqCoDelQueueDisc> queue, uint16_t flow)
+{
+  queue->Enqueue (Create<FlatFqCoDelTestItem> (Create<Packet> (100), flow, 0));
+}
+
+void
+FlatFqCoDelQueueDiscPacketLimit::DoRun (void)
+{
+  Ptr<FlatFqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FlatFqCoDelQueueDisc> ("PacketLimit", UintegerValue (4));
+  queueDisc->AddPacketFilter (CreateObject<FlatFqCoDelTestFilter> ());
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  // Packets that cannot be classified are dropped
+  AddPacket (queueDisc, 0);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNPackets (), 0, "the unclassified packet should have been dropped");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNFlowQueues (), 0, "no flow queue should have been used");
+
+  // Add three packets from the first flow
+  AddPacket (queueDisc, 7);
+  AddPacket (queueDisc, 7);
+  AddPacket (queueDisc, 7);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the flow queue");
+
+  // Add the first packet of the second flow
+  AddPacket (queueDisc, 9);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNPackets (), 4, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 3, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 1, "unexpected number of packets in the flow queue");
+
+  // Add the second packet that causes two packets to be dropped from the fat flow (max backlog = 300, threshold = 150)
+  AddPacket (queueDisc, 9);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 2, "unexpected number of packets in the flow queue");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Test the deficit and the status of the flows
+ */
+class FlatFqCoDelQueueDiscDeficit : public TestCase
+{
+public:
+  FlatFqCoDelQueueDiscDeficit ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a 120 bytes packet
+   * \param queue the queue disc
+   * \param flow the flow identifier
+   */
+  void AddPacket (Ptr<FlatFqCoDelQueueDisc> queue, uint16_t flow);
+  /**
+   * Check the state of the flow queues
+   * \param queue the queue disc
+   * \param deficit1 the expected deficit of the first flow
+   * \param status1 the expected status of the first flow
+   * \param deficit2 the expected deficit of the second flow
+   * \param status2 the expected status of the second flow
+   */
+  void CheckFlows (Ptr<FlatFqCoDelQueueDisc> queue, int32_t deficit1, FqCoDelFlow::FlowStatus status1,
+                   int32_t deficit2, FqCoDelFlow::FlowStatus status2);
+};
+
+FlatFqCoDelQueueDiscDeficit::FlatFqCoDelQueueDiscDeficit ()
+  : TestCase ("Test credits and flows status")
+{
+}
+
+void
+FlatFqCoDelQueueDiscDeficit::AddPacket (Ptr<FlatFqCoDelQueueDisc> queue, uint16_t flow)
+{
+  queue->Enqueue (Create<FlatFqCoDelTestItem> (Create<Packet> (120), flow, 0));
+}
+
+void
+FlatFqCoDelQueueDiscDeficit::CheckFlows (Ptr<FlatFqCoDelQueueDisc> queue, int32_t deficit1, FqCoDelFlow::FlowStatus status1,
+                                         int32_t deficit2, FqCoDelFlow::FlowStatus status2)
+{
+  NS_TEST_EXPECT_MSG_EQ (queue->GetFlowQueueDeficit (0), deficit1, "unexpected deficit for the first flow");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetFlowQueueStatus (0), status1, "unexpected status for the first flow");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetFlowQueueDeficit (1), deficit2, "unexpected deficit for the second flow");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetFlowQueueStatus (1), status2, "unexpected status for the second flow");
+}
+
+void
+FlatFqCoDelQueueDiscDeficit::DoRun (void)
+{
+  Ptr<FlatFqCoDelQueueDisc> queueDisc = CreateObject<FlatFqCoDelQueueDisc> ();
+  queueDisc->AddPacketFilter (CreateObject<FlatFqCoDelTestFilter> ());
+  queueDisc->SetQuantum (90);
+  queueDisc->Initialize ();
+
+  // Add a packet from the first flow, and dequeue it
+  AddPacket (queueDisc, 1);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), 90, "the deficit of the first flow must equal the quantum");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueStatus (0), FqCoDelFlow::NEW_FLOW, "the first flow must be in the list of new queues");
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueDeficit (0), -30, "unexpected deficit for the first flow");
+
+  // Add two packets from each flow
+  AddPacket (queueDisc, 1);
+  AddPacket (queueDisc, 1);
+  AddPacket (queueDisc, 2);
+  AddPacket (queueDisc, 2);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (0), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowQueueNPackets (1), 2, "unexpected number of packets in the second flow queue");
+  CheckFlows (queueDisc, -30, FqCoDelFlow::NEW_FLOW, 90, FqCoDelFlow::NEW_FLOW);
+
+  // Same sequence of deficits and status as with FqCoDelQueueDisc
+  queueDisc->Dequeue ();
+  CheckFlows (queueDisc, 60, FqCoDelFlow::OLD_FLOW, -30, FqCoDelFlow::NEW_FLOW);
+  queueDisc->Dequeue ();
+  CheckFlows (queueDisc, -60, FqCoDelFlow::OLD_FLOW, 60, FqCoDelFlow::OLD_FLOW);
+  queueDisc->Dequeue ();
+  CheckFlows (queueDisc, 30, FqCoDelFlow::OLD_FLOW, -60, FqCoDelFlow::OLD_FLOW);
+  queueDisc->Dequeue ();
+  CheckFlows (queueDisc, -90, FqCoDelFlow::OLD_FLOW, 30, FqCoDelFlow::OLD_FLOW);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNPackets (), 0, "unexpected number of packets in the queue disc");
+  queueDisc->Dequeue ();
+  CheckFlows (queueDisc, 90, FqCoDelFlow::INACTIVE, 30, FqCoDelFlow::INACTIVE);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that FlatFqCoDelQueueDisc dequeues and drops the same
+ * packets as FqCoDelQueueDisc, including the CoDel drops
+ */
+class FlatFqCoDelQueueDiscEquivalence : public TestCase
+{
+public:
+  FlatFqCoDelQueueDiscEquivalence ();
+
+private:
+  virtual void DoRun (void);
+  /// Enqueue and dequeue the packets of a millisecond
+  void Step (void);
+  /**
+   * \return a pseudo-random number
+   */
+  uint32_t Random (void);
+  /**
+   * Record a packet
+   * \param ids the identifiers of the recorded packets
+   * \param item the packet
+   */
+  static void Record (std::vector<uint32_t> *ids, Ptr<const QueueDiscItem> item);
+
+  Ptr<FqCoDelQueueDisc> m_reference;      //!< the reference queue disc
+  Ptr<FlatFqCoDelQueueDisc> m_flat;       //!< the tested queue disc
+  std::vector<uint32_t> m_referenceOut;   //!< the packets dequeued by the reference queue disc
+  std::vector<uint32_t> m_flatOut;        //!< the packets dequeued by the tested queue disc
+  std::vector<uint32_t> m_referenceDrops; //!< the packets dropped by the reference queue disc
+  std::vector<uint32_t> m_flatDrops;      //!< the packets dropped by the tested queue disc
+  uint32_t m_seed;                        //!< the state of the pseudo-random generator
+  uint32_t m_nextId;                      //!< the identifier of the next packet
+  uint32_t m_codelDrops;                  //!< the number of packets dropped by CoDel
+};
+
+FlatFqCoDelQueueDiscEquivalence::FlatFqCoDelQueueDiscEquivalence ()
+  : TestCase ("Test that the flat implementation behaves like FqCoDelQueueDisc"),
+    m_seed (12345),
+    m_nextId (1),
+    m_codelDrops (0)
+{
+}
+
+uint32_t
+FlatFqCoDelQueueDiscEquivalence::Random (void)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return (m_seed >> 16) & 0x7fff;
+}
+
+void
+FlatFqCoDelQueueDiscEquivalence::Record (std::vector<uint32_t> *ids, Ptr<const QueueDiscItem> item)
+{
+  ids->push_back (DynamicCast<const FlatFqCoDelTestItem> (item)->GetId ());
+}
+
+void
+FlatFqCoDelQueueDiscEquivalence::Step (void)
+{
+  // bursts of packets from a few flows, with sizes around the quantum
+  uint32_t arrivals = Random () % 5;
+  for (uint32_t i = 0; i < arrivals; i++)
+    {
+      uint16_t flow = 1 + Random () % 12;
+      uint32_t size = 64 + Random () % 1437;
+      m_reference->Enqueue (Create<FlatFqCoDelTestItem> (Create<Packet> (size), flow, m_nextId));
+      m_flat->Enqueue (Create<FlatFqCoDelTestItem> (Create<Packet> (size), flow, m_nextId));
+      m_nextId++;
+    }
+
+  uint32_t departures = Random () % 5;
+  uint32_t drops = m_referenceDrops.size ();
+  for (uint32_t i = 0; i < departures; i++)
+    {
+      Ptr<QueueDiscItem> reference = m_reference->Dequeue ();
+      Ptr<QueueDiscItem> flat = m_flat->Dequeue ();
+      NS_TEST_ASSERT_MSG_EQ ((reference == 0), (flat == 0), "only one of the queue discs returned a packet");
+      if (reference)
+        {
+          Record (&m_referenceOut, reference);
+          Record (&m_flatOut, flat);
+        }
+    }
+  m_codelDrops += m_referenceDrops.size () - drops;
+  NS_TEST_ASSERT_MSG_EQ (m_flat->GetNPackets (), m_reference->GetNPackets (), "the queue discs store different numbers of packets");
+  NS_TEST_ASSERT_MSG_EQ (m_flat->GetNBytes (), m_reference->GetNBytes (), "the queue discs store different numbers of bytes");
+
+  if (m_nextId < 20000)
+    {
+      Simulator::Schedule (MilliSeconds (1), &FlatFqCoDelQueueDiscEquivalence::Step, this);
+    }
+}
+
+void
+FlatFqCoDelQueueDiscEquivalence::DoRun (void)
+{
+  m_reference = CreateObjectWithAttributes<FqCoDelQueueDisc> ("PacketLimit", UintegerValue (48),
+                                                              "Flows", UintegerValue (8),
+                                                              "DropBatchSize", UintegerValue (16));
+  m_flat = CreateObjectWithAttributes<FlatFqCoDelQueueDisc> ("PacketLimit", UintegerValue (48),
+                                                             "Flows", UintegerValue (8),
+                                                             "DropBatchSize", UintegerValue (16));
+  m_reference->AddPacketFilter (CreateObject<FlatFqCoDelTestFilter> ());
+  m_flat->AddPacketFilter (CreateObject<FlatFqCoDelTestFilter> ());
+  m_reference->SetQuantum (1000);
+  m_flat->SetQuantum (1000);
+  m_reference->Initialize ();
+  m_flat->Initialize ();
+  m_reference->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&FlatFqCoDelQueueDiscEquivalence::Record, &m_referenceDrops));
+  m_flat->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&FlatFqCoDelQueueDiscEquivalence::Record, &m_flatDrops));
+
+  Simulator::Schedule (MilliSeconds (1), &FlatFqCoDelQueueDiscEquivalence::Step, this);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_referenceOut.size (), 1000, "too few packets were dequeued");
+  NS_TEST_ASSERT_MSG_GT (m_codelDrops, 100, "too few packets were dropped by CoDel");
+  NS_TEST_ASSERT_MSG_GT (m_referenceDrops.size (), m_codelDrops, "no packet was dropped because of the packet limit");
+  NS_TEST_ASSERT_MSG_EQ (m_flatOut.size (), m_referenceOut.size (), "different numbers of packets were dequeued");
+  NS_TEST_ASSERT_MSG_EQ (m_flatDrops.size (), m_referenceDrops.size (), "different numbers of packets were dropped");
+  NS_TEST_ASSERT_MSG_EQ ((m_flatOut == m_referenceOut), true, "the packets were dequeued in a different order");
+  NS_TEST_ASSERT_MSG_EQ ((m_flatDrops == m_referenceDrops), true, "different packets were dropped");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Flat FqCoDel Queue Disc Test Suite
+ */
+static class FlatFqCoDelQueueDiscTestSuite : public TestSuite
+{
+public:
+  FlatFqCoDelQueueDiscTestSuite ()
+    : TestSuite ("flat-fq-codel-queue-disc", UNIT)
+  {
+    AddTestCase (new FlatFqCoDelQueueDiscPacketLimit, TestCase::QUICK);
+    AddTestCase (new FlatFqCoDelQueueDiscDeficit, TestCase::QUICK);
+    AddTestCase (new FlatFqCoDelQueueDiscEquivalence, TestCase::QUICK);
+  }
+} g_flatFqCoDelQueueDiscTestSuite; ///< the test suite
@@ -33,6 +33,8 @@
 #include "ns3/simple-channel.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
+#include "ns3/boolean.h"
 #include "ns3/config.h"
 
 using namespace ns3;
@@ -383,6 +385,210 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue limits with a fixed limit, in bytes
+ */
+class FixedQueueLimits : public QueueLimits
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param limit the maximum number of bytes in the device queue
+   */
+  FixedQueueLimits (uint32_t limit);
+  virtual void Reset ();
+  virtual void Completed (uint32_t count);
+  virtual int32_t Available () const;
+  virtual void Queued (uint32_t count);
+
+private:
+  int32_t m_limit;    //!< the limit
+  int32_t m_inFlight; //!< the bytes queued and not completed
+};
+
+FixedQueueLimits::FixedQueueLimits (uint32_t limit)
+  : m_limit (limit),
+    m_inFlight (0)
+{
+}
+
+void
+FixedQueueLimits::Reset ()
+{
+  m_inFlight = 0;
+}
+
+void
+FixedQueueLimits::Completed (uint32_t count)
+{
+  m_inFlight -= count;
+}
+
+int32_t
+FixedQueueLimits::Available () const
+{
+  return m_limit - m_inFlight;
+}
+
+void
+FixedQueueLimits::Queued (uint32_t count)
+{
+  m_inFlight += count;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Test the bulk dequeue of packets within the queue limits of the device
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Send 10 packets through a device with queue limits of 5000 bytes
+   * \param bulk whether bulk dequeue is enabled
+   * \param [out] events a character per packet dequeued from the queue disc
+   *             ('D') and per packet enqueued in the device queue ('E')
+   * \param [out] rxTimes the time each packet is received
+   * \param [out] requeued the number of packets requeued by the queue disc
+   */
+  void RunOnce (bool bulk, std::string &events, std::vector<Time> &rxTimes, uint32_t &requeued);
+  /**
+   * Enqueue packets in the queue disc and run it
+   * \param qdisc the queue disc
+   * \param nPackets the number of packets
+   */
+  static void EnqueueAndRun (Ptr<QueueDisc> qdisc, uint16_t nPackets);
+  /**
+   * Record the dequeue of a packet from the queue disc
+   * \param events the events
+   * \param item the packet
+   */
+  static void RecordDequeue (std::string *events, Ptr<const QueueDiscItem> item);
+  /**
+   * Record the enqueue of a packet in the device queue
+   * \param events the events
+   * \param p the packet
+   */
+  static void RecordEnqueue (std::string *events, Ptr<const Packet> p);
+  /**
+   * Record the reception of a packet
+   * \param rxTimes the reception times
+   * \param dev the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \return true
+   */
+  static bool Receive (std::vector<Time> *rxTimes, Ptr<NetDevice> dev, Ptr<const Packet> p,
+                       uint16_t protocol, const Address &from);
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase ()
+  : TestCase ("Test the bulk dequeue within the device queue limits")
+{
+}
+
+void
+TcBulkDequeueTestCase::EnqueueAndRun (Ptr<QueueDisc> qdisc, uint16_t nPackets)
+{
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      qdisc->Enqueue (Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+  qdisc->Run ();
+}
+
+void
+TcBulkDequeueTestCase::RecordDequeue (std::string *events, Ptr<const QueueDiscItem> item)
+{
+  events->push_back ('D');
+}
+
+void
+TcBulkDequeueTestCase::RecordEnqueue (std::string *events, Ptr<const Packet> p)
+{
+  events->push_back ('E');
+}
+
+bool
+TcBulkDequeueTestCase::Receive (std::vector<Time> *rxTimes, Ptr<NetDevice> dev, Ptr<const Packet> p,
+                                uint16_t protocol, const Address &from)
+{
+  rxTimes->push_back (Simulator::Now ());
+  return true;
+}
+
+void
+TcBulkDequeueTestCase::RunOnce (bool bulk, std::string &events, std::vector<Time> &rxTimes, uint32_t &requeued)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  Ptr<Queue<Packet> > queue = CreateObjectWithAttributes<DropTailQueue<Packet> > ("Mode", EnumValue (QueueBase::QUEUE_MODE_PACKETS),
+                                                                                  "MaxPackets", UintegerValue (100));
+  Ptr<SimpleNetDevice> txDev, rxDev;
+  txDev = CreateObjectWithAttributes<SimpleNetDevice> ("TxQueue", PointerValue (queue),
+                                                       "DataRate", DataRateValue (DataRate ("1Mb/s")));
+  rxDev = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  txDev->SetChannel (channel);
+  rxDev->SetChannel (channel);
+  rxDev->SetReceiveCallback (MakeBoundCallback (&TcBulkDequeueTestCase::Receive, &rxTimes));
+
+  TrafficControlHelper tch = TrafficControlHelper::Default ();
+  Ptr<QueueDisc> qdisc = tch.Install (txDev).Get (0);
+  qdisc->SetAttribute ("BulkDequeue", BooleanValue (bulk));
+  txDev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0)->SetQueueLimits (Create<FixedQueueLimits> (5000));
+
+  qdisc->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&TcBulkDequeueTestCase::RecordDequeue, &events));
+  queue->TraceConnectWithoutContext ("Enqueue", MakeBoundCallback (&TcBulkDequeueTestCase::RecordEnqueue, &events));
+
+  Simulator::Schedule (Seconds (0), &TcBulkDequeueTestCase::EnqueueAndRun, qdisc, 10);
+  Simulator::Run ();
+  requeued = qdisc->GetTotalRequeuedPackets ();
+  Simulator::Destroy ();
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  std::string events, bulkEvents;
+  std::vector<Time> rxTimes, bulkRxTimes;
+  uint32_t requeued, bulkRequeued;
+
+  RunOnce (false, events, rxTimes, requeued);
+  RunOnce (true, bulkEvents, bulkRxTimes, bulkRequeued);
+
+  // Without bulk dequeue, each packet is sent to the device after being dequeued
+  NS_TEST_EXPECT_MSG_EQ (events.find ("DD"), std::string::npos, "Unexpected burst without bulk dequeue");
+  // With bulk dequeue, the first run dequeues the 6 packets which fit in the
+  // queue limits (5000 bytes left after the first one) before sending them
+  NS_TEST_EXPECT_MSG_EQ (bulkEvents.substr (0, 12), "DDDDDDEEEEEE", "Unexpected first burst");
+  NS_TEST_EXPECT_MSG_EQ (bulkRequeued, requeued, "Bulk dequeue must not requeue more packets");
+
+  // The packets are transmitted at the same times
+  NS_TEST_ASSERT_MSG_EQ (rxTimes.size (), 10, "All the packets must be received");
+  NS_TEST_ASSERT_MSG_EQ (bulkRxTimes.size (), 10, "All the packets must be received with bulk dequeue");
+  for (uint32_t i = 0; i < rxTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (bulkRxTimes[i], rxTimes[i], "Packet " << i << " received at a different time");
+    }
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -397,5 +603,6 @@ public:
   {
     AddTestCase (new TcFlowControlTestCase (TcFlowControlTestCase::PACKET_MODE), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (TcFlowControlTestCase::BYTE_MODE), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase, TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
@@ -216,6 +216,12 @@ VisualSimulatorImpl::GetContext (void) const
   return m_simulator->GetContext ();
 }
 
+void
+VisualSimulatorImpl::SetContext (uint32_t context)
+{
+  m_simulator->SetContext (context);
+}
+
 void
 VisualSimulatorImpl::RunRealSimulator (void)
 {
@@ -55,6 +55,16 @@ AsciiPhyTransmitSinkWithContext (
   uint8_t txLevel)
 {
   NS_LOG_FUNCTION (stream << context << p << mode << preamble << txLevel);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', context, p);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -75,6 +85,16 @@ AsciiPhyTransmitSinkWithoutContext (
   uint8_t txLevel)
 {
   NS_LOG_FUNCTION (stream << p << mode << preamble << txLevel);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('t', p);
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -97,6 +117,16 @@ AsciiPhyReceiveSinkWithContext (
   enum WifiPreamble preamble)
 {
   NS_LOG_FUNCTION (stream << context << p << snr << mode << preamble);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', context, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -117,6 +147,16 @@ AsciiPhyReceiveSinkWithoutContext (
   enum WifiPreamble preamble)
 {
   NS_LOG_FUNCTION (stream << p << snr << mode << preamble);
+  if (!stream->Accept (p))
+    {
+      return;
+    }
+  Ptr<BinaryTraceWriter> binary = stream->GetBinaryTrace ();
+  if (binary)
+    {
+      binary->Write ('r', p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -18,9 +18,11 @@
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
@@ -32,6 +34,13 @@ NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
 
+/**
+ * Margin of the cached neighbor sets, as a fraction of MaxRange.  A
+ * larger margin keeps the sets valid longer when the nodes move, but
+ * adds candidate receivers.
+ */
+static const double NEIGHBOR_MARGIN = 0.1;
+
 TypeId
 YansWifiChannel::GetTypeId (void)
 {
@@ -47,11 +56,41 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The distance in meters beyond which transmissions are not "
+                   "passed to the receiving PHY, or 0 to pass them at any distance.  "
+                   "The receivers within range are looked up in a neighbor set "
+                   "cached for each sender, so that the receivers beyond range "
+                   "cost nothing.  Tune this value with care: the receivers "
+                   "beyond range do not see the signal as interference either.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::SetMaxRange,
+                                       &YansWifiChannel::GetMaxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MaxLossDb",
+                   "The maximum loss in dB for which transmissions are passed "
+                   "to the receiving PHY.  Signals for which the "
+                   "PropagationLossModel returns a loss bigger than this value "
+                   "are not propagated to the receiver.  Note that the default "
+                   "value corresponds to considering all signals for reception. "
+                   "Tune this value with care.",
+                   DoubleValue (1.0e9),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxLossDb),
+                   MakeDoubleChecker<double> ())
   ;
   return tid;
 }
 
+YansWifiChannel::NeighborSet::NeighborSet ()
+  : generation (0),
+    drift (0)
+{
+}
+
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0.0),
+    m_maxLossDb (1.0e9),
+    m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -60,6 +99,21 @@ YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION (this);
   m_phyList.clear ();
+  m_neighbors.clear ();
+}
+
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Ptr<MobilityModel> >::const_iterator i = m_watched.begin (); i != m_watched.end (); i++)
+    {
+      (*i)->TraceDisconnectWithoutContext ("CourseChange",
+                                           MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+    }
+  m_watched.clear ();
+  m_neighbors.clear ();
+  Channel::DoDispose ();
 }
 
 void
@@ -80,7 +134,8 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  const PhyList &receivers = m_maxRange > 0 ? GetNeighbors (sender, senderMobility) : m_phyList;
+  for (PhyList::const_iterator i = receivers.begin (); i != receivers.end (); i++)
     {
       if (sender != (*i))
         {
@@ -91,10 +146,20 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
             }
 
           Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          if (m_maxRange > 0 && senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+            {
+              // beyond range
+              continue;
+            }
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+          if (txPowerDbm - rxPowerDbm > m_maxLossDb)
+            {
+              // beyond range
+              continue;
+            }
           Ptr<Packet> copy = packet->Copy ();
           Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
           uint32_t dstNode;
@@ -137,6 +202,125 @@ void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   m_phyList.push_back (phy);
+  // The new phy may be a neighbor of any sender
+  m_generation++;
+}
+
+void
+YansWifiChannel::SetMaxRange (double maxRange)
+{
+  NS_LOG_FUNCTION (this << maxRange);
+  m_maxRange = maxRange;
+  m_generation++;
+}
+
+double
+YansWifiChannel::GetMaxRange (void) const
+{
+  return m_maxRange;
+}
+
+const YansWifiChannel::PhyList &
+YansWifiChannel::GetNeighbors (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility) const
+{
+  NS_LOG_FUNCTION (this << sender);
+
+  // Watch the mobility models of the phys added since the last call;
+  // they may not be set when the phys are added
+  while (m_watched.size () < m_phyList.size ())
+    {
+      Ptr<MobilityModel> mobility = m_phyList[m_watched.size ()]->GetMobility ();
+      NS_ASSERT (mobility != 0);
+      mobility->TraceConnectWithoutContext ("CourseChange",
+                                            MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+      m_watched.push_back (mobility);
+    }
+
+  NeighborSet &neighbors = m_neighbors[sender];
+  Time now = Simulator::Now ();
+  if (neighbors.generation == m_generation && now < neighbors.expiry)
+    {
+      return neighbors.phys;
+    }
+
+  // Cache the phys within range plus a margin.  Until the nodes change
+  // course, the others cannot come within range before they cover the
+  // margin at their relative speed.
+  double margin = m_maxRange * NEIGHBOR_MARGIN;
+  Vector position = senderMobility->GetPosition ();
+  double maxSpeed = 0;
+  neighbors.phys.clear ();
+  neighbors.mobilities.clear ();
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      if (sender == (*i))
+        {
+          continue;
+        }
+      Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ();
+      if (CalculateDistance (position, receiverMobility->GetPosition ()) <= m_maxRange + margin)
+        {
+          neighbors.phys.push_back (*i);
+          neighbors.mobilities.push_back (receiverMobility);
+        }
+      maxSpeed = std::max (maxSpeed, receiverMobility->GetVelocity ().GetLength ());
+    }
+  double senderSpeed = senderMobility->GetVelocity ().GetLength ();
+  double speed = senderSpeed + maxSpeed;
+  neighbors.expiry = speed > 0 ? now + Seconds (margin / speed) : Time::Max ();
+  neighbors.generation = m_generation;
+  neighbors.mobility = senderMobility;
+  neighbors.position = position;
+  neighbors.drift = speed > 0 ? margin * senderSpeed / speed : 0;
+  NS_LOG_DEBUG ("sender " << sender << " has " << neighbors.phys.size () << " neighbors until " << neighbors.expiry);
+  return neighbors.phys;
+}
+
+void
+YansWifiChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << mobility);
+  Time now = Simulator::Now ();
+  Vector position = mobility->GetPosition ();
+  double speed = mobility->GetVelocity ().GetLength ();
+  for (NeighborMap::iterator i = m_neighbors.begin (); i != m_neighbors.end (); i++)
+    {
+      NeighborSet &neighbors = i->second;
+      if (neighbors.generation != m_generation || now >= neighbors.expiry)
+        {
+          continue;
+        }
+      if (neighbors.mobility == mobility)
+        {
+          // The speed of the sender bounds the expiry of its set
+          neighbors.generation = 0;
+          continue;
+        }
+      if (std::find (neighbors.mobilities.begin (), neighbors.mobilities.end (), mobility)
+          != neighbors.mobilities.end ())
+        {
+          // Already a candidate receiver
+          continue;
+        }
+      // Until the set expires, the sender stays within its drift of the
+      // cached position, and the node within its speed of its position.
+      // A set cached while all the nodes stood still never expires.
+      bool reachable;
+      if (neighbors.expiry == Time::Max ())
+        {
+          reachable = speed > 0 || CalculateDistance (position, neighbors.position) <= m_maxRange;
+        }
+      else
+        {
+          double reach = neighbors.drift + speed * (neighbors.expiry - now).GetSeconds ();
+          reachable = CalculateDistance (position, neighbors.position) - reach <= m_maxRange;
+        }
+      if (reachable)
+        {
+          NS_LOG_DEBUG ("invalidate the neighbors of sender " << i->first);
+          neighbors.generation = 0;
+        }
+    }
 }
 
 int64_t
@@ -29,6 +29,8 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/double.h"
 #include "ns3/test.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
@@ -1154,6 +1156,146 @@ Bug2222TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_countInternalCollisions, 1, "unexpected number of internal collisions!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the YansWifiChannel cuts off the receivers beyond
+ * MaxRange and MaxLossDb, and that its cached neighbor sets follow the
+ * nodes when they change course and as they move.
+ *
+ * Node 0 broadcasts frames.  Node 1 is always within range.  Node 2 is
+ * out of range until it is moved within range, node 3 is out of range
+ * until it drives within range.  The last frame is cut off by MaxLossDb.
+ */
+class YansWifiChannelRangeTest : public TestCase
+{
+public:
+  YansWifiChannelRangeTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Send one broadcast frame
+   * \param dev the device
+   */
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  /**
+   * Receive callback of the devices
+   * \param dev the receiving device
+   * \param p the packet
+   * \param protocol the protocol
+   * \param sender the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &sender);
+
+  NetDeviceContainer m_devices; ///< devices
+  uint32_t m_received[4]; ///< number of frames received by each device
+};
+
+YansWifiChannelRangeTest::YansWifiChannelRangeTest ()
+  : TestCase ("Test case for YansWifiChannel receiver cutoff")
+{
+}
+
+void
+YansWifiChannelRangeTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+bool
+YansWifiChannelRangeTest::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &sender)
+{
+  for (uint32_t i = 0; i < m_devices.GetN (); i++)
+    {
+      if (m_devices.Get (i) == dev)
+        {
+          m_received[i]++;
+        }
+    }
+  return true;
+}
+
+void
+YansWifiChannelRangeTest::DoRun (void)
+{
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_received[i] = 0;
+    }
+
+  NodeContainer wifiNodes;
+  wifiNodes.Create (4);
+
+  // Every frame is received, unless it is cut off by the channel
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<FixedRssLossModel> loss = CreateObject<FixedRssLossModel> ();
+  loss->SetRss (-60.0);
+  channel->SetPropagationLossModel (loss);
+  channel->SetAttribute ("MaxRange", DoubleValue (100.0));
+
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+
+  WifiHelper wifi;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  m_devices = wifi.Install (phy, mac, wifiNodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (50.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (150.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (300.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (wifiNodes);
+
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_devices.Get (i)->SetReceiveCallback (MakeCallback (&YansWifiChannelRangeTest::Receive, this));
+    }
+
+  Ptr<WifiNetDevice> txDev = DynamicCast<WifiNetDevice> (m_devices.Get (0));
+  Ptr<ConstantVelocityMobilityModel> mobility1 = wifiNodes.Get (1)->GetObject<ConstantVelocityMobilityModel> ();
+  Ptr<ConstantVelocityMobilityModel> mobility2 = wifiNodes.Get (2)->GetObject<ConstantVelocityMobilityModel> ();
+  Ptr<ConstantVelocityMobilityModel> mobility3 = wifiNodes.Get (3)->GetObject<ConstantVelocityMobilityModel> ();
+
+  // Only node 1 is within range
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelRangeTest::SendOnePacket, this, txDev);
+  // Node 2 is moved within range
+  Simulator::Schedule (Seconds (1.5), &ConstantVelocityMobilityModel::SetPosition, mobility2, Vector (60.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (2.0), &YansWifiChannelRangeTest::SendOnePacket, this, txDev);
+  // Node 3 drives towards node 0, and is still out of range at 3 s
+  Simulator::Schedule (Seconds (2.5), &ConstantVelocityMobilityModel::SetVelocity, mobility3, Vector (-100.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (3.0), &YansWifiChannelRangeTest::SendOnePacket, this, txDev);
+  // Node 1 changes course while it is a candidate receiver of node 0
+  Simulator::Schedule (Seconds (3.05), &ConstantVelocityMobilityModel::SetVelocity, mobility1, Vector (5.0, 0.0, 0.0));
+  // Node 3 is 90 m away, without any course change since 2.5 s
+  Simulator::Schedule (Seconds (4.6), &YansWifiChannelRangeTest::SendOnePacket, this, txDev);
+  // The loss of every frame is 76 dB
+  Simulator::Schedule (Seconds (5.0), &YansWifiChannel::SetAttribute, channel, "MaxLossDb", DoubleValue (50.0));
+  Simulator::Schedule (Seconds (5.5), &YansWifiChannelRangeTest::SendOnePacket, this, txDev);
+
+  Simulator::Stop (Seconds (6.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_devices = NetDeviceContainer ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received[0], 0, "The sender received its own frames!");
+  NS_TEST_ASSERT_MSG_EQ (m_received[1], 4, "Node 1 did not receive the frames within range!");
+  NS_TEST_ASSERT_MSG_EQ (m_received[2], 3, "Node 2 did not receive the frames after it moved!");
+  NS_TEST_ASSERT_MSG_EQ (m_received[3], 1, "Node 3 did not receive the frames after it drove within range!");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1176,6 +1318,7 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
   AddTestCase (new SetChannelFrequencyTest, TestCase::QUICK);
   AddTestCase (new Bug2222TestCase, TestCase::QUICK); //Bug 2222
+  AddTestCase (new YansWifiChannelRangeTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
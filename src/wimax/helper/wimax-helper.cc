@@ -23,6 +23,7 @@
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include <string>
 #include "ns3/config.h"
 #include "ns3/wimax-net-device.h"
@@ -409,12 +410,20 @@ void WimaxHelper::AsciiRxEvent (Ptr<OutputStreamWrapper> stream,
                                 Ptr<const Packet> packet,
                                 const Mac48Address &source)
 {
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " from: " << source << " ";
   *stream->GetStream () << path << std::endl;
 }
 
 void WimaxHelper::AsciiTxEvent (Ptr<OutputStreamWrapper> stream, std::string path, Ptr<const Packet> packet, const Mac48Address &dest)
 {
+  if (!stream->Accept (packet))
+    {
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " to: " << dest << " ";
   *stream->GetStream () << path << std::endl;
 }
@@ -527,6 +536,12 @@ WimaxHelper::EnableAsciiInternal (Ptr<OutputStreamWrapper> stream,
   // but the default trace sinks are actually publicly available static
   // functions that are always there waiting for just such a case.
   //
+  // The "r" and "t" events print the trace path and the MAC address rather
+  // than the packet, which cannot be recorded in a binary trace.
+  //
+  NS_ABORT_MSG_IF (stream->GetBinaryTrace (),
+                   "WimaxHelper::EnableAsciiInternal(): binary traces are not supported");
+
   uint32_t nodeid = nd->GetNode ()->GetId ();
   uint32_t deviceid = nd->GetIfIndex ();
   std::ostringstream oss;
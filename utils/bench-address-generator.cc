@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the setup of large address plans
+// with Ipv4AddressGenerator and Ipv6AddressGenerator.  The plan has 'networks'
+// subnets of 'hosts' addresses each.  The addresses are allocated one by one
+// in order, one by one in a random order, and by ranges of one subnet.
+// Sample usage:  ./waf --run 'bench-address-generator --networks=4000 --hosts=250'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/ipv6-address-generator.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h> // for rand ()
+
+using namespace ns3;
+
+/**
+ * Print the result of a benchmark.
+ * \param name the benchmark name
+ * \param n the number of addresses allocated
+ * \param ms the elapsed time
+ */
+static void
+PrintResult (const char *name, uint32_t n, int64_t ms)
+{
+  std::cout << name << ": " << n << " addresses in " << ms << " ms";
+  if (ms > 0)
+    {
+      std::cout << " (" << n / ms << " addresses/ms)";
+    }
+  std::cout << std::endl;
+}
+
+/**
+ * Benchmark Ipv4AddressGenerator.
+ * \param networks the number of subnets
+ * \param hosts the number of addresses in each subnet
+ */
+static void
+BenchIpv4 (uint32_t networks, uint32_t hosts)
+{
+  Ipv4Mask mask ("255.255.255.0");
+  uint32_t n = networks * hosts;
+  SystemWallClockMs time;
+
+  Ipv4AddressGenerator::Reset ();
+  Ipv4AddressGenerator::Init (Ipv4Address ("10.0.0.0"), mask, Ipv4Address ("0.0.0.1"));
+  time.Start ();
+  for (uint32_t i = 0; i < networks; i++)
+    {
+      for (uint32_t j = 0; j < hosts; j++)
+        {
+          Ipv4AddressGenerator::NextAddress (mask);
+        }
+      Ipv4AddressGenerator::NextNetwork (mask);
+      Ipv4AddressGenerator::InitAddress (Ipv4Address ("0.0.0.1"), mask);
+    }
+  PrintResult ("ipv4 sequential", n, time.End ());
+
+  std::vector<uint32_t> addresses;
+  addresses.reserve (n);
+  for (uint32_t i = 0; i < networks; i++)
+    {
+      for (uint32_t j = 0; j < hosts; j++)
+        {
+          addresses.push_back (Ipv4Address ("10.0.0.0").Get () + (i << 8) + j + 1);
+        }
+    }
+  std::random_shuffle (addresses.begin (), addresses.end ());
+  Ipv4AddressGenerator::Reset ();
+  time.Start ();
+  for (std::vector<uint32_t>::const_iterator it = addresses.begin (); it != addresses.end (); it++)
+    {
+      Ipv4AddressGenerator::AddAllocated (Ipv4Address (*it));
+    }
+  PrintResult ("ipv4 random", n, time.End ());
+
+  Ipv4AddressGenerator::Reset ();
+  time.Start ();
+  for (uint32_t i = 0; i < networks; i++)
+    {
+      uint32_t base = Ipv4Address ("10.0.0.0").Get () + (i << 8);
+      Ipv4AddressGenerator::AddAllocated (Ipv4Address (base + 1), Ipv4Address (base + hosts));
+    }
+  PrintResult ("ipv4 ranges", n, time.End ());
+  Ipv4AddressGenerator::Reset ();
+}
+
+/**
+ * Benchmark Ipv6AddressGenerator.
+ * \param networks the number of subnets
+ * \param hosts the number of addresses in each subnet
+ */
+static void
+BenchIpv6 (uint32_t networks, uint32_t hosts)
+{
+  Ipv6Prefix prefix (64);
+  uint32_t n = networks * hosts;
+  SystemWallClockMs time;
+
+  Ipv6AddressGenerator::Reset ();
+  Ipv6AddressGenerator::Init (Ipv6Address ("2001:db8::"), prefix, Ipv6Address ("::1"));
+  time.Start ();
+  for (uint32_t i = 0; i < networks; i++)
+    {
+      for (uint32_t j = 0; j < hosts; j++)
+        {
+          Ipv6AddressGenerator::NextAddress (prefix);
+        }
+      Ipv6AddressGenerator::NextNetwork (prefix);
+      Ipv6AddressGenerator::InitAddress (Ipv6Address ("::1"), prefix);
+    }
+  PrintResult ("ipv6 sequential", n, time.End ());
+
+  std::vector<Ipv6Address> addresses;
+  addresses.reserve (n);
+  uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  for (uint32_t i = 0; i < networks; i++)
+    {
+      bytes[4] = i >> 24;
+      bytes[5] = i >> 16;
+      bytes[6] = i >> 8;
+      bytes[7] = i;
+      for (uint32_t j = 0; j < hosts; j++)
+        {
+          bytes[12] = (j + 1) >> 24;
+          bytes[13] = (j + 1) >> 16;
+          bytes[14] = (j + 1) >> 8;
+          bytes[15] = j + 1;
+          addresses.push_back (Ipv6Address (bytes));
+        }
+    }
+  std::random_shuffle (addresses.begin (), addresses.end ());
+  Ipv6AddressGenerator::Reset ();
+  time.Start ();
+  for (std::vector<Ipv6Address>::const_iterator it = addresses.begin (); it != addresses.end (); it++)
+    {
+      Ipv6AddressGenerator::AddAllocated (*it);
+    }
+  PrintResult ("ipv6 random", n, time.End ());
+
+  Ipv6AddressGenerator::Reset ();
+  time.Start ();
+  for (uint32_t i = 0; i < networks; i++)
+    {
+      bytes[4] = i >> 24;
+      bytes[5] = i >> 16;
+      bytes[6] = i >> 8;
+      bytes[7] = i;
+      bytes[12] = bytes[13] = bytes[14] = 0;
+      bytes[15] = 1;
+      Ipv6Address low (bytes);
+      bytes[12] = hosts >> 24;
+      bytes[13] = hosts >> 16;
+      bytes[14] = hosts >> 8;
+      bytes[15] = hosts;
+      Ipv6AddressGenerator::AddAllocated (low, Ipv6Address (bytes));
+    }
+  PrintResult ("ipv6 ranges", n, time.End ());
+  Ipv6AddressGenerator::Reset ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t networks = 4000;
+  uint32_t hosts = 250;
+
+  CommandLine cmd;
+  cmd.AddValue ("networks", "number of subnets (at most 65536)", networks);
+  cmd.AddValue ("hosts", "number of addresses per subnet (at most 254)", hosts);
+  cmd.Parse (argc, argv);
+
+  std::cout << "Running bench-address-generator with " << networks
+            << " networks of " << hosts << " hosts" << std::endl;
+  BenchIpv4 (networks, hosts);
+  BenchIpv6 (networks, hosts);
+  return 0;
+}
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program converts a binary trace, recorded with
+// AsciiTraceHelper::CreateBinaryFileStream, to the ascii trace that the
+// default trace sinks would have written.
+// Sample usage:  ./waf --run 'print-binary-trace --input=trace.bin --output=trace.tr'
+
+#include <iostream>
+#include <fstream>
+#include "ns3/command-line.h"
+#include "ns3/abort.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/binary-trace.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a binary trace to an ascii trace");
+  cmd.AddValue ("input", "binary trace file", input);
+  cmd.AddValue ("output", "ascii trace file (standard output if empty)", output);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (input.empty (), "print-binary-trace: --input is required");
+
+  //
+  // The trace packets carry their metadata, which is only used if printing
+  // is enabled.
+  //
+  Packet::EnablePrinting ();
+
+  BinaryTraceReader reader (input);
+  if (reader.GetResolution () != Time::GetResolution ())
+    {
+      Time::SetResolution (reader.GetResolution ());
+    }
+
+  std::ofstream file;
+  std::ostream *os = &std::cout;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      NS_ABORT_MSG_IF (file.fail (), "print-binary-trace: unable to open " << output);
+      os = &file;
+    }
+
+  BinaryTraceReader::Record record;
+  while (reader.Read (record))
+    {
+      BinaryTraceReader::Print (*os, record);
+    }
+
+  return 0;
+}